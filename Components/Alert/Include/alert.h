@@ -2,22 +2,35 @@
 #define _ALERT_H
 
 #include <stdint.h>
-#include <gpiod.h>
 
 // Use macros for constants to avoid memory allocation in header
 #define CHIP_PATH "/dev/gpiochip0"
 #define ERROR_LOG "[Error at alert library]"
 
-uint8_t led_pin = -1;
-uint8_t buzzer_pin = -1;
-// Extern declarations (Defined in alert.c)
-extern struct gpiod_chip* chip;
-extern struct gpiod_line_request* led_request;
-extern struct gpiod_line_request* buzzer_request;
+#define ALERT_MAX_OUTPUTS 8     // Lines held in the single GPIO request
+#define ALERT_OUTPUT_LED 0      // Output index of the LED (first offset given to alert_init)
+#define ALERT_OUTPUT_BUZZER 1   // Output index of the buzzer (second offset given to alert_init)
 
 /*-------------------- Function declearation---------------------*/
 
+/**
+ * @brief Requests the LED and buzzer lines (BCM offsets). Aborts if the lines cannot be reserved.
+ */
 void alert_init (uint8_t led, uint8_t buzzer);
+
+/**
+ * @brief Requests n output lines in one GPIO line request and starts the pattern thread.
+ *        Output i drives offsets[i]; index 0 is the LED and index 1 the buzzer.
+ * @return 0 on success, -1 on failure.
+ */
+int alert_init_outputs(const unsigned int* offsets, int n);
+
+/**
+ * @brief Removes the alert rules, stops the pattern thread, drives every output low and releases the lines.
+ *        Called automatically when the library is unloaded.
+ */
+void alert_close(void);
+
 /**
  * @brief Sets the state of the Alert LED.
  * * @param state 1 to turn the LED on (High), 0 to turn it off (Low).
@@ -42,7 +55,6 @@ int alert_get_led_state(void);
  */
 int alert_get_buzzer_state(void);
 
-
 /**
  * @brief Immediately activates both the LED and the Buzzer.
  */
@@ -52,4 +64,46 @@ void alert_all_on(void);
  * @brief Immediately deactivates both the LED and the Buzzer.
  */
 void alert_all_off(void);
+
+/**
+ * @brief Sets the state of one output. Cancels a pattern running on it.
+ * @return 0 on success, -1 on invalid index or GPIO error.
+ */
+int alert_set_output(int index, int state);
+
+/**
+ * @brief Updates every output selected by mask (bit i = output i) in a single line update.
+ *        Cancels patterns running on the selected outputs.
+ * @param values Bit i is the new state of output i.
+ * @return 0 on success, -1 on GPIO error.
+ */
+int alert_set_outputs(uint32_t mask, uint32_t values);
+
+/**
+ * @brief Reads one output back from the line.
+ * @return 1 if High, 0 if Low, or -1 if the output is not initialized.
+ */
+int alert_get_output(int index);
+
+/*-------------------- Pattern engine ---------------------*/
+
+/**
+ * @brief Blinks/beeps an output from the pattern thread: on_ms high, off_ms low, repeated.
+ *        Outputs whose phases change at the same time are updated together.
+ * @param cycles Number of on/off cycles, 0 = until alert_pattern_stop(). The output ends low.
+ * @return 0 on success, -1 on invalid arguments or if the library is not initialized.
+ */
+int alert_pattern_start(int index, unsigned int on_ms, unsigned int off_ms, unsigned int cycles);
+
+/**
+ * @brief Stops the pattern of one output and drives it low.
+ * @return 0 on success, -1 on invalid index.
+ */
+int alert_pattern_stop(int index);
+
+/**
+ * @brief 1 while a pattern runs on the output, 0 otherwise.
+ */
+int alert_pattern_active(int index);
+
 #endif
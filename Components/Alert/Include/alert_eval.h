@@ -0,0 +1,85 @@
+#ifndef _ALERT_EVAL_H
+#define _ALERT_EVAL_H
+
+#include <stdint.h>
+
+#define ALERT_EVAL_MAX_RULES 16
+#define ALERT_EVAL_EVENT_QUEUE_LEN 64
+
+// Rule direction, same values as AlertType in alert_manager.py
+#define ALERT_EVAL_LOW 1    // Breach when value < threshold
+#define ALERT_EVAL_HIGH 2   // Breach when value > threshold
+
+/**
+ * @brief Threshold rule on one value channel, equivalent to an Alert object.
+ */
+typedef struct {
+    int channel;            // Caller-defined channel id passed to alert_eval_feed()
+    int type;               // ALERT_EVAL_LOW / ALERT_EVAL_HIGH
+    float threshold;
+    float hysteresis;       // Non-latched rules clear once the value is back past threshold by this margin
+    int persistence;        // Consecutive breaching samples needed to raise the rule
+    int latch;              // 1 = stay raised until alert_eval_clear()
+    uint32_t output_mask;   // Outputs driven while raised (bit i = output i)
+    unsigned int on_ms;     // Pattern on/off times; 0 = outputs held solid on
+    unsigned int off_ms;
+} alert_rule_t;
+
+/**
+ * @brief Rule transition queued for the application (logging, uplink).
+ */
+typedef struct {
+    int rule;
+    int active;             // 1 = raised, 0 = cleared
+    float value;            // Sample that caused the transition
+    uint64_t timestamp_ms;  // CLOCK_MONOTONIC
+} alert_eval_event_t;
+
+/**
+ * @brief Adds a rule. Outputs must already be initialized with alert_init()/alert_init_outputs().
+ * @return Rule id (>= 0), or -1 on invalid rule / table full.
+ */
+int alert_eval_add_rule(const alert_rule_t* rule);
+
+/**
+ * @brief Evaluates every rule of the channel against a new sample. Outputs are switched
+ *        before the call returns, so breach-to-output latency is the feed latency.
+ * @return Number of rule transitions (>= 0), or -1 if no rule is defined.
+ */
+int alert_eval_feed(int channel, float value);
+
+/**
+ * @brief alert_eval_feed() for n (channel, value) pairs under one lock.
+ */
+int alert_eval_feed_many(const int* channels, const float* values, int n);
+
+/**
+ * @brief 1 if the rule is raised, 0 if not, -1 on invalid id.
+ */
+int alert_eval_rule_active(int rule);
+
+/**
+ * @brief Clears a raised rule and its persistence counter; releases its outputs.
+ * @return 0 on success, -1 on invalid id.
+ */
+int alert_eval_clear(int rule);
+
+/**
+ * @brief eventfd readable while transitions are queued (for poll/select loops).
+ */
+int alert_eval_get_fd(void);
+
+/**
+ * @brief Pops queued transitions, waiting up to timeout_ms for the first one (-1 = forever, 0 = no wait).
+ * @return Number of events written to out, or -1 on error or when alert_eval_reset() ran meanwhile.
+ *         Oldest events are dropped when the queue overflows.
+ */
+int alert_eval_wait_events(alert_eval_event_t* out, int max, int timeout_ms);
+
+/**
+ * @brief Removes every rule and releases the event fd (called by alert_close()).
+ *        Threads waiting in alert_eval_wait_events() are woken and have returned before the fd is closed.
+ */
+void alert_eval_reset(void);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _ALERT_PATTERN_H
+#define _ALERT_PATTERN_H
+
+#include <stdint.h>
+
+/*-------------------- Internal interface between main.c and pattern.c ---------------------*/
+
+/**
+ * @brief Starts the pattern thread (timerfd for the next phase change, eventfd for wake-ups).
+ * @return 0 on success, -1 on failure.
+ */
+int pattern_engine_start(void);
+
+/**
+ * @brief Cancels every pattern and joins the thread.
+ */
+void pattern_engine_stop(void);
+
+/**
+ * @brief Cancels the patterns of the outputs in mask without touching the lines.
+ */
+void pattern_engine_cancel(uint32_t mask);
+
+/**
+ * @brief Writes the outputs in mask without cancelling patterns (defined in main.c).
+ * @return 0 on success, -1 on GPIO error.
+ */
+int alert_write_outputs(uint32_t mask, uint32_t values);
+
+/**
+ * @brief Number of initialized outputs (defined in main.c).
+ */
+int alert_output_count(void);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef _GPIO_BACKEND_H
+#define _GPIO_BACKEND_H
+
+/*
+ * Output line backend used by the alert library. gpio_gpiod.c drives the lines through
+ * one libgpiod request; gpio_mock.c (ALERT_MOCK_GPIO build) keeps them in memory so the
+ * library runs on a machine without /dev/gpiochip0.
+ */
+
+/**
+ * @brief Requests n output lines, all driven low.
+ * @return 0 on success, -1 on failure.
+ */
+int gpio_backend_open(const char* chip_path, const unsigned int* offsets, int n, const char* consumer);
+
+/**
+ * @brief Writes every line at once. values[i] is the state of offsets[i].
+ * @return 0 on success, -1 on failure.
+ */
+int gpio_backend_set(const int* values);
+
+/**
+ * @brief Reads line `index` back. Returns 1, 0, or -1 on error.
+ */
+int gpio_backend_get(int index);
+
+void gpio_backend_close(void);
+
+#endif
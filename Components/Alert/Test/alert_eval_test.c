@@ -0,0 +1,116 @@
+#include "alert.h"
+#include "alert_eval.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Native threshold evaluator on the mock GPIO backend.
+ *
+ * Persistence, hysteresis and the outputs switched by a rule, then alert_close() racing a
+ * thread blocked in alert_eval_wait_events(): the waiter must be woken and gone before the
+ * event fd is closed, every time, whatever the timeout it is blocked with.
+ */
+
+#define CLOSE_CYCLES 200
+#define WAKE_LIMIT_MS 2000
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __func__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+typedef struct {
+    int timeout_ms;
+    int ret;
+    volatile int done;
+} waiter_t;
+
+static const unsigned int OFFSETS[2] = { 17, 27 };
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static int add_high_rule(float threshold, int persistence, float hysteresis) {
+    alert_rule_t rule = { 0 };
+    rule.channel = 0;
+    rule.type = ALERT_EVAL_HIGH;
+    rule.threshold = threshold;
+    rule.hysteresis = hysteresis;
+    rule.persistence = persistence;
+    rule.output_mask = 1u << 0;
+    return alert_eval_add_rule(&rule);
+}
+
+static void* wait_thread(void *arg) {
+    waiter_t *w = (waiter_t*)arg;
+    alert_eval_event_t ev[4];
+    w->ret = alert_eval_wait_events(ev, 4, w->timeout_ms);
+    __atomic_store_n(&w->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void test_rule(void) {
+    CHECK(alert_init_outputs(OFFSETS, 2) == 0, "mock outputs");
+    int rule = add_high_rule(50.0f, 3, 5.0f);
+    CHECK(rule >= 0, "add_rule");
+
+    alert_eval_event_t ev[4];
+    CHECK(alert_eval_feed(0, 60.0f) == 0 && alert_eval_feed(0, 60.0f) == 0, "raised before persistence");
+    CHECK(alert_eval_feed(0, 40.0f) == 0 && alert_eval_feed(0, 60.0f) == 0, "breach count not reset");
+    CHECK(alert_eval_feed(0, 61.0f) == 0 && alert_eval_feed(0, 62.0f) == 1, "not raised after 3 breaches");
+    CHECK(alert_eval_rule_active(rule) == 1 && alert_get_output(0) == 1, "output %d", alert_get_output(0));
+    CHECK(alert_eval_wait_events(ev, 4, 0) == 1 && ev[0].rule == rule && ev[0].active == 1 && ev[0].value == 62.0f,
+          "raise event");
+
+    // Hysteresis: back under the threshold is not enough, under threshold - hysteresis clears
+    CHECK(alert_eval_feed(0, 48.0f) == 0 && alert_eval_rule_active(rule) == 1, "cleared inside the hysteresis band");
+    CHECK(alert_eval_feed(0, 44.0f) == 1 && alert_eval_rule_active(rule) == 0 && alert_get_output(0) == 0, "not cleared");
+    CHECK(alert_eval_wait_events(ev, 4, 0) == 1 && ev[0].active == 0, "clear event");
+    CHECK(alert_eval_wait_events(ev, 4, 0) == 0, "spurious event");
+    alert_close();
+    CHECK(alert_eval_wait_events(ev, 4, 0) == -1, "wait after close");
+}
+
+// A waiter blocked forever (or for a while) on the event fd while the evaluator is closed
+static void test_close_wakes_waiter(void) {
+    for (int i = 0; i < CLOSE_CYCLES; i++) {
+        alert_init_outputs(OFFSETS, 2);
+        if (add_high_rule(50.0f, 1, 0.0f) < 0) {
+            CHECK(0, "cycle %d: add_rule", i);
+            return;
+        }
+        waiter_t w = { (i % 2) ? -1 : 60000, 0, 0 };
+        pthread_t thread;
+        pthread_create(&thread, NULL, wait_thread, &w);
+        usleep((useconds_t)(i % 4) * 500);     // Before, while and after the waiter enters poll()
+
+        alert_close();
+        uint64_t start = now_ms();
+        while (!__atomic_load_n(&w.done, __ATOMIC_ACQUIRE) && now_ms() - start < WAKE_LIMIT_MS) usleep(1000);
+        if (!__atomic_load_n(&w.done, __ATOMIC_ACQUIRE)) {
+            printf("FAIL %s: cycle %d: waiter still blocked %d ms after alert_close()\n", __func__, i, WAKE_LIMIT_MS);
+            fflush(stdout);
+            _exit(1);   // Cannot join it
+        }
+        pthread_join(thread, NULL);
+        CHECK(w.ret <= 0, "cycle %d: waiter returned %d events", i, w.ret);
+    }
+}
+
+int main(void) {
+    test_rule();
+    test_close_wakes_waiter();
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+#include "Include/alert.h"
+#include "Include/alert_eval.h"
+#include "logger.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+typedef struct {
+    alert_rule_t cfg;
+    int breach_count;
+    int active;
+} rule_state_t;
+
+static rule_state_t rules[ALERT_EVAL_MAX_RULES];
+static int n_rules = 0;
+static int output_refs[ALERT_MAX_OUTPUTS];   // Raised rules holding each output
+
+static alert_eval_event_t events[ALERT_EVAL_EVENT_QUEUE_LEN];
+static int event_head = 0;
+static int event_count = 0;
+static int event_fd = -1;
+static int waiters = 0;             // Threads inside alert_eval_wait_events() holding a copy of event_fd
+static int closing = 0;             // alert_eval_reset() waiting for them to leave
+
+static pthread_mutex_t eval_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t waiters_gone = PTHREAD_COND_INITIALIZER;
+
+/*---------------------------- Private Function --------------------------------*/
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static int is_breach(const alert_rule_t* r, float v) {
+    return (r->type == ALERT_EVAL_HIGH) ? v > r->threshold : v < r->threshold;
+}
+
+static int is_recovered(const alert_rule_t* r, float v) {
+    return (r->type == ALERT_EVAL_HIGH) ? v <= r->threshold - r->hysteresis
+                                        : v >= r->threshold + r->hysteresis;
+}
+
+// Drives or releases the outputs of a rule. Called with eval_lock held.
+static void apply_outputs(const rule_state_t* s, int raise) {
+    uint32_t mask = s->cfg.output_mask;
+    uint32_t switch_mask = 0;
+
+    for (int i = 0; i < ALERT_MAX_OUTPUTS; i++) {
+        if (!(mask & (1u << i))) continue;
+        if (raise) {
+            if (output_refs[i]++ == 0) switch_mask |= 1u << i;
+        } else if (output_refs[i] > 0 && --output_refs[i] == 0) {
+            switch_mask |= 1u << i;   // Last raised rule on this output
+        }
+    }
+    if (switch_mask == 0) return;
+
+    if (raise && s->cfg.on_ms != 0) {
+        for (int i = 0; i < ALERT_MAX_OUTPUTS; i++) {
+            if (switch_mask & (1u << i)) alert_pattern_start(i, s->cfg.on_ms, s->cfg.off_ms, 0);
+        }
+    } else {
+        alert_set_outputs(switch_mask, raise ? switch_mask : 0);  // One line update
+    }
+}
+
+static void push_event(int rule, int active, float value) {
+    int tail = (event_head + event_count) % ALERT_EVAL_EVENT_QUEUE_LEN;
+    if (event_count == ALERT_EVAL_EVENT_QUEUE_LEN) {
+        event_head = (event_head + 1) % ALERT_EVAL_EVENT_QUEUE_LEN;  // Drop the oldest
+    } else {
+        event_count++;
+    }
+    events[tail].rule = rule;
+    events[tail].active = active;
+    events[tail].value = value;
+    events[tail].timestamp_ms = now_ms();
+
+    uint64_t one = 1;
+    if (event_fd >= 0 && write(event_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        LOGGER_E(LOGGER_COMP_ALERT, "Failed to signal alert event");
+    }
+}
+
+// Returns 1 on a transition. Called with eval_lock held.
+static int evaluate(int id, float v) {
+    rule_state_t* s = &rules[id];
+
+    if (s->active) {
+        if (s->cfg.latch || !is_recovered(&s->cfg, v)) return 0;
+        s->active = 0;
+        s->breach_count = 0;
+        apply_outputs(s, 0);
+        push_event(id, 0, v);
+        return 1;
+    }
+
+    if (!is_breach(&s->cfg, v)) {
+        s->breach_count = 0;
+        return 0;
+    }
+    if (++s->breach_count < s->cfg.persistence) return 0;
+    s->active = 1;
+    apply_outputs(s, 1);   // Outputs first: logging happens later, off the critical path
+    push_event(id, 1, v);
+    return 1;
+}
+
+static int feed_locked(int channel, float value) {
+    int transitions = 0;
+    for (int i = 0; i < n_rules; i++) {
+        if (rules[i].cfg.channel == channel) transitions += evaluate(i, value);
+    }
+    return transitions;
+}
+
+/*------------------------ Public Function -----------------------------*/
+int alert_eval_add_rule(const alert_rule_t* rule) {
+    if (rule == NULL || (rule->type != ALERT_EVAL_LOW && rule->type != ALERT_EVAL_HIGH)) return -1;
+
+    pthread_mutex_lock(&eval_lock);
+    if (n_rules == ALERT_EVAL_MAX_RULES) {
+        pthread_mutex_unlock(&eval_lock);
+        LOGGER_E(LOGGER_COMP_ALERT, "Alert rule table full");
+        return -1;
+    }
+    if (event_fd < 0) {
+        event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (event_fd < 0) {
+            pthread_mutex_unlock(&eval_lock);
+            LOGGER_E(LOGGER_COMP_ALERT, "Failed to create alert event fd: %s", strerror(errno));
+            return -1;
+        }
+    }
+    int id = n_rules++;
+    memset(&rules[id], 0, sizeof(rules[id]));
+    rules[id].cfg = *rule;
+    if (rules[id].cfg.persistence < 1) rules[id].cfg.persistence = 1;
+    pthread_mutex_unlock(&eval_lock);
+    return id;
+}
+
+int alert_eval_feed(int channel, float value) {
+    pthread_mutex_lock(&eval_lock);
+    int ret = (n_rules == 0) ? -1 : feed_locked(channel, value);
+    pthread_mutex_unlock(&eval_lock);
+    return ret;
+}
+
+int alert_eval_feed_many(const int* channels, const float* values, int n) {
+    if (channels == NULL || values == NULL || n < 0) return -1;
+
+    pthread_mutex_lock(&eval_lock);
+    int ret = (n_rules == 0) ? -1 : 0;
+    for (int i = 0; i < n && ret >= 0; i++) ret += feed_locked(channels[i], values[i]);
+    pthread_mutex_unlock(&eval_lock);
+    return ret;
+}
+
+int alert_eval_rule_active(int rule) {
+    pthread_mutex_lock(&eval_lock);
+    int ret = (rule < 0 || rule >= n_rules) ? -1 : rules[rule].active;
+    pthread_mutex_unlock(&eval_lock);
+    return ret;
+}
+
+int alert_eval_clear(int rule) {
+    pthread_mutex_lock(&eval_lock);
+    if (rule < 0 || rule >= n_rules) {
+        pthread_mutex_unlock(&eval_lock);
+        return -1;
+    }
+    rule_state_t* s = &rules[rule];
+    if (s->active) apply_outputs(s, 0);
+    s->active = 0;
+    s->breach_count = 0;
+    pthread_mutex_unlock(&eval_lock);
+    return 0;
+}
+
+int alert_eval_get_fd(void) {
+    return event_fd;
+}
+
+int alert_eval_wait_events(alert_eval_event_t* out, int max, int timeout_ms) {
+    if (out == NULL || max <= 0) return -1;
+
+    pthread_mutex_lock(&eval_lock);
+    int fd = event_fd;
+    int pending = event_count;
+    if (fd < 0 || closing) {
+        pthread_mutex_unlock(&eval_lock);
+        return -1;
+    }
+    waiters++;  // The fd stays open until this thread is back
+    pthread_mutex_unlock(&eval_lock);
+
+    int poll_failed = 0;
+    if (pending == 0 && timeout_ms != 0) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        poll_failed = poll(&pfd, 1, timeout_ms) < 0 && errno != EINTR;
+    }
+
+    pthread_mutex_lock(&eval_lock);
+    if (--waiters == 0 && closing) pthread_cond_broadcast(&waiters_gone);
+    if (poll_failed || closing) {
+        pthread_mutex_unlock(&eval_lock);
+        return -1;
+    }
+    uint64_t drain;
+    (void)!read(event_fd, &drain, sizeof(drain));
+    int n = 0;
+    while (n < max && event_count > 0) {
+        out[n++] = events[event_head];
+        event_head = (event_head + 1) % ALERT_EVAL_EVENT_QUEUE_LEN;
+        event_count--;
+    }
+    if (event_count > 0) {  // Keep the fd readable for the rest
+        uint64_t one = 1;
+        (void)!write(event_fd, &one, sizeof(one));
+    }
+    pthread_mutex_unlock(&eval_lock);
+    return n;
+}
+
+void alert_eval_reset(void) {
+    pthread_mutex_lock(&eval_lock);
+    n_rules = 0;
+    memset(output_refs, 0, sizeof(output_refs));
+    event_head = 0;
+    event_count = 0;
+    if (event_fd >= 0) {
+        // Wake the threads blocked in poll() on the fd and wait for them to leave before closing it:
+        // a closed (or reused) descriptor would leave them asleep or polling something else
+        closing = 1;
+        uint64_t one = 1;
+        (void)!write(event_fd, &one, sizeof(one));
+        while (waiters > 0) pthread_cond_wait(&waiters_gone, &eval_lock);
+        closing = 0;
+        close(event_fd);
+    }
+    event_fd = -1;
+    pthread_mutex_unlock(&eval_lock);
+}
@@ -0,0 +1,76 @@
+#include "Include/alert.h"
+#include "Include/gpio_backend.h"
+#include "logger.h"
+#include <gpiod.h>
+#include <stdio.h>
+
+static struct gpiod_chip* chip = NULL;
+static struct gpiod_line_request* request = NULL;
+static unsigned int line_offsets[ALERT_MAX_OUTPUTS];
+static int n_lines = 0;
+
+/*------------------------ Public Function -----------------------------*/
+int gpio_backend_open(const char* chip_path, const unsigned int* offsets, int n, const char* consumer) {
+    if (n <= 0 || n > ALERT_MAX_OUTPUTS) return -1;
+
+    chip = gpiod_chip_open(chip_path);
+    if (!chip) {
+        LOGGER_E(LOGGER_COMP_ALERT, "Failed to open chip %s", chip_path);
+        return -1;
+    }
+
+    struct gpiod_line_settings* settings = gpiod_line_settings_new();
+    struct gpiod_line_config* line_cfg = gpiod_line_config_new();
+    struct gpiod_request_config* req_cfg = gpiod_request_config_new();
+    if (settings && line_cfg && req_cfg) {
+        gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_OUTPUT);
+        gpiod_line_settings_set_output_value(settings, GPIOD_LINE_VALUE_INACTIVE);
+        // Every offset shares the same settings, so all of them go into one request
+        if (gpiod_line_config_add_line_settings(line_cfg, offsets, (size_t)n, settings) == 0) {
+            gpiod_request_config_set_consumer(req_cfg, consumer);
+            request = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+        }
+    }
+
+    // Clean up temporary objects
+    gpiod_line_settings_free(settings);
+    gpiod_line_config_free(line_cfg);
+    gpiod_request_config_free(req_cfg);
+
+    if (!request) {
+        gpiod_chip_close(chip);
+        chip = NULL;
+        return -1;
+    }
+    for (int i = 0; i < n; i++) line_offsets[i] = offsets[i];
+    n_lines = n;
+    return 0;
+}
+
+int gpio_backend_set(const int* values) {
+    if (!request) return -1;
+
+    enum gpiod_line_value levels[ALERT_MAX_OUTPUTS];
+    for (int i = 0; i < n_lines; i++) {
+        levels[i] = values[i] ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
+    }
+    // Values follow the offset order of the request: one ioctl for all lines
+    return gpiod_line_request_set_values(request, levels) == 0 ? 0 : -1;
+}
+
+int gpio_backend_get(int index) {
+    if (!request || index < 0 || index >= n_lines) return -1;
+    return gpiod_line_request_get_value(request, line_offsets[index]);
+}
+
+void gpio_backend_close(void) {
+    if (request != NULL) {
+        gpiod_line_request_release(request);
+        request = NULL;
+    }
+    if (chip != NULL) {
+        gpiod_chip_close(chip);
+        chip = NULL;
+    }
+    n_lines = 0;
+}
@@ -0,0 +1,57 @@
+#include "Include/alert.h"
+#include "Include/gpio_backend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * In-memory GPIO lines for development machines (cmake -DALERT_MOCK_GPIO=ON).
+ * Set ALERT_MOCK_TRACE=1 to print every line update with a monotonic timestamp.
+ */
+
+static int line_values[ALERT_MAX_OUTPUTS];
+static unsigned int line_offsets[ALERT_MAX_OUTPUTS];
+static int n_lines = 0;
+static int trace = 0;
+static unsigned long n_writes = 0;
+
+/*------------------------ Public Function -----------------------------*/
+int gpio_backend_open(const char* chip_path, const unsigned int* offsets, int n, const char* consumer) {
+    if (n <= 0 || n > ALERT_MAX_OUTPUTS) return -1;
+
+    const char* env = getenv("ALERT_MOCK_TRACE");
+    trace = (env != NULL && env[0] == '1');
+    for (int i = 0; i < n; i++) {
+        line_offsets[i] = offsets[i];
+        line_values[i] = 0;
+    }
+    n_lines = n;
+    n_writes = 0;
+    printf("Alert mock GPIO: %d lines requested on %s for %s\n", n, chip_path, consumer);
+    return 0;
+}
+
+int gpio_backend_set(const int* values) {
+    if (n_lines == 0) return -1;
+
+    for (int i = 0; i < n_lines; i++) line_values[i] = values[i] ? 1 : 0;
+    n_writes++;
+    if (trace) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        printf("[alert-mock] %ld.%03ld write #%lu:", (long)ts.tv_sec, ts.tv_nsec / 1000000L, n_writes);
+        for (int i = 0; i < n_lines; i++) printf(" %u=%d", line_offsets[i], line_values[i]);
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}
+
+int gpio_backend_get(int index) {
+    if (index < 0 || index >= n_lines) return -1;
+    return line_values[index];
+}
+
+void gpio_backend_close(void) {
+    n_lines = 0;
+}
@@ -1,118 +1,139 @@
 #include "Include/alert.h"
+#include "Include/alert_eval.h"
+#include "Include/alert_pattern.h"
+#include "Include/gpio_backend.h"
+#include "logger.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
 
-// Definitions of the externs
-struct gpiod_chip* chip = NULL;
-struct gpiod_line_request* led_request = NULL;
-struct gpiod_line_request* buzzer_request = NULL;
+// All outputs live in one line request; output_values mirrors what was last written
+static int n_outputs = 0;
+static uint32_t output_values = 0;
+static pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /*---------------------------- Private Function --------------------------------*/
-static struct gpiod_line_request* setup_pin(unsigned int offset, const char* consumer) {
-    struct gpiod_line_settings* settings = gpiod_line_settings_new();
-    gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_OUTPUT);
-
-    struct gpiod_line_config* line_cfg = gpiod_line_config_new();
-    gpiod_line_config_add_line_settings(line_cfg, &offset, 1, settings);
-
-    struct gpiod_request_config* req_cfg = gpiod_request_config_new();
-    gpiod_request_config_set_consumer(req_cfg, consumer);
-
-    struct gpiod_line_request* request = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+static void __attribute__((destructor)) _deconstruction(void) {
+    if (n_outputs == 0) return;
+    alert_close();
+    LOGGER_I(LOGGER_COMP_ALERT, "Alert library resources released successfully");
+}
 
-    // Clean up temporary objects
-    gpiod_line_settings_free(settings);
-    gpiod_line_config_free(line_cfg);
-    gpiod_request_config_free(req_cfg);
+/*------------------------ Internal Function -----------------------------*/
+int alert_write_outputs(uint32_t mask, uint32_t values) {
+    int ret = 0;
+    pthread_mutex_lock(&output_lock);
+    if (n_outputs == 0) {
+        pthread_mutex_unlock(&output_lock);
+        return -1;
+    }
+    mask &= (1u << n_outputs) - 1;
+    uint32_t next = (output_values & ~mask) | (values & mask);
+    if (next != output_values) {   // Skip the ioctl when nothing changes
+        int levels[ALERT_MAX_OUTPUTS];
+        for (int i = 0; i < n_outputs; i++) levels[i] = (next >> i) & 1u;
+        ret = gpio_backend_set(levels);
+        if (ret == 0) output_values = next;
+    }
+    pthread_mutex_unlock(&output_lock);
+    return ret;
+}
 
-    return request;
+int alert_output_count(void) {
+    return n_outputs;
 }
 
-static void __attribute__((constructor)) _construction(void) {
-    chip = gpiod_chip_open(CHIP_PATH);
-    if (!chip) {
-        fprintf(stderr, "%s Failed to open chip\n", ERROR_LOG);
+/*------------------------ Public Function -----------------------------*/
+void alert_init(uint8_t led, uint8_t buzzer){
+    unsigned int offsets[2] = {led, buzzer};
+
+    if (alert_init_outputs(offsets, 2) != 0) {
+        LOGGER_E(LOGGER_COMP_ALERT, "Failed to reserve GPIO pins");
         abort();
     }
-    printf ("Open chip successfully");
-    info = gpiod_chip_get_info(chip);
-    if (!info) {
-	fprintf(stderr, "failed to read info: %s\n", strerror(errno));
-	abort();	
-    }
-
-    printf("%s [%s] (%zu lines)\n", gpiod_chip_info_get_name(info),
-    gpiod_chip_info_get_label(info),
-    gpiod_chip_info_get_num_lines(info));
-    gpiod_chip_info_free(info);
 
-    printf ("Get infor successfully");
+    LOGGER_I(LOGGER_COMP_ALERT, "Alert C initialized: LED (BCM %d) and Buzzer (BCM %d) ready",
+            led, buzzer);
 }
 
-static void __attribute__((destructor)) _deconstruction(void) {
-    // 1. Release the LED line request
-    if (led_request != NULL) {
-        gpiod_line_request_release(led_request);
-        led_request = NULL;
+int alert_init_outputs(const unsigned int* offsets, int n) {
+    if (offsets == NULL || n <= 0 || n > ALERT_MAX_OUTPUTS) {
+        LOGGER_E(LOGGER_COMP_ALERT, "Invalid output count (%d)", n);
+        return -1;
     }
+    if (n_outputs != 0) alert_close();
 
-    // 2. Release the Buzzer line request
-    if (buzzer_request != NULL) {
-        gpiod_line_request_release(buzzer_request);
-        buzzer_request = NULL;
+    if (gpio_backend_open(CHIP_PATH, offsets, n, "Alert") != 0) {
+        LOGGER_E(LOGGER_COMP_ALERT, "Failed to request %d GPIO lines", n);
+        return -1;
     }
-
-    // 3. Close the chip file descriptor
-    if (chip != NULL) {
-        gpiod_chip_close(chip);
-        chip = NULL;
+    pthread_mutex_lock(&output_lock);
+    n_outputs = n;
+    output_values = 0;
+    pthread_mutex_unlock(&output_lock);
+
+    if (pattern_engine_start() != 0) {
+        LOGGER_E(LOGGER_COMP_ALERT, "Failed to start the pattern thread");
+        alert_close();
+        return -1;
     }
-
-    printf("Alert library resources released successfully.\n");
+    return 0;
 }
 
+void alert_close(void) {
+    alert_eval_reset();
+    pattern_engine_stop();
+
+    pthread_mutex_lock(&output_lock);
+    if (n_outputs != 0) {
+        int levels[ALERT_MAX_OUTPUTS] = {0};
+        gpio_backend_set(levels);
+        gpio_backend_close();
+        n_outputs = 0;
+        output_values = 0;
+    }
+    pthread_mutex_unlock(&output_lock);
+}
 
-/*------------------------ Public Function -----------------------------*/
-void alert_init(uint8_t led, uint8_t buzzer){
-    led_pin = led;
-    buzzer_pin = buzzer;
-    led_request = setup_pin(led_pin, "Alert-LED");
-    buzzer_request = setup_pin(buzzer_pin, "Alert-Buzzer");
+int alert_set_outputs(uint32_t mask, uint32_t values) {
+    pattern_engine_cancel(mask);
+    return alert_write_outputs(mask, values);
+}
 
-    if (!led_request || !buzzer_request) {
-        fprintf(stderr, "%s Failed to reserve GPIO pins\n", ERROR_LOG);
-        abort();
-    }
+int alert_set_output(int index, int state) {
+    if (index < 0 || index >= n_outputs) return -1;
+    return alert_set_outputs(1u << index, state ? (1u << index) : 0);
+}
 
-    printf("Alert C initialized: LED (BCM %d) and Buzzer (BCM %d) ready.\n", 
-            led_pin, buzzer_pin);
+int alert_get_output(int index) {
+    int ret;
+    pthread_mutex_lock(&output_lock);
+    ret = (index < 0 || index >= n_outputs) ? -1 : gpio_backend_get(index);
+    pthread_mutex_unlock(&output_lock);
+    return ret;
 }
 
 void alert_set_led(int state) {
-    if (!led_request) return;
-
-    enum gpiod_line_value value = state ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
-    gpiod_line_request_set_value(led_request, led_pin, value);
+    alert_set_output(ALERT_OUTPUT_LED, state);
 }
 
 void alert_set_buzzer(int state) {
-    if (!buzzer_request) return;
-
-    enum gpiod_line_value value = state ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
-    gpiod_line_request_set_value(buzzer_request, buzzer_pin, value);
+    alert_set_output(ALERT_OUTPUT_BUZZER, state);
 }
 
 void alert_all_on(void) {
-    alert_set_led(1);
-    alert_set_buzzer(1);
+    alert_set_outputs((1u << ALERT_OUTPUT_LED) | (1u << ALERT_OUTPUT_BUZZER),
+                      (1u << ALERT_OUTPUT_LED) | (1u << ALERT_OUTPUT_BUZZER));
+}
+
+void alert_all_off(void) {
+    alert_set_outputs((1u << ALERT_OUTPUT_LED) | (1u << ALERT_OUTPUT_BUZZER), 0);
 }
 
 int alert_get_led_state(void) {
-    if (!led_request) return -1;
-    return gpiod_line_request_get_value(led_request, led_pin);
+    return alert_get_output(ALERT_OUTPUT_LED);
 }
 
 int alert_get_buzzer_state(void) {
-	if (!buzzer_request) return -1;
-	return gpiod_line_request_get_value (buzzer_request, buzzer_pin);
+	return alert_get_output(ALERT_OUTPUT_BUZZER);
 }
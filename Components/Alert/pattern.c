@@ -0,0 +1,194 @@
+#include "Include/alert.h"
+#include "Include/alert_pattern.h"
+#include "logger.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define NO_DEADLINE UINT64_MAX
+
+typedef struct {
+    int active;
+    int level;              // Current phase: 1 = on, 0 = off
+    unsigned int on_ms;
+    unsigned int off_ms;
+    unsigned int cycles_left; // Remaining on/off cycles, 0 = forever
+    uint64_t next_ms;       // CLOCK_MONOTONIC time of the next phase change
+} pattern_t;
+
+static pattern_t patterns[ALERT_MAX_OUTPUTS];
+static pthread_mutex_t pattern_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t pattern_thread;
+static int thread_running = 0;
+static int timer_fd = -1;
+static int wake_fd = -1;
+
+/*---------------------------- Private Function --------------------------------*/
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static void wake_thread(void) {
+    uint64_t one = 1;
+    if (wake_fd >= 0 && write(wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        LOGGER_E(LOGGER_COMP_ALERT, "Failed to wake the pattern thread");
+    }
+}
+
+static void arm_timer(uint64_t deadline_ms) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));  // All zero disarms the timer
+    if (deadline_ms != NO_DEADLINE) {
+        its.it_value.tv_sec = (time_t)(deadline_ms / 1000u);
+        its.it_value.tv_nsec = (long)(deadline_ms % 1000u) * 1000000L;
+    }
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+// Advances every due pattern and writes all changed outputs in one update. Called with pattern_lock held.
+static uint64_t run_due_patterns(uint64_t now) {
+    uint32_t mask = 0, values = 0;
+    uint64_t next = NO_DEADLINE;
+
+    for (int i = 0; i < ALERT_MAX_OUTPUTS; i++) {
+        pattern_t* p = &patterns[i];
+        if (!p->active) continue;
+
+        if (p->next_ms <= now) {
+            if (p->level) {
+                p->level = 0;
+                p->next_ms += p->off_ms;
+                if (p->cycles_left != 0 && --p->cycles_left == 0) p->active = 0;
+            } else {
+                p->level = 1;
+                p->next_ms += p->on_ms;
+            }
+            if (p->next_ms <= now) p->next_ms = now + 1;  // Fell behind (thread was descheduled): resync
+            mask |= 1u << i;
+            if (p->level) values |= 1u << i;
+        }
+        if (p->active && p->next_ms < next) next = p->next_ms;
+    }
+
+    if (mask != 0) alert_write_outputs(mask, values);
+    return next;
+}
+
+static void* pattern_loop(void* arg) {
+    (void)arg;
+    struct pollfd fds[2] = {
+        { .fd = timer_fd, .events = POLLIN },
+        { .fd = wake_fd, .events = POLLIN },
+    };
+
+    for (;;) {
+        pthread_mutex_lock(&pattern_lock);
+        if (!thread_running) {
+            pthread_mutex_unlock(&pattern_lock);
+            break;
+        }
+        arm_timer(run_due_patterns(now_ms()));
+        pthread_mutex_unlock(&pattern_lock);
+
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+            LOGGER_E(LOGGER_COMP_ALERT, "Pattern thread poll failed: %s", strerror(errno));
+            break;
+        }
+        uint64_t drain;
+        if (fds[0].revents & POLLIN) (void)!read(timer_fd, &drain, sizeof(drain));
+        if (fds[1].revents & POLLIN) (void)!read(wake_fd, &drain, sizeof(drain));
+    }
+    return NULL;
+}
+
+/*------------------------ Internal Function -----------------------------*/
+int pattern_engine_start(void) {
+    if (thread_running) return 0;
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (timer_fd < 0 || wake_fd < 0) {
+        LOGGER_E(LOGGER_COMP_ALERT, "Failed to create pattern timer: %s", strerror(errno));
+        pattern_engine_stop();
+        return -1;
+    }
+
+    memset(patterns, 0, sizeof(patterns));
+    thread_running = 1;
+    if (pthread_create(&pattern_thread, NULL, pattern_loop, NULL) != 0) {
+        thread_running = 0;
+        pattern_engine_stop();
+        return -1;
+    }
+    return 0;
+}
+
+void pattern_engine_stop(void) {
+    pthread_mutex_lock(&pattern_lock);
+    int was_running = thread_running;
+    thread_running = 0;
+    memset(patterns, 0, sizeof(patterns));
+    pthread_mutex_unlock(&pattern_lock);
+
+    if (was_running) {
+        wake_thread();
+        pthread_join(pattern_thread, NULL);
+    }
+    if (timer_fd >= 0) close(timer_fd);
+    if (wake_fd >= 0) close(wake_fd);
+    timer_fd = -1;
+    wake_fd = -1;
+}
+
+void pattern_engine_cancel(uint32_t mask) {
+    pthread_mutex_lock(&pattern_lock);
+    for (int i = 0; i < ALERT_MAX_OUTPUTS; i++) {
+        if (mask & (1u << i)) patterns[i].active = 0;
+    }
+    pthread_mutex_unlock(&pattern_lock);
+    // The thread notices on its next wake-up; a stale timer expiry finds nothing due
+}
+
+/*------------------------ Public Function -----------------------------*/
+int alert_pattern_start(int index, unsigned int on_ms, unsigned int off_ms, unsigned int cycles) {
+    if (index < 0 || index >= alert_output_count() || on_ms == 0 || off_ms == 0) return -1;
+
+    pthread_mutex_lock(&pattern_lock);
+    if (!thread_running) {
+        pthread_mutex_unlock(&pattern_lock);
+        return -1;
+    }
+    pattern_t* p = &patterns[index];
+    p->active = 1;
+    p->level = 1;
+    p->on_ms = on_ms;
+    p->off_ms = off_ms;
+    p->cycles_left = cycles;
+    p->next_ms = now_ms() + on_ms;
+    int ret = alert_write_outputs(1u << index, 1u << index);  // First on phase starts now
+    pthread_mutex_unlock(&pattern_lock);
+
+    wake_thread();  // Re-arm the timer for the new deadline
+    return ret;
+}
+
+int alert_pattern_stop(int index) {
+    if (index < 0 || index >= alert_output_count()) return -1;
+    return alert_set_output(index, 0);  // Cancels the pattern and drives the line low
+}
+
+int alert_pattern_active(int index) {
+    if (index < 0 || index >= ALERT_MAX_OUTPUTS) return 0;
+    pthread_mutex_lock(&pattern_lock);
+    int active = patterns[index].active;
+    pthread_mutex_unlock(&pattern_lock);
+    return active;
+}
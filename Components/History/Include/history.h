@@ -0,0 +1,129 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+
+/*
+ * On-device time-series history: append-only, memory-mapped, compressed segments.
+ *
+ * Each channel has its own directory; a segment file holds the samples of one channel
+ * inside one time block (<root>/chNN/<first_timestamp_ms>.seg). Samples are encoded as
+ * in Facebook's Gorilla: delta-of-delta timestamps and XOR-compressed doubles, so a
+ * regular 1 Hz channel costs a few bits per sample. Files are preallocated and written
+ * through a shared mapping: appends are memory writes, the kernel writes the dirty pages
+ * back in batches and history_sync() makes everything appended so far durable.
+ *
+ * Crash safety: the encoder state lives in checksummed slots in the segment header,
+ * written after the data. Reopening a segment picks the newest slot whose checksum and
+ * data tail both verify, and clears whatever was written past it.
+ *
+ * One writer process per root. Readers in other processes open the root read-only.
+ */
+
+// --- Limits ---
+#define HISTORY_MAX_CHANNELS 64
+#define HISTORY_BLOCK_MS_DEFAULT (6 * 3600 * 1000U)     // One segment per channel per 6 h block
+#define HISTORY_SEGMENT_BYTES_DEFAULT (128 * 1024U)     // Compressed data per segment (a new one starts when full)
+#define HISTORY_INDEX_STRIDE 256                        // Samples between seek points of a segment
+
+// --- history_open() flags ---
+#define HISTORY_F_READONLY 0x01
+
+// --- Error codes ---
+#define HISTORY_SUCCESS 0
+#define HISTORY_E_GENERIC_FAIL -1
+#define HISTORY_E_OPEN -2       // Directory or segment file could not be created/mapped
+#define HISTORY_E_LAYOUT -3     // Segment file with another magic/version/size
+#define HISTORY_E_ORDER -4      // Timestamp not after the last one of the channel
+#define HISTORY_E_READONLY -5
+
+typedef struct {
+    uint32_t block_ms;          // Time block covered by one segment
+    uint32_t segment_bytes;     // Compressed data capacity of one segment
+} history_config_t;
+
+typedef struct {
+    int64_t timestamp_ms;
+    double value;
+} history_point_t;
+
+/**
+ * @brief Aggregate of the samples inside [start_ms, start_ms + step_ms).
+ */
+typedef struct {
+    int64_t start_ms;
+    uint32_t count;             // 0 = no sample in the bucket (min/max/avg undefined)
+    uint32_t reserved;
+    double min;
+    double max;
+    double avg;
+} history_bucket_t;
+
+typedef struct {
+    uint32_t segments;
+    uint32_t reserved;
+    uint64_t samples;
+    uint64_t data_bytes;        // Compressed bytes in use
+    int64_t first_ms;           // 0 when the channel is empty
+    int64_t last_ms;
+} history_channel_stats_t;
+
+typedef struct history history_t;
+
+void history_default_config(history_config_t *cfg);
+
+/**
+ * @brief Opens (creating it if needed) a history root directory.
+ * @param cfg NULL for the defaults. Existing segments keep the layout they were created with.
+ * @param flags HISTORY_F_* flags.
+ * @param err Optional pointer receiving a HISTORY_E_* code on failure.
+ * @return Handle, or NULL on failure.
+ */
+history_t* history_open(const char *root, const history_config_t *cfg, int flags, int *err);
+
+/**
+ * @brief Appends one sample. Timestamps must increase per channel, across restarts too:
+ *        the first append after history_open() is checked against the newest sample on disk.
+ * @return HISTORY_SUCCESS or a negative HISTORY_E_* code.
+ */
+int history_append(history_t *h, int channel, int64_t timestamp_ms, double value);
+
+/**
+ * @brief Copies the samples of [from_ms, to_ms] in time order.
+ *        To read more than max_points, query again from out[max_points - 1].timestamp_ms + 1.
+ * @return Number of points written (>= 0), or a negative HISTORY_E_* code.
+ */
+int history_query(history_t *h, int channel, int64_t from_ms, int64_t to_ms, history_point_t *out, int max_points);
+
+/**
+ * @brief Min/max/average per step_ms bucket, buckets starting at from_ms (dashboard plots).
+ * @return Number of buckets written (>= 0), or a negative HISTORY_E_* code.
+ */
+int history_query_buckets(history_t *h, int channel, int64_t from_ms, int64_t to_ms, uint32_t step_ms,
+                          history_bucket_t *out, int max_buckets);
+
+/**
+ * @brief Writes the appended data, then a durable checkpoint, of every open segment.
+ *        Without it, the kernel writes dirty pages back on its own schedule.
+ * @return HISTORY_SUCCESS or HISTORY_E_GENERIC_FAIL.
+ */
+int history_sync(history_t *h);
+
+/**
+ * @brief Deletes the segments whose samples are all older than before_ms.
+ * @return Number of segments removed (>= 0), or a negative HISTORY_E_* code.
+ */
+int history_prune(history_t *h, int64_t before_ms);
+
+/**
+ * @brief Segment count, sample count and compressed size of a channel.
+ * @return HISTORY_SUCCESS or a negative HISTORY_E_* code.
+ */
+int history_channel_stats(history_t *h, int channel, history_channel_stats_t *out);
+
+/**
+ * @brief Syncs (writer), unmaps every segment and frees the handle.
+ */
+void history_close(history_t *h);
+
+#endif
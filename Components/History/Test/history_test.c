@@ -0,0 +1,176 @@
+#define _GNU_SOURCE
+#include "history.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * History writer killed with SIGKILL mid-append, then reopened.
+ *
+ * A child appends a regular series as fast as it can and is killed at a random point,
+ * over and over on the same root, each run resuming after the last sample on disk. Small
+ * blocks and segments make the kills land around segment rollover too. Whatever survives
+ * must be a gap-free prefix of the series, and the order check must hold across the
+ * restart, including when the newest segment on disk is already sealed.
+ *
+ *     history_test [seed]
+ */
+
+#define KILLS 25
+#define STEP_MS 1000
+#define BASE_MS 1700000000000LL
+#define REPORT_EVERY 200
+#define HEADER_BYTES 4096           // Segment header page (see history.c)
+
+static int failures;
+static uint32_t rng = 0x9E3779B9U;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __func__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+static uint32_t next_rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static double series_value(int64_t i) {
+    // Varied bit patterns: exercises every XOR window case of the encoder
+    return (double)(i % 97) * 0.37 - (double)(i % 13) * 1e-3 + (i % 5 == 0 ? 1e6 : 0.0);
+}
+
+static int64_t stored_samples(history_t *h) {
+    history_channel_stats_t st;
+    if (history_channel_stats(h, 0, &st) != HISTORY_SUCCESS || st.samples == 0) return 0;
+    return (st.last_ms - BASE_MS) / STEP_MS + 1;
+}
+
+// Appends the series from sample `from` on, reporting progress through the pipe, until killed
+static void child_writer(const char *root, const history_config_t *cfg, int64_t from, int report_fd) {
+    history_t *h = history_open(root, cfg, 0, NULL);
+    if (h == NULL) _exit(2);
+    for (int64_t i = from;; i++) {
+        if (history_append(h, 0, BASE_MS + i * STEP_MS, series_value(i)) != HISTORY_SUCCESS) _exit(3);
+        if ((i - from) % REPORT_EVERY == REPORT_EVERY - 1 && write(report_fd, &i, sizeof(i)) != sizeof(i)) _exit(4);
+    }
+}
+
+// Every stored sample is the series, gap-free from the start. Returns the count.
+static int64_t check_series(const char *root) {
+    history_t *h = history_open(root, NULL, HISTORY_F_READONLY, NULL);
+    if (h == NULL) return -1;
+    int64_t expect = stored_samples(h);
+    history_point_t *pts = malloc((size_t)(expect + 1) * sizeof(*pts));
+    int n = pts ? history_query(h, 0, 0, INT64_MAX, pts, (int)expect + 1) : -1;
+    CHECK(n == expect, "query returned %d of %lld samples", n, (long long)expect);
+    for (int i = 0; i < n; i++) {
+        if (pts[i].timestamp_ms != BASE_MS + (int64_t)i * STEP_MS || pts[i].value != series_value(i)) {
+            CHECK(0, "sample %d: %lld %.17g", i, (long long)pts[i].timestamp_ms, pts[i].value);
+            break;
+        }
+    }
+    free(pts);
+    history_close(h);
+    return expect;
+}
+
+static void test_sigkill(const char *root) {
+    history_config_t cfg = { 600 * STEP_MS, 1024 };     // 600-sample blocks, 1 KiB segments
+    int64_t reported = 0;
+
+    for (int k = 0; k < KILLS; k++) {
+        history_t *h = history_open(root, &cfg, 0, NULL);
+        int64_t from = h ? stored_samples(h) : 0;
+        CHECK(from >= reported, "kill %d: %lld samples on disk, %lld were appended", k, (long long)from, (long long)reported);
+
+        // Restarted writer: nothing at or before the newest stored sample goes in
+        if (h != NULL && from > 0) {
+            int64_t last = BASE_MS + (from - 1) * STEP_MS;
+            CHECK(history_append(h, 0, last, 1.0) == HISTORY_E_ORDER, "kill %d: duplicate of the last sample accepted", k);
+            CHECK(history_append(h, 0, last - 10 * STEP_MS, 1.0) == HISTORY_E_ORDER, "kill %d: older sample accepted", k);
+        }
+        history_close(h);
+
+        int fds[2];
+        if (pipe(fds) != 0) return;
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            child_writer(root, &cfg, from, fds[1]);
+        }
+        close(fds[1]);
+        int reports = 1 + (int)(next_rand() % 4);
+        int64_t done = -1;
+        for (int i = 0; i < reports && read(fds[0], &done, sizeof(done)) == sizeof(done); i++) reported = done + 1;
+        usleep(next_rand() % 3000);
+        kill(pid, SIGKILL);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        close(fds[0]);
+        CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL, "kill %d: writer exited on its own (%d)", k, status);
+
+        int64_t stored = check_series(root);
+        CHECK(stored >= reported, "kill %d: %lld samples recovered, %lld were appended", k, (long long)stored, (long long)reported);
+    }
+}
+
+// Writer killed after sealing its segment and before creating the next one
+static void test_sealed_newest(const char *root) {
+    history_config_t cfg = { 24 * 3600 * 1000U, 64 * 1024 };
+    history_t *h = history_open(root, &cfg, 0, NULL);
+    CHECK(h != NULL, "open");
+    if (h == NULL) return;
+    for (int64_t i = 0; i < 10; i++) history_append(h, 0, BASE_MS + i * STEP_MS, series_value(i));
+    history_close(h);
+
+    // Sealing gives the unused preallocation back: the file shrinks to the pages in use
+    char path[512];
+    snprintf(path, sizeof(path), "%s/ch00/%lld.seg", root, (long long)BASE_MS);
+    CHECK(truncate(path, HEADER_BYTES + 4096) == 0, "truncate %s", path);
+
+    h = history_open(root, &cfg, 0, NULL);
+    int64_t last = BASE_MS + 9 * STEP_MS;
+    CHECK(history_append(h, 0, last - STEP_MS, 1.0) == HISTORY_E_ORDER, "older sample accepted after a sealed segment");
+    CHECK(history_append(h, 0, last, 1.0) == HISTORY_E_ORDER, "duplicate accepted after a sealed segment");
+    CHECK(history_append(h, 0, last + STEP_MS, series_value(10)) == HISTORY_SUCCESS, "next sample refused");
+    CHECK(history_append(h, 0, last + STEP_MS, 1.0) == HISTORY_E_ORDER, "duplicate accepted in the new segment");
+    history_close(h);
+    CHECK(check_series(root) == 11, "series after the sealed segment");
+}
+
+static void remove_root(const char *root) {
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", root);
+    if (system(cmd) != 0) printf("unable to remove %s\n", root);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) rng = (uint32_t)strtoul(argv[1], NULL, 0) | 1U;
+    char base[] = "/tmp/history_test_XXXXXX";
+    if (mkdtemp(base) == NULL) {
+        printf("FAIL: no temporary directory\n");
+        return 1;
+    }
+    char root[600];
+    printf("seed 0x%08X\n", rng);
+
+    snprintf(root, sizeof(root), "%s/killed", base);
+    test_sigkill(root);
+    snprintf(root, sizeof(root), "%s/sealed", base);
+    test_sealed_newest(root);
+
+    remove_root(base);
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
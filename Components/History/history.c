@@ -0,0 +1,804 @@
+#define _GNU_SOURCE
+#include "history.h"
+#include "logger.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SEG_MAGIC 0x5349484CU       // "LHIS"
+#define SEG_VERSION 1
+#define HEADER_BYTES 4096
+#define INDEX_ENTRIES 95
+#define TAIL_BYTES 16               // Data bytes covered by a slot's tail checksum
+#define MAX_SAMPLE_BITS 113         // '1111' + 32-bit delta-of-delta, '11' + 5 + 6 + 64-bit XOR
+#define BLOCK_MS_MIN 1000U
+#define BLOCK_MS_MAX (7 * 24 * 3600 * 1000U)   // Keeps every delta-of-delta within 32 bits
+#define SEGMENT_BYTES_MIN 1024U
+#define PATH_BYTES 320
+#define NO_WINDOW 0xFF              // No XOR window yet (leading)
+
+// Encoder state after `count` samples: enough to resume encoding or decoding
+typedef struct {
+    uint64_t bit_pos;
+    int64_t last_ts;
+    int64_t last_delta;
+    uint64_t last_value;            // Bit pattern of the last double
+    uint32_t count;
+    uint8_t leading;
+    uint8_t trailing;
+    uint16_t reserved;
+} enc_state_t;
+
+typedef struct {
+    uint64_t seq;
+    enc_state_t st;
+    uint32_t tail_crc;              // Last TAIL_BYTES complete data bytes before st.bit_pos
+    uint32_t crc;                   // Everything above
+} slot_t;
+
+// First page of a segment file; compressed data follows at HEADER_BYTES
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t channel;
+    uint32_t data_bytes;
+    int64_t block_start_ms;
+    int64_t first_ts;               // Also the file name
+    uint32_t block_ms;
+    uint32_t reserved;
+    slot_t live[2];                 // Written after every append, alternately
+    slot_t durable[2];              // Written by history_sync() once the data is on disk
+    enc_state_t index[INDEX_ENTRIES];   // State after every HISTORY_INDEX_STRIDE samples
+} seg_header_t;
+
+_Static_assert(sizeof(seg_header_t) <= HEADER_BYTES, "segment header must fit its page");
+
+typedef struct {
+    seg_header_t *hdr;              // NULL when no segment is open
+    uint8_t *data;
+    size_t map_bytes;
+    enc_state_t st;
+    uint64_t seq;
+    uint64_t synced_bytes;          // Data bytes already made durable
+    uint64_t synced_seq;            // Live slot covered by the last checkpoint
+    uint32_t durable_n;
+} segment_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    int loaded;                     // Last segment on disk looked up
+    int64_t last_ts;                // Newest sample stored, INT64_MIN if none: the order check
+    segment_t active;
+} channel_t;
+
+struct history {
+    char root[PATH_BYTES - 32];
+    history_config_t cfg;
+    int readonly;
+    channel_t ch[HISTORY_MAX_CHANNELS];
+};
+
+typedef struct {
+    const uint8_t *buf;
+    uint64_t pos;
+    uint64_t end;
+} bit_reader_t;
+
+// Receives each decoded sample; returns non-zero to stop the scan
+typedef int (*sample_fn)(void *ctx, int64_t ts, double value);
+
+/*---------------------------- Private Function --------------------------------*/
+static uint32_t crc32c(uint32_t crc, const void *buf, size_t len) {
+    static const uint32_t nibble[16] = {
+        0x00000000, 0x105EC76F, 0x20BD8EDE, 0x30E349B1, 0x417B1DBC, 0x5125DAD3, 0x61C69362, 0x7198540D,
+        0x82F63B78, 0x92A8FC17, 0xA24BB5A6, 0xB21572C9, 0xC38D26C4, 0xD3D3E1AB, 0xE330A81A, 0xF36E6F75,
+    };
+    const uint8_t *p = buf;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ nibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static uint32_t tail_crc(const uint8_t *data, uint64_t bit_pos) {
+    // Complete bytes only: the partial last byte still changes with the next append
+    uint64_t full = bit_pos / 8;
+    uint64_t from = full > TAIL_BYTES ? full - TAIL_BYTES : 0;
+    return crc32c(0, data + from, (size_t)(full - from));
+}
+
+static uint32_t slot_crc(const slot_t *s) {
+    return crc32c(0, s, offsetof(slot_t, crc));
+}
+
+static void put_bits(uint8_t *buf, uint64_t *pos, uint64_t value, int n) {
+    while (n > 0) {
+        int room = 8 - (int)(*pos & 7);
+        int take = n < room ? n : room;
+        uint8_t bits = (uint8_t)((value >> (n - take)) & ((1U << take) - 1));
+        buf[*pos >> 3] |= (uint8_t)(bits << (room - take));   // Bits past the tail are always zero
+        *pos += (uint64_t)take;
+        n -= take;
+    }
+}
+
+static int get_bits(bit_reader_t *r, int n, uint64_t *out) {
+    if (r->pos + (uint64_t)n > r->end) return -1;
+    uint64_t v = 0;
+    while (n > 0) {
+        int avail = 8 - (int)(r->pos & 7);
+        int take = n < avail ? n : avail;
+        uint8_t byte = r->buf[r->pos >> 3];
+        v = (v << take) | ((uint64_t)(byte >> (avail - take)) & ((1U << take) - 1));
+        r->pos += (uint64_t)take;
+        n -= take;
+    }
+    *out = v;
+    return 0;
+}
+
+static int64_t sign_extend(uint64_t v, int bits) {
+    uint64_t m = 1ULL << (bits - 1);
+    return (int64_t)((v ^ m) - m);
+}
+
+static void encode(uint8_t *data, enc_state_t *st, int64_t ts, uint64_t value) {
+    if (st->count == 0) {
+        // First sample: timestamp is the header's first_ts, value raw
+        put_bits(data, &st->bit_pos, value, 64);
+        st->last_ts = ts;
+        st->last_delta = 0;
+        st->last_value = value;
+        st->leading = NO_WINDOW;
+        st->count = 1;
+        return;
+    }
+
+    int64_t delta = ts - st->last_ts;
+    int64_t dod = delta - st->last_delta;
+    if (dod == 0) put_bits(data, &st->bit_pos, 0x0, 1);
+    else if (dod >= -64 && dod <= 63) { put_bits(data, &st->bit_pos, 0x2, 2); put_bits(data, &st->bit_pos, (uint64_t)dod, 7); }
+    else if (dod >= -256 && dod <= 255) { put_bits(data, &st->bit_pos, 0x6, 3); put_bits(data, &st->bit_pos, (uint64_t)dod, 9); }
+    else if (dod >= -2048 && dod <= 2047) { put_bits(data, &st->bit_pos, 0xE, 4); put_bits(data, &st->bit_pos, (uint64_t)dod, 12); }
+    else { put_bits(data, &st->bit_pos, 0xF, 4); put_bits(data, &st->bit_pos, (uint64_t)dod, 32); }
+
+    uint64_t x = value ^ st->last_value;
+    if (x == 0) {
+        put_bits(data, &st->bit_pos, 0x0, 1);
+    } else {
+        int lead = __builtin_clzll(x);
+        int trail = __builtin_ctzll(x);
+        if (lead > 31) lead = 31;   // 5-bit field
+        if (st->leading != NO_WINDOW && lead >= st->leading && trail >= st->trailing) {
+            // Fits the previous window
+            put_bits(data, &st->bit_pos, 0x2, 2);
+            put_bits(data, &st->bit_pos, x >> st->trailing, 64 - st->leading - st->trailing);
+        } else {
+            int sig = 64 - lead - trail;
+            put_bits(data, &st->bit_pos, 0x3, 2);
+            put_bits(data, &st->bit_pos, (uint64_t)lead, 5);
+            put_bits(data, &st->bit_pos, (uint64_t)(sig & 0x3F), 6);   // 64 is stored as 0
+            put_bits(data, &st->bit_pos, x >> trail, sig);
+            st->leading = (uint8_t)lead;
+            st->trailing = (uint8_t)trail;
+        }
+    }
+    st->last_ts = ts;
+    st->last_delta = delta;
+    st->last_value = value;
+    st->count++;
+}
+
+static int decode(bit_reader_t *r, enc_state_t *st, int64_t first_ts) {
+    uint64_t v;
+    if (st->count == 0) {
+        if (get_bits(r, 64, &v) != 0) return -1;
+        st->last_ts = first_ts;
+        st->last_delta = 0;
+        st->last_value = v;
+        st->leading = NO_WINDOW;
+        st->count = 1;
+        return 0;
+    }
+
+    int ones = 0;
+    while (ones < 4) {
+        if (get_bits(r, 1, &v) != 0) return -1;
+        if (v == 0) break;
+        ones++;
+    }
+    static const int dod_bits[5] = { 0, 7, 9, 12, 32 };
+    int64_t dod = 0;
+    if (ones > 0) {
+        if (get_bits(r, dod_bits[ones], &v) != 0) return -1;
+        dod = sign_extend(v, dod_bits[ones]);
+    }
+
+    uint64_t x = 0;
+    if (get_bits(r, 1, &v) != 0) return -1;
+    if (v == 1) {
+        if (get_bits(r, 1, &v) != 0) return -1;
+        if (v == 0) {
+            if (st->leading == NO_WINDOW) return -1;
+            int sig = 64 - st->leading - st->trailing;
+            if (get_bits(r, sig, &v) != 0) return -1;
+            x = v << st->trailing;
+        } else {
+            uint64_t lead, sig;
+            if (get_bits(r, 5, &lead) != 0 || get_bits(r, 6, &sig) != 0) return -1;
+            if (sig == 0) sig = 64;
+            if (lead + sig > 64) return -1;
+            if (get_bits(r, (int)sig, &v) != 0) return -1;
+            int trail = 64 - (int)lead - (int)sig;
+            x = v << trail;
+            st->leading = (uint8_t)lead;
+            st->trailing = (uint8_t)trail;
+        }
+    }
+    st->last_delta += dod;
+    st->last_ts += st->last_delta;
+    st->last_value ^= x;
+    st->count++;
+    return 0;
+}
+
+// Newest slot whose checksum and data tail verify. Safe against a concurrent writer.
+static int read_state(const seg_header_t *hdr, size_t file_bytes, enc_state_t *out) {
+    const uint8_t *data = (const uint8_t*)hdr + HEADER_BYTES;
+    uint64_t max_bits = (uint64_t)hdr->data_bytes * 8;
+    if ((file_bytes - HEADER_BYTES) * 8 < max_bits) max_bits = (file_bytes - HEADER_BYTES) * 8;   // Sealed
+    const slot_t *slots[4] = { &hdr->live[0], &hdr->live[1], &hdr->durable[0], &hdr->durable[1] };
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint64_t best_seq = 0;
+        for (int i = 0; i < 4; i++) {
+            slot_t s;
+            memcpy(&s, slots[i], sizeof(s));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (s.seq == 0 || s.seq <= best_seq || s.crc != slot_crc(&s)) continue;
+            if (s.st.bit_pos > max_bits || s.tail_crc != tail_crc(data, s.st.bit_pos)) continue;
+            best_seq = s.seq;
+            *out = s.st;
+        }
+        if (best_seq != 0) return 0;
+    }
+    return -1;
+}
+
+static int header_valid(const seg_header_t *hdr, size_t file_bytes, int channel) {
+    return hdr->magic == SEG_MAGIC && hdr->version == SEG_VERSION && (int)hdr->channel == channel &&
+           hdr->data_bytes >= SEGMENT_BYTES_MIN && file_bytes >= HEADER_BYTES;
+}
+
+static void channel_dir(const history_t *h, int channel, char *buf, size_t size) {
+    snprintf(buf, size, "%s/ch%02d", h->root, channel);
+}
+
+static void segment_path(const history_t *h, int channel, int64_t first_ts, char *buf, size_t size) {
+    snprintf(buf, size, "%s/ch%02d/%lld.seg", h->root, channel, (long long)first_ts);
+}
+
+static int cmp_i64(const void *a, const void *b) {
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// First timestamps of the channel's segments, ascending. Returns the count (*out malloc'd) or -1.
+static int list_segments(const history_t *h, int channel, int64_t **out) {
+    char dir_path[PATH_BYTES];
+    channel_dir(h, channel, dir_path, sizeof(dir_path));
+    *out = NULL;
+
+    DIR *dir = opendir(dir_path);
+    if (dir == NULL) return (errno == ENOENT) ? 0 : -1;
+
+    int n = 0, cap = 0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        char *end;
+        long long ts = strtoll(de->d_name, &end, 10);
+        if (end == de->d_name || strcmp(end, ".seg") != 0) continue;
+        if (n == cap) {
+            cap = cap ? cap * 2 : 32;
+            int64_t *grown = realloc(*out, (size_t)cap * sizeof(int64_t));
+            if (grown == NULL) {
+                free(*out);
+                *out = NULL;
+                closedir(dir);
+                return -1;
+            }
+            *out = grown;
+        }
+        (*out)[n++] = ts;
+    }
+    closedir(dir);
+    if (n > 1) qsort(*out, (size_t)n, sizeof(int64_t), cmp_i64);
+    return n;
+}
+
+static void* map_file(const char *path, int writable, size_t *bytes) {
+    int fd = open(path, (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= HEADER_BYTES) {
+        *bytes = (size_t)st.st_size;
+        addr = mmap(NULL, *bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);  // The mapping keeps the file open
+    return (addr == MAP_FAILED) ? NULL : addr;
+}
+
+static void publish(segment_t *seg) {
+    slot_t s;
+    memset(&s, 0, sizeof(s));
+    s.seq = ++seg->seq;
+    s.st = seg->st;
+    s.tail_crc = tail_crc(seg->data, seg->st.bit_pos);
+    s.crc = slot_crc(&s);
+    __atomic_thread_fence(__ATOMIC_RELEASE);    // Data before the slot that covers it
+    memcpy(&seg->hdr->live[s.seq & 1], &s, sizeof(s));
+}
+
+static void sync_segment(segment_t *seg) {
+    if (seg->hdr == NULL) return;
+    if (seg->seq == seg->synced_seq) return;
+    uint64_t used = (seg->st.bit_pos + 7) / 8;
+
+    // 1. Data appended since the last sync
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t from = ((uintptr_t)seg->data + seg->synced_bytes) & ~(page - 1);
+    uintptr_t to = (uintptr_t)seg->data + used;
+    if (to > from && msync((void*)from, to - from, MS_SYNC) != 0) {
+        LOGGER_E(LOGGER_COMP_HISTORY, "msync of segment %lld failed: %s", (long long)seg->hdr->first_ts, strerror(errno));
+        return;
+    }
+    // 2. Checkpoint that only refers to durable data
+    memcpy(&seg->hdr->durable[seg->durable_n++ & 1], &seg->hdr->live[seg->seq & 1], sizeof(slot_t));
+    msync(seg->hdr, HEADER_BYTES, MS_SYNC);
+    seg->synced_bytes = seg->st.bit_pos / 8;    // The partial byte is written again next time
+    seg->synced_seq = seg->seq;
+}
+
+// Finished segment: give the preallocated space it did not use back to the card
+static void seal_segment(const history_t *h, int channel, segment_t *seg) {
+    if (seg->hdr == NULL) return;
+    sync_segment(seg);
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t used = ((seg->st.bit_pos + 7) / 8 + page - 1) & ~(page - 1);
+    if (used < seg->hdr->data_bytes) {
+        char path[PATH_BYTES];
+        segment_path(h, channel, seg->hdr->first_ts, path, sizeof(path));
+        munmap(seg->hdr, seg->map_bytes);
+        seg->hdr = NULL;
+        if (truncate(path, (off_t)(HEADER_BYTES + used)) != 0) {
+            LOGGER_W(LOGGER_COMP_HISTORY, "Unable to shrink %s: %s", path, strerror(errno));
+        }
+    }
+}
+
+static void unmap_segment(segment_t *seg) {
+    if (seg->hdr != NULL) munmap(seg->hdr, seg->map_bytes);
+    memset(seg, 0, sizeof(*seg));
+}
+
+// Last timestamp of a segment file, INT64_MIN if it holds no readable sample
+static int64_t segment_last_ts(const history_t *h, int channel, int64_t first_ts) {
+    char path[PATH_BYTES];
+    segment_path(h, channel, first_ts, path, sizeof(path));
+    size_t bytes;
+    const seg_header_t *hdr = map_file(path, 0, &bytes);
+    if (hdr == NULL) return INT64_MIN;
+
+    enc_state_t st;
+    int64_t last = INT64_MIN;
+    if (header_valid(hdr, bytes, channel) && read_state(hdr, bytes, &st) == 0 && st.count > 0) last = st.last_ts;
+    munmap((void*)hdr, bytes);
+    return last;
+}
+
+// Maps a segment for appending, recovering its tail. Returns 0 if appends must go to a new segment.
+static int open_active(history_t *h, int channel, int64_t first_ts) {
+    char path[PATH_BYTES];
+    segment_path(h, channel, first_ts, path, sizeof(path));
+
+    size_t bytes;
+    seg_header_t *hdr = map_file(path, 1, &bytes);
+    if (hdr == NULL) {
+        // Shorter than its header: creation was cut short before the space was allocated
+        struct stat sb;
+        if (stat(path, &sb) == 0 && (size_t)sb.st_size < HEADER_BYTES) unlink(path);
+        return 0;
+    }
+    uint8_t *data = (uint8_t*)hdr + HEADER_BYTES;
+
+    enc_state_t st;
+    if (header_valid(hdr, bytes, channel) && bytes < HEADER_BYTES + (size_t)hdr->data_bytes) {
+        munmap(hdr, bytes);     // Sealed: appends go to a new segment
+        return 0;
+    }
+    int readable = header_valid(hdr, bytes, channel) && read_state(hdr, bytes, &st) == 0;
+    if (!readable || st.count == 0) {
+        // Never initialised, or no sample yet (crash right after creation): nothing to keep.
+        // Unreadable: appends go to a new segment.
+        int blank = hdr->magic == 0 || readable;
+        munmap(hdr, bytes);
+        if (blank) unlink(path);
+        else LOGGER_W(LOGGER_COMP_HISTORY, "Segment %s unreadable, left as is", path);
+        return 0;
+    }
+
+    // Whatever was written past the recovered state belongs to lost appends: clear it
+    uint64_t used = (st.bit_pos + 7) / 8;
+    uint64_t last = hdr->data_bytes;
+    while (last > used && data[last - 1] == 0) last--;
+    int partial = (int)(st.bit_pos & 7);
+    if (last > used || (partial && (data[used - 1] & (0xFF >> partial)))) {
+        if (partial) data[used - 1] &= (uint8_t)(0xFF << (8 - partial));
+        if (last > used) memset(data + used, 0, (size_t)(last - used));
+        LOGGER_W(LOGGER_COMP_HISTORY, "Channel %d: segment %lld recovered at sample %u",
+                 channel, (long long)hdr->first_ts, st.count);
+    }
+
+    segment_t *seg = &h->ch[channel].active;
+    seg->hdr = hdr;
+    seg->data = data;
+    seg->map_bytes = bytes;
+    seg->st = st;
+    seg->seq = hdr->live[0].seq > hdr->live[1].seq ? hdr->live[0].seq : hdr->live[1].seq;
+    seg->synced_bytes = 0;
+    seg->synced_seq = 0;
+    seg->durable_n = (hdr->durable[0].seq > hdr->durable[1].seq) ? 1 : 0;
+    publish(seg);   // The recovered state becomes the newest live slot
+    return 1;
+}
+
+// Maps the channel's newest segment for appending and finds the last timestamp stored
+static void load_active(history_t *h, int channel) {
+    channel_t *c = &h->ch[channel];
+    c->loaded = 1;
+    c->last_ts = INT64_MIN;
+
+    int64_t *firsts;
+    int n = list_segments(h, channel, &firsts);
+    if (n <= 0) return;
+    if (open_active(h, channel, firsts[n - 1])) {
+        c->last_ts = c->active.st.last_ts;
+    } else {
+        // Sealed or unusable newest segment: samples before the restart still bound the next append
+        for (int i = n - 1; i >= 0 && c->last_ts == INT64_MIN; i--) c->last_ts = segment_last_ts(h, channel, firsts[i]);
+    }
+    free(firsts);
+}
+
+static int create_segment(history_t *h, int channel, int64_t ts) {
+    char path[PATH_BYTES];
+    channel_dir(h, channel, path, sizeof(path));
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+        LOGGER_E(LOGGER_COMP_HISTORY, "Unable to create %s: %s", path, strerror(errno));
+        return HISTORY_E_OPEN;
+    }
+    int dir_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    segment_path(h, channel, ts, path, sizeof(path));
+    size_t bytes = HEADER_BYTES + (size_t)h->cfg.segment_bytes;
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    int err = (fd < 0) ? errno : posix_fallocate(fd, 0, (off_t)bytes);   // Real blocks: no SIGBUS on a full card
+    void *addr = MAP_FAILED;
+    if (err == 0) addr = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (fd >= 0) close(fd);
+    if (err != 0 || addr == MAP_FAILED) {
+        LOGGER_E(LOGGER_COMP_HISTORY, "Unable to create segment %s: %s", path, strerror(err ? err : errno));
+        if (fd >= 0) unlink(path);
+        if (dir_fd >= 0) close(dir_fd);
+        return HISTORY_E_OPEN;
+    }
+
+    segment_t *seg = &h->ch[channel].active;
+    seg->hdr = addr;
+    seg->data = (uint8_t*)addr + HEADER_BYTES;
+    seg->map_bytes = bytes;
+    memset(&seg->st, 0, sizeof(seg->st));
+    seg->seq = 0;
+    seg->synced_bytes = 0;
+    seg->synced_seq = 0;
+    seg->durable_n = 0;
+
+    seg_header_t *hdr = seg->hdr;
+    hdr->version = SEG_VERSION;
+    hdr->channel = (uint32_t)channel;
+    hdr->data_bytes = h->cfg.segment_bytes;
+    hdr->block_ms = h->cfg.block_ms;
+    hdr->block_start_ms = ts - (ts % (int64_t)h->cfg.block_ms);
+    hdr->first_ts = ts;
+    publish(seg);
+    __atomic_store_n(&hdr->magic, SEG_MAGIC, __ATOMIC_RELEASE);     // Last: marks the header complete
+
+    // New directory entry survives a power cut together with the first checkpoint
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return HISTORY_SUCCESS;
+}
+
+// Calls fn for every sample of one segment inside [from, to]. Returns 1 if fn asked to stop.
+static int scan_segment(const history_t *h, int channel, int64_t first_ts, int64_t from, int64_t to,
+                        sample_fn fn, void *ctx) {
+    char path[PATH_BYTES];
+    segment_path(h, channel, first_ts, path, sizeof(path));
+    size_t bytes;
+    const seg_header_t *hdr = map_file(path, 0, &bytes);
+    if (hdr == NULL) return 0;
+
+    const uint8_t *data = (const uint8_t*)hdr + HEADER_BYTES;
+    enc_state_t end;
+    int stop = 0;
+    if (!header_valid(hdr, bytes, channel) || read_state(hdr, bytes, &end) != 0 || end.count == 0 ||
+        end.last_ts < from) {
+        munmap((void*)hdr, bytes);
+        return 0;
+    }
+
+    // Seek: last index point strictly before `from` (its own sample is not needed)
+    enc_state_t st;
+    memset(&st, 0, sizeof(st));
+    for (int i = 0; i < INDEX_ENTRIES; i++) {
+        enc_state_t e;
+        memcpy(&e, &hdr->index[i], sizeof(e));
+        if (e.count != (uint32_t)(i + 1) * HISTORY_INDEX_STRIDE || e.count > end.count || e.last_ts >= from) break;
+        st = e;
+    }
+
+    bit_reader_t r = { data, st.bit_pos, end.bit_pos };
+    while (st.count < end.count) {
+        if (decode(&r, &st, hdr->first_ts) != 0) break;
+        if (st.last_ts > to) break;
+        if (st.last_ts < from) continue;
+        double value;
+        memcpy(&value, &st.last_value, sizeof(value));
+        if (fn(ctx, st.last_ts, value)) {
+            stop = 1;
+            break;
+        }
+    }
+    munmap((void*)hdr, bytes);
+    return stop;
+}
+
+// Runs fn over [from, to] of a channel, across segments
+static int scan_channel(history_t *h, int channel, int64_t from, int64_t to, sample_fn fn, void *ctx) {
+    int64_t *firsts;
+    int n = list_segments(h, channel, &firsts);
+    if (n < 0) return HISTORY_E_OPEN;
+    for (int i = 0; i < n; i++) {
+        if (i + 1 < n && firsts[i + 1] <= from) continue;  // Ends before the range
+        if (firsts[i] > to) break;
+        if (scan_segment(h, channel, firsts[i], from, to, fn, ctx)) break;
+    }
+    free(firsts);
+    return HISTORY_SUCCESS;
+}
+
+struct points_ctx {
+    history_point_t *out;
+    int n;
+    int max;
+};
+
+static int collect_point(void *arg, int64_t ts, double value) {
+    struct points_ctx *c = arg;
+    c->out[c->n].timestamp_ms = ts;
+    c->out[c->n].value = value;
+    return ++c->n == c->max;
+}
+
+struct buckets_ctx {
+    history_bucket_t *out;
+    int64_t from;
+    uint32_t step;
+    int n;
+};
+
+static int collect_bucket(void *arg, int64_t ts, double value) {
+    struct buckets_ctx *c = arg;
+    int64_t i = (ts - c->from) / c->step;
+    if (i >= c->n) return 1;
+    history_bucket_t *b = &c->out[i];
+    if (b->count == 0 || value < b->min) b->min = value;
+    if (b->count == 0 || value > b->max) b->max = value;
+    b->avg += value;    // Sum until the scan ends
+    b->count++;
+    return 0;
+}
+
+static int channel_ok(const history_t *h, int channel) {
+    return h != NULL && channel >= 0 && channel < HISTORY_MAX_CHANNELS;
+}
+
+/*------------------------ Public Function -----------------------------*/
+void history_default_config(history_config_t *cfg) {
+    if (cfg == NULL) return;
+    cfg->block_ms = HISTORY_BLOCK_MS_DEFAULT;
+    cfg->segment_bytes = HISTORY_SEGMENT_BYTES_DEFAULT;
+}
+
+history_t* history_open(const char *root, const history_config_t *cfg, int flags, int *err) {
+    int code = HISTORY_SUCCESS;
+    history_t *h = NULL;
+    if (root == NULL || strlen(root) >= sizeof(h->root) ||
+        (cfg != NULL && (cfg->block_ms < BLOCK_MS_MIN || cfg->block_ms > BLOCK_MS_MAX ||
+                         cfg->segment_bytes < SEGMENT_BYTES_MIN))) {
+        code = HISTORY_E_GENERIC_FAIL;
+        goto fail;
+    }
+    if (!(flags & HISTORY_F_READONLY) && mkdir(root, 0755) != 0 && errno != EEXIST) {
+        LOGGER_E(LOGGER_COMP_HISTORY, "Unable to create %s: %s", root, strerror(errno));
+        code = HISTORY_E_OPEN;
+        goto fail;
+    }
+
+    h = calloc(1, sizeof(*h));
+    if (h == NULL) {
+        code = HISTORY_E_GENERIC_FAIL;
+        goto fail;
+    }
+    snprintf(h->root, sizeof(h->root), "%s", root);
+    if (cfg != NULL) h->cfg = *cfg;
+    else history_default_config(&h->cfg);
+    h->readonly = (flags & HISTORY_F_READONLY) != 0;
+    for (int i = 0; i < HISTORY_MAX_CHANNELS; i++) pthread_mutex_init(&h->ch[i].lock, NULL);
+    return h;
+
+fail:
+    if (err != NULL) *err = code;
+    return NULL;
+}
+
+int history_append(history_t *h, int channel, int64_t timestamp_ms, double value) {
+    if (!channel_ok(h, channel)) return HISTORY_E_GENERIC_FAIL;
+    if (h->readonly) return HISTORY_E_READONLY;
+
+    channel_t *c = &h->ch[channel];
+    pthread_mutex_lock(&c->lock);
+    if (!c->loaded) load_active(h, channel);
+
+    segment_t *seg = &c->active;
+    if (timestamp_ms <= c->last_ts) {
+        pthread_mutex_unlock(&c->lock);
+        return HISTORY_E_ORDER;
+    }
+
+    // Next block, or not enough room for a worst-case sample: start a new segment
+    if (seg->hdr == NULL || timestamp_ms >= seg->hdr->block_start_ms + (int64_t)seg->hdr->block_ms ||
+        seg->st.bit_pos + MAX_SAMPLE_BITS > (uint64_t)seg->hdr->data_bytes * 8) {
+        seal_segment(h, channel, seg);
+        unmap_segment(seg);
+        int ret = create_segment(h, channel, timestamp_ms);
+        if (ret != HISTORY_SUCCESS) {
+            pthread_mutex_unlock(&c->lock);
+            return ret;
+        }
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    encode(seg->data, &seg->st, timestamp_ms, bits);
+    uint32_t k = seg->st.count / HISTORY_INDEX_STRIDE;
+    if (seg->st.count % HISTORY_INDEX_STRIDE == 0 && k <= INDEX_ENTRIES) seg->hdr->index[k - 1] = seg->st;
+    publish(seg);
+    c->last_ts = timestamp_ms;
+
+    pthread_mutex_unlock(&c->lock);
+    return HISTORY_SUCCESS;
+}
+
+int history_query(history_t *h, int channel, int64_t from_ms, int64_t to_ms, history_point_t *out, int max_points) {
+    if (!channel_ok(h, channel) || out == NULL || max_points < 0) return HISTORY_E_GENERIC_FAIL;
+    if (max_points == 0 || from_ms > to_ms) return 0;
+
+    struct points_ctx ctx = { out, 0, max_points };
+    int ret = scan_channel(h, channel, from_ms, to_ms, collect_point, &ctx);
+    return (ret != HISTORY_SUCCESS) ? ret : ctx.n;
+}
+
+int history_query_buckets(history_t *h, int channel, int64_t from_ms, int64_t to_ms, uint32_t step_ms,
+                          history_bucket_t *out, int max_buckets) {
+    if (!channel_ok(h, channel) || out == NULL || step_ms == 0 || max_buckets < 0) return HISTORY_E_GENERIC_FAIL;
+    if (from_ms > to_ms) return 0;
+
+    int64_t span = (to_ms - from_ms) / step_ms + 1;
+    int n = (span < max_buckets) ? (int)span : max_buckets;
+    memset(out, 0, (size_t)n * sizeof(*out));
+    for (int i = 0; i < n; i++) out[i].start_ms = from_ms + (int64_t)i * step_ms;
+    if (n == 0) return 0;
+
+    struct buckets_ctx ctx = { out, from_ms, step_ms, n };
+    int64_t last = from_ms + (int64_t)n * step_ms - 1;
+    int ret = scan_channel(h, channel, from_ms, last < to_ms ? last : to_ms, collect_bucket, &ctx);
+    if (ret != HISTORY_SUCCESS) return ret;
+    for (int i = 0; i < n; i++) {
+        if (out[i].count > 0) out[i].avg /= out[i].count;
+    }
+    return n;
+}
+
+int history_sync(history_t *h) {
+    if (h == NULL) return HISTORY_E_GENERIC_FAIL;
+    if (h->readonly) return HISTORY_SUCCESS;
+    for (int i = 0; i < HISTORY_MAX_CHANNELS; i++) {
+        pthread_mutex_lock(&h->ch[i].lock);
+        sync_segment(&h->ch[i].active);
+        pthread_mutex_unlock(&h->ch[i].lock);
+    }
+    return HISTORY_SUCCESS;
+}
+
+int history_prune(history_t *h, int64_t before_ms) {
+    if (h == NULL) return HISTORY_E_GENERIC_FAIL;
+    if (h->readonly) return HISTORY_E_READONLY;
+
+    int removed = 0;
+    for (int ch = 0; ch < HISTORY_MAX_CHANNELS; ch++) {
+        int64_t *firsts;
+        int n = list_segments(h, ch, &firsts);
+        // A segment ends where the next one starts; the newest one is never removed
+        for (int i = 0; i + 1 < n && firsts[i + 1] <= before_ms; i++) {
+            char path[PATH_BYTES];
+            segment_path(h, ch, firsts[i], path, sizeof(path));
+            if (unlink(path) == 0) removed++;
+        }
+        free(firsts);
+    }
+    return removed;
+}
+
+int history_channel_stats(history_t *h, int channel, history_channel_stats_t *out) {
+    if (!channel_ok(h, channel) || out == NULL) return HISTORY_E_GENERIC_FAIL;
+    memset(out, 0, sizeof(*out));
+
+    int64_t *firsts;
+    int n = list_segments(h, channel, &firsts);
+    if (n < 0) return HISTORY_E_OPEN;
+    for (int i = 0; i < n; i++) {
+        char path[PATH_BYTES];
+        segment_path(h, channel, firsts[i], path, sizeof(path));
+        size_t bytes;
+        const seg_header_t *hdr = map_file(path, 0, &bytes);
+        if (hdr == NULL) continue;
+
+        enc_state_t st;
+        if (header_valid(hdr, bytes, channel) && read_state(hdr, bytes, &st) == 0 &&
+            st.count > 0) {
+            if (out->samples == 0) out->first_ms = hdr->first_ts;
+            out->last_ms = st.last_ts;
+            out->samples += st.count;
+            out->data_bytes += (st.bit_pos + 7) / 8;
+        }
+        out->segments++;
+        munmap((void*)hdr, bytes);
+    }
+    free(firsts);
+    return HISTORY_SUCCESS;
+}
+
+void history_close(history_t *h) {
+    if (h == NULL) return;
+    history_sync(h);
+    for (int i = 0; i < HISTORY_MAX_CHANNELS; i++) {
+        unmap_segment(&h->ch[i].active);
+        pthread_mutex_destroy(&h->ch[i].lock);
+    }
+    free(h);
+}
@@ -0,0 +1,139 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Asynchronous binary logger shared by the C components.
+ *
+ * logger_write() never formats text and never touches a file: it parses the
+ * printf format only to capture the arguments into a fixed-size record and pushes
+ * it into a ring owned by the calling thread (single producer, single consumer).
+ * A drain thread moves records from every ring to a binary file; the format string
+ * itself is written once per file, the first time it is seen. When a ring is full
+ * the record is dropped and counted instead of blocking the caller.
+ *
+ * Until logger_init() runs (tools, examples), logger_write() prints to stderr
+ * synchronously, like the components used to.
+ *
+ * Format strings must be string literals: their address identifies them.
+ * Supported conversions: d i u x X o c p s f F e E g G %, with flags, width,
+ * precision and the hh h l ll z j t length modifiers ('*' is not supported).
+ */
+
+// --- Levels ---
+#define LOGGER_ERROR 0
+#define LOGGER_WARN 1
+#define LOGGER_INFO 2
+#define LOGGER_DEBUG 3
+
+// --- Components ---
+#define LOGGER_COMP_GENERIC 0
+#define LOGGER_COMP_RS485 1
+#define LOGGER_COMP_ALERT 2
+#define LOGGER_COMP_DATA_HANDLE 3
+#define LOGGER_COMP_MSG 4
+#define LOGGER_COMP_SNAPSHOT 5
+#define LOGGER_COMP_PM_SENSOR 6
+#define LOGGER_COMP_HISTORY 7
+#define LOGGER_COMP_COUNT 8
+
+// --- Limits ---
+#define LOGGER_MAX_ARGS 6
+#define LOGGER_STR_BYTES 48         // %s payloads of one record, NUL-separated and truncated
+#define LOGGER_RING_RECORDS 256     // Per thread, power of two
+#define LOGGER_DRAIN_MS 50          // Drain thread period
+
+// --- logger_init() flags ---
+#define LOGGER_F_STDERR 0x01        // Also render records as text on stderr (from the drain thread)
+
+// --- Error codes ---
+#define LOGGER_SUCCESS 0
+#define LOGGER_E_GENERIC_FAIL -1
+#define LOGGER_E_OPEN -2            // Log file could not be opened
+#define LOGGER_E_FORMAT -3          // Not a logger file, or unsupported version
+
+// --- File format ---
+#define LOGGER_FILE_MAGIC 0x474C534CU   // "LSLG"
+#define LOGGER_FILE_VERSION 1
+
+// Record types in the file
+#define LOGGER_REC_EVENT 0          // A logged message
+#define LOGGER_REC_FORMAT 1         // Format text for an id: the record is followed by args[0] bytes of text
+#define LOGGER_REC_DROPPED 2        // args[0] records were dropped since the previous marker
+
+/**
+ * @brief One binary record, as stored in the rings and in the file.
+ */
+typedef struct {
+    uint64_t timestamp_ns;          // CLOCK_REALTIME
+    uint64_t format_id;
+    uint32_t thread_id;
+    uint8_t type;                   // LOGGER_REC_*
+    uint8_t component;              // LOGGER_COMP_*
+    uint8_t level;                  // LOGGER_*
+    uint8_t n_args;
+    uint64_t args[LOGGER_MAX_ARGS]; // Integers, pointers and double bit patterns in format order
+    char str[LOGGER_STR_BYTES];
+} logger_record_t;
+
+/**
+ * @brief Header at the start of every log file.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+} logger_file_header_t;
+
+/**
+ * @brief Starts the drain thread. Records go to path (appended), rotated to path.1 above max_bytes.
+ * @param min_level Records above this level are discarded at the call site.
+ * @param max_bytes 0 for no rotation.
+ * @return LOGGER_SUCCESS, or a negative LOGGER_E_* code.
+ */
+int logger_init(const char *path, int min_level, uint32_t max_bytes, int flags);
+
+/**
+ * @brief Drains every ring, stops the drain thread and closes the file. Logging falls back to stderr.
+ */
+void logger_shutdown(void);
+
+void logger_set_level(int min_level);
+
+/**
+ * @brief Captures one record. Never blocks, never allocates after the thread's first call.
+ */
+void logger_write(int component, int level, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief Blocks until everything logged so far is written to the file.
+ */
+void logger_flush(void);
+
+/**
+ * @brief Records dropped because a ring was full, since logger_init().
+ */
+uint64_t logger_dropped(void);
+
+/**
+ * @brief Renders a record as text (no trailing newline).
+ * @param fmt Format text of the record (NULL renders the raw arguments).
+ * @return Length written, as snprintf().
+ */
+int logger_render(const logger_record_t *rec, const char *fmt, char *buf, size_t size);
+
+/**
+ * @brief Prints a binary log file as text.
+ * @return LOGGER_SUCCESS, or a negative LOGGER_E_* code.
+ */
+int logger_decode_file(const char *path, FILE *out);
+
+#define LOGGER_E(comp, ...) logger_write((comp), LOGGER_ERROR, __VA_ARGS__)
+#define LOGGER_W(comp, ...) logger_write((comp), LOGGER_WARN, __VA_ARGS__)
+#define LOGGER_I(comp, ...) logger_write((comp), LOGGER_INFO, __VA_ARGS__)
+#define LOGGER_D(comp, ...) logger_write((comp), LOGGER_DEBUG, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,613 @@
+#define _GNU_SOURCE
+#include "logger.h"
+#include <stdatomic.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+
+#define RING_MASK (LOGGER_RING_RECORDS - 1)
+#define SEEN_SLOTS 1024             // Format ids already written to the current file (open addressing)
+#define PATH_BYTES 256
+
+_Static_assert((LOGGER_RING_RECORDS & RING_MASK) == 0, "LOGGER_RING_RECORDS must be a power of two");
+
+typedef struct logger_ring {
+    logger_record_t rec[LOGGER_RING_RECORDS];
+    _Atomic uint32_t head;          // Written by the owner thread
+    _Atomic uint32_t tail;          // Written by the drain thread
+    _Atomic uint64_t dropped;
+    uint64_t dropped_reported;      // Drain thread only
+    _Atomic int free;               // Owner exited; reusable by a new thread once empty
+    uint32_t thread_id;
+    struct logger_ring *next;
+} logger_ring_t;
+
+// Parsed printf conversion
+typedef struct {
+    const char *start;              // '%'
+    size_t flags_len;               // '%' + flags + width + precision
+    int length;                     // LEN_*
+    char conv;
+} spec_t;
+
+enum { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_Z, LEN_J, LEN_T, LEN_BIG_L };
+
+static const char *comp_names[LOGGER_COMP_COUNT] = {
+    "GENERIC", "RS485", "ALERT", "DATA HANDLE", "MSG", "SNAPSHOT", "PM SENSOR", "HISTORY",
+};
+static const char *level_names[] = { "ERROR", "WARN", "INFO", "DEBUG" };
+
+static _Atomic(logger_ring_t*) rings = NULL;   // Push-only list, lock-free registration
+static __thread logger_ring_t *my_ring = NULL;
+static pthread_key_t ring_key;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+
+static _Atomic int running = 0;
+static _Atomic int min_level = LOGGER_INFO;
+
+// Drain thread state
+static pthread_t drain_thread;
+static pthread_mutex_t drain_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t drain_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t flush_done = PTHREAD_COND_INITIALIZER;
+static uint64_t flush_requested, flush_completed;
+static int stop_requested;
+static FILE *log_file;
+static char log_path[PATH_BYTES];
+static uint32_t log_max_bytes;
+static int log_flags;
+static uint64_t seen[SEEN_SLOTS];
+static _Atomic uint64_t dropped_total = 0;
+
+/*---------------------------- Private Function --------------------------------*/
+static const char* parse_spec(const char *p, spec_t *s) {
+    s->start = p++;
+    while (*p != '\0' && strchr("-+ #0'", *p) != NULL) p++;
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    s->flags_len = (size_t)(p - s->start);
+
+    s->length = LEN_NONE;
+    switch (*p) {
+        case 'h': s->length = (p[1] == 'h') ? LEN_HH : LEN_H; p += (p[1] == 'h') ? 2 : 1; break;
+        case 'l': s->length = (p[1] == 'l') ? LEN_LL : LEN_L; p += (p[1] == 'l') ? 2 : 1; break;
+        case 'z': s->length = LEN_Z; p++; break;
+        case 'j': s->length = LEN_J; p++; break;
+        case 't': s->length = LEN_T; p++; break;
+        case 'L': s->length = LEN_BIG_L; p++; break;
+        default: break;
+    }
+    s->conv = *p;
+    return (*p != '\0') ? p + 1 : p;
+}
+
+static uint64_t signed_arg(int length, va_list *ap) {
+    switch (length) {
+        case LEN_HH: return (uint64_t)(int64_t)(signed char)va_arg(*ap, int);
+        case LEN_H: return (uint64_t)(int64_t)(short)va_arg(*ap, int);
+        case LEN_L: return (uint64_t)(int64_t)va_arg(*ap, long);
+        case LEN_LL: return (uint64_t)(int64_t)va_arg(*ap, long long);
+        case LEN_Z: return (uint64_t)(int64_t)va_arg(*ap, ssize_t);
+        case LEN_J: return (uint64_t)(int64_t)va_arg(*ap, intmax_t);
+        case LEN_T: return (uint64_t)(int64_t)va_arg(*ap, ptrdiff_t);
+        default: return (uint64_t)(int64_t)va_arg(*ap, int);
+    }
+}
+
+static uint64_t unsigned_arg(int length, va_list *ap) {
+    switch (length) {
+        case LEN_HH: return (unsigned char)va_arg(*ap, unsigned int);
+        case LEN_H: return (unsigned short)va_arg(*ap, unsigned int);
+        case LEN_L: return va_arg(*ap, unsigned long);
+        case LEN_LL: return va_arg(*ap, unsigned long long);
+        case LEN_Z: return va_arg(*ap, size_t);
+        case LEN_J: return va_arg(*ap, uintmax_t);
+        case LEN_T: return (uint64_t)va_arg(*ap, ptrdiff_t);
+        default: return va_arg(*ap, unsigned int);
+    }
+}
+
+// Pulls the arguments out of ap in format order; no text is produced
+static void capture(logger_record_t *r, const char *fmt, va_list *ap) {
+    size_t str_used = 0;
+    int n = 0;
+
+    for (const char *p = fmt; *p != '\0';) {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+        spec_t s;
+        p = parse_spec(p, &s);
+        if (n == LOGGER_MAX_ARGS) break;
+
+        switch (s.conv) {
+            case 'd': case 'i':
+                r->args[n++] = signed_arg(s.length, ap);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                r->args[n++] = unsigned_arg(s.length, ap);
+                break;
+            case 'c':
+                r->args[n++] = (uint64_t)va_arg(*ap, int);
+                break;
+            case 'p':
+                r->args[n++] = (uint64_t)(uintptr_t)va_arg(*ap, void*);
+                break;
+            case 's': {
+                const char *str = va_arg(*ap, const char*);
+                if (str == NULL) str = "(null)";
+                if (str_used < LOGGER_STR_BYTES) {
+                    size_t room = LOGGER_STR_BYTES - str_used - 1;
+                    size_t len = strnlen(str, room);
+                    memcpy(r->str + str_used, str, len);
+                    r->str[str_used + len] = '\0';
+                    r->args[n++] = str_used;
+                    str_used += len + 1;
+                } else {
+                    r->args[n++] = LOGGER_STR_BYTES - 1;  // Out of room: renders as ""
+                }
+                break;
+            }
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                double d = (s.length == LEN_BIG_L) ? (double)va_arg(*ap, long double) : va_arg(*ap, double);
+                memcpy(&r->args[n++], &d, sizeof(d));
+                break;
+            }
+            default:
+                // Unsupported conversion: the remaining arguments cannot be located
+                r->n_args = (uint8_t)n;
+                return;
+        }
+    }
+    r->n_args = (uint8_t)n;
+}
+
+static void ring_key_destroy(void *arg) {
+    logger_ring_t *ring = arg;
+    atomic_store_explicit(&ring->free, 1, memory_order_release);
+}
+
+static void make_key(void) {
+    pthread_key_create(&ring_key, ring_key_destroy);
+}
+
+static logger_ring_t* thread_ring(void) {
+    if (my_ring != NULL) return my_ring;
+    pthread_once(&key_once, make_key);
+
+    uint32_t tid = (uint32_t)syscall(SYS_gettid);
+    // Reuse the ring of an exited thread once the drain thread has emptied it
+    for (logger_ring_t *r = atomic_load_explicit(&rings, memory_order_acquire); r != NULL; r = r->next) {
+        int expected = 1;
+        if (atomic_load_explicit(&r->head, memory_order_relaxed) == atomic_load_explicit(&r->tail, memory_order_acquire) &&
+            atomic_compare_exchange_strong(&r->free, &expected, 0)) {
+            r->thread_id = tid;
+            my_ring = r;
+            break;
+        }
+    }
+    if (my_ring == NULL) {
+        logger_ring_t *r = calloc(1, sizeof(*r));
+        if (r == NULL) return NULL;
+        r->thread_id = tid;
+        logger_ring_t *head = atomic_load_explicit(&rings, memory_order_relaxed);
+        do {
+            r->next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&rings, &head, r, memory_order_release, memory_order_relaxed));
+        my_ring = r;
+    }
+    pthread_setspecific(ring_key, my_ring);
+    return my_ring;
+}
+
+static uint64_t now_realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void format_prefix(const logger_record_t *rec, char *buf, size_t size) {
+    time_t sec = (time_t)(rec->timestamp_ns / 1000000000ULL);
+    struct tm tm;
+    localtime_r(&sec, &tm);
+    size_t n = strftime(buf, size, "%Y-%m-%d %H:%M:%S", &tm);
+    const char *comp = rec->component < LOGGER_COMP_COUNT ? comp_names[rec->component] : "?";
+    const char *level = rec->level <= LOGGER_DEBUG ? level_names[rec->level] : "?";
+    snprintf(buf + n, size - n, ".%06u [%s %s] (%u) ", (unsigned)((rec->timestamp_ns / 1000ULL) % 1000000ULL),
+             comp, level, rec->thread_id);
+}
+
+/*--------------------- Drain thread ---------------------*/
+static int seen_insert(uint64_t id) {
+    size_t i = (size_t)((id >> 3) * 0x9E3779B97F4A7C15ULL >> 54) & (SEEN_SLOTS - 1);
+    for (size_t probe = 0; probe < SEEN_SLOTS; probe++, i = (i + 1) & (SEEN_SLOTS - 1)) {
+        if (seen[i] == id) return 0;
+        if (seen[i] == 0) {
+            seen[i] = id;
+            return 1;
+        }
+    }
+    return 1;   // Table full: write the format again, harmless
+}
+
+static int open_log_file(void) {
+    log_file = fopen(log_path, "ab+");
+    if (log_file == NULL) return -1;
+    memset(seen, 0, sizeof(seen));
+
+    fseek(log_file, 0, SEEK_END);
+    if (ftell(log_file) == 0) {
+        logger_file_header_t h = { LOGGER_FILE_MAGIC, LOGGER_FILE_VERSION, sizeof(logger_record_t), 0 };
+        fwrite(&h, sizeof(h), 1, log_file);
+        return 0;
+    }
+    // Existing file: append only if it has our layout, otherwise move it aside
+    logger_file_header_t h;
+    rewind(log_file);
+    int ok = fread(&h, sizeof(h), 1, log_file) == 1 && h.magic == LOGGER_FILE_MAGIC &&
+             h.version == LOGGER_FILE_VERSION && h.record_size == sizeof(logger_record_t);
+    fseek(log_file, 0, SEEK_END);
+    if (ok) return 0;
+
+    fclose(log_file);
+    char old[PATH_BYTES + 4];
+    snprintf(old, sizeof(old), "%s.1", log_path);
+    rename(log_path, old);
+    return open_log_file();
+}
+
+static void rotate_if_needed(void) {
+    if (log_max_bytes == 0 || ftell(log_file) < (long)log_max_bytes) return;
+    fclose(log_file);
+    char old[PATH_BYTES + 4];
+    snprintf(old, sizeof(old), "%s.1", log_path);
+    rename(log_path, old);
+    if (open_log_file() != 0) log_file = NULL;
+}
+
+static void emit(const logger_record_t *rec) {
+    if (rec->type == LOGGER_REC_EVENT && seen_insert(rec->format_id)) {
+        const char *text = (const char*)(uintptr_t)rec->format_id;
+        logger_record_t f;
+        memset(&f, 0, sizeof(f));
+        f.type = LOGGER_REC_FORMAT;
+        f.timestamp_ns = rec->timestamp_ns;
+        f.format_id = rec->format_id;
+        f.args[0] = strlen(text);
+        fwrite(&f, sizeof(f), 1, log_file);
+        fwrite(text, 1, (size_t)f.args[0], log_file);
+    }
+    fwrite(rec, sizeof(*rec), 1, log_file);
+
+    if (log_flags & LOGGER_F_STDERR) {
+        char prefix[80], text[512];
+        format_prefix(rec, prefix, sizeof(prefix));
+        logger_render(rec, rec->type == LOGGER_REC_EVENT ? (const char*)(uintptr_t)rec->format_id : NULL,
+                      text, sizeof(text));
+        fprintf(stderr, "%s%s\n", prefix, text);
+    }
+}
+
+// Moves every queued record to the file. Returns the number of records written.
+static int drain_rings(void) {
+    int written = 0;
+    for (logger_ring_t *r = atomic_load_explicit(&rings, memory_order_acquire); r != NULL; r = r->next) {
+        uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+        for (; tail != head; tail++, written++) {
+            if (log_file != NULL) emit(&r->rec[tail & RING_MASK]);
+        }
+        atomic_store_explicit(&r->tail, tail, memory_order_release);
+
+        uint64_t dropped = atomic_load_explicit(&r->dropped, memory_order_relaxed);
+        if (dropped != r->dropped_reported && log_file != NULL) {
+            logger_record_t d;
+            memset(&d, 0, sizeof(d));
+            d.type = LOGGER_REC_DROPPED;
+            d.level = LOGGER_WARN;
+            d.timestamp_ns = now_realtime_ns();
+            d.thread_id = r->thread_id;
+            d.n_args = 1;
+            d.args[0] = dropped - r->dropped_reported;
+            emit(&d);
+            r->dropped_reported = dropped;
+            written++;
+        }
+    }
+    if (written > 0 && log_file != NULL) {
+        fflush(log_file);   // One write() per pass, however many records
+        rotate_if_needed();
+    }
+    return written;
+}
+
+static void* drain_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&drain_lock);
+    for (;;) {
+        if (!stop_requested && flush_requested == flush_completed) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += LOGGER_DRAIN_MS * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&drain_wake, &drain_lock, &deadline);
+        }
+        uint64_t flush_target = flush_requested;
+        int stopping = stop_requested;
+        pthread_mutex_unlock(&drain_lock);
+
+        drain_rings();
+
+        pthread_mutex_lock(&drain_lock);
+        flush_completed = flush_target;
+        pthread_cond_broadcast(&flush_done);
+        if (stopping) break;
+    }
+    pthread_mutex_unlock(&drain_lock);
+    return NULL;
+}
+
+/*------------------------ Public Function -----------------------------*/
+int logger_init(const char *path, int min, uint32_t max_bytes, int flags) {
+    if (path == NULL || strlen(path) >= PATH_BYTES) return LOGGER_E_GENERIC_FAIL;
+    if (atomic_load(&running)) return LOGGER_E_GENERIC_FAIL;
+
+    snprintf(log_path, sizeof(log_path), "%s", path);
+    if (open_log_file() != 0) {
+        fprintf(stderr, "logger_init: Unable to open %s - %s\n", path, strerror(errno));
+        return LOGGER_E_OPEN;
+    }
+    log_max_bytes = max_bytes;
+    log_flags = flags;
+    atomic_store(&min_level, min);
+    stop_requested = 0;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_destroy(&drain_wake);
+    pthread_cond_init(&drain_wake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (pthread_create(&drain_thread, NULL, drain_main, NULL) != 0) {
+        fclose(log_file);
+        log_file = NULL;
+        return LOGGER_E_GENERIC_FAIL;
+    }
+    atomic_store_explicit(&running, 1, memory_order_release);
+    return LOGGER_SUCCESS;
+}
+
+void logger_shutdown(void) {
+    if (!atomic_exchange(&running, 0)) return;
+
+    pthread_mutex_lock(&drain_lock);
+    stop_requested = 1;
+    pthread_cond_signal(&drain_wake);
+    pthread_mutex_unlock(&drain_lock);
+    pthread_join(drain_thread, NULL);
+
+    drain_rings();  // Records pushed while the thread was stopping
+    if (log_file != NULL) fclose(log_file);
+    log_file = NULL;
+}
+
+void logger_set_level(int min) {
+    atomic_store(&min_level, min);
+}
+
+void logger_write(int component, int level, const char *fmt, ...) {
+    if (fmt == NULL || level > atomic_load_explicit(&min_level, memory_order_relaxed)) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    if (!atomic_load_explicit(&running, memory_order_acquire)) {
+        // No drain thread: behave like the old synchronous fprintf
+        const char *comp = (component >= 0 && component < LOGGER_COMP_COUNT) ? comp_names[component] : "?";
+        const char *lvl = (level >= 0 && level <= LOGGER_DEBUG) ? level_names[level] : "?";
+        fprintf(stderr, "[%s %s] ", comp, lvl);
+        vfprintf(stderr, fmt, ap);
+        fputc('\n', stderr);
+        va_end(ap);
+        return;
+    }
+
+    logger_ring_t *ring = thread_ring();
+    if (ring == NULL) {
+        va_end(ap);
+        return;
+    }
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) >= LOGGER_RING_RECORDS) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&dropped_total, 1, memory_order_relaxed);
+        va_end(ap);
+        return;
+    }
+
+    logger_record_t *r = &ring->rec[head & RING_MASK];
+    r->timestamp_ns = now_realtime_ns();
+    r->format_id = (uint64_t)(uintptr_t)fmt;
+    r->thread_id = ring->thread_id;
+    r->type = LOGGER_REC_EVENT;
+    r->component = (uint8_t)component;
+    r->level = (uint8_t)level;
+    capture(r, fmt, &ap);
+    va_end(ap);
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    // Burst: wake the drain thread early instead of waiting for its period (a lost wakeup only costs latency)
+    if (head + 1 - atomic_load_explicit(&ring->tail, memory_order_relaxed) == LOGGER_RING_RECORDS / 2) {
+        pthread_cond_signal(&drain_wake);
+    }
+}
+
+void logger_flush(void) {
+    if (!atomic_load(&running)) return;
+    pthread_mutex_lock(&drain_lock);
+    uint64_t target = ++flush_requested;
+    pthread_cond_signal(&drain_wake);
+    while (flush_completed < target && !stop_requested) pthread_cond_wait(&flush_done, &drain_lock);
+    pthread_mutex_unlock(&drain_lock);
+}
+
+uint64_t logger_dropped(void) {
+    return atomic_load_explicit(&dropped_total, memory_order_relaxed);
+}
+
+int logger_render(const logger_record_t *rec, const char *fmt, char *buf, size_t size) {
+    if (rec == NULL || buf == NULL || size == 0) return 0;
+    size_t pos = 0;
+#define APPEND(...) do { \
+        int w_ = snprintf(buf + (pos < size ? pos : size - 1), pos < size ? size - pos : 1, __VA_ARGS__); \
+        if (w_ > 0) pos += (size_t)w_; \
+    } while (0)
+
+    if (rec->type == LOGGER_REC_DROPPED) {
+        APPEND("*** %llu log records dropped (ring full)", (unsigned long long)rec->args[0]);
+        return (int)pos;
+    }
+    if (fmt == NULL) {
+        APPEND("<format %#llx>", (unsigned long long)rec->format_id);
+        for (int i = 0; i < rec->n_args; i++) APPEND(" %#llx", (unsigned long long)rec->args[i]);
+        return (int)pos;
+    }
+
+    int n = 0;
+    for (const char *p = fmt; *p != '\0';) {
+        if (*p != '%') {
+            const char *lit = p;
+            while (*p != '\0' && *p != '%') p++;
+            APPEND("%.*s", (int)(p - lit), lit);
+            continue;
+        }
+        if (p[1] == '%') {
+            APPEND("%%");
+            p += 2;
+            continue;
+        }
+        spec_t s;
+        p = parse_spec(p, &s);
+        if (n >= rec->n_args) {
+            APPEND("%.*s", (int)(p - s.start), s.start);   // Argument was not captured
+            continue;
+        }
+
+        // Rebuild the spec with a length modifier matching how the value was stored
+        char spec[32];
+        size_t fl = s.flags_len < sizeof(spec) - 4 ? s.flags_len : sizeof(spec) - 4;
+        memcpy(spec, s.start, fl);
+        uint64_t v = rec->args[n++];
+        switch (s.conv) {
+            case 'd': case 'i':
+                memcpy(spec + fl, "lld", 4);
+                APPEND(spec, (long long)v);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                spec[fl] = 'l'; spec[fl + 1] = 'l'; spec[fl + 2] = s.conv; spec[fl + 3] = '\0';
+                APPEND(spec, (unsigned long long)v);
+                break;
+            case 'c':
+                spec[fl] = 'c'; spec[fl + 1] = '\0';
+                APPEND(spec, (int)v);
+                break;
+            case 'p':
+                spec[fl] = 'p'; spec[fl + 1] = '\0';
+                APPEND(spec, (void*)(uintptr_t)v);
+                break;
+            case 's':
+                spec[fl] = 's'; spec[fl + 1] = '\0';
+                APPEND(spec, v < LOGGER_STR_BYTES ? rec->str + v : "");
+                break;
+            default: {
+                double d;
+                memcpy(&d, &v, sizeof(d));
+                spec[fl] = s.conv; spec[fl + 1] = '\0';
+                APPEND(spec, d);
+                break;
+            }
+        }
+    }
+#undef APPEND
+    return (int)pos;
+}
+
+int logger_decode_file(const char *path, FILE *out) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) return LOGGER_E_OPEN;
+
+    logger_file_header_t h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != LOGGER_FILE_MAGIC || h.version != LOGGER_FILE_VERSION ||
+        h.record_size != sizeof(logger_record_t)) {
+        fclose(f);
+        return LOGGER_E_FORMAT;
+    }
+
+    // Format table: id -> text, later definitions replace earlier ones (new process, same address)
+    struct { uint64_t id; char *text; } *formats = NULL;
+    size_t n_formats = 0, cap = 0;
+
+    logger_record_t rec;
+    while (fread(&rec, sizeof(rec), 1, f) == 1) {
+        if (rec.type == LOGGER_REC_FORMAT) {
+            size_t len = (size_t)rec.args[0];
+            char *text = malloc(len + 1);
+            if (text == NULL || fread(text, 1, len, f) != len) {
+                free(text);
+                break;
+            }
+            text[len] = '\0';
+            size_t i = 0;
+            while (i < n_formats && formats[i].id != rec.format_id) i++;
+            if (i == n_formats) {
+                if (n_formats == cap) {
+                    cap = cap ? cap * 2 : 64;
+                    void *grown = realloc(formats, cap * sizeof(*formats));
+                    if (grown == NULL) {
+                        free(text);
+                        break;
+                    }
+                    formats = grown;
+                }
+                n_formats++;
+            } else {
+                free(formats[i].text);
+            }
+            formats[i].id = rec.format_id;
+            formats[i].text = text;
+            continue;
+        }
+
+        const char *fmt = NULL;
+        for (size_t i = 0; i < n_formats && rec.type == LOGGER_REC_EVENT; i++) {
+            if (formats[i].id == rec.format_id) fmt = formats[i].text;
+        }
+        char prefix[80], text[1024];
+        format_prefix(&rec, prefix, sizeof(prefix));
+        logger_render(&rec, fmt, text, sizeof(text));
+        fprintf(out, "%s%s\n", prefix, text);
+    }
+
+    for (size_t i = 0; i < n_formats; i++) free(formats[i].text);
+    free(formats);
+    fclose(f);
+    return LOGGER_SUCCESS;
+}
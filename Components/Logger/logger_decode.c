@@ -0,0 +1,28 @@
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Renders binary log files written by the logger drain thread as text.
+ * Usage: logger_decode file [file...]   (e.g. components.lg.1 components.lg)
+ */
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s log_file [log_file...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int status = EXIT_SUCCESS;
+    for (int i = 1; i < argc; i++) {
+        int ret = logger_decode_file(argv[i], stdout);
+        if (ret == LOGGER_E_OPEN) {
+            perror(argv[i]);
+            status = EXIT_FAILURE;
+        } else if (ret == LOGGER_E_FORMAT) {
+            fprintf(stderr, "%s: not a logger file, or unsupported version\n", argv[i]);
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}
@@ -2,6 +2,7 @@
 #define MSG_LIB_H
 
 #include <stddef.h> // For size_t
+#include <signal.h> // For struct sigevent (msg_notify)
 
 // --- Custom Error Codes for the Library ---
 #define MSG_SUCCESS 0        // Task completed successfully
@@ -10,12 +11,27 @@
 #define MSG_E_SEND_FAIL -3   // Failed to send the message
 #define MSG_E_RECV_FAIL -4   // Failed to receive the message
 #define MSG_E_QUEUE_CLOSE -5 // Failed to close the queue descriptor
+#define MSG_E_TIMEOUT -6     // Timed operation expired before completion
+#define MSG_E_AGAIN -7       // Non-blocking operation would have blocked
+#define MSG_E_INVALID_ARG -8 // Bad handle, buffer or size
 
 // --- Constants ---
 #define QUEUE_NAME_DEFAULT "/task_queue"
 #define MAX_MSG_SIZE_DEFAULT 256
 #define MAX_MSGS_DEFAULT 10
 
+// --- Open flags for msg_open ---
+#define MSG_O_READ 0x01      // Open for receiving
+#define MSG_O_WRITE 0x02     // Open for sending
+#define MSG_O_CREATE 0x04    // Create the queue if it does not exist
+#define MSG_O_NONBLOCK 0x08  // Send/receive never block (MSG_E_AGAIN instead)
+
+// --- Timeouts for the *_timed calls ---
+#define MSG_WAIT_FOREVER -1
+#define MSG_NO_WAIT 0
+
+typedef struct msg_handle msg_handle_t;
+
 /**
  * @brief Writes a message to the specified message queue.
  *
@@ -51,4 +67,88 @@ int msg_read(const char *queue_name, char *buffer, size_t buffer_size, size_t *r
  * @return MSG_SUCCESS (0) on success, or a negative error code on failure.
  */
 int msg_cleanup(const char *queue_name);
+
+/*---------------------- Persistent-handle API ----------------------*/
+
+/**
+ * @brief Opens a queue once for many send/receive calls.
+ *
+ * @param queue_name The name of the POSIX queue (e.g., "/my_queue").
+ * @param flags Combination of MSG_O_* flags.
+ * @param max_msgs Queue depth used when MSG_O_CREATE creates the queue (0 = MAX_MSGS_DEFAULT).
+ * @param max_msg_size Message size used when MSG_O_CREATE creates the queue (0 = MAX_MSG_SIZE_DEFAULT).
+ * @param err Optional pointer receiving a negative error code on failure.
+ * @return Handle on success, NULL on failure.
+ */
+msg_handle_t *msg_open(const char *queue_name, int flags, long max_msgs, long max_msg_size, int *err);
+
+/**
+ * @brief Closes the handle. The queue itself stays until msg_cleanup().
+ * @return MSG_SUCCESS (0) on success, or a negative error code on failure.
+ */
+int msg_close(msg_handle_t *handle);
+
+/**
+ * @brief Sends one message.
+ * @param priority Higher priorities are received first (0 = lowest).
+ * @param timeout_ms MSG_WAIT_FOREVER, MSG_NO_WAIT, or a timeout in milliseconds.
+ * @return MSG_SUCCESS, MSG_E_TIMEOUT, MSG_E_AGAIN, or another negative error code.
+ */
+int msg_send_timed(msg_handle_t *handle, const char *message, size_t msg_len, unsigned int priority, int timeout_ms);
+
+/**
+ * @brief Sends one message, blocking while the queue is full (unless opened MSG_O_NONBLOCK).
+ */
+int msg_send(msg_handle_t *handle, const char *message, size_t msg_len, unsigned int priority);
+
+/**
+ * @brief Receives the oldest message of the highest priority.
+ * @param buffer Must hold at least msg_max_size(handle) bytes.
+ * @param received_len Receives the message length.
+ * @param priority Optional, receives the message priority.
+ * @param timeout_ms MSG_WAIT_FOREVER, MSG_NO_WAIT, or a timeout in milliseconds.
+ * @return MSG_SUCCESS, MSG_E_TIMEOUT, MSG_E_AGAIN, or another negative error code.
+ */
+int msg_receive_timed(msg_handle_t *handle, char *buffer, size_t buffer_size, size_t *received_len,
+                      unsigned int *priority, int timeout_ms);
+
+/**
+ * @brief Receives one message, blocking while the queue is empty (unless opened MSG_O_NONBLOCK).
+ */
+int msg_receive(msg_handle_t *handle, char *buffer, size_t buffer_size, size_t *received_len, unsigned int *priority);
+
+/**
+ * @brief Sends up to count messages. Only the first send may wait (timeout_ms);
+ *        the rest are sent while the queue has room.
+ * @return Number of messages sent (>= 0), or a negative error code if none was sent.
+ */
+int msg_send_batch(msg_handle_t *handle, const char *const *messages, const size_t *msg_lens, int count,
+                   unsigned int priority, int timeout_ms);
+
+/**
+ * @brief Receives up to max_count messages into consecutive slots of slot_size bytes.
+ *        Only the first receive may wait (timeout_ms); the rest drain what is already queued.
+ * @param buffers max_count * slot_size bytes; slot_size must be >= msg_max_size(handle).
+ * @param received_lens Array of max_count lengths.
+ * @return Number of messages received (>= 0), or a negative error code if none was received.
+ */
+int msg_receive_batch(msg_handle_t *handle, char *buffers, size_t slot_size, size_t *received_lens,
+                      int max_count, int timeout_ms);
+
+/**
+ * @brief Largest message the queue accepts (cached at open time).
+ */
+long msg_max_size(const msg_handle_t *handle);
+
+/**
+ * @brief File descriptor of the queue, usable with poll/select/epoll (EPOLLIN = message available).
+ * @return Descriptor (>= 0), or MSG_E_INVALID_ARG.
+ */
+int msg_get_fd(const msg_handle_t *handle);
+
+/**
+ * @brief Registers (or with NULL, removes) a one-shot mq_notify() notification for an empty queue.
+ * @return MSG_SUCCESS (0) on success, or a negative error code on failure.
+ */
+int msg_notify(msg_handle_t *handle, const struct sigevent *sev);
 #endif // MSG_LIB_H
\ No newline at end of file
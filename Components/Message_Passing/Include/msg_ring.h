@@ -0,0 +1,91 @@
+#ifndef MSG_RING_H
+#define MSG_RING_H
+
+#include <stddef.h> // For size_t
+#include <stdint.h>
+#include "msg.h"    // Shares error codes, MSG_O_* flags and timeouts with the mqueue transport
+
+// --- Constants ---
+#define MSG_RING_NAME_DEFAULT "/task_ring"
+#define MSG_RING_SLOTS_DEFAULT 256       // Rounded up to a power of two
+#define MSG_RING_SLOT_SIZE_DEFAULT 256   // Payload bytes per slot
+
+typedef struct msg_ring msg_ring_t;
+
+/**
+ * @brief Opens (or creates) a lock-free ring queue in /dev/shm.
+ *
+ * Any number of producers and consumers may attach; messages are written and
+ * read in place inside the shared segment. The fast path is a couple of atomic
+ * operations; a futex is only touched when a side actually has to sleep.
+ * An attacher that races the creator waits up to 1 s for the header to be stamped.
+ *
+ * @param ring_name POSIX shm name (e.g., "/my_ring").
+ * @param flags MSG_O_CREATE to create the ring if missing (other MSG_O_* flags are ignored).
+ * @param slots Ring depth when created (0 = MSG_RING_SLOTS_DEFAULT).
+ * @param slot_size Max message size when created (0 = MSG_RING_SLOT_SIZE_DEFAULT).
+ * @param err Optional pointer receiving a negative error code on failure.
+ * @return Handle on success, NULL on failure.
+ */
+msg_ring_t *msg_ring_open(const char *ring_name, int flags, uint32_t slots, uint32_t slot_size, int *err);
+
+/**
+ * @brief Unmaps the ring. The segment stays until msg_ring_cleanup().
+ * @return MSG_SUCCESS (0) on success, or a negative error code on failure.
+ */
+int msg_ring_close(msg_ring_t *ring);
+
+/**
+ * @brief Removes the ring from /dev/shm.
+ * @return MSG_SUCCESS (0) on success, or a negative error code on failure.
+ */
+int msg_ring_cleanup(const char *ring_name);
+
+/**
+ * @brief Reserves a free slot for writing in place.
+ * @param timeout_ms MSG_WAIT_FOREVER, MSG_NO_WAIT, or a timeout in milliseconds.
+ * @param err Receives MSG_E_AGAIN / MSG_E_TIMEOUT when the ring stays full.
+ * @return Pointer to msg_ring_slot_size() writable bytes, or NULL.
+ */
+void *msg_ring_reserve(msg_ring_t *ring, int timeout_ms, int *err);
+
+/**
+ * @brief Publishes a slot obtained from msg_ring_reserve().
+ * @param msg_len Number of bytes written (<= msg_ring_slot_size()).
+ * @return MSG_SUCCESS (0) on success, or MSG_E_INVALID_ARG.
+ */
+int msg_ring_commit(msg_ring_t *ring, void *slot, size_t msg_len);
+
+/**
+ * @brief Claims the oldest message for reading in place.
+ * @param msg_len Receives the message length.
+ * @param timeout_ms MSG_WAIT_FOREVER, MSG_NO_WAIT, or a timeout in milliseconds.
+ * @param err Receives MSG_E_AGAIN / MSG_E_TIMEOUT when the ring stays empty.
+ * @return Pointer to the message, valid until msg_ring_release(), or NULL.
+ */
+const void *msg_ring_peek(msg_ring_t *ring, size_t *msg_len, int timeout_ms, int *err);
+
+/**
+ * @brief Returns a slot obtained from msg_ring_peek() to the producers.
+ * @return MSG_SUCCESS (0) on success, or MSG_E_INVALID_ARG.
+ */
+int msg_ring_release(msg_ring_t *ring, const void *slot);
+
+/**
+ * @brief Copying convenience: reserve + memcpy + commit.
+ * @return MSG_SUCCESS (0) on success, or a negative error code on failure.
+ */
+int msg_ring_send(msg_ring_t *ring, const char *message, size_t msg_len, int timeout_ms);
+
+/**
+ * @brief Copying convenience: peek + memcpy + release.
+ * @return MSG_SUCCESS (0) on success, or a negative error code on failure.
+ */
+int msg_ring_receive(msg_ring_t *ring, char *buffer, size_t buffer_size, size_t *received_len, int timeout_ms);
+
+/**
+ * @brief Largest message a slot can hold.
+ */
+size_t msg_ring_slot_size(const msg_ring_t *ring);
+
+#endif // MSG_RING_H
@@ -3,7 +3,16 @@
 #include <fcntl.h>    // O_RDONLY, O_WRONLY, O_CREAT
 #include <sys/stat.h> // S_IRUSR, S_IWUSR
 #include <string.h>   // For strerror (though not strictly necessary for return values)
-#include <stdio.h>    // For optional perror
+#include "logger.h"
+#include <stdlib.h>   // malloc, free
+#include <errno.h>    // ETIMEDOUT, EAGAIN
+#include <time.h>     // clock_gettime for absolute timeouts
+
+struct msg_handle {
+    mqd_t mq;
+    long max_msg_size;
+    int flags;
+};
 
 // --- Function to set up default queue attributes (used by msg_read) ---
 static void setup_default_attr(struct mq_attr *attr) {
@@ -21,25 +30,25 @@ int msg_write(const char *queue_name, const char *message, size_t msg_len) {
     mq = mq_open(queue_name, O_WRONLY);
     if (mq == (mqd_t)-1) {
         // If the queue doesn't exist, errno will be ENOENT
-        perror("msg_write: mq_open failed");
+        LOGGER_E(LOGGER_COMP_MSG, "msg_write: mq_open failed: %s", strerror(errno));
         return MSG_E_QUEUE_OPEN;
     }
 
     // Check if the message exceeds the default max size (optional check, better done with proper queue attrs)
     if (msg_len > MAX_MSG_SIZE_DEFAULT) {
-        fprintf(stderr, "msg_write: Message size %zu exceeds default maximum size %d\n", msg_len, MAX_MSG_SIZE_DEFAULT);
+        LOGGER_E(LOGGER_COMP_MSG, "msg_write: Message size %zu exceeds default maximum size %d", msg_len, MAX_MSG_SIZE_DEFAULT);
         // Note: For a strict library, you might not want to close on failure here.
     }
     
     // Send the message (priority set to 0)
     if (mq_send(mq, message, msg_len, 0) == -1) {
-        perror("msg_write: mq_send failed");
+        LOGGER_E(LOGGER_COMP_MSG, "msg_write: mq_send failed: %s", strerror(errno));
         return_code = MSG_E_SEND_FAIL;
     }
 
     // Close the queue descriptor
     if (mq_close(mq) == -1) {
-        perror("msg_write: mq_close failed");
+        LOGGER_E(LOGGER_COMP_MSG, "msg_write: mq_close failed: %s", strerror(errno));
         // Prioritize the send error if it occurred, otherwise return the close error
         if (return_code == MSG_SUCCESS) {
             return_code = MSG_E_QUEUE_CLOSE;
@@ -62,13 +71,13 @@ int msg_read(const char *queue_name, char *buffer, size_t buffer_size, size_t *r
     // Permissions 0644 (rw-r--r--). Attributes &attr are used ONLY if O_CREAT creates it.
     mq = mq_open(queue_name, O_RDONLY | O_CREAT, 0644, &attr);
     if (mq == (mqd_t)-1) {
-        perror("msg_read: mq_open failed");
+        LOGGER_E(LOGGER_COMP_MSG, "msg_read: mq_open failed: %s", strerror(errno));
         return MSG_E_QUEUE_OPEN;
     }
 
     // Check actual queue size against buffer size for safety
     if (mq_getattr(mq, &attr) == 0 && buffer_size < (size_t)attr.mq_msgsize) {
-        fprintf(stderr, "msg_read: Warning: Buffer size %zu is smaller than queue's max message size %ld.\n", 
+        LOGGER_W(LOGGER_COMP_MSG, "msg_read: Buffer size %zu is smaller than queue's max message size %ld", 
                 buffer_size, attr.mq_msgsize);
         // Reception might still succeed for small messages, but buffer overflow is possible for large ones.
     }
@@ -77,7 +86,7 @@ int msg_read(const char *queue_name, char *buffer, size_t buffer_size, size_t *r
     bytes_read = mq_receive(mq, buffer, buffer_size, NULL);
     
     if (bytes_read == -1) {
-        perror("msg_read: mq_receive failed");
+        LOGGER_E(LOGGER_COMP_MSG, "msg_read: mq_receive failed: %s", strerror(errno));
         return_code = MSG_E_RECV_FAIL;
     } else {
         *received_len = (size_t)bytes_read;
@@ -85,7 +94,7 @@ int msg_read(const char *queue_name, char *buffer, size_t buffer_size, size_t *r
 
     // Close the queue descriptor
     if (mq_close(mq) == -1) {
-        perror("msg_read: mq_close failed");
+        LOGGER_E(LOGGER_COMP_MSG, "msg_read: mq_close failed: %s", strerror(errno));
         if (return_code == MSG_SUCCESS) {
             return_code = MSG_E_QUEUE_CLOSE;
         }
@@ -102,8 +111,182 @@ int msg_cleanup(const char *queue_name){
     if (mq_unlink(queue_name) == -1) {
         // If the queue doesn't exist (ENOENT), we might still treat it as success, 
         // but generally, we report the error.
-        perror("msg_cleanup: mq_unlink failed"); 
+        LOGGER_E(LOGGER_COMP_MSG, "msg_cleanup: mq_unlink failed: %s", strerror(errno)); 
         return MSG_E_GENERIC_FAIL; // Using a generic failure code for unlink errors
     }
     return MSG_SUCCESS;
 }
+
+
+/*---------------------- Persistent-handle API ----------------------*/
+
+// Converts a relative timeout into the absolute CLOCK_REALTIME deadline mq_timed* expects.
+// MSG_NO_WAIT yields a deadline in the past, so the call fails immediately instead of blocking.
+static struct timespec deadline_from_ms(int timeout_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+static int errno_to_code(int err, int fail_code) {
+    if (err == ETIMEDOUT) return MSG_E_TIMEOUT;
+    if (err == EAGAIN) return MSG_E_AGAIN;
+    if (err == EMSGSIZE || err == EBADF || err == EINVAL) return MSG_E_INVALID_ARG;
+    return fail_code;
+}
+
+msg_handle_t *msg_open(const char *queue_name, int flags, long max_msgs, long max_msg_size, int *err) {
+    struct mq_attr attr;
+    int oflag;
+
+    if ((flags & (MSG_O_READ | MSG_O_WRITE)) == (MSG_O_READ | MSG_O_WRITE)) oflag = O_RDWR;
+    else if (flags & MSG_O_WRITE) oflag = O_WRONLY;
+    else oflag = O_RDONLY;
+    if (flags & MSG_O_NONBLOCK) oflag |= O_NONBLOCK;
+
+    msg_handle_t *handle = malloc(sizeof(*handle));
+    if (handle == NULL) {
+        if (err) *err = MSG_E_GENERIC_FAIL;
+        return NULL;
+    }
+
+    if (flags & MSG_O_CREATE) {
+        setup_default_attr(&attr);
+        if (max_msgs > 0) attr.mq_maxmsg = max_msgs;
+        if (max_msg_size > 0) attr.mq_msgsize = max_msg_size;
+        handle->mq = mq_open(queue_name, oflag | O_CREAT, 0644, &attr);
+    } else {
+        handle->mq = mq_open(queue_name, oflag);
+    }
+    if (handle->mq == (mqd_t)-1) {
+        LOGGER_E(LOGGER_COMP_MSG, "msg_open: mq_open failed: %s", strerror(errno));
+        free(handle);
+        if (err) *err = MSG_E_QUEUE_OPEN;
+        return NULL;
+    }
+
+    // Attributes are fixed for the queue's lifetime: read them once here, not per message
+    if (mq_getattr(handle->mq, &attr) == -1) {
+        LOGGER_E(LOGGER_COMP_MSG, "msg_open: mq_getattr failed: %s", strerror(errno));
+        mq_close(handle->mq);
+        free(handle);
+        if (err) *err = MSG_E_QUEUE_OPEN;
+        return NULL;
+    }
+    handle->max_msg_size = attr.mq_msgsize;
+    handle->flags = flags;
+    if (err) *err = MSG_SUCCESS;
+    return handle;
+}
+
+int msg_close(msg_handle_t *handle) {
+    if (handle == NULL) return MSG_E_INVALID_ARG;
+    int return_code = MSG_SUCCESS;
+    if (mq_close(handle->mq) == -1) {
+        LOGGER_E(LOGGER_COMP_MSG, "msg_close: mq_close failed: %s", strerror(errno));
+        return_code = MSG_E_QUEUE_CLOSE;
+    }
+    free(handle);
+    return return_code;
+}
+
+int msg_send_timed(msg_handle_t *handle, const char *message, size_t msg_len, unsigned int priority, int timeout_ms) {
+    if (handle == NULL || message == NULL || msg_len > (size_t)handle->max_msg_size) return MSG_E_INVALID_ARG;
+
+    int rc;
+    if (timeout_ms < 0) {
+        rc = mq_send(handle->mq, message, msg_len, priority);
+    } else {
+        struct timespec deadline = deadline_from_ms(timeout_ms);
+        rc = mq_timedsend(handle->mq, message, msg_len, priority, &deadline);
+    }
+    if (rc == -1) {
+        // MSG_NO_WAIT on a full queue is an expected outcome, not a timeout
+        if (errno == ETIMEDOUT && timeout_ms == MSG_NO_WAIT) return MSG_E_AGAIN;
+        return errno_to_code(errno, MSG_E_SEND_FAIL);
+    }
+    return MSG_SUCCESS;
+}
+
+int msg_send(msg_handle_t *handle, const char *message, size_t msg_len, unsigned int priority) {
+    return msg_send_timed(handle, message, msg_len, priority, MSG_WAIT_FOREVER);
+}
+
+int msg_receive_timed(msg_handle_t *handle, char *buffer, size_t buffer_size, size_t *received_len,
+                      unsigned int *priority, int timeout_ms) {
+    if (handle == NULL || buffer == NULL || received_len == NULL) return MSG_E_INVALID_ARG;
+    if (buffer_size < (size_t)handle->max_msg_size) return MSG_E_INVALID_ARG; // mq_receive would reject it
+
+    ssize_t bytes_read;
+    if (timeout_ms < 0) {
+        bytes_read = mq_receive(handle->mq, buffer, buffer_size, priority);
+    } else {
+        struct timespec deadline = deadline_from_ms(timeout_ms);
+        bytes_read = mq_timedreceive(handle->mq, buffer, buffer_size, priority, &deadline);
+    }
+    if (bytes_read == -1) {
+        if (errno == ETIMEDOUT && timeout_ms == MSG_NO_WAIT) return MSG_E_AGAIN;
+        return errno_to_code(errno, MSG_E_RECV_FAIL);
+    }
+    *received_len = (size_t)bytes_read;
+    return MSG_SUCCESS;
+}
+
+int msg_receive(msg_handle_t *handle, char *buffer, size_t buffer_size, size_t *received_len, unsigned int *priority) {
+    return msg_receive_timed(handle, buffer, buffer_size, received_len, priority, MSG_WAIT_FOREVER);
+}
+
+int msg_send_batch(msg_handle_t *handle, const char *const *messages, const size_t *msg_lens, int count,
+                   unsigned int priority, int timeout_ms) {
+    if (handle == NULL || messages == NULL || msg_lens == NULL || count < 0) return MSG_E_INVALID_ARG;
+
+    int sent = 0;
+    while (sent < count) {
+        int rc = msg_send_timed(handle, messages[sent], msg_lens[sent], priority, sent == 0 ? timeout_ms : MSG_NO_WAIT);
+        if (rc != MSG_SUCCESS) {
+            return sent > 0 ? sent : rc;
+        }
+        sent++;
+    }
+    return sent;
+}
+
+int msg_receive_batch(msg_handle_t *handle, char *buffers, size_t slot_size, size_t *received_lens,
+                      int max_count, int timeout_ms) {
+    if (handle == NULL || buffers == NULL || received_lens == NULL || max_count < 0) return MSG_E_INVALID_ARG;
+
+    int received = 0;
+    while (received < max_count) {
+        int rc = msg_receive_timed(handle, buffers + (size_t)received * slot_size, slot_size,
+                                   &received_lens[received], NULL, received == 0 ? timeout_ms : MSG_NO_WAIT);
+        if (rc != MSG_SUCCESS) {
+            return received > 0 ? received : rc;
+        }
+        received++;
+    }
+    return received;
+}
+
+long msg_max_size(const msg_handle_t *handle) {
+    return handle ? handle->max_msg_size : MSG_E_INVALID_ARG;
+}
+
+int msg_get_fd(const msg_handle_t *handle) {
+    // On Linux mqd_t is a file descriptor, so it can be registered with epoll directly
+    return handle ? (int)handle->mq : MSG_E_INVALID_ARG;
+}
+
+int msg_notify(msg_handle_t *handle, const struct sigevent *sev) {
+    if (handle == NULL) return MSG_E_INVALID_ARG;
+    if (mq_notify(handle->mq, sev) == -1) {
+        LOGGER_E(LOGGER_COMP_MSG, "msg_notify: mq_notify failed: %s", strerror(errno));
+        return MSG_E_GENERIC_FAIL;
+    }
+    return MSG_SUCCESS;
+}
@@ -0,0 +1,364 @@
+#include "msg_ring.h"
+#include "logger.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>        // O_RDWR, O_CREAT, O_EXCL
+#include <sys/mman.h>     // shm_open, mmap
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+
+#define RING_MAGIC 0x474E5252U   // "RRNG"
+#define RING_VERSION 1
+#define CACHE_LINE 64
+#define ALIGN_UP(x, a) (((x) + (a) - 1) & ~((size_t)(a) - 1))
+#define ATTACH_WAIT_MS 1000      // How long an attacher waits for the creator to stamp the header
+#define ATTACH_POLL_US 1000
+
+// Shared header. Producer and consumer cursors live on separate cache lines.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;          // Power of two
+    uint32_t slot_size;      // Payload bytes
+    uint32_t slot_stride;    // Bytes between two slots
+    _Alignas(CACHE_LINE) _Atomic uint64_t enqueue_pos;
+    _Atomic uint32_t space_seq;     // Futex word: bumped on every release
+    _Atomic uint32_t space_waiters;
+    _Alignas(CACHE_LINE) _Atomic uint64_t dequeue_pos;
+    _Atomic uint32_t data_seq;      // Futex word: bumped on every commit
+    _Atomic uint32_t data_waiters;
+} ring_header_t;
+
+// Slot state is encoded Vyukov-style in seq:
+//   seq == pos             free for the producer that claims position pos
+//   seq == pos + 1         committed, readable by the consumer of position pos
+//   seq == pos + slots     released, free for position pos + slots
+typedef struct {
+    _Atomic uint64_t seq;
+    uint64_t pos;            // Position owned while reserved/peeked
+    uint32_t len;
+    uint32_t reserved;
+    _Alignas(16) char data[];
+} ring_slot_t;
+
+struct msg_ring {
+    ring_header_t *hdr;
+    char *slots_base;
+    size_t map_size;
+};
+
+/*---------------------------- Private Function --------------------------------*/
+static ring_slot_t *slot_at(const msg_ring_t *ring, uint64_t pos) {
+    return (ring_slot_t*)(ring->slots_base + (size_t)(pos & (ring->hdr->slots - 1)) * ring->hdr->slot_stride);
+}
+
+static ring_slot_t *slot_from_data(const msg_ring_t *ring, const void *data) {
+    const char *p = (const char*)data - offsetof(ring_slot_t, data);
+    if (p < ring->slots_base) return NULL;
+    size_t off = (size_t)(p - ring->slots_base);
+    if (off % ring->hdr->slot_stride != 0 || off / ring->hdr->slot_stride >= ring->hdr->slots) return NULL;
+    return (ring_slot_t*)p;
+}
+
+static uint32_t next_pow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+// Sleeps on a shared futex word while it still holds expected. Returns MSG_E_TIMEOUT once the deadline passed.
+static int futex_wait_until(_Atomic uint32_t *word, uint32_t expected, int timeout_ms, uint64_t deadline_ms) {
+    struct timespec rel, *relp = NULL;
+    if (timeout_ms >= 0) {
+        uint64_t now = now_ms();
+        if (now >= deadline_ms) return MSG_E_TIMEOUT;
+        uint64_t left = deadline_ms - now;
+        rel.tv_sec = (time_t)(left / 1000);
+        rel.tv_nsec = (long)(left % 1000) * 1000000L;
+        relp = &rel;
+    }
+    // Not FUTEX_PRIVATE: the word is shared between processes
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, relp, NULL, 0);
+    return MSG_SUCCESS;
+}
+
+static void futex_wake_all(_Atomic uint32_t *word) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+// Reads the geometry of a ring created by another process. The creator sizes the segment and
+// stamps the magic last, so an early attacher waits for both instead of failing.
+static int read_geometry(int fd, const char *ring_name, ring_header_t *geometry) {
+    for (int waited_us = 0; ; waited_us += ATTACH_POLL_US) {
+        struct stat st;
+        if (fstat(fd, &st) == -1) break;
+        if ((size_t)st.st_size >= sizeof(ring_header_t)) {
+            ring_header_t *peek = mmap(NULL, sizeof(ring_header_t), PROT_READ, MAP_SHARED, fd, 0);
+            if (peek == MAP_FAILED) break;
+            int stamped = __atomic_load_n(&peek->magic, __ATOMIC_ACQUIRE) == RING_MAGIC;
+            int valid = stamped && peek->version == RING_VERSION;
+            geometry->slots = peek->slots;
+            geometry->slot_stride = peek->slot_stride;
+            munmap(peek, sizeof(ring_header_t));
+            if (valid) return 0;
+            if (stamped) break;     // Another layout: waiting will not help
+        }
+        if (waited_us >= ATTACH_WAIT_MS * 1000) break;
+        usleep(ATTACH_POLL_US);
+    }
+    LOGGER_E(LOGGER_COMP_MSG, "msg_ring_open: %s is not an initialised ring", ring_name);
+    return -1;
+}
+
+/*------------------------ Public Function -----------------------------*/
+msg_ring_t *msg_ring_open(const char *ring_name, int flags, uint32_t slots, uint32_t slot_size, int *err) {
+    msg_ring_t *ring = calloc(1, sizeof(*ring));
+    if (ring == NULL) {
+        if (err) *err = MSG_E_GENERIC_FAIL;
+        return NULL;
+    }
+
+    int created = 0;
+    int fd = -1;
+    if (flags & MSG_O_CREATE) {
+        fd = shm_open(ring_name, O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd != -1) created = 1;
+    }
+    if (fd == -1) fd = shm_open(ring_name, O_RDWR, 0);
+    if (fd == -1) {
+        LOGGER_E(LOGGER_COMP_MSG, "msg_ring_open: shm_open failed: %s", strerror(errno));
+        free(ring);
+        if (err) *err = MSG_E_QUEUE_OPEN;
+        return NULL;
+    }
+
+    ring_header_t geometry;
+    if (created) {
+        geometry.slots = next_pow2(slots ? slots : MSG_RING_SLOTS_DEFAULT);
+        geometry.slot_size = slot_size ? slot_size : MSG_RING_SLOT_SIZE_DEFAULT;
+        geometry.slot_stride = (uint32_t)ALIGN_UP(sizeof(ring_slot_t) + geometry.slot_size, CACHE_LINE);
+        ring->map_size = ALIGN_UP(sizeof(ring_header_t), CACHE_LINE) + (size_t)geometry.slots * geometry.slot_stride;
+        if (ftruncate(fd, (off_t)ring->map_size) == -1) {
+            LOGGER_E(LOGGER_COMP_MSG, "msg_ring_open: ftruncate failed: %s", strerror(errno));
+            close(fd);
+            shm_unlink(ring_name);
+            free(ring);
+            if (err) *err = MSG_E_QUEUE_OPEN;
+            return NULL;
+        }
+    } else {
+        // Attach: the creator may still be sizing the segment or writing its header
+        if (read_geometry(fd, ring_name, &geometry) != 0) {
+            close(fd);
+            free(ring);
+            if (err) *err = MSG_E_QUEUE_OPEN;
+            return NULL;
+        }
+        ring->map_size = ALIGN_UP(sizeof(ring_header_t), CACHE_LINE) + (size_t)geometry.slots * geometry.slot_stride;
+    }
+
+    void *addr = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        LOGGER_E(LOGGER_COMP_MSG, "msg_ring_open: mmap failed: %s", strerror(errno));
+        free(ring);
+        if (err) *err = MSG_E_QUEUE_OPEN;
+        return NULL;
+    }
+    ring->hdr = (ring_header_t*)addr;
+    ring->slots_base = (char*)addr + ALIGN_UP(sizeof(ring_header_t), CACHE_LINE);
+
+    if (created) {
+        ring->hdr->slots = geometry.slots;
+        ring->hdr->slot_size = geometry.slot_size;
+        ring->hdr->slot_stride = geometry.slot_stride;
+        for (uint32_t i = 0; i < geometry.slots; i++) {
+            atomic_init(&slot_at(ring, i)->seq, i);
+        }
+        ring->hdr->version = RING_VERSION;
+        __atomic_store_n(&ring->hdr->magic, RING_MAGIC, __ATOMIC_RELEASE); // Last: attachers wait for it
+    }
+
+    if (err) *err = MSG_SUCCESS;
+    return ring;
+}
+
+int msg_ring_close(msg_ring_t *ring) {
+    if (ring == NULL) return MSG_E_INVALID_ARG;
+    int return_code = MSG_SUCCESS;
+    if (munmap(ring->hdr, ring->map_size) == -1) {
+        LOGGER_E(LOGGER_COMP_MSG, "msg_ring_close: munmap failed: %s", strerror(errno));
+        return_code = MSG_E_QUEUE_CLOSE;
+    }
+    free(ring);
+    return return_code;
+}
+
+int msg_ring_cleanup(const char *ring_name) {
+    if (shm_unlink(ring_name) == -1) {
+        LOGGER_E(LOGGER_COMP_MSG, "msg_ring_cleanup: shm_unlink failed: %s", strerror(errno));
+        return MSG_E_GENERIC_FAIL;
+    }
+    return MSG_SUCCESS;
+}
+
+void *msg_ring_reserve(msg_ring_t *ring, int timeout_ms, int *err) {
+    if (ring == NULL) {
+        if (err) *err = MSG_E_INVALID_ARG;
+        return NULL;
+    }
+    ring_header_t *hdr = ring->hdr;
+    uint64_t deadline = timeout_ms > 0 ? now_ms() + (uint64_t)timeout_ms : 0;
+
+    for (;;) {
+        uint32_t space = atomic_load_explicit(&hdr->space_seq, memory_order_acquire);
+        uint64_t pos = atomic_load_explicit(&hdr->enqueue_pos, memory_order_relaxed);
+        for (;;) {
+            ring_slot_t *slot = slot_at(ring, pos);
+            uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+            int64_t diff = (int64_t)(seq - pos);
+            if (diff == 0) {
+                if (atomic_compare_exchange_weak_explicit(&hdr->enqueue_pos, &pos, pos + 1,
+                                                          memory_order_relaxed, memory_order_relaxed)) {
+                    slot->pos = pos;
+                    if (err) *err = MSG_SUCCESS;
+                    return slot->data;
+                }
+            } else if (diff < 0) {
+                break; // Full
+            } else {
+                pos = atomic_load_explicit(&hdr->enqueue_pos, memory_order_relaxed);
+            }
+        }
+
+        if (timeout_ms == MSG_NO_WAIT) {
+            if (err) *err = MSG_E_AGAIN;
+            return NULL;
+        }
+        atomic_fetch_add_explicit(&hdr->space_waiters, 1, memory_order_seq_cst);
+        int rc = futex_wait_until(&hdr->space_seq, space, timeout_ms, deadline);
+        atomic_fetch_sub_explicit(&hdr->space_waiters, 1, memory_order_relaxed);
+        if (rc != MSG_SUCCESS) {
+            if (err) *err = rc;
+            return NULL;
+        }
+    }
+}
+
+int msg_ring_commit(msg_ring_t *ring, void *data, size_t msg_len) {
+    if (ring == NULL) return MSG_E_INVALID_ARG;
+    ring_slot_t *slot = slot_from_data(ring, data);
+    if (slot == NULL || msg_len > ring->hdr->slot_size) return MSG_E_INVALID_ARG;
+
+    slot->len = (uint32_t)msg_len;
+    atomic_store_explicit(&slot->seq, slot->pos + 1, memory_order_release);
+
+    // Only enter the kernel when a consumer is actually asleep
+    atomic_fetch_add_explicit(&ring->hdr->data_seq, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&ring->hdr->data_waiters, memory_order_seq_cst) > 0) {
+        futex_wake_all(&ring->hdr->data_seq);
+    }
+    return MSG_SUCCESS;
+}
+
+const void *msg_ring_peek(msg_ring_t *ring, size_t *msg_len, int timeout_ms, int *err) {
+    if (ring == NULL || msg_len == NULL) {
+        if (err) *err = MSG_E_INVALID_ARG;
+        return NULL;
+    }
+    ring_header_t *hdr = ring->hdr;
+    uint64_t deadline = timeout_ms > 0 ? now_ms() + (uint64_t)timeout_ms : 0;
+
+    for (;;) {
+        uint32_t data = atomic_load_explicit(&hdr->data_seq, memory_order_acquire);
+        uint64_t pos = atomic_load_explicit(&hdr->dequeue_pos, memory_order_relaxed);
+        for (;;) {
+            ring_slot_t *slot = slot_at(ring, pos);
+            uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+            int64_t diff = (int64_t)(seq - (pos + 1));
+            if (diff == 0) {
+                if (atomic_compare_exchange_weak_explicit(&hdr->dequeue_pos, &pos, pos + 1,
+                                                          memory_order_relaxed, memory_order_relaxed)) {
+                    slot->pos = pos;
+                    *msg_len = slot->len;
+                    if (err) *err = MSG_SUCCESS;
+                    return slot->data;
+                }
+            } else if (diff < 0) {
+                break; // Empty
+            } else {
+                pos = atomic_load_explicit(&hdr->dequeue_pos, memory_order_relaxed);
+            }
+        }
+
+        if (timeout_ms == MSG_NO_WAIT) {
+            if (err) *err = MSG_E_AGAIN;
+            return NULL;
+        }
+        atomic_fetch_add_explicit(&hdr->data_waiters, 1, memory_order_seq_cst);
+        int rc = futex_wait_until(&hdr->data_seq, data, timeout_ms, deadline);
+        atomic_fetch_sub_explicit(&hdr->data_waiters, 1, memory_order_relaxed);
+        if (rc != MSG_SUCCESS) {
+            if (err) *err = rc;
+            return NULL;
+        }
+    }
+}
+
+int msg_ring_release(msg_ring_t *ring, const void *data) {
+    if (ring == NULL) return MSG_E_INVALID_ARG;
+    ring_slot_t *slot = slot_from_data(ring, data);
+    if (slot == NULL) return MSG_E_INVALID_ARG;
+
+    atomic_store_explicit(&slot->seq, slot->pos + ring->hdr->slots, memory_order_release);
+
+    atomic_fetch_add_explicit(&ring->hdr->space_seq, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&ring->hdr->space_waiters, memory_order_seq_cst) > 0) {
+        futex_wake_all(&ring->hdr->space_seq);
+    }
+    return MSG_SUCCESS;
+}
+
+int msg_ring_send(msg_ring_t *ring, const char *message, size_t msg_len, int timeout_ms) {
+    if (ring == NULL || message == NULL || msg_len > ring->hdr->slot_size) return MSG_E_INVALID_ARG;
+    int err;
+    void *slot = msg_ring_reserve(ring, timeout_ms, &err);
+    if (slot == NULL) return err;
+    memcpy(slot, message, msg_len);
+    return msg_ring_commit(ring, slot, msg_len);
+}
+
+int msg_ring_receive(msg_ring_t *ring, char *buffer, size_t buffer_size, size_t *received_len, int timeout_ms) {
+    if (ring == NULL || buffer == NULL || received_len == NULL) return MSG_E_INVALID_ARG;
+    int err;
+    size_t len;
+    const void *slot = msg_ring_peek(ring, &len, timeout_ms, &err);
+    if (slot == NULL) return err;
+    if (len > buffer_size) {
+        // Do not lose the message silently: it is consumed, report the truncation
+        memcpy(buffer, slot, buffer_size);
+        *received_len = buffer_size;
+        msg_ring_release(ring, slot);
+        return MSG_E_RECV_FAIL;
+    }
+    memcpy(buffer, slot, len);
+    *received_len = len;
+    return msg_ring_release(ring, slot);
+}
+
+size_t msg_ring_slot_size(const msg_ring_t *ring) {
+    return ring ? ring->hdr->slot_size : 0;
+}
@@ -0,0 +1,89 @@
+#ifndef MODBUS_SIM_H
+#define MODBUS_SIM_H
+
+#include <stdint.h>
+
+/*
+ * Modbus RTU slaves behind a pseudo-terminal.
+ *
+ * The simulator owns the master side of a pty pair and answers FC03/FC06
+ * requests on it from one thread. The host opens modbus_sim_device() exactly
+ * like /dev/ttyUSB0, so air_rs485, pm_sensor and rs485_rtu run unchanged.
+ */
+
+// --- Limits ---
+#define MODBUS_SIM_MAX_SLAVES 16
+#define MODBUS_SIM_DATA_REGS 0x0010         // Data registers 0x0000..0x000F
+#define MODBUS_SIM_REG_ADDR 0x0100          // Slave ID register
+#define MODBUS_SIM_REG_BAUD 0x0101          // Baud code register
+
+// --- Slave models ---
+#define MODBUS_SIM_PM 1     // PM2.5 at 0x0004, PM10 at 0x0009
+#define MODBUS_SIM_CO 2     // CO at 0x0006
+
+/**
+ * @brief Behaviour of every slave on the simulated bus.
+ */
+typedef struct {
+    uint32_t delay_us;      // Device turnaround before each response
+    uint32_t jitter_us;     // Extra uniform random delay in [0, jitter_us]
+    double error_rate;      // Probability of a response with a corrupted CRC
+    double silence_rate;    // Probability of no response at all
+    uint32_t baud;          // Emulated line speed for wire time (0 = instant)
+    unsigned int seed;      // Random seed, fixed for reproducible runs
+} modbus_sim_config_t;
+
+typedef struct {
+    uint64_t requests;      // Valid frames addressed to a simulated slave
+    uint64_t responses;     // Correct responses sent (including exceptions)
+    uint64_t corrupted;     // Responses sent with a bad CRC
+    uint64_t silenced;      // Requests deliberately left unanswered
+    uint64_t discarded;     // Bytes dropped while resynchronising on garbage
+} modbus_sim_stats_t;
+
+typedef struct modbus_sim modbus_sim_t;
+
+/**
+ * @brief 2 ms turnaround, no jitter, no injected faults, instant wire.
+ */
+void modbus_sim_default_config(modbus_sim_config_t *cfg);
+
+/**
+ * @brief Opens the pty pair. cfg may be NULL for the defaults.
+ * @return Simulator handle, or NULL on failure.
+ */
+modbus_sim_t* modbus_sim_create(const modbus_sim_config_t *cfg);
+
+/**
+ * @brief Adds a slave with the registers of the given model.
+ * @return 0 on success, -1 on invalid model/ID, duplicate ID or table full.
+ */
+int modbus_sim_add_slave(modbus_sim_t *sim, int slave_id, int model);
+
+/**
+ * @brief Sets a data or config register. Data registers otherwise drift slowly on every read.
+ * @return 0 on success, -1 on unknown slave or register.
+ */
+int modbus_sim_set_register(modbus_sim_t *sim, int slave_id, uint16_t reg, uint16_t value);
+
+/**
+ * @brief Path of the pty slave side, to be opened by the host (e.g. "/dev/pts/3").
+ */
+const char* modbus_sim_device(const modbus_sim_t *sim);
+
+/**
+ * @brief Starts answering requests on a background thread.
+ * @return 0 on success, -1 on failure or if already running.
+ */
+int modbus_sim_start(modbus_sim_t *sim);
+
+void modbus_sim_stop(modbus_sim_t *sim);
+
+void modbus_sim_get_stats(modbus_sim_t *sim, modbus_sim_stats_t *out);
+
+/**
+ * @brief Stops the thread, closes the pty and frees the simulator.
+ */
+void modbus_sim_destroy(modbus_sim_t *sim);
+
+#endif
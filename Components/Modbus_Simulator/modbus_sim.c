@@ -0,0 +1,339 @@
+#define _GNU_SOURCE
+#include "modbus_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include <time.h>
+#include <pthread.h>
+
+#define REQ_BYTES 8                 // FC03 and FC06 requests
+#define MAX_FRAME 256
+#define MAX_READ 125
+#define BITS_PER_CHAR 11
+#define POLL_MS 100                 // Stop flag check interval
+#define HUP_RETRY_US 10000          // Re-check interval while no host has the pty open
+
+#define FC_READ_HOLDING 0x03
+#define FC_WRITE_SINGLE 0x06
+#define EX_ILLEGAL_FUNCTION 0x01
+#define EX_ILLEGAL_ADDRESS 0x02
+#define EX_ILLEGAL_VALUE 0x03
+
+typedef struct {
+    uint8_t id;
+    int model;
+    uint16_t data[MODBUS_SIM_DATA_REGS];
+    uint16_t base[MODBUS_SIM_DATA_REGS];    // Centre of the drift of each data register
+    uint16_t addr_reg;
+    uint16_t baud_reg;
+} sim_slave_t;
+
+struct modbus_sim {
+    int master_fd;
+    char device[64];
+    modbus_sim_config_t cfg;
+    unsigned int rng;
+
+    pthread_mutex_t lock;           // Protects slaves and stats
+    sim_slave_t slaves[MODBUS_SIM_MAX_SLAVES];
+    int n_slaves;
+    modbus_sim_stats_t stats;
+
+    pthread_t thread;
+    volatile int running;
+
+    uint8_t rx[MAX_FRAME];
+    int rx_len;
+};
+
+/*---------------------------- Private Function --------------------------------*/
+static uint16_t crc16(const uint8_t *data, int len) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+    }
+    return crc;
+}
+
+static double rand_unit(modbus_sim_t *sim) {
+    return (double)rand_r(&sim->rng) / ((double)RAND_MAX + 1.0);
+}
+
+static void sleep_us(uint64_t us) {
+    if (us == 0) return;
+    struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+static sim_slave_t* find_slave(modbus_sim_t *sim, int id) {
+    for (int i = 0; i < sim->n_slaves; i++) {
+        if (sim->slaves[i].id == id) return &sim->slaves[i];
+    }
+    return NULL;
+}
+
+static uint16_t* reg_ptr(sim_slave_t *s, uint16_t reg) {
+    if (reg < MODBUS_SIM_DATA_REGS) return &s->data[reg];
+    if (reg == MODBUS_SIM_REG_ADDR) return &s->addr_reg;
+    if (reg == MODBUS_SIM_REG_BAUD) return &s->baud_reg;
+    return NULL;
+}
+
+// Random walk of +-1 around the base value so readings look alive
+static void drift(modbus_sim_t *sim, sim_slave_t *s) {
+    for (int r = 0; r < MODBUS_SIM_DATA_REGS; r++) {
+        if (s->base[r] == 0) continue;
+        int step = (int)(rand_r(&sim->rng) % 3) - 1;
+        int v = (int)s->data[r] + step;
+        int lo = s->base[r] - s->base[r] / 4, hi = s->base[r] + s->base[r] / 4;
+        s->data[r] = (uint16_t)(v < lo ? lo : (v > hi ? hi : v));
+    }
+}
+
+static int build_exception(uint8_t *resp, const uint8_t *req, uint8_t code) {
+    resp[0] = req[0];
+    resp[1] = (uint8_t)(req[1] | 0x80);
+    resp[2] = code;
+    return 3;
+}
+
+// Builds the response body (without CRC). Called with sim->lock held.
+static int handle_request(modbus_sim_t *sim, sim_slave_t *s, const uint8_t *req, uint8_t *resp) {
+    uint16_t addr = (uint16_t)((req[2] << 8) | req[3]);
+    uint16_t arg = (uint16_t)((req[4] << 8) | req[5]);
+
+    if (req[1] == FC_READ_HOLDING) {
+        if (arg == 0 || arg > MAX_READ) return build_exception(resp, req, EX_ILLEGAL_VALUE);
+        for (uint32_t i = 0; i < arg; i++) {
+            if (reg_ptr(s, (uint16_t)(addr + i)) == NULL) return build_exception(resp, req, EX_ILLEGAL_ADDRESS);
+        }
+        drift(sim, s);
+        resp[0] = req[0];
+        resp[1] = FC_READ_HOLDING;
+        resp[2] = (uint8_t)(2 * arg);
+        for (uint32_t i = 0; i < arg; i++) {
+            uint16_t v = *reg_ptr(s, (uint16_t)(addr + i));
+            resp[3 + 2 * i] = (uint8_t)(v >> 8);
+            resp[4 + 2 * i] = (uint8_t)v;
+        }
+        return 3 + 2 * arg;
+    }
+    if (req[1] == FC_WRITE_SINGLE) {
+        uint16_t *p = reg_ptr(s, addr);
+        if (p == NULL) return build_exception(resp, req, EX_ILLEGAL_ADDRESS);
+        if (addr == MODBUS_SIM_REG_ADDR && (arg < 1 || arg > 247)) return build_exception(resp, req, EX_ILLEGAL_VALUE);
+        *p = arg;
+        if (addr < MODBUS_SIM_DATA_REGS) s->base[addr] = 0;  // Pinned by the host
+        memcpy(resp, req, 6);   // Echo
+        return 6;
+    }
+    return build_exception(resp, req, EX_ILLEGAL_FUNCTION);
+}
+
+static void serve_frame(modbus_sim_t *sim, const uint8_t *req) {
+    uint8_t resp[MAX_FRAME];
+    int len;
+    int corrupt = 0;
+
+    pthread_mutex_lock(&sim->lock);
+    sim_slave_t *s = find_slave(sim, req[0]);
+    if (s == NULL) {
+        // Not one of ours: a real slave would stay silent too
+        pthread_mutex_unlock(&sim->lock);
+        return;
+    }
+    sim->stats.requests++;
+    if (rand_unit(sim) < sim->cfg.silence_rate) {
+        sim->stats.silenced++;
+        pthread_mutex_unlock(&sim->lock);
+        return;
+    }
+    len = handle_request(sim, s, req, resp);
+    corrupt = rand_unit(sim) < sim->cfg.error_rate;
+    if (corrupt) sim->stats.corrupted++;
+    else sim->stats.responses++;
+    // New address takes effect after the response, like the real sensors
+    if (req[1] == FC_WRITE_SINGLE && resp[1] == FC_WRITE_SINGLE && s->addr_reg != s->id) s->id = (uint8_t)s->addr_reg;
+    uint32_t jitter = sim->cfg.jitter_us ? (uint32_t)(rand_unit(sim) * (sim->cfg.jitter_us + 1)) : 0;
+    pthread_mutex_unlock(&sim->lock);
+
+    uint16_t crc = crc16(resp, len);
+    if (corrupt) crc ^= 0x0001;
+    resp[len++] = (uint8_t)crc;
+    resp[len++] = (uint8_t)(crc >> 8);
+
+    uint64_t wait_us = (uint64_t)sim->cfg.delay_us + jitter;
+    if (sim->cfg.baud > 0) {
+        uint32_t char_us = (BITS_PER_CHAR * 1000000u + sim->cfg.baud - 1) / sim->cfg.baud;
+        wait_us += (uint64_t)(REQ_BYTES + len) * char_us;  // Request in, response out
+    }
+    sleep_us(wait_us);
+
+    for (int off = 0; off < len;) {
+        ssize_t n = write(sim->master_fd, resp + off, (size_t)(len - off));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                sleep_us(100);
+                continue;
+            }
+            break;
+        }
+        off += (int)n;
+    }
+}
+
+// Consumes complete requests from the receive buffer, resynchronising on bad CRCs
+static void process_rx(modbus_sim_t *sim) {
+    int pos = 0;
+    while (sim->rx_len - pos >= REQ_BYTES) {
+        const uint8_t *f = sim->rx + pos;
+        uint16_t crc = (uint16_t)(f[6] | (f[7] << 8));
+        if (crc16(f, REQ_BYTES - 2) != crc) {
+            pos++;
+            pthread_mutex_lock(&sim->lock);
+            sim->stats.discarded++;
+            pthread_mutex_unlock(&sim->lock);
+            continue;
+        }
+        serve_frame(sim, f);
+        pos += REQ_BYTES;
+    }
+    memmove(sim->rx, sim->rx + pos, (size_t)(sim->rx_len - pos));
+    sim->rx_len -= pos;
+}
+
+static void* sim_thread(void *arg) {
+    modbus_sim_t *sim = arg;
+    while (sim->running) {
+        struct pollfd pfd = { sim->master_fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, POLL_MS);
+        if (ready <= 0) continue;
+        if (pfd.revents & POLLHUP) {
+            // Host side not open (or closed): nothing to read until it reopens
+            sleep_us(HUP_RETRY_US);
+            continue;
+        }
+        ssize_t n = read(sim->master_fd, sim->rx + sim->rx_len, sizeof(sim->rx) - (size_t)sim->rx_len);
+        if (n <= 0) continue;
+        sim->rx_len += (int)n;
+        process_rx(sim);
+    }
+    return NULL;
+}
+
+/*------------------------ Public Function -----------------------------*/
+void modbus_sim_default_config(modbus_sim_config_t *cfg) {
+    if (cfg == NULL) return;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->delay_us = 2000;
+    cfg->seed = 1;
+}
+
+modbus_sim_t* modbus_sim_create(const modbus_sim_config_t *cfg) {
+    modbus_sim_t *sim = calloc(1, sizeof(*sim));
+    if (sim == NULL) return NULL;
+    if (cfg != NULL) sim->cfg = *cfg;
+    else modbus_sim_default_config(&sim->cfg);
+    sim->rng = sim->cfg.seed;
+
+    sim->master_fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (sim->master_fd < 0 || grantpt(sim->master_fd) != 0 || unlockpt(sim->master_fd) != 0 ||
+        ptsname_r(sim->master_fd, sim->device, sizeof(sim->device)) != 0) {
+        fprintf(stderr, "MODBUS SIM ERROR: Unable to create pty - %s\n", strerror(errno));
+        if (sim->master_fd >= 0) close(sim->master_fd);
+        free(sim);
+        return NULL;
+    }
+
+    // Raw on both ends: no echo, no line editing, binary safe
+    struct termios tio;
+    if (tcgetattr(sim->master_fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(sim->master_fd, TCSANOW, &tio);
+    }
+    pthread_mutex_init(&sim->lock, NULL);
+    return sim;
+}
+
+int modbus_sim_add_slave(modbus_sim_t *sim, int slave_id, int model) {
+    if (sim == NULL || slave_id < 1 || slave_id > 247) return -1;
+    if (model != MODBUS_SIM_PM && model != MODBUS_SIM_CO) return -1;
+
+    pthread_mutex_lock(&sim->lock);
+    if (sim->n_slaves == MODBUS_SIM_MAX_SLAVES || find_slave(sim, slave_id) != NULL) {
+        pthread_mutex_unlock(&sim->lock);
+        return -1;
+    }
+    sim_slave_t *s = &sim->slaves[sim->n_slaves++];
+    memset(s, 0, sizeof(*s));
+    s->id = (uint8_t)slave_id;
+    s->model = model;
+    s->addr_reg = (uint16_t)slave_id;
+    s->baud_reg = 2;    // 9600 baud code of the PM sensor family
+    if (model == MODBUS_SIM_PM) {
+        s->base[0x0004] = 35;   // PM2.5 ug/m3
+        s->base[0x0009] = 50;   // PM10 ug/m3
+    } else {
+        s->base[0x0006] = 150;  // CO raw, 0.01 ppm per count
+    }
+    memcpy(s->data, s->base, sizeof(s->data));
+    pthread_mutex_unlock(&sim->lock);
+    return 0;
+}
+
+int modbus_sim_set_register(modbus_sim_t *sim, int slave_id, uint16_t reg, uint16_t value) {
+    if (sim == NULL) return -1;
+
+    pthread_mutex_lock(&sim->lock);
+    sim_slave_t *s = find_slave(sim, slave_id);
+    uint16_t *p = s ? reg_ptr(s, reg) : NULL;
+    if (p != NULL) {
+        *p = value;
+        if (reg < MODBUS_SIM_DATA_REGS) s->base[reg] = 0;
+        if (reg == MODBUS_SIM_REG_ADDR && value >= 1 && value <= 247) s->id = (uint8_t)value;
+    }
+    pthread_mutex_unlock(&sim->lock);
+    return p ? 0 : -1;
+}
+
+const char* modbus_sim_device(const modbus_sim_t *sim) {
+    return sim ? sim->device : NULL;
+}
+
+int modbus_sim_start(modbus_sim_t *sim) {
+    if (sim == NULL || sim->running) return -1;
+    sim->running = 1;
+    if (pthread_create(&sim->thread, NULL, sim_thread, sim) != 0) {
+        sim->running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void modbus_sim_stop(modbus_sim_t *sim) {
+    if (sim == NULL || !sim->running) return;
+    sim->running = 0;
+    pthread_join(sim->thread, NULL);
+}
+
+void modbus_sim_get_stats(modbus_sim_t *sim, modbus_sim_stats_t *out) {
+    if (sim == NULL || out == NULL) return;
+    pthread_mutex_lock(&sim->lock);
+    *out = sim->stats;
+    pthread_mutex_unlock(&sim->lock);
+}
+
+void modbus_sim_destroy(modbus_sim_t *sim) {
+    if (sim == NULL) return;
+    modbus_sim_stop(sim);
+    close(sim->master_fd);
+    pthread_mutex_destroy(&sim->lock);
+    free(sim);
+}
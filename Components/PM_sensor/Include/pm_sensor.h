@@ -10,6 +10,15 @@
 #define PM_REG_BAUD 0x0101
 #define PM_REG_ADDR 0x0100
 
+// Baud register (0x0101) encoding
+#define PM_BAUD_CODE_2400 0
+#define PM_BAUD_CODE_4800 1
+#define PM_BAUD_CODE_9600 2
+#define PM_BAUD_CODE_19200 3
+#define PM_BAUD_CODE_38400 4
+#define PM_BAUD_CODE_57600 5
+#define PM_BAUD_CODE_115200 6
+
 typedef struct {
     uint8_t slave_addr;
     uint32_t baudrate;
@@ -26,6 +35,16 @@ int pm_sensor_read_data(PMSensor_t *s, float *pm25, float *pm10);
 int pm_sensor_check_connection(PMSensor_t *s);
 
 // Hardware Configuration (Writes to Device and local struct)
+/**
+ * @brief Moves the sensor and the host port to new_baud, then checks the link.
+ *        Restores the previous rate on both sides if the sensor does not answer.
+ * @return 0 on success, -1 on unsupported rate or failure.
+ */
 int pm_sensor_update_baud(PMSensor_t *s, uint32_t new_baud);
 
+/**
+ * @brief Register code for a baud rate, -1 if the sensor does not support it.
+ */
+int pm_sensor_baud_code(uint32_t baud);
+
 #endif
@@ -1,6 +1,50 @@
 #include "pm_sensor.h"
+#include "air_rs485.h"
 #include <stdio.h>
 
+#define CHAR_BITS 11            // Worst-case framing of one character
+#define TURNAROUND_US 100000    // Sensor processing time budget
+#define ADAPTER_SLACK_US 4000   // USB-serial delivery latency
+
+static const struct { uint32_t baud; uint16_t code; } baud_table[] = {
+    {2400, PM_BAUD_CODE_2400}, {4800, PM_BAUD_CODE_4800}, {9600, PM_BAUD_CODE_9600},
+    {19200, PM_BAUD_CODE_19200}, {38400, PM_BAUD_CODE_38400}, {57600, PM_BAUD_CODE_57600},
+    {115200, PM_BAUD_CODE_115200},
+};
+
+/*---------------------------- Private Function --------------------------------*/
+// Timeouts derived from the baud rate instead of libmodbus' fixed 500 ms
+static void set_timeouts(modbus_t *ctx, uint32_t baud) {
+    uint32_t char_us = (CHAR_BITS * 1000000u + baud - 1) / baud;
+    uint32_t response = 9 * char_us + TURNAROUND_US + ADAPTER_SLACK_US;
+    modbus_set_response_timeout(ctx, 0, response);
+    modbus_set_byte_timeout(ctx, 0, 4 * char_us + ADAPTER_SLACK_US);
+}
+
+static int open_port(PMSensor_t *s) {
+    s->ctx = modbus_new_rtu(s->device_path, s->baudrate, 'N', 8, 1);
+    if (s->ctx == NULL) return -1;
+
+    modbus_set_slave(s->ctx, s->slave_addr);
+    set_timeouts(s->ctx, s->baudrate);
+
+    if (modbus_connect(s->ctx) == -1) {
+        modbus_free(s->ctx);
+        s->ctx = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static void close_port(PMSensor_t *s) {
+    if (s->ctx == NULL) return;
+    modbus_close(s->ctx);
+    modbus_free(s->ctx);
+    s->ctx = NULL;
+}
+
+/*------------------------ Public Function -----------------------------*/
+
 int pm_sensor_init(PMSensor_t *s, const char *config_file) {
     // 1. Load from disk
     FILE *f = fopen(config_file, "r");
@@ -15,33 +59,13 @@ int pm_sensor_init(PMSensor_t *s, const char *config_file) {
     }
 
     // 2. Setup libmodbus context
-    s->ctx = modbus_new_rtu(s->device_path, s->baudrate, 'N', 8, 1);
-    if (s->ctx == NULL) return -1;
-
-    modbus_set_slave(s->ctx, s->slave_addr);
-    
-    if (modbus_connect(s->ctx) == -1) {
-        modbus_free(s->ctx);
-        return -1;
-    }
-    return 0;
+    return open_port(s);
 }
 
 int pm_sensor_read_data(PMSensor_t *s, float *pm25, float *pm10) {
-    uint16_t tab_reg[10]; // Buffer for holding registers
-
-    // Read PM2.5 (0x0004)
-    if (modbus_read_registers(s->ctx, PM_REG_PM25, 1, tab_reg) > 0) {
-        *pm25 = (float)tab_reg[0];
-    } else return -1;
-
-    // Read PM10 (0x0009)
-    if (modbus_read_registers(s->ctx, PM_REG_PM10, 1, tab_reg) > 0) {
-        *pm10 = (float)tab_reg[0];
-        return 0; // Success
-    }
-    
-    return -1; // Device communication error
+    // PM2.5 (0x0004) .. PM10 (0x0009) in one transaction, converted by the shared EPAM descriptor
+    if (s->ctx == NULL) return -1;
+    return air_rs485_read_epam(s->ctx, s->slave_addr, pm25, pm10) == AIR_RS485_SUCCESS ? 0 : -1;
 }
 
 int pm_sensor_check_connection(PMSensor_t *s) {
@@ -50,18 +74,35 @@ int pm_sensor_check_connection(PMSensor_t *s) {
     return (modbus_read_registers(s->ctx, PM_REG_ADDR, 1, &dummy) > 0);
 }
 
-int pm_sensor_update_baud(PMSensor_t *s, uint32_t new_baud) {
-    // Write to sensor register 0x0101
-    // Note: Actual Modbus value usually maps 0=2400, 1=4800, 2=9600
-    uint16_t baud_code = (new_baud == 9600) ? 2 : (new_baud == 4800) ? 1 : 0;
-    
-    if (modbus_write_register(s->ctx, PM_REG_BAUD, baud_code) != -1) {
-        s->baudrate = new_baud;
-        return 0;
+int pm_sensor_baud_code(uint32_t baud) {
+    for (size_t i = 0; i < sizeof(baud_table) / sizeof(baud_table[0]); i++) {
+        if (baud_table[i].baud == baud) return baud_table[i].code;
     }
     return -1;
 }
 
+int pm_sensor_update_baud(PMSensor_t *s, uint32_t new_baud) {
+    int new_code = pm_sensor_baud_code(new_baud);
+    int old_code = pm_sensor_baud_code(s->baudrate);
+    if (new_code < 0 || s->ctx == NULL) return -1;
+
+    // Write to sensor register 0x0101 at the current speed
+    if (modbus_write_register(s->ctx, PM_REG_BAUD, (uint16_t)new_code) == -1) return -1;
+
+    // Host follows, then checks the sensor answers at the new speed
+    uint32_t old_baud = s->baudrate;
+    close_port(s);
+    s->baudrate = new_baud;
+    if (open_port(s) == 0 && pm_sensor_check_connection(s)) return 0;
+
+    // Roll back on both sides
+    if (s->ctx != NULL && old_code >= 0) modbus_write_register(s->ctx, PM_REG_BAUD, (uint16_t)old_code);
+    close_port(s);
+    s->baudrate = old_baud;
+    if (open_port(s) == 0 && old_code >= 0) modbus_write_register(s->ctx, PM_REG_BAUD, (uint16_t)old_code);
+    return -1;
+}
+
 int pm_sensor_save_config(PMSensor_t *s, const char *config_file) {
     FILE *f = fopen(config_file, "w");
     if (!f) return -1;
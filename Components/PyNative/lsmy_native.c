@@ -0,0 +1,607 @@
+/*
+ * lsmy_native: CPython extension over air_485, datahandle and alert.
+ *
+ * Replaces the per-call ctypes marshalling of rs485_wrapper.py / alert_wrapper.py on the
+ * paths that run every poll cycle. Bulk data goes through the buffer protocol (array.array,
+ * bytearray, memoryview, numpy...) without per-element conversion, and every call that can
+ * block (serial transaction, GPIO ioctl, event wait) runs with the GIL released, so the
+ * alert and CoreIoT threads of the interpreter keep running meanwhile.
+ */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <pythread.h>
+#include <stdint.h>
+#include "air_rs485.h"
+#include "batch.h"
+#include "alert.h"
+#include "alert_eval.h"
+
+#define STACK_VALUES 64         // Sequences up to this length are converted without allocating
+#define MAX_EVENTS 64           // Largest wait_events() batch
+
+typedef struct {
+    PyObject_HEAD
+    modbus_t *ctx;
+    PyThread_type_lock lock;    // A Modbus context is not thread-safe: one transaction at a time
+} BusObject;
+
+typedef struct {
+    PyObject_HEAD
+    rs485_read_plan_t plan;
+} ReadPlanObject;
+
+static PyTypeObject ReadPlanType;
+
+/*---------------------------- Private Function --------------------------------*/
+/**
+ * Gets a C-contiguous buffer of n items of item_size bytes whose format is one of `formats`
+ * ("f" for float32, "H" for uint16...). Byte-order prefixes '@', '=' and '<' are accepted.
+ * @return 0, or -1 with an exception set.
+ */
+static int get_buffer(PyObject *obj, Py_buffer *view, int writable, Py_ssize_t item_size, const char *formats,
+                      Py_ssize_t min_items, const char *name) {
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0)) != 0) {
+        return -1;
+    }
+    const char *fmt = view->format != NULL ? view->format : "B";
+    if (*fmt == '@' || *fmt == '=' || *fmt == '<') {
+        fmt++;
+    }
+    if (view->itemsize != item_size || fmt[0] == '\0' || fmt[1] != '\0' || strchr(formats, fmt[0]) == NULL) {
+        PyErr_Format(PyExc_TypeError, "%s: expected a buffer of format '%s', got '%s'", name, formats,
+                     view->format != NULL ? view->format : "B");
+        PyBuffer_Release(view);
+        return -1;
+    }
+    if (view->len / item_size < min_items) {
+        PyErr_Format(PyExc_ValueError, "%s: %zd items needed, buffer holds %zd", name, min_items, view->len / item_size);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Float32 view of `values`: its own memory for a float32 buffer, else a copy into `stack`
+ * (or a PyMem block, returned in *heap) for any sequence of numbers.
+ * @return Pointer to the values, or NULL with an exception set.
+ */
+static float* float_values(PyObject *values, Py_buffer *view, float *stack, float **heap, Py_ssize_t *n) {
+    *heap = NULL;
+    view->obj = NULL;
+    if (PyObject_CheckBuffer(values)) {
+        if (get_buffer(values, view, 0, sizeof(float), "f", 0, "values") != 0) {
+            return NULL;
+        }
+        *n = view->len / (Py_ssize_t)sizeof(float);
+        return (float*)view->buf;
+    }
+
+    PyObject *seq = PySequence_Fast(values, "values must be a float32 buffer or a sequence of numbers");
+    if (seq == NULL) {
+        return NULL;
+    }
+    *n = PySequence_Fast_GET_SIZE(seq);
+    float *out = stack;
+    if (*n > STACK_VALUES) {
+        out = *heap = PyMem_New(float, *n);
+        if (out == NULL) {
+            Py_DECREF(seq);
+            PyErr_NoMemory();
+            return NULL;
+        }
+    }
+    PyObject **items = PySequence_Fast_ITEMS(seq);
+    for (Py_ssize_t i = 0; i < *n; i++) {
+        double v = PyFloat_AsDouble(items[i]);
+        if (v == -1.0 && PyErr_Occurred()) {
+            Py_DECREF(seq);
+            PyMem_Free(*heap);
+            *heap = NULL;
+            return NULL;
+        }
+        out[i] = (float)v;
+    }
+    Py_DECREF(seq);
+    return out;
+}
+
+static void release_values(Py_buffer *view, float *heap) {
+    if (view->obj != NULL) {
+        PyBuffer_Release(view);
+    }
+    PyMem_Free(heap);
+}
+
+// Runs one reduction of batch.h over a single channel (window = all values)
+static PyObject* reduce_values(PyObject *values, int (*kernel)(const float*, int, int, int, float*)) {
+    float stack[STACK_VALUES];
+    float *heap;
+    Py_buffer view;
+    Py_ssize_t n;
+    float *data = float_values(values, &view, stack, &heap, &n);
+    if (data == NULL) {
+        return NULL;
+    }
+    float result = 0.0f;
+    if (n > 0 && n <= INT_MAX) {
+        kernel(data, 1, (int)n, 1, &result);
+    }
+    release_values(&view, heap);
+    return PyFloat_FromDouble(result);
+}
+
+// Runs a multi-channel kernel of batch.h over a float32 block
+static PyObject* batch_call(PyObject *args, PyObject *kwargs, int (*kernel)(const float*, int, int, int, float*)) {
+    static char *kwlist[] = { "block", "channels", "window", "stride", "out", NULL };
+    PyObject *block_obj, *out_obj = Py_None;
+    int channels, window, stride = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oii|iO", kwlist, &block_obj, &channels, &window, &stride, &out_obj)) {
+        return NULL;
+    }
+    if (stride == 0) {
+        stride = channels;
+    }
+    if (channels <= 0 || window <= 0 || stride < channels) {
+        PyErr_SetString(PyExc_ValueError, "channels and window must be > 0, stride >= channels");
+        return NULL;
+    }
+
+    Py_buffer block;
+    if (get_buffer(block_obj, &block, 0, sizeof(float), "f", (Py_ssize_t)(window - 1) * stride + channels, "block") != 0) {
+        return NULL;
+    }
+    Py_buffer out;
+    float stack[STACK_VALUES];
+    float *results = stack;
+    float *heap = NULL;
+    if (out_obj != Py_None) {
+        if (get_buffer(out_obj, &out, 1, sizeof(float), "f", channels, "out") != 0) {
+            PyBuffer_Release(&block);
+            return NULL;
+        }
+        results = (float*)out.buf;
+    } else if (channels > STACK_VALUES) {
+        results = heap = PyMem_New(float, channels);
+        if (results == NULL) {
+            PyBuffer_Release(&block);
+            return PyErr_NoMemory();
+        }
+    }
+
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = kernel((const float*)block.buf, channels, window, stride, results);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&block);
+
+    PyObject *ret = NULL;
+    if (rc != 0) {
+        PyErr_SetString(PyExc_ValueError, "invalid block geometry");
+    } else if (out_obj != Py_None) {
+        ret = Py_NewRef(out_obj);
+    } else if ((ret = PyList_New(channels)) != NULL) {
+        for (int k = 0; k < channels; k++) {
+            PyObject *v = PyFloat_FromDouble(results[k]);
+            if (v == NULL) {
+                Py_CLEAR(ret);
+                break;
+            }
+            PyList_SET_ITEM(ret, k, v);
+        }
+    }
+    if (out_obj != Py_None) {
+        PyBuffer_Release(&out);
+    }
+    PyMem_Free(heap);
+    return ret;
+}
+
+/*---------------------------- Bus type --------------------------------*/
+// Takes the bus lock without the GIL; fails if the bus is closed (lock then released)
+static int bus_enter(BusObject *self) {
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+    if (self->ctx == NULL) {
+        PyThread_release_lock(self->lock);
+        PyErr_SetString(PyExc_ValueError, "bus is closed");
+        return -1;
+    }
+    return 0;
+}
+
+static int Bus_init(BusObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = { "device", "baud", "parity", "data_bit", "stop_bit", NULL };
+    const char *device;
+    int baud = 9600, data_bit = 8, stop_bit = 1;
+    char parity = 'N';
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|iCii", kwlist, &device, &baud, &parity, &data_bit, &stop_bit)) {
+        return -1;
+    }
+    if (self->lock == NULL && (self->lock = PyThread_allocate_lock()) == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (self->ctx != NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "bus already open");
+        return -1;
+    }
+    modbus_t *ctx;
+    Py_BEGIN_ALLOW_THREADS
+    ctx = rs485_init(device, baud, parity, data_bit, stop_bit);
+    Py_END_ALLOW_THREADS
+    if (ctx == NULL) {
+        PyErr_Format(PyExc_OSError, "unable to open RS485 bus %s", device);
+        return -1;
+    }
+    self->ctx = ctx;
+    return 0;
+}
+
+static void Bus_dealloc(BusObject *self) {
+    if (self->ctx != NULL) {
+        rs485_close(self->ctx);
+    }
+    if (self->lock != NULL) {
+        PyThread_free_lock(self->lock);
+    }
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* Bus_read(BusObject *self, PyObject *args) {
+    int slave_id, reg_addr;
+    if (!PyArg_ParseTuple(args, "ii", &slave_id, &reg_addr) || bus_enter(self) != 0) {
+        return NULL;
+    }
+    uint16_t value = 0;
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = rs485_read_raw(self->ctx, slave_id, reg_addr, &value);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+    if (rc != 0) {
+        Py_RETURN_NONE;
+    }
+    return PyLong_FromLong(value);
+}
+
+static PyObject* Bus_read_block(BusObject *self, PyObject *args) {
+    int slave_id, start_addr;
+    PyObject *out_obj;
+    if (!PyArg_ParseTuple(args, "iiO", &slave_id, &start_addr, &out_obj)) {
+        return NULL;
+    }
+    Py_buffer out;
+    if (get_buffer(out_obj, &out, 1, sizeof(uint16_t), "H", 1, "out") != 0) {
+        return NULL;
+    }
+    Py_ssize_t count = out.len / (Py_ssize_t)sizeof(uint16_t);
+    if (count > MODBUS_MAX_READ_REGISTERS) {
+        PyBuffer_Release(&out);
+        return PyErr_Format(PyExc_ValueError, "at most %d registers per block", MODBUS_MAX_READ_REGISTERS);
+    }
+    if (bus_enter(self) != 0) {
+        PyBuffer_Release(&out);
+        return NULL;
+    }
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = rs485_read_block(self->ctx, slave_id, start_addr, (int)count, (uint16_t*)out.buf);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&out);
+    return PyBool_FromLong(rc == 0);
+}
+
+static PyObject* Bus_write(BusObject *self, PyObject *args) {
+    int slave_id, reg_addr, value;
+    if (!PyArg_ParseTuple(args, "iii", &slave_id, &reg_addr, &value) || bus_enter(self) != 0) {
+        return NULL;
+    }
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = rs485_write_raw(self->ctx, slave_id, reg_addr, (uint16_t)value);
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+    return PyBool_FromLong(rc == 0);
+}
+
+static PyObject* Bus_execute(BusObject *self, PyObject *args) {
+    ReadPlanObject *plan;
+    PyObject *values_obj, *valid_obj = Py_None;
+    if (!PyArg_ParseTuple(args, "O!O|O", &ReadPlanType, &plan, &values_obj, &valid_obj)) {
+        return NULL;
+    }
+    Py_buffer values, valid;
+    if (get_buffer(values_obj, &values, 1, sizeof(uint16_t), "H", plan->plan.n_regs, "values") != 0) {
+        return NULL;
+    }
+    if (valid_obj != Py_None && get_buffer(valid_obj, &valid, 1, 1, "Bbc?", plan->plan.n_regs, "valid") != 0) {
+        PyBuffer_Release(&values);
+        return NULL;
+    }
+    int rc = -1;
+    if (bus_enter(self) == 0) {
+        Py_BEGIN_ALLOW_THREADS
+        rc = rs485_plan_execute(self->ctx, &plan->plan, (uint16_t*)values.buf,
+                                valid_obj != Py_None ? (uint8_t*)valid.buf : NULL);
+        PyThread_release_lock(self->lock);
+        Py_END_ALLOW_THREADS
+    }
+    PyBuffer_Release(&values);
+    if (valid_obj != Py_None) {
+        PyBuffer_Release(&valid);
+    }
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+    return PyBool_FromLong(rc == 0);
+}
+
+static PyObject* Bus_close(BusObject *self, PyObject *Py_UNUSED(ignored)) {
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);   // Waits for a transaction in flight
+    if (self->ctx != NULL) {
+        rs485_close(self->ctx);
+        self->ctx = NULL;
+    }
+    PyThread_release_lock(self->lock);
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+static PyObject* Bus_enter(BusObject *self, PyObject *Py_UNUSED(ignored)) {
+    return Py_NewRef(self);
+}
+
+static PyObject* Bus_exit(BusObject *self, PyObject *Py_UNUSED(args)) {
+    return Bus_close(self, NULL);
+}
+
+static PyMethodDef Bus_methods[] = {
+    { "read", (PyCFunction)Bus_read, METH_VARARGS,
+      "read(slave_id, reg_addr) -> int or None\nReads one holding register." },
+    { "read_block", (PyCFunction)Bus_read_block, METH_VARARGS,
+      "read_block(slave_id, start_addr, out) -> bool\nReads len(out) registers into a writable uint16 buffer." },
+    { "write", (PyCFunction)Bus_write, METH_VARARGS,
+      "write(slave_id, reg_addr, value) -> bool\nWrites one holding register." },
+    { "execute", (PyCFunction)Bus_execute, METH_VARARGS,
+      "execute(plan, values, valid=None) -> bool\n"
+      "Runs a ReadPlan into a uint16 buffer (request order); valid receives one byte per register.\n"
+      "Returns True if every block was read." },
+    { "close", (PyCFunction)Bus_close, METH_NOARGS, "Closes the port (waits for a transaction in flight)." },
+    { "__enter__", (PyCFunction)Bus_enter, METH_NOARGS, NULL },
+    { "__exit__", (PyCFunction)Bus_exit, METH_VARARGS, NULL },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject BusType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "lsmy_native.Bus",
+    .tp_doc = PyDoc_STR("Bus(device, baud=9600, parity='N', data_bit=8, stop_bit=1)\n"
+                        "Modbus RTU port. Transactions run without the GIL, one at a time per bus."),
+    .tp_basicsize = sizeof(BusObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Bus_init,
+    .tp_dealloc = (destructor)Bus_dealloc,
+    .tp_methods = Bus_methods,
+};
+
+/*---------------------------- ReadPlan type --------------------------------*/
+static int ReadPlan_init(ReadPlanObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = { "refs", "max_gap", NULL };
+    PyObject *refs_obj;
+    int max_gap = RS485_PLAN_DEFAULT_GAP;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", kwlist, &refs_obj, &max_gap)) {
+        return -1;
+    }
+    PyObject *seq = PySequence_Fast(refs_obj, "refs must be a sequence of (slave_id, register) pairs");
+    if (seq == NULL) {
+        return -1;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    if (n <= 0 || n > RS485_PLAN_MAX_REGS) {
+        Py_DECREF(seq);
+        PyErr_Format(PyExc_ValueError, "1 to %d registers per plan", RS485_PLAN_MAX_REGS);
+        return -1;
+    }
+    rs485_reg_ref_t refs[RS485_PLAN_MAX_REGS];
+    for (Py_ssize_t i = 0; i < n; i++) {
+        int slave_id, reg_addr;
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(seq, i), "ii", &slave_id, &reg_addr)) {
+            Py_DECREF(seq);
+            return -1;
+        }
+        refs[i].slave_id = (uint8_t)slave_id;
+        refs[i].reg_addr = (uint16_t)reg_addr;
+    }
+    Py_DECREF(seq);
+    if (rs485_plan_build(&self->plan, refs, (int)n, max_gap) < 0) {
+        PyErr_SetString(PyExc_ValueError, "registers do not fit in one read plan");
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject* ReadPlan_get_n_regs(ReadPlanObject *self, void *Py_UNUSED(closure)) {
+    return PyLong_FromLong(self->plan.n_regs);
+}
+
+static PyObject* ReadPlan_get_n_blocks(ReadPlanObject *self, void *Py_UNUSED(closure)) {
+    return PyLong_FromLong(self->plan.n_blocks);
+}
+
+static PyGetSetDef ReadPlan_getset[] = {
+    { "n_regs", (getter)ReadPlan_get_n_regs, NULL, "Registers requested (length of the value buffers).", NULL },
+    { "n_blocks", (getter)ReadPlan_get_n_blocks, NULL, "Modbus transactions per execution.", NULL },
+    { NULL, NULL, NULL, NULL, NULL }
+};
+
+static PyTypeObject ReadPlanType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "lsmy_native.ReadPlan",
+    .tp_doc = PyDoc_STR("ReadPlan(refs, max_gap=8)\nCoalesced block reads of a list of (slave_id, register) pairs."),
+    .tp_basicsize = sizeof(ReadPlanObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)ReadPlan_init,
+    .tp_getset = ReadPlan_getset,
+};
+
+/*------------------------ Module functions: data_handle -----------------------------*/
+static PyObject* native_median(PyObject *Py_UNUSED(module), PyObject *values) {
+    return reduce_values(values, batch_median);     // Selection on a copy-free view, like calculate_median()
+}
+
+static PyObject* native_average(PyObject *Py_UNUSED(module), PyObject *values) {
+    return reduce_values(values, batch_average);
+}
+
+static PyObject* native_batch_median(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwargs) {
+    return batch_call(args, kwargs, batch_median);
+}
+
+static PyObject* native_batch_average(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwargs) {
+    return batch_call(args, kwargs, batch_average);
+}
+
+/*------------------------ Module functions: alert -----------------------------*/
+static PyObject* native_set_output(PyObject *Py_UNUSED(module), PyObject *args) {
+    int index, state, rc;
+    if (!PyArg_ParseTuple(args, "ii", &index, &state)) {
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    rc = alert_set_output(index, state);
+    Py_END_ALLOW_THREADS
+    return PyBool_FromLong(rc == 0);
+}
+
+static PyObject* native_set_outputs(PyObject *Py_UNUSED(module), PyObject *args) {
+    unsigned int mask, values;
+    int rc;
+    if (!PyArg_ParseTuple(args, "II", &mask, &values)) {
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    rc = alert_set_outputs(mask, values);
+    Py_END_ALLOW_THREADS
+    return PyBool_FromLong(rc == 0);
+}
+
+static PyObject* native_get_output(PyObject *Py_UNUSED(module), PyObject *args) {
+    int index, state;
+    if (!PyArg_ParseTuple(args, "i", &index)) {
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    state = alert_get_output(index);
+    Py_END_ALLOW_THREADS
+    return PyLong_FromLong(state);
+}
+
+static PyObject* native_feed_many(PyObject *Py_UNUSED(module), PyObject *pairs) {
+    PyObject *seq = PySequence_Fast(pairs, "feed_many expects a sequence of (channel, value) pairs");
+    if (seq == NULL) {
+        return NULL;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    if (n > STACK_VALUES) {
+        Py_DECREF(seq);
+        return PyErr_Format(PyExc_ValueError, "at most %d pairs per call", STACK_VALUES);
+    }
+    int channels[STACK_VALUES];
+    float values[STACK_VALUES];
+    for (Py_ssize_t i = 0; i < n; i++) {
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(seq, i), "if", &channels[i], &values[i])) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+    }
+    Py_DECREF(seq);
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = alert_eval_feed_many(channels, values, (int)n);   // May switch outputs
+    Py_END_ALLOW_THREADS
+    return PyLong_FromLong(rc);
+}
+
+static PyObject* native_wait_events(PyObject *Py_UNUSED(module), PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = { "timeout_ms", "max_events", NULL };
+    int timeout_ms = 1000, max_events = 16;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ii", kwlist, &timeout_ms, &max_events)) {
+        return NULL;
+    }
+    if (max_events <= 0 || max_events > MAX_EVENTS) {
+        return PyErr_Format(PyExc_ValueError, "max_events must be 1..%d", MAX_EVENTS);
+    }
+    alert_eval_event_t events[MAX_EVENTS];
+    int count;
+    Py_BEGIN_ALLOW_THREADS
+    count = alert_eval_wait_events(events, max_events, timeout_ms);
+    Py_END_ALLOW_THREADS
+
+    PyObject *ret = PyList_New(count > 0 ? count : 0);
+    for (int i = 0; ret != NULL && i < count; i++) {
+        PyObject *event = Py_BuildValue("(iNdK)", events[i].rule, PyBool_FromLong(events[i].active),
+                                        (double)events[i].value, (unsigned long long)events[i].timestamp_ms);
+        if (event == NULL) {
+            Py_CLEAR(ret);
+            break;
+        }
+        PyList_SET_ITEM(ret, i, event);
+    }
+    return ret;
+}
+
+static PyMethodDef native_methods[] = {
+    { "median", native_median, METH_O,
+      "median(values) -> float\nMedian of a float32 buffer (read in place) or of a sequence of numbers." },
+    { "average", native_average, METH_O,
+      "average(values) -> float\nMean of a float32 buffer (read in place) or of a sequence of numbers." },
+    { "batch_median", (PyCFunction)(void(*)(void))native_batch_median, METH_VARARGS | METH_KEYWORDS,
+      "batch_median(block, channels, window, stride=0, out=None)\n"
+      "Median of every channel of a float32 block (block[w * stride + k]), see batch.h.\n"
+      "Writes into the float32 buffer out and returns it, else returns a list." },
+    { "batch_average", (PyCFunction)(void(*)(void))native_batch_average, METH_VARARGS | METH_KEYWORDS,
+      "batch_average(block, channels, window, stride=0, out=None)\nMean of every channel of a float32 block." },
+    { "set_output", native_set_output, METH_VARARGS, "set_output(index, state) -> bool" },
+    { "set_outputs", native_set_outputs, METH_VARARGS,
+      "set_outputs(mask, values) -> bool\nUpdates every output of mask in one line update." },
+    { "get_output", native_get_output, METH_VARARGS, "get_output(index) -> 1, 0 or -1" },
+    { "feed_many", native_feed_many, METH_O,
+      "feed_many(pairs) -> int\nEvaluates (channel, value) pairs against the alert rules in one call." },
+    { "wait_events", (PyCFunction)(void(*)(void))native_wait_events, METH_VARARGS | METH_KEYWORDS,
+      "wait_events(timeout_ms=1000, max_events=16)\n"
+      "Waits for rule transitions. Returns a list of (rule_id, active, value, timestamp_ms)." },
+    { NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef native_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "lsmy_native",
+    .m_doc = "Batch-oriented bindings of the air_485, datahandle and alert libraries.",
+    .m_size = -1,
+    .m_methods = native_methods,
+};
+
+/*------------------------ Public Function -----------------------------*/
+PyMODINIT_FUNC PyInit_lsmy_native(void) {
+    if (PyType_Ready(&BusType) < 0 || PyType_Ready(&ReadPlanType) < 0) {
+        return NULL;
+    }
+    PyObject *m = PyModule_Create(&native_module);
+    if (m == NULL) {
+        return NULL;
+    }
+    if (PyModule_AddObjectRef(m, "Bus", (PyObject*)&BusType) < 0 ||
+        PyModule_AddObjectRef(m, "ReadPlan", (PyObject*)&ReadPlanType) < 0 ||
+        PyModule_AddIntConstant(m, "PLAN_MAX_REGS", RS485_PLAN_MAX_REGS) < 0 ||
+        PyModule_AddStringConstant(m, "SIMD", batch_simd_name()) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    return m;
+}
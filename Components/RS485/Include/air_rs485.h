@@ -3,6 +3,48 @@
 
 #include <stdint.h>
 #include <modbus/modbus.h>
+
+// --- Read plan limits ---
+#define RS485_PLAN_MAX_REGS 64      // Max (slave, register) pairs in one plan
+#define RS485_PLAN_MAX_BLOCKS 32    // Max FC03 transactions in one plan
+#define RS485_PLAN_DEFAULT_GAP 8    // Unused registers tolerated between two merged reads
+
+// --- Typed sensor read status (air_rs485_read_*) ---
+#define AIR_RS485_SUCCESS 0
+#define AIR_RS485_E_INVALID -1      // NULL context or output pointer
+#define AIR_RS485_E_BUS -2          // Transaction failed (details logged)
+
+/**
+ * @brief One register requested by the caller.
+ */
+typedef struct {
+    uint8_t slave_id;
+    uint16_t reg_addr;
+} rs485_reg_ref_t;
+
+/**
+ * @brief One contiguous FC03 read issued on the bus.
+ */
+typedef struct {
+    uint8_t slave_id;
+    uint16_t start_addr;
+    uint16_t count;
+} rs485_block_t;
+
+/**
+ * @brief Pre-computed set of block reads covering a list of registers.
+ *
+ * Build it once with rs485_plan_build() and execute it every poll cycle.
+ * ref_block/ref_offset map every input register back to its block.
+ */
+typedef struct {
+    rs485_block_t blocks[RS485_PLAN_MAX_BLOCKS];
+    int n_blocks;
+    uint8_t ref_block[RS485_PLAN_MAX_REGS];
+    uint8_t ref_offset[RS485_PLAN_MAX_REGS];
+    int n_regs;
+} rs485_read_plan_t;
+
 /**
  * @brief Initializes the Modbus RTU context.
  * @return Pointer to modbus_t context, or NULL on failure.
@@ -19,6 +61,42 @@ modbus_t* rs485_init(const char* device, int baud, char parity, int data_bit, in
  */
 int rs485_read_raw(modbus_t *ctx, int slave_id, int reg_addr, uint16_t *out_value);
 
+/**
+ * @brief Reads a contiguous range of registers from one slave in a single transaction.
+ * @param ctx The Modbus context.
+ * @param slave_id The target slave ID.
+ * @param start_addr First register address.
+ * @param count Number of registers (1..MODBUS_MAX_READ_REGISTERS).
+ * @param out_values Buffer of at least count entries.
+ * @return 0 on success, -1 on failure.
+ */
+int rs485_read_block(modbus_t *ctx, int slave_id, int start_addr, int count, uint16_t *out_values);
+
+/**
+ * @brief Merges a list of (slave, register) pairs into as few block reads as possible.
+ *
+ * Registers of the same slave are merged when the hole between them is at most
+ * max_gap registers and the block stays within MODBUS_MAX_READ_REGISTERS.
+ * Use max_gap = 0 for devices that reject reads of unmapped registers.
+ *
+ * @param plan Plan to fill.
+ * @param regs Requested registers, in any order. Duplicates are allowed.
+ * @param n_regs Number of entries in regs (<= RS485_PLAN_MAX_REGS).
+ * @param max_gap Maximum number of unused registers bridged inside one block.
+ * @return Number of blocks on success, -1 on invalid input or plan overflow.
+ */
+int rs485_plan_build(rs485_read_plan_t *plan, const rs485_reg_ref_t *regs, int n_regs, int max_gap);
+
+/**
+ * @brief Executes a read plan and scatters the results back in request order.
+ * @param ctx The Modbus context.
+ * @param plan Plan built with rs485_plan_build().
+ * @param out_values Array of plan->n_regs values, same order as the request list.
+ * @param out_valid Optional array of plan->n_regs flags (1 = value read), may be NULL.
+ * @return 0 if every block was read, -1 if at least one block failed.
+ */
+int rs485_plan_execute(modbus_t *ctx, const rs485_read_plan_t *plan, uint16_t *out_values, uint8_t *out_valid);
+
 /**
  * @brief Writes a single 16-bit value to a specific sensor register.
  * @param ctx The Modbus context.
@@ -29,6 +107,24 @@ int rs485_read_raw(modbus_t *ctx, int slave_id, int reg_addr, uint16_t *out_valu
  */
 int rs485_write_raw(modbus_t *ctx, int slave_id, int reg_addr, uint16_t value);
 
+/**
+ * @brief Reads an EPAM particulate sensor: PM2.5 and PM10 in ug/m3, one transaction.
+ * @return AIR_RS485_SUCCESS or a negative AIR_RS485_E_* code.
+ */
+int air_rs485_read_epam(modbus_t *ctx, int slave_id, float *pm25, float *pm10);
+
+/**
+ * @brief Reads an EPCO sensor: CO in ppm.
+ * @return AIR_RS485_SUCCESS or a negative AIR_RS485_E_* code.
+ */
+int air_rs485_read_epco(modbus_t *ctx, int slave_id, float *co_ppm);
+
+/**
+ * @brief Reads an EPNO2 sensor: NO2 in ppm.
+ * @return AIR_RS485_SUCCESS or a negative AIR_RS485_E_* code.
+ */
+int air_rs485_read_epno2(modbus_t *ctx, int slave_id, float *no2_ppm);
+
 /**
  * @brief Closes the Modbus context and frees resources.
  * @param ctx The Modbus context to close.
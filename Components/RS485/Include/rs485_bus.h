@@ -0,0 +1,98 @@
+#ifndef RS485_BUS_H
+#define RS485_BUS_H
+
+#include <stdint.h>
+#include "rs485_poller.h"
+
+// --- Registry limits ---
+#define RS485_MAX_BUSES 8           // Serial ports (USB-RS485 adapters) per registry
+#define RS485_BUS_NONE (-1)
+
+/*
+ * A registry owns one poller (one thread, one Modbus context) per serial port.
+ * Every slave is routed to exactly one bus, so transactions on different
+ * adapters run in parallel while each context is only touched by its owner thread.
+ * Samples of every bus land in one shared queue.
+ *
+ * Sensor IDs returned by the registry are global: bus_id * RS485_POLL_MAX_SENSORS + local ID.
+ */
+typedef struct rs485_bus_registry rs485_bus_registry_t;
+
+rs485_bus_registry_t* rs485_bus_registry_create(void);
+
+/**
+ * @brief Opens a serial port with its own line settings.
+ * @return Bus ID (>= 0), or -1 on failure (port error, registry full, already started).
+ */
+int rs485_bus_add(rs485_bus_registry_t *r, const char* device, int baud, char parity, int data_bit, int stop_bit);
+
+/**
+ * @brief Routes a slave to a bus. Slaves used before being routed go to bus 0.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int rs485_bus_route_slave(rs485_bus_registry_t *r, int slave_id, int bus_id);
+
+/**
+ * @brief Bus a slave is routed to, or RS485_BUS_NONE.
+ */
+int rs485_bus_find_slave(rs485_bus_registry_t *r, int slave_id);
+
+/**
+ * @brief Schedules a sensor on the bus of its slave (see rs485_poller_add_sensor()).
+ * @return Global sensor ID (>= 0), or -1 on failure.
+ */
+int rs485_bus_add_sensor(rs485_bus_registry_t *r, int slave_id, const uint16_t *regs, int n_regs, uint32_t period_ms);
+
+/**
+ * @brief Changes the poll period of a sensor.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int rs485_bus_set_period(rs485_bus_registry_t *r, int sensor_id, uint32_t period_ms);
+
+/**
+ * @brief Starts one polling thread per bus.
+ * @return 0 on success, -1 if any bus failed to start (the others are stopped again).
+ */
+int rs485_bus_start(rs485_bus_registry_t *r);
+
+void rs485_bus_stop(rs485_bus_registry_t *r);
+
+/**
+ * @brief Drains samples of every bus, oldest first. sample.sensor_id is the global sensor ID.
+ * @return Number of samples copied (0 on timeout), -1 on invalid arguments.
+ */
+int rs485_bus_get_samples(rs485_bus_registry_t *r, rs485_sample_t *out, int max, int timeout_ms);
+
+uint64_t rs485_bus_dropped(rs485_bus_registry_t *r);
+
+/**
+ * @brief Runs fn on the owner thread of the slave's bus (see rs485_poller_submit()).
+ * @return fn's return value, -1 if the slave has no bus.
+ */
+int rs485_bus_submit(rs485_bus_registry_t *r, int slave_id, rs485_job_fn fn, void *arg);
+
+/**
+ * @brief Health of a slave on the bus it is routed to (see rs485_poller_slave_health()).
+ * @return 0 on success, -1 if the slave has no bus.
+ */
+int rs485_bus_slave_health(rs485_bus_registry_t *r, int slave_id, rs485_slave_health_t *out);
+
+/**
+ * @brief rs485_poller_negotiate_baud() on one bus.
+ */
+int rs485_bus_negotiate_baud(rs485_bus_registry_t *r, int bus_id, uint16_t baud_reg, uint16_t probe_reg,
+                             const rs485_baud_option_t *options, int n_options);
+
+/**
+ * @brief Poller of a bus, NULL for an invalid ID.
+ */
+rs485_poller_t* rs485_bus_poller(rs485_bus_registry_t *r, int bus_id);
+
+int rs485_bus_count(rs485_bus_registry_t *r);
+
+/**
+ * @brief Stops every bus, closes the ports and frees the registry.
+ */
+void rs485_bus_registry_destroy(rs485_bus_registry_t *r);
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef RS485_DISCOVERY_H
+#define RS485_DISCOVERY_H
+
+#include <stdint.h>
+#include "rs485_bus.h"
+#include "rs485_driver.h"
+
+/*
+ * Bus discovery: finds every slave in an address range without knowing its ID.
+ *
+ * A quick pass sends one FC03 read of the configuration registers (0x0100 slave id,
+ * 0x0101 baud code) to each address with a short response timeout, so an empty address
+ * costs about one request on the wire plus the turnaround budget. Any reply, even a
+ * corrupt or exception frame, is confirmed by a second read with the normal timeouts,
+ * which also rejects late answers that leaked into the next address.
+ *
+ * Confirmed EP sensors (0x0100 reads back their own address) are then matched against the
+ * driver table (rs485_driver.h): each model whose data block answers is a candidate, and the
+ * one with the widest block is the model. Models sharing a layout cannot be told apart.
+ *
+ * On a registry, every bus is scanned by its own thread, and the scan runs as small
+ * rs485_poller_submit() jobs so a running poller keeps serving its sensors in between.
+ */
+
+// --- Scan parameters ---
+#define RS485_DISCOVERY_MAX_DEVICES 64
+#define RS485_DISCOVERY_TURNAROUND_US 20000    // Device answer budget in the quick pass
+#define RS485_DISCOVERY_CHUNK 4                 // Addresses per poller job
+#define RS485_DISCOVERY_PERIOD_MS 1000          // Default poll period given to found devices
+
+typedef struct {
+    int bus_id;
+    uint8_t slave_id;
+    uint8_t signature;          // 1 if 0x0100 holds the slave's own address (EP sensor family)
+    uint16_t addr_value;        // Content of 0x0100 (0 if the slave answered with an exception)
+    uint16_t baud_code;         // Content of 0x0101
+    uint32_t candidates;        // Bit i set if the data block of rs485_driver_get(i) answered
+    const rs485_sensor_desc_t *model;   // Best candidate, NULL if none or ambiguous; may be set by the caller
+    uint32_t period_ms;         // Used by rs485_bus_load_map()
+    int sensor_id;              // Set by rs485_bus_load_map(), -1 until then
+} rs485_device_t;
+
+typedef struct {
+    int n_devices;
+    rs485_device_t devices[RS485_DISCOVERY_MAX_DEVICES];   // Sorted by bus, then address
+} rs485_device_map_t;
+
+/**
+ * @brief Scans first_id..last_id on one Modbus context and appends what answers to map.
+ *        The caller must own ctx (no poller running on it).
+ * @param baud Line speed, for the wire time of the short timeouts.
+ * @param turnaround_us Answer budget of the quick pass, 0 for RS485_DISCOVERY_TURNAROUND_US.
+ * @param bus_id Recorded in the devices found.
+ * @return Number of devices appended, -1 on invalid arguments.
+ */
+int rs485_discovery_scan(modbus_t *ctx, uint32_t baud, int first_id, int last_id, uint32_t turnaround_us,
+                         int bus_id, rs485_device_map_t *map);
+
+/**
+ * @brief Scans every bus of the registry in parallel (running or not) and fills map.
+ *        Each device found is routed to its bus (rs485_bus_route_slave()).
+ * @return Number of devices found, -1 on invalid arguments.
+ */
+int rs485_bus_discover(rs485_bus_registry_t *r, int first_id, int last_id, uint32_t turnaround_us,
+                       rs485_device_map_t *map);
+
+/**
+ * @brief Schedules every device of the map that has a model and is not polled yet: the model's
+ *        data registers on the device's bus, every period_ms. Sets sensor_id. Loading the map of a
+ *        re-scan (hot-plug) therefore only adds the new devices.
+ * @return Number of sensors added, -1 on invalid arguments.
+ */
+int rs485_bus_load_map(rs485_bus_registry_t *r, rs485_device_map_t *map);
+
+/**
+ * @brief First device of the map whose model is desc, NULL if none.
+ */
+const rs485_device_t* rs485_device_map_find(const rs485_device_map_t *map, const rs485_sensor_desc_t *desc);
+
+#endif
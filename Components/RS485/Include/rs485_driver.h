@@ -0,0 +1,72 @@
+#ifndef RS485_DRIVER_H
+#define RS485_DRIVER_H
+
+#include <stdint.h>
+#include <modbus/modbus.h>
+
+/*
+ * Typed sensor drivers: one constant descriptor per sensor model.
+ *
+ * A descriptor lists the data registers of the model and how to turn each raw count
+ * into a physical value (physical = raw * scale + offset). Every data register of a
+ * model lies inside one contiguous block, so reading a device is one FC03 transaction
+ * whatever the number of values, and decoding is a table walk in C. The Python pipeline
+ * takes its conversions from the same table (rs485_driver_find()).
+ */
+
+#define RS485_DRIVER_MAX_VALUES 4
+
+/**
+ * @brief One value of a sensor model.
+ */
+typedef struct {
+    const char *name;       // Value name, e.g. "pm25"
+    const char *unit;
+    uint16_t reg_addr;      // Holding register of the raw count
+    float scale;            // Physical unit per count
+    float offset;
+} rs485_value_desc_t;
+
+/**
+ * @brief Register layout and conversions of a sensor model.
+ */
+typedef struct {
+    const char *model;      // e.g. "EPAM"
+    uint16_t block_start;   // First register of the block covering every value
+    uint16_t block_count;   // Registers read per device access
+    uint16_t addr_reg;      // Slave id configuration register
+    uint16_t baud_reg;      // Baud rate configuration register
+    int n_values;
+    rs485_value_desc_t values[RS485_DRIVER_MAX_VALUES];
+} rs485_sensor_desc_t;
+
+// --- Built-in models ---
+extern const rs485_sensor_desc_t rs485_sensor_epam;     // PM2.5 / PM10
+extern const rs485_sensor_desc_t rs485_sensor_epco;     // CO
+extern const rs485_sensor_desc_t rs485_sensor_epno2;    // NO2
+
+/**
+ * @brief Looks a model up by name (case-sensitive, e.g. "EPCO").
+ * @return Descriptor, or NULL if the model is unknown.
+ */
+const rs485_sensor_desc_t* rs485_driver_find(const char *model);
+
+/**
+ * @brief Number of built-in models, and the i-th of them (NULL when out of range).
+ */
+int rs485_driver_count(void);
+const rs485_sensor_desc_t* rs485_driver_get(int index);
+
+/**
+ * @brief Converts a raw block (as read from block_start) into n_values physical values.
+ */
+void rs485_driver_decode(const rs485_sensor_desc_t *desc, const uint16_t *block, float *out_values);
+
+/**
+ * @brief Reads every value of a device in one transaction and decodes it.
+ * @param out_values Array of desc->n_values entries.
+ * @return 0 on success, -1 on invalid arguments or bus failure (logged).
+ */
+int rs485_driver_read(modbus_t *ctx, int slave_id, const rs485_sensor_desc_t *desc, float *out_values);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef RS485_HEALTH_H
+#define RS485_HEALTH_H
+
+#include <stdint.h>
+#include "rs485_timing.h"
+
+/*
+ * Per-slave circuit breaker.
+ *
+ * A slave that stops answering costs a full response timeout on every poll, which delays
+ * every other sensor on its bus. After fail_threshold consecutive failed polls the slave is
+ * taken offline: its polls are skipped and a one-register probe (the address register that
+ * every EP sensor has) is sent at exponentially growing intervals instead. The first probe
+ * that answers puts the slave back on its normal schedule.
+ *
+ * Like rs485_timing_t, a table is owned by the thread that owns the Modbus context.
+ */
+
+// --- Defaults ---
+#define RS485_HEALTH_MAX_SLAVE 247
+#define RS485_HEALTH_FAIL_THRESHOLD 3       // Consecutive failed polls before going offline
+#define RS485_HEALTH_PROBE_MIN_MS 1000      // First probe interval once offline
+#define RS485_HEALTH_PROBE_MAX_MS 60000     // Probe interval cap (doubles after every failed probe)
+#define RS485_HEALTH_PROBE_REG 0x0100       // Slave address register
+
+// --- Slave states ---
+#define RS485_SLAVE_HEALTHY 0
+#define RS485_SLAVE_FAILING 1               // Failed its last poll(s), still polled
+#define RS485_SLAVE_OFFLINE 2               // Polls skipped, probed only
+
+// --- Actions of rs485_health_check() ---
+#define RS485_HEALTH_POLL 0
+#define RS485_HEALTH_PROBE 1
+#define RS485_HEALTH_SKIP 2
+
+typedef struct {
+    uint32_t state;                 // RS485_SLAVE_*
+    uint32_t consecutive_failures;
+    uint32_t probe_interval_ms;     // Spacing of the next probe while offline
+    uint32_t outages;               // Times the slave went offline
+    uint64_t next_probe_ns;         // CLOCK_MONOTONIC
+    uint64_t offline_since_ns;      // CLOCK_MONOTONIC, 0 while not offline
+    uint64_t skipped;               // Polls not sent because the slave was offline
+    uint64_t probes;                // Probes sent (answered or not)
+} rs485_slave_health_t;
+
+typedef struct {
+    uint32_t fail_threshold;
+    uint32_t probe_min_ms;
+    uint32_t probe_max_ms;
+    rs485_slave_health_t slaves[RS485_HEALTH_MAX_SLAVE + 1];
+} rs485_health_t;
+
+/**
+ * @brief Marks every slave healthy. Zero arguments select the RS485_HEALTH_* defaults.
+ */
+void rs485_health_init(rs485_health_t *h, uint32_t fail_threshold, uint32_t probe_min_ms, uint32_t probe_max_ms);
+
+/**
+ * @brief What to do with a poll of the slave that is due now.
+ * @param now_ns CLOCK_MONOTONIC.
+ * @return RS485_HEALTH_POLL, RS485_HEALTH_PROBE (probe first, poll if it answers) or RS485_HEALTH_SKIP.
+ */
+int rs485_health_check(rs485_health_t *h, int slave_id, uint64_t now_ns);
+
+/**
+ * @brief Records the outcome of a poll.
+ * @param ok 1 if the slave answered at least one request.
+ * @return 1 if the slave just went offline, 0 otherwise.
+ */
+int rs485_health_record(rs485_health_t *h, int slave_id, int ok, uint64_t now_ns);
+
+/**
+ * @brief Records the outcome of a probe and schedules the next one if it failed.
+ * @return 1 if the slave is back online, 0 otherwise.
+ */
+int rs485_health_probe_done(rs485_health_t *h, int slave_id, int ok, uint64_t now_ns);
+
+/**
+ * @brief Sends the probe: one read of RS485_HEALTH_PROBE_REG with the slave's base timeout
+ *        (timing backoff cleared, so a dead slave costs one plain timeout per probe).
+ * @param t Timing state of the bus, may be NULL.
+ * @return 0 if the slave answered, -1 otherwise.
+ */
+int rs485_health_probe(modbus_t *ctx, rs485_timing_t *t, int slave_id);
+
+#endif
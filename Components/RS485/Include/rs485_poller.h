@@ -0,0 +1,223 @@
+#ifndef RS485_POLLER_H
+#define RS485_POLLER_H
+
+#include <stdint.h>
+#include "air_rs485.h"
+#include "rs485_timing.h"
+#include "rs485_stats.h"
+#include "rs485_health.h"
+
+// --- Poller limits ---
+#define RS485_POLL_MAX_SENSORS 32   // Sensors scheduled by one poller (one bus)
+#define RS485_POLL_MAX_REGS 16      // Data registers per sensor
+#define RS485_SAMPLE_QUEUE_LEN 256  // Finished samples buffered for the consumer
+
+/**
+ * @brief One finished poll of one sensor.
+ */
+typedef struct {
+    int sensor_id;          // Value returned by rs485_poller_add_sensor() (or rs485_bus_add_sensor())
+    int bus_id;             // Set by rs485_poller_attach_queue(), 0 otherwise
+    uint8_t slave_id;
+    int status;             // 0 if every register was read, -1 otherwise (polls skipped while the slave is offline are not published)
+    uint32_t seq;           // Increments for every sample published by this poller
+    uint64_t timestamp_ms;  // Wall clock (ms since epoch) when the read finished
+    uint32_t duration_us;   // Time spent on the bus for this sample
+    int n_values;
+    uint16_t values[RS485_POLL_MAX_REGS];  // Same order as the registers given at add time
+    uint8_t valid[RS485_POLL_MAX_REGS];
+} rs485_sample_t;
+
+/**
+ * @brief Optional hook run on the poller thread for every finished sample.
+ * Must be short and must not call back into the poller.
+ */
+typedef void (*rs485_sample_cb)(const rs485_sample_t *sample, void *user_data);
+
+/**
+ * @brief Transaction run on the poller thread, which owns the Modbus context.
+ * @return Value handed back to the submitter.
+ */
+typedef int (*rs485_job_fn)(modbus_t *ctx, void *arg);
+
+/**
+ * @brief Real-time scheduling of a poller thread (see rs485_poller_set_realtime()).
+ *
+ * Each setting is best effort: one the system refuses (no CAP_SYS_NICE, no CAP_IPC_LOCK,
+ * offline CPU) is logged and the poller keeps running without it.
+ */
+typedef struct {
+    int priority;           // SCHED_FIFO priority (1..99), 0 keeps the default scheduler
+    int cpu;                // Core the thread is pinned to (e.g. one kept free with isolcpus=), -1 for any
+    int lock_memory;        // mlockall() the process when the poller starts, so no page fault hits a poll
+} rs485_rt_config_t;
+
+/**
+ * @brief Timing accuracy of a poller's schedule.
+ *
+ * Lateness is how long after its deadline a poll started: wakeup latency plus the time
+ * spent behind other sensors of the same bus. Jitter is the change of lateness between
+ * two consecutive polls of a sensor, i.e. the error of the achieved period.
+ */
+typedef struct {
+    uint64_t cycles;                // Polls started
+    uint64_t overruns;              // Polls that ended after their sensor's next deadline
+    uint64_t missed_slots;          // Deadlines skipped because of overruns
+    uint64_t lateness_sum_us;
+    uint64_t lateness_max_us;
+    uint64_t lateness_hist[RS485_STATS_HIST_BUCKETS];  // Buckets of rs485_stats_bucket()
+    uint64_t jitter_count;          // Polls that had a previous poll to compare with
+    uint64_t jitter_sum_us;
+    uint64_t jitter_max_us;
+    int32_t cpu;                    // Core the thread is pinned to, -1 if not pinned
+    int32_t priority;               // SCHED_FIFO priority in effect, 0 for the default scheduler
+} rs485_poll_timing_t;
+
+typedef struct rs485_poller rs485_poller_t;
+typedef struct rs485_sample_queue rs485_sample_queue_t;
+
+/**
+ * @brief Opens the serial port and creates an idle poller that owns the Modbus context.
+ * @return Poller handle, or NULL on failure.
+ */
+rs485_poller_t* rs485_poller_create(const char* device, int baud, char parity, int data_bit, int stop_bit);
+
+/**
+ * @brief Registers a sensor to be polled every period_ms.
+ *
+ * The registers are merged into block reads once, at registration time.
+ * Can be called before or after rs485_poller_start().
+ *
+ * @param regs Data register addresses of the sensor.
+ * @param n_regs Number of registers (<= RS485_POLL_MAX_REGS).
+ * @param period_ms Poll period in milliseconds (> 0).
+ * @return Sensor ID (>= 0) on success, -1 on failure.
+ */
+int rs485_poller_add_sensor(rs485_poller_t *p, int slave_id, const uint16_t *regs, int n_regs, uint32_t period_ms);
+
+/**
+ * @brief 1 if a sensor of the slave is scheduled on this poller, 0 otherwise.
+ */
+int rs485_poller_has_slave(rs485_poller_t *p, int slave_id);
+
+/**
+ * @brief Changes the poll period of a registered sensor. Takes effect after its next poll.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int rs485_poller_set_period(rs485_poller_t *p, int sensor_id, uint32_t period_ms);
+
+/**
+ * @brief Installs (or clears with NULL) the per-sample hook. Can be called while running: the
+ *        next poll uses the new pair, a poll already in progress finishes with the previous one.
+ */
+void rs485_poller_set_callback(rs485_poller_t *p, rs485_sample_cb cb, void *user_data);
+
+/**
+ * @brief Configures the dead-slave circuit breaker (see rs485_health.h) and marks every slave healthy.
+ *        Zero arguments keep the RS485_HEALTH_* defaults, which are active from creation.
+ */
+void rs485_poller_set_health(rs485_poller_t *p, uint32_t fail_threshold, uint32_t probe_min_ms, uint32_t probe_max_ms);
+
+/**
+ * @brief Copies the health of one slave of the bus.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int rs485_poller_slave_health(rs485_poller_t *p, int slave_id, rs485_slave_health_t *out);
+
+/**
+ * @brief Switches the poller to real-time mode (NULL switches it back). Call before rs485_poller_start().
+ *
+ * In real-time mode the thread sleeps on a timerfd armed with the absolute deadline of the
+ * next poll, with a 1 ns timer slack, and runs with the scheduling given in cfg.
+ *
+ * @return 0 on success, -1 if the poller is running or the timer cannot be created.
+ */
+int rs485_poller_set_realtime(rs485_poller_t *p, const rs485_rt_config_t *cfg);
+
+/**
+ * @brief Copies the timing statistics of the poller (kept in every mode).
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int rs485_poller_timing(rs485_poller_t *p, rs485_poll_timing_t *out);
+
+/**
+ * @brief Clears the timing statistics, e.g. after start-up or a configuration change.
+ */
+void rs485_poller_timing_reset(rs485_poller_t *p);
+
+/**
+ * @brief Starts the polling thread. Sensors are served earliest-deadline-first.
+ * @return 0 on success, -1 on failure.
+ */
+int rs485_poller_start(rs485_poller_t *p);
+
+/**
+ * @brief Stops the polling thread and waits for the current transaction to finish.
+ */
+void rs485_poller_stop(rs485_poller_t *p);
+
+/**
+ * @brief Runs fn(ctx, arg) on the poller thread between two polls and waits for it.
+ *
+ * This is the only safe way for other threads to talk to a bus while its poller runs
+ * (configuration writes, one-off reads). Without a running thread the job runs on the caller.
+ *
+ * @return fn's return value, -1 on invalid arguments.
+ */
+int rs485_poller_submit(rs485_poller_t *p, rs485_job_fn fn, void *arg);
+
+/**
+ * @brief Moves the bus to the highest baud rate every scheduled slave supports (see rs485_negotiate_baud()).
+ *        Runs on the poller thread; polling pauses meanwhile. Transactions use per-slave adaptive
+ *        timeouts (rs485_timing.h) at every speed.
+ * @return Baud rate in use afterwards, or -1 if the port was lost.
+ */
+int rs485_poller_negotiate_baud(rs485_poller_t *p, uint16_t baud_reg, uint16_t probe_reg,
+                                const rs485_baud_option_t *options, int n_options);
+
+/**
+ * @brief Current host-side baud rate of the bus.
+ */
+int rs485_poller_baud(rs485_poller_t *p);
+
+/**
+ * @brief Publishes samples to q (shared with other pollers) instead of the poller's own queue,
+ *        tagging them with bus_id. NULL restores the own queue. Call before rs485_poller_start().
+ */
+void rs485_poller_attach_queue(rs485_poller_t *p, rs485_sample_queue_t *q, int bus_id);
+
+/**
+ * @brief Drains finished samples, oldest first.
+ * @param out Buffer for at most max samples.
+ * @param timeout_ms 0 to return immediately, < 0 to wait forever, otherwise max wait.
+ * @return Number of samples copied (0 on timeout), -1 on invalid arguments.
+ */
+int rs485_poller_get_samples(rs485_poller_t *p, rs485_sample_t *out, int max, int timeout_ms);
+
+/**
+ * @brief Number of samples dropped because the consumer did not drain fast enough.
+ */
+uint64_t rs485_poller_dropped(rs485_poller_t *p);
+
+/**
+ * @brief Stops the poller if needed, closes the port and frees the handle.
+ */
+void rs485_poller_destroy(rs485_poller_t *p);
+
+/*-------------------- Sample queue (shared by several pollers) ---------------------*/
+
+rs485_sample_queue_t* rs485_sample_queue_create(void);
+
+/**
+ * @brief Same semantics as rs485_poller_get_samples().
+ */
+int rs485_sample_queue_get(rs485_sample_queue_t *q, rs485_sample_t *out, int max, int timeout_ms);
+
+uint64_t rs485_sample_queue_dropped(rs485_sample_queue_t *q);
+
+/**
+ * @brief Frees the queue. Every poller using it must be stopped or detached first.
+ */
+void rs485_sample_queue_destroy(rs485_sample_queue_t *q);
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef RS485_RTU_H
+#define RS485_RTU_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Non-blocking Modbus RTU transport (no libmodbus).
+ *
+ * Ports are opened raw through termios and registered with an engine. The engine
+ * owns one epoll instance; each port has its serial fd plus one timerfd that is armed
+ * either for the response timeout or, once bytes arrive, for the 3.5 character
+ * inter-frame silence that ends an RTU frame. One thread calling rs485_rtu_engine_poll()
+ * therefore drives one outstanding transaction on every port at the same time.
+ *
+ * Every port and the engine belong to the thread that polls the engine.
+ */
+
+// --- Limits ---
+#define RS485_RTU_MAX_READ 125      // FC03 register limit (Modbus application protocol)
+#define RS485_RTU_MAX_ADU 256       // Largest RTU frame
+#define RS485_RTU_MAX_PORTS 16      // Ports per engine
+
+// --- Transaction status (callback and blocking calls) ---
+#define RS485_RTU_OK 0
+#define RS485_RTU_ERR_IO (-1)       // write()/read() failed
+#define RS485_RTU_ERR_TIMEOUT (-2)  // No response, or frame never completed
+#define RS485_RTU_ERR_CRC (-3)      // Frame with a bad CRC
+#define RS485_RTU_ERR_FRAME (-4)    // Valid CRC but wrong slave, function or length
+#define RS485_RTU_ERR_EXCEPTION (-5) // Slave answered with a Modbus exception
+#define RS485_RTU_ERR_BUSY (-6)     // Port already has a transaction in flight
+
+typedef struct rs485_rtu_engine rs485_rtu_engine_t;
+typedef struct rs485_rtu_port rs485_rtu_port_t;
+
+/**
+ * @brief Completion of one transaction, called from rs485_rtu_engine_poll().
+ * @param status RS485_RTU_OK or a negative RS485_RTU_ERR_* code.
+ * @param values Registers read (FC03) or the echoed value (FC06); valid during the call only.
+ * @param count Number of values (0 on failure).
+ */
+typedef void (*rs485_rtu_done_fn)(rs485_rtu_port_t *port, int status, const uint16_t *values, int count, void *user);
+
+/**
+ * @brief Modbus CRC16 (poly 0xA001, init 0xFFFF), slice-by-8 tables.
+ */
+uint16_t rs485_rtu_crc16(const uint8_t *data, size_t len);
+
+/**
+ * @brief Bit-serial reference CRC16, for benchmarks and self-checks.
+ */
+uint16_t rs485_rtu_crc16_bitwise(const uint8_t *data, size_t len);
+
+rs485_rtu_engine_t* rs485_rtu_engine_create(void);
+
+/**
+ * @brief Closes every port still registered and frees the engine. Not from a done callback.
+ */
+void rs485_rtu_engine_destroy(rs485_rtu_engine_t *e);
+
+/**
+ * @brief Opens a serial port in raw non-blocking mode and registers it with the engine.
+ * @return Port handle, or NULL on failure (bad settings, open/termios error, engine full).
+ */
+rs485_rtu_port_t* rs485_rtu_open(rs485_rtu_engine_t *e, const char *device, int baud, char parity, int data_bit, int stop_bit);
+
+/**
+ * @brief Unregisters and closes a port. An in-flight transaction is dropped without callback.
+ *        May be called from a done callback (the memory is released when the poll returns).
+ */
+void rs485_rtu_close(rs485_rtu_port_t *port);
+
+/**
+ * @brief Overrides the response timeout (default: request wire time + 100 ms + USB slack).
+ */
+void rs485_rtu_set_response_timeout(rs485_rtu_port_t *port, uint32_t timeout_us);
+
+/**
+ * @brief Minimum end-of-frame silence. Defaults to 3.5 characters plus USB slack, since
+ *        USB-serial adapters deliver bytes in chunks and hide the real line gaps.
+ */
+void rs485_rtu_set_frame_gap(rs485_rtu_port_t *port, uint32_t gap_us);
+
+/**
+ * @brief Starts an FC03 read. Returns immediately; done is called from the engine poll.
+ * @return 0 if the request was queued on the wire, RS485_RTU_ERR_* otherwise (no callback then).
+ */
+int rs485_rtu_submit_read(rs485_rtu_port_t *port, int slave_id, int start_addr, int count,
+                          rs485_rtu_done_fn done, void *user);
+
+/**
+ * @brief Starts an FC06 single register write. Same contract as rs485_rtu_submit_read().
+ */
+int rs485_rtu_submit_write(rs485_rtu_port_t *port, int slave_id, int reg_addr, uint16_t value,
+                           rs485_rtu_done_fn done, void *user);
+
+/**
+ * @brief 1 while a transaction is in flight on the port.
+ */
+int rs485_rtu_busy(const rs485_rtu_port_t *port);
+
+/**
+ * @brief Waits for serial and timer events and advances every port.
+ * @param timeout_ms -1 to block until something happens, 0 to only process ready events.
+ * @return Number of transactions completed, -1 on error.
+ */
+int rs485_rtu_engine_poll(rs485_rtu_engine_t *e, int timeout_ms);
+
+/**
+ * @brief Number of transactions in flight across all ports.
+ */
+int rs485_rtu_engine_pending(const rs485_rtu_engine_t *e);
+
+/*
+ * Blocking calls with the semantics of rs485_read_raw()/rs485_read_block()/rs485_write_raw():
+ * they submit one transaction and poll the port's engine until it completes.
+ * Other ports of the engine keep progressing meanwhile.
+ * Return 0 on success, -1 on failure.
+ */
+int rs485_rtu_read_raw(rs485_rtu_port_t *port, int slave_id, int reg_addr, uint16_t *out_value);
+int rs485_rtu_read_block(rs485_rtu_port_t *port, int slave_id, int start_addr, int count, uint16_t *out_values);
+int rs485_rtu_write_raw(rs485_rtu_port_t *port, int slave_id, int reg_addr, uint16_t value);
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef RS485_STATS_H
+#define RS485_STATS_H
+
+#include <stdint.h>
+
+/*
+ * Transaction counters per bus and per slave.
+ *
+ * Every counter is a relaxed atomic add on a fixed page, so recording costs a few
+ * uncontended atomics per transaction and can stay on in production. The page lives
+ * in process memory until rs485_stats_export_shm() moves it into a shared memory
+ * segment, where external scrapers map it read-only (rs485_stats_shm_read()).
+ *
+ * Buses are identified by device path, so counters survive a port reopen
+ * (baud negotiation). Transports bind their handle (modbus_t*, RTU port) to a bus.
+ */
+
+// --- Limits ---
+#define RS485_STATS_MAX_BUSES 8
+#define RS485_STATS_MAX_SLAVES 32          // Tracked per bus; later slaves only count in the bus total
+#define RS485_STATS_SLAVE_IDS 248          // Modbus addresses 0..247
+#define RS485_STATS_HIST_BUCKETS 20        // Bucket k holds [2^k, 2^(k+1)) us, bucket 0 holds < 2 us
+
+// --- Shared memory page ---
+#define RS485_STATS_SHM_NAME_DEFAULT "/lsmy_rs485_stats"
+#define RS485_STATS_MAGIC 0x53383452U     // "R48S"
+#define RS485_STATS_VERSION 1
+
+// --- Transaction results ---
+#define RS485_RESULT_OK 0
+#define RS485_RESULT_TIMEOUT 1
+#define RS485_RESULT_CRC 2
+#define RS485_RESULT_EXCEPTION 3          // Slave answered with a Modbus exception
+#define RS485_RESULT_FRAME 4              // Wrong slave, function or length
+#define RS485_RESULT_IO 5                 // Port error, invalid call
+#define RS485_RESULT_COUNT 6
+
+// --- Error codes ---
+#define RS485_STATS_SUCCESS 0
+#define RS485_STATS_E_GENERIC_FAIL -1
+#define RS485_STATS_E_OPEN -2             // shm_open/mmap failed
+#define RS485_STATS_E_LAYOUT -3           // Segment exists but has another magic/version
+
+typedef struct {
+    uint64_t requests;
+    uint64_t results[RS485_RESULT_COUNT];  // Indexed by RS485_RESULT_*
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+    uint64_t latency_sum_us;
+    uint64_t latency_max_us;
+    uint64_t latency_hist[RS485_STATS_HIST_BUCKETS];
+} rs485_stats_counters_t;
+
+typedef struct {
+    char device[32];
+    rs485_stats_counters_t total;
+    uint32_t n_slaves;
+    uint32_t reserved;
+    uint64_t untracked;                     // Transactions of slaves beyond RS485_STATS_MAX_SLAVES
+    uint8_t slave_index[RS485_STATS_SLAVE_IDS];  // 0 = not tracked, else index + 1 into slaves[]
+    uint8_t slave_id[RS485_STATS_MAX_SLAVES];
+    rs485_stats_counters_t slaves[RS485_STATS_MAX_SLAVES];
+} rs485_stats_bus_t;
+
+// Layout of the page (process memory or shared segment). Only append fields and bump RS485_STATS_VERSION.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t n_buses;
+    uint32_t reserved;
+    rs485_stats_bus_t buses[RS485_STATS_MAX_BUSES];
+} rs485_stats_page_t;
+
+/**
+ * @brief Bus index of a device path, allocated on first use.
+ * @return Bus index (>= 0), or -1 if the table is full.
+ */
+int rs485_stats_bus_open(const char *device);
+
+/**
+ * @brief Associates a transport handle (modbus_t*, rs485_rtu_port_t*) with a bus.
+ * @return 0 on success, -1 on invalid bus or full binding table.
+ */
+int rs485_stats_bind(const void *handle, int bus);
+
+void rs485_stats_unbind(const void *handle);
+
+/**
+ * @brief Bus bound to a handle, -1 if none.
+ */
+int rs485_stats_bus_of(const void *handle);
+
+/**
+ * @brief Records one transaction. Lock-free; callable from any thread.
+ * @param bus Bus index (-1 is ignored, so unbound handles cost nothing).
+ * @param result RS485_RESULT_*.
+ */
+void rs485_stats_record(int bus, int slave_id, int result, uint32_t tx_bytes, uint32_t rx_bytes, uint32_t latency_us);
+
+/**
+ * @brief Histogram bucket of a latency.
+ */
+int rs485_stats_bucket(uint32_t latency_us);
+
+/**
+ * @brief Copies the counters of one bus.
+ * @return RS485_STATS_SUCCESS, or RS485_STATS_E_GENERIC_FAIL on invalid bus.
+ */
+int rs485_stats_bus_snapshot(int bus, rs485_stats_bus_t *out);
+
+int rs485_stats_bus_count(void);
+
+/**
+ * @brief Clears every counter. Bus and slave assignments are kept.
+ */
+void rs485_stats_reset(void);
+
+/**
+ * @brief Moves the counters into a shared memory segment (created if needed).
+ *        Call it before the pollers start: increments racing the move may be lost.
+ * @return RS485_STATS_SUCCESS, or a negative RS485_STATS_E_* code.
+ */
+int rs485_stats_export_shm(const char *name);
+
+/**
+ * @brief Reads the page exported by another process.
+ * @return RS485_STATS_SUCCESS, or a negative RS485_STATS_E_* code.
+ */
+int rs485_stats_shm_read(const char *name, rs485_stats_page_t *out);
+
+/**
+ * @brief Maps a transport errno (libmodbus or system) to an RS485_RESULT_* code.
+ */
+int rs485_stats_result_from_errno(int err);
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef RS485_TIMING_H
+#define RS485_TIMING_H
+
+#include <stdint.h>
+#include "air_rs485.h"
+
+// --- Timing limits ---
+#define RS485_TIMING_MAX_SLAVE 247
+#define RS485_TIMING_SLACK_US 4000          // USB-serial adapter latency budget (FTDI latency_timer set to 1-2 ms)
+#define RS485_TIMING_COLD_LATENCY_US 100000 // Assumed device turnaround before the first measurement
+#define RS485_TIMING_MAX_RESPONSE_US 1000000
+#define RS485_TIMING_MAX_BACKOFF 8          // Timeout multiplier cap after consecutive timeouts
+
+/**
+ * @brief Measured behaviour of one slave.
+ *
+ * Only the device turnaround (round trip minus wire time) is tracked, so the
+ * profile stays valid across block sizes and baud rate changes.
+ */
+typedef struct {
+    uint32_t latency_us;    // Smoothed turnaround (0 = no measurement yet)
+    uint32_t latency_var_us;
+    uint32_t backoff;       // Current timeout multiplier (1 = healthy)
+    uint32_t n_ok;
+    uint32_t n_timeout;
+} rs485_slave_timing_t;
+
+/**
+ * @brief Timing state of one bus. Owned by the thread that owns the Modbus context.
+ */
+typedef struct {
+    uint32_t baud;
+    uint32_t char_us;       // One 11-bit character on the wire
+    uint32_t frame_gap_us;  // Modbus inter-frame silence (3.5 characters, 1750 us above 19200 baud)
+    uint32_t slack_us;
+    uint64_t last_frame_end_ns;
+    uint64_t txn_start_ns;
+    rs485_slave_timing_t slaves[RS485_TIMING_MAX_SLAVE + 1];
+} rs485_timing_t;
+
+/**
+ * @brief Baud rate and the value a device expects in its baud register for it.
+ */
+typedef struct {
+    uint32_t baud;
+    uint16_t code;
+} rs485_baud_option_t;
+
+void rs485_timing_init(rs485_timing_t *t, uint32_t baud);
+
+/**
+ * @brief Switches the wire-time model to a new baud rate. Slave profiles are kept.
+ */
+void rs485_timing_set_baud(rs485_timing_t *t, uint32_t baud);
+
+/**
+ * @brief Response timeout for one transaction: wire time + smoothed turnaround + 4 deviations + slack,
+ *        multiplied by the slave's backoff.
+ */
+uint32_t rs485_timing_response_us(const rs485_timing_t *t, int slave_id, int req_bytes, int resp_bytes);
+
+/**
+ * @brief Waits out the inter-frame gap, then programs the response and byte timeouts of ctx for the slave.
+ */
+void rs485_timing_begin(rs485_timing_t *t, modbus_t *ctx, int slave_id, int req_bytes, int resp_bytes);
+
+/**
+ * @brief Updates the slave profile with the transaction started by rs485_timing_begin().
+ * @param ok 1 if a valid response arrived; failed transactions only raise the backoff.
+ */
+void rs485_timing_end(rs485_timing_t *t, int slave_id, int req_bytes, int resp_bytes, int ok);
+
+/**
+ * @brief Static timeouts derived from the baud rate, for code that does not track profiles.
+ */
+void rs485_timing_apply_defaults(modbus_t *ctx, uint32_t baud);
+
+/**
+ * @brief rs485_read_block() with adaptive timeouts (t may be NULL for the plain call).
+ */
+int rs485_read_block_timed(modbus_t *ctx, rs485_timing_t *t, int slave_id, int start_addr, int count, uint16_t *out_values);
+
+/**
+ * @brief rs485_plan_execute() with adaptive timeouts (t may be NULL for the plain call).
+ */
+int rs485_plan_execute_timed(modbus_t *ctx, rs485_timing_t *t, const rs485_read_plan_t *plan,
+                             uint16_t *out_values, uint8_t *out_valid);
+
+/**
+ * @brief Moves every slave of a bus, and the host port, to the highest common baud rate.
+ *
+ * Options are tried from the fastest down to the current baud. For each one, the code is written
+ * to every slave at the current speed, the port is reopened at the new speed and every slave is
+ * probed (probe_reg read). If any slave fails, the old code is written back and the port returns
+ * to the old speed before the next option is tried.
+ *
+ * @param ctx Context of the bus; replaced when the port is reopened.
+ * @param t Timing state of the bus (baud kept in sync), may be NULL.
+ * @param options Supported rates; the current rate must be listed so it can be restored.
+ * @return Baud rate in use afterwards, or -1 if the port could not be reopened.
+ */
+int rs485_negotiate_baud(modbus_t **ctx, rs485_timing_t *t, const char *device, char parity, int data_bit, int stop_bit,
+                         uint32_t current_baud, const uint8_t *slaves, int n_slaves, uint16_t baud_reg, uint16_t probe_reg,
+                         const rs485_baud_option_t *options, int n_options);
+
+#endif
@@ -0,0 +1,283 @@
+#define _GNU_SOURCE
+#include "rs485_rtu.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Non-blocking RTU transport against scripted slaves on pseudo-terminals.
+ *
+ * The test owns the master side of each pty and plays the slave by hand: it reads the
+ * request the engine wrote, answers with exactly the bytes (and gaps) a case needs, then
+ * polls the engine. Only rs485_rtu.c and rs485_stats.c are built in: no libmodbus link. Everything runs on one thread, so every case is deterministic.
+ */
+
+#define RESPONSE_TIMEOUT_US 50000
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __func__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+typedef struct {
+    int calls;
+    int status;
+    int count;
+    uint16_t values[RS485_RTU_MAX_READ];
+} result_t;
+
+static rs485_rtu_port_t *close_on_done[2];
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static int open_pty(void) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) return -1;
+    struct termios t;
+    tcgetattr(fd, &t);
+    cfmakeraw(&t);
+    tcsetattr(fd, TCSANOW, &t);
+    return fd;
+}
+
+static void on_done(rs485_rtu_port_t *port, int status, const uint16_t *values, int count, void *user) {
+    (void)port;
+    result_t *r = (result_t*)user;
+    r->calls++;
+    r->status = status;
+    r->count = count;
+    if (count > 0) memcpy(r->values, values, (size_t)count * sizeof(uint16_t));
+}
+
+// First completion closes every port listed, its own included
+static void on_done_close(rs485_rtu_port_t *port, int status, const uint16_t *values, int count, void *user) {
+    on_done(port, status, values, count, user);
+    for (int i = 0; i < 2; i++) {
+        if (close_on_done[i] != NULL) rs485_rtu_close(close_on_done[i]);
+        close_on_done[i] = NULL;
+    }
+}
+
+// Reads the 8-byte request the engine wrote to the line; 0 if it arrived with a valid CRC
+static int read_request(int master, uint8_t req[8]) {
+    int len = 0;
+    while (len < 8) {
+        struct pollfd pfd = { master, POLLIN, 0 };
+        if (poll(&pfd, 1, 1000) <= 0) return -1;
+        ssize_t n = read(master, req + len, (size_t)(8 - len));
+        if (n <= 0) return -1;
+        len += (int)n;
+    }
+    uint16_t crc = (uint16_t)(req[6] | req[7] << 8);
+    return rs485_rtu_crc16(req, 6) == crc ? 0 : -1;
+}
+
+// Appends the CRC and writes the frame, optionally in two chunks separated by gap_us
+static void send_frame(int master, uint8_t *frame, int len, int split, uint32_t gap_us, int corrupt_crc) {
+    uint16_t crc = rs485_rtu_crc16(frame, (size_t)len);
+    if (corrupt_crc) crc ^= 0x0001;
+    frame[len++] = (uint8_t)crc;
+    frame[len++] = (uint8_t)(crc >> 8);
+    if (split > 0 && split < len) {
+        if (write(master, frame, (size_t)split) != split) return;
+        usleep(gap_us);
+        if (write(master, frame + split, (size_t)(len - split)) != len - split) return;
+    } else {
+        if (write(master, frame, (size_t)len) != len) return;
+    }
+}
+
+// Polls until the result has a completion or max_ms passed
+static void run(rs485_rtu_engine_t *e, const result_t *r, int max_ms) {
+    uint64_t end = now_ms() + (uint64_t)max_ms;
+    while (r->calls == 0 && now_ms() < end) rs485_rtu_engine_poll(e, 5);
+}
+
+static void test_crc(void) {
+    uint8_t buf[300];
+    unsigned int seed = 1;
+    for (int len = 0; len <= (int)sizeof(buf); len++) {
+        for (int i = 0; i < len; i++) buf[i] = (uint8_t)rand_r(&seed);
+        CHECK(rs485_rtu_crc16(buf, (size_t)len) == rs485_rtu_crc16_bitwise(buf, (size_t)len), "crc length %d", len);
+    }
+    const uint8_t known[6] = { 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A };   // Modbus spec example: CRC 0xCDC5
+    CHECK(rs485_rtu_crc16(known, sizeof(known)) == 0xCDC5, "known vector %04X", rs485_rtu_crc16(known, sizeof(known)));
+}
+
+static void test_read_ok(rs485_rtu_engine_t *e, rs485_rtu_port_t *port, int master) {
+    result_t r = { 0 };
+    uint8_t req[8], rsp[64];
+    CHECK(rs485_rtu_submit_read(port, 0x24, 0x0004, 6, on_done, &r) == 0, "submit");
+    CHECK(rs485_rtu_busy(port) == 1, "busy after submit");
+    CHECK(rs485_rtu_submit_read(port, 0x24, 0x0004, 1, on_done, &r) == RS485_RTU_ERR_BUSY, "second submit not refused");
+    CHECK(read_request(master, req) == 0, "request CRC");
+    CHECK(req[0] == 0x24 && req[1] == 0x03 && req[3] == 0x04 && req[5] == 6, "request fields");
+
+    rsp[0] = 0x24;
+    rsp[1] = 0x03;
+    rsp[2] = 12;
+    for (int i = 0; i < 6; i++) {
+        rsp[3 + 2 * i] = (uint8_t)(0x10 + i);
+        rsp[4 + 2 * i] = (uint8_t)(0xA0 + i);
+    }
+    // Chunked like a USB adapter delivers it, the gap well under the end-of-frame silence
+    send_frame(master, rsp, 15, 4, 1000, 0);
+    run(e, &r, 500);
+    CHECK(r.calls == 1 && r.status == RS485_RTU_OK && r.count == 6, "calls %d status %d count %d", r.calls, r.status, r.count);
+    CHECK(r.values[0] == 0x10A0 && r.values[5] == 0x15A5, "values %04X %04X", r.values[0], r.values[5]);
+    CHECK(rs485_rtu_busy(port) == 0 && rs485_rtu_engine_pending(e) == 0, "idle after completion");
+}
+
+static void test_write(rs485_rtu_engine_t *e, rs485_rtu_port_t *port, int master) {
+    for (int bad_echo = 0; bad_echo <= 1; bad_echo++) {
+        result_t r = { 0 };
+        uint8_t req[8], rsp[16];
+        CHECK(rs485_rtu_submit_write(port, 0x01, 0x0100, 0x0030, on_done, &r) == 0, "submit");
+        CHECK(read_request(master, req) == 0 && req[1] == 0x06, "request");
+        memcpy(rsp, req, 6);
+        if (bad_echo) rsp[5] ^= 0x01;
+        send_frame(master, rsp, 6, 0, 0, 0);
+        run(e, &r, 500);
+        int expect = bad_echo ? RS485_RTU_ERR_FRAME : RS485_RTU_OK;
+        CHECK(r.calls == 1 && r.status == expect, "bad_echo %d: calls %d status %d", bad_echo, r.calls, r.status);
+        if (!bad_echo) CHECK(r.count == 1 && r.values[0] == 0x0030, "echoed value %04X", r.values[0]);
+    }
+}
+
+// Complete frames that are wrong: each must end the transaction with its own status
+static void test_bad_frames(rs485_rtu_engine_t *e, rs485_rtu_port_t *port, int master) {
+    enum { EXCEPTION, BAD_CRC, WRONG_SLAVE, WRONG_COUNT, SHORT_FRAME, CASES };
+    const int expect[CASES] = { RS485_RTU_ERR_EXCEPTION, RS485_RTU_ERR_CRC, RS485_RTU_ERR_FRAME,
+                                RS485_RTU_ERR_FRAME, RS485_RTU_ERR_FRAME };
+    for (int c = 0; c < CASES; c++) {
+        result_t r = { 0 };
+        uint8_t req[8], rsp[16] = { 0x24, 0x03, 2, 0x12, 0x34 };
+        int len = 5;
+        CHECK(rs485_rtu_submit_read(port, 0x24, 0x0004, 1, on_done, &r) == 0, "case %d submit", c);
+        CHECK(read_request(master, req) == 0, "case %d request", c);
+        if (c == EXCEPTION) {
+            rsp[1] = 0x83;
+            len = 3;
+        } else if (c == WRONG_SLAVE) {
+            rsp[0] = 0x25;
+        } else if (c == WRONG_COUNT) {
+            // Well-formed for 2 registers while 1 was asked: longer than expected, ends on the gap
+            rsp[2] = 4;
+            rsp[5] = 0x56;
+            rsp[6] = 0x78;
+            len = 7;
+        } else if (c == SHORT_FRAME) {
+            rsp[2] = 0;         // Valid CRC, no data: shorter than expected, ends on the gap
+            len = 3;
+        }
+        send_frame(master, rsp, len, 0, 0, c == BAD_CRC);
+        run(e, &r, 500);
+        CHECK(r.calls == 1 && r.status == expect[c], "case %d: calls %d status %d (expected %d)",
+              c, r.calls, r.status, expect[c]);
+        CHECK(rs485_rtu_engine_pending(e) == 0, "case %d: pending %d", c, rs485_rtu_engine_pending(e));
+    }
+}
+
+static void test_timeouts(rs485_rtu_engine_t *e, rs485_rtu_port_t *port, int master) {
+    result_t r = { 0 };
+    uint8_t req[8], rsp[16] = { 0x24, 0x03, 2, 0x12, 0x34 };
+
+    // Silent slave: the response timeout ends the transaction
+    uint64_t start = now_ms();
+    CHECK(rs485_rtu_submit_read(port, 0x24, 0x0004, 1, on_done, &r) == 0, "submit");
+    CHECK(read_request(master, req) == 0, "request");
+    run(e, &r, 1000);
+    uint64_t elapsed = now_ms() - start;
+    CHECK(r.calls == 1 && r.status == RS485_RTU_ERR_TIMEOUT, "calls %d status %d", r.calls, r.status);
+    CHECK(elapsed >= RESPONSE_TIMEOUT_US / 1000 && elapsed < 500, "timeout after %llu ms", (unsigned long long)elapsed);
+
+    // Its late answer, still unread when the next request goes out, must not be taken for the response
+    send_frame(master, rsp, 5, 0, 0, 0);
+    usleep(2000);
+    memset(&r, 0, sizeof(r));
+    CHECK(rs485_rtu_submit_read(port, 0x24, 0x0009, 1, on_done, &r) == 0, "submit after timeout");
+    CHECK(read_request(master, req) == 0, "request after timeout");
+    rsp[3] = 0x0A;
+    rsp[4] = 0xBC;
+    send_frame(master, rsp, 5, 0, 0, 0);
+    run(e, &r, 500);
+    CHECK(r.calls == 1 && r.status == RS485_RTU_OK && r.values[0] == 0x0ABC, "status %d value %04X", r.status, r.values[0]);
+
+    // Frame cut short by the slave: the end-of-frame silence completes it as a bad frame
+    memset(&r, 0, sizeof(r));
+    CHECK(rs485_rtu_submit_read(port, 0x24, 0x0004, 2, on_done, &r) == 0, "submit");
+    CHECK(read_request(master, req) == 0, "request");
+    uint8_t part[4] = { 0x24, 0x03, 4, 0x12 };
+    CHECK(write(master, part, sizeof(part)) == (ssize_t)sizeof(part), "partial write");
+    start = now_ms();
+    run(e, &r, 1000);
+    elapsed = now_ms() - start;
+    CHECK(r.calls == 1 && r.status == RS485_RTU_ERR_FRAME, "calls %d status %d", r.calls, r.status);
+    CHECK(elapsed < RESPONSE_TIMEOUT_US / 1000, "cut frame took %llu ms (gap, not response timeout)", (unsigned long long)elapsed);
+}
+
+// Two ports complete in one poll batch; the first callback closes both
+static void test_close_from_callback(void) {
+    rs485_rtu_engine_t *e = rs485_rtu_engine_create();
+    int masters[2] = { open_pty(), open_pty() };
+    rs485_rtu_port_t *ports[2];
+    result_t r[2] = { { 0 }, { 0 } };
+    for (int i = 0; i < 2; i++) ports[i] = rs485_rtu_open(e, ptsname(masters[i]), 9600, 'N', 8, 1);
+    CHECK(ports[0] != NULL && ports[1] != NULL, "open");
+    if (ports[0] == NULL || ports[1] == NULL) return;
+
+    for (int i = 0; i < 2; i++) {
+        uint8_t req[8], rsp[16] = { (uint8_t)(i + 1), 0x03, 2, 0x12, 0x34 };
+        close_on_done[i] = ports[i];
+        CHECK(rs485_rtu_submit_read(ports[i], i + 1, 0x0004, 1, on_done_close, &r[i]) == 0, "submit %d", i);
+        CHECK(read_request(masters[i], req) == 0, "request %d", i);
+        send_frame(masters[i], rsp, 5, 0, 0, 0);
+    }
+    usleep(20000);      // Both responses readable before the poll: their events share one batch
+    int n = rs485_rtu_engine_poll(e, 100);
+    CHECK(n == 1 && r[0].calls + r[1].calls == 1, "poll %d, calls %d + %d", n, r[0].calls, r[1].calls);
+    CHECK(rs485_rtu_engine_pending(e) == 0, "pending %d", rs485_rtu_engine_pending(e));
+    CHECK(rs485_rtu_engine_poll(e, 10) == 0, "events of closed ports delivered");
+
+    rs485_rtu_engine_destroy(e);
+    close(masters[0]);
+    close(masters[1]);
+}
+
+int main(void) {
+    rs485_rtu_engine_t *e = rs485_rtu_engine_create();
+    int master = open_pty();
+    rs485_rtu_port_t *port = (e != NULL && master >= 0) ? rs485_rtu_open(e, ptsname(master), 9600, 'N', 8, 1) : NULL;
+    if (port == NULL) {
+        printf("FAIL: no pty\n");
+        return 1;
+    }
+    rs485_rtu_set_response_timeout(port, RESPONSE_TIMEOUT_US);
+
+    test_crc();
+    test_read_ok(e, port, master);
+    test_write(e, port, master);
+    test_bad_frames(e, port, master);
+    test_timeouts(e, port, master);
+    test_close_from_callback();
+
+    rs485_rtu_engine_destroy(e);
+    close(master);
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
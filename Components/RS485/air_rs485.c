@@ -1,6 +1,18 @@
 #include "air_rs485.h"
+#include "rs485_timing.h"
+#include "rs485_stats.h"
+#include "logger.h"
 #include <stdio.h>
 #include <errno.h>
+#include <time.h>
+
+#define REQ_BYTES 8                 // FC03/FC06 request (and FC06 echo)
+
+static uint32_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL);
+}
 
 modbus_t* rs485_init(const char* device, int baud, char parity, int data_bit, int stop_bit) {
     modbus_t *ctx = modbus_new_rtu(device, baud, parity, data_bit, stop_bit);
@@ -12,50 +24,126 @@ modbus_t* rs485_init(const char* device, int baud, char parity, int data_bit, in
         modbus_free(ctx);
         return NULL;
     }
+    // Timeouts sized for the baud rate instead of libmodbus' fixed 500 ms
+    rs485_timing_apply_defaults(ctx, (uint32_t)baud);
+    rs485_stats_bind(ctx, rs485_stats_bus_open(device));
     return ctx;
 }
 
 int rs485_read_raw(modbus_t *ctx, int slave_id, int reg_addr, uint16_t *out_value) {
-    if (ctx == NULL) return -1;
+    return rs485_read_block(ctx, slave_id, reg_addr, 1, out_value);
+}
+
+int rs485_read_block(modbus_t *ctx, int slave_id, int start_addr, int count, uint16_t *out_values) {
+    if (ctx == NULL || out_values == NULL) return -1;
+    if (count <= 0 || count > MODBUS_MAX_READ_REGISTERS) return -1;
 
+    int bus = rs485_stats_bus_of(ctx);
     // Set the target slave for this specific transaction 
     if (modbus_set_slave(ctx, slave_id) == -1) {
-        fprintf(stderr, "RS485: Failed to set slave ID 0x%02X\n", slave_id);
+        LOGGER_E(LOGGER_COMP_RS485, "Failed to set slave ID 0x%02X", slave_id);
+        rs485_stats_record(bus, slave_id, RS485_RESULT_IO, 0, 0, 0);
         return -1;
     }
 
-    uint16_t buffer[1];
-    // Perform the physical read 
-    if (modbus_read_registers(ctx, reg_addr, 1, buffer) == -1) {
-        fprintf(stderr, "RS485 Error: Slave 0x%02X, Reg 0x%04X - %s\n", 
-                slave_id, reg_addr, modbus_strerror(errno));
+    // Perform the physical read (one FC03 transaction for the whole range)
+    uint32_t start = now_us();
+    if (modbus_read_registers(ctx, start_addr, count, out_values) == -1) {
+        int err = errno;
+        rs485_stats_record(bus, slave_id, rs485_stats_result_from_errno(err), REQ_BYTES, 0, now_us() - start);
+        LOGGER_E(LOGGER_COMP_RS485, "Slave 0x%02X, Reg 0x%04X (x%d) - %s",
+                 slave_id, start_addr, count, modbus_strerror(err));
         return -1;
     }
-
-    *out_value = buffer[0];
+    rs485_stats_record(bus, slave_id, RS485_RESULT_OK, REQ_BYTES, (uint32_t)(5 + 2 * count), now_us() - start);
     return 0;
 }
 
+/*---------------------------- Read plan --------------------------------*/
+static int ref_less(const rs485_reg_ref_t *a, const rs485_reg_ref_t *b) {
+    if (a->slave_id != b->slave_id) return a->slave_id < b->slave_id;
+    return a->reg_addr < b->reg_addr;
+}
+
+int rs485_plan_build(rs485_read_plan_t *plan, const rs485_reg_ref_t *regs, int n_regs, int max_gap) {
+    if (plan == NULL || regs == NULL) return -1;
+    if (n_regs <= 0 || n_regs > RS485_PLAN_MAX_REGS || max_gap < 0) return -1;
+
+    // Sort request indices by (slave, register); insertion sort is enough for <= 64 entries
+    uint8_t order[RS485_PLAN_MAX_REGS];
+    for (int i = 0; i < n_regs; i++) {
+        int j = i;
+        while (j > 0 && ref_less(&regs[i], &regs[order[j - 1]])) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint8_t)i;
+    }
+
+    plan->n_blocks = 0;
+    plan->n_regs = n_regs;
+    rs485_block_t *cur = NULL;
+
+    for (int k = 0; k < n_regs; k++) {
+        const rs485_reg_ref_t *ref = &regs[order[k]];
+        int need_new = (cur == NULL) || (cur->slave_id != ref->slave_id);
+
+        if (!need_new) {
+            int end = cur->start_addr + cur->count - 1;
+            int span = ref->reg_addr - cur->start_addr + 1;
+            if (ref->reg_addr > end + max_gap + 1 || span > MODBUS_MAX_READ_REGISTERS) {
+                need_new = 1;
+            } else if (ref->reg_addr > end) {
+                cur->count = (uint16_t)span;
+            }
+        }
+
+        if (need_new) {
+            if (plan->n_blocks >= RS485_PLAN_MAX_BLOCKS) return -1;
+            cur = &plan->blocks[plan->n_blocks++];
+            cur->slave_id = ref->slave_id;
+            cur->start_addr = ref->reg_addr;
+            cur->count = 1;
+        }
+
+        plan->ref_block[order[k]] = (uint8_t)(plan->n_blocks - 1);
+        plan->ref_offset[order[k]] = (uint8_t)(ref->reg_addr - cur->start_addr);
+    }
+    return plan->n_blocks;
+}
+
+int rs485_plan_execute(modbus_t *ctx, const rs485_read_plan_t *plan, uint16_t *out_values, uint8_t *out_valid) {
+    return rs485_plan_execute_timed(ctx, NULL, plan, out_values, out_valid);
+}
+
 int rs485_write_raw(modbus_t *ctx, int slave_id, int reg_addr, uint16_t value) {
     if (ctx == NULL) return -1;
 
+    int bus = rs485_stats_bus_of(ctx);
     // Target the specific sensor
     if (modbus_set_slave(ctx, slave_id) == -1) {
-        fprintf(stderr, "RS485 WRITE ERROR: Invalid slave ID 0x%02X\n", slave_id);
+        LOGGER_E(LOGGER_COMP_RS485, "Write: invalid slave ID 0x%02X", slave_id);
+        rs485_stats_record(bus, slave_id, RS485_RESULT_IO, 0, 0, 0);
         return -1;
     }
 
     // Perform the write operation
+    uint32_t start = now_us();
     if (modbus_write_register(ctx, reg_addr, value) == -1) {
-        fprintf(stderr, "RS485 WRIodbus_new_rtTE ERROR [ID 0x%02X, Reg 0x%04X]: %s\n", 
-                slave_id, reg_addr, modbus_strerror(errno));
+        int err = errno;
+        rs485_stats_record(bus, slave_id, rs485_stats_result_from_errno(err), REQ_BYTES, 0, now_us() - start);
+        LOGGER_E(LOGGER_COMP_RS485, "Write [ID 0x%02X, Reg 0x%04X]: %s",
+                 slave_id, reg_addr, modbus_strerror(err));
         return -1;
     }
+    rs485_stats_record(bus, slave_id, RS485_RESULT_OK, REQ_BYTES, REQ_BYTES, now_us() - start);
     return 0;
 }
 
 void rs485_close(modbus_t *ctx) {
     if (ctx != NULL) {
+        rs485_stats_unbind(ctx);
+        modbus_close(ctx);
         modbus_free(ctx);
     }
 }
@@ -0,0 +1,208 @@
+#include "rs485_bus.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define MAX_SLAVE_ID 247
+
+struct rs485_bus_registry {
+    pthread_mutex_t lock;           // Protects the tables below; never held during bus I/O
+    rs485_poller_t *buses[RS485_MAX_BUSES];
+    int n_buses;
+    int8_t slave_bus[MAX_SLAVE_ID + 1];
+    int running;
+    rs485_sample_queue_t *queue;    // Shared by every bus
+};
+
+/*---------------------------- Private Function --------------------------------*/
+// Bus of a slave, falling back to bus 0. Called with r->lock held.
+static int route(const rs485_bus_registry_t *r, int slave_id) {
+    if (slave_id < 0 || slave_id > MAX_SLAVE_ID || r->n_buses == 0) return RS485_BUS_NONE;
+    int bus = r->slave_bus[slave_id];
+    return (bus == RS485_BUS_NONE) ? 0 : bus;
+}
+
+// Called with r->lock held
+static int split_sensor_id(const rs485_bus_registry_t *r, int sensor_id, int *local_id) {
+    if (sensor_id < 0) return RS485_BUS_NONE;
+    int bus = sensor_id / RS485_POLL_MAX_SENSORS;
+    if (bus >= r->n_buses) return RS485_BUS_NONE;
+    *local_id = sensor_id % RS485_POLL_MAX_SENSORS;
+    return bus;
+}
+
+/*------------------------ Public Function -----------------------------*/
+rs485_bus_registry_t* rs485_bus_registry_create(void) {
+    rs485_bus_registry_t *r = calloc(1, sizeof(*r));
+    if (r == NULL) return NULL;
+
+    r->queue = rs485_sample_queue_create();
+    if (r->queue == NULL) {
+        free(r);
+        return NULL;
+    }
+    memset(r->slave_bus, RS485_BUS_NONE, sizeof(r->slave_bus));
+    pthread_mutex_init(&r->lock, NULL);
+    return r;
+}
+
+int rs485_bus_add(rs485_bus_registry_t *r, const char* device, int baud, char parity, int data_bit, int stop_bit) {
+    if (r == NULL || device == NULL) return -1;
+
+    pthread_mutex_lock(&r->lock);
+    if (r->n_buses == RS485_MAX_BUSES || r->running) {
+        pthread_mutex_unlock(&r->lock);
+        LOGGER_E(LOGGER_COMP_RS485, "Bus: cannot add %s (registry full or running)", device);
+        return -1;
+    }
+    rs485_poller_t *p = rs485_poller_create(device, baud, parity, data_bit, stop_bit);
+    if (p == NULL) {
+        pthread_mutex_unlock(&r->lock);
+        return -1;
+    }
+    int id = r->n_buses++;
+    rs485_poller_attach_queue(p, r->queue, id);
+    r->buses[id] = p;
+    pthread_mutex_unlock(&r->lock);
+    return id;
+}
+
+int rs485_bus_route_slave(rs485_bus_registry_t *r, int slave_id, int bus_id) {
+    if (r == NULL || slave_id < 0 || slave_id > MAX_SLAVE_ID) return -1;
+
+    pthread_mutex_lock(&r->lock);
+    if (bus_id < 0 || bus_id >= r->n_buses) {
+        pthread_mutex_unlock(&r->lock);
+        return -1;
+    }
+    r->slave_bus[slave_id] = (int8_t)bus_id;
+    pthread_mutex_unlock(&r->lock);
+    return 0;
+}
+
+int rs485_bus_find_slave(rs485_bus_registry_t *r, int slave_id) {
+    if (r == NULL || slave_id < 0 || slave_id > MAX_SLAVE_ID) return RS485_BUS_NONE;
+
+    pthread_mutex_lock(&r->lock);
+    int bus = r->slave_bus[slave_id];
+    pthread_mutex_unlock(&r->lock);
+    return bus;
+}
+
+int rs485_bus_add_sensor(rs485_bus_registry_t *r, int slave_id, const uint16_t *regs, int n_regs, uint32_t period_ms) {
+    if (r == NULL) return -1;
+
+    pthread_mutex_lock(&r->lock);
+    int bus = route(r, slave_id);
+    rs485_poller_t *p = (bus == RS485_BUS_NONE) ? NULL : r->buses[bus];
+    pthread_mutex_unlock(&r->lock);
+    if (p == NULL) return -1;
+
+    int local = rs485_poller_add_sensor(p, slave_id, regs, n_regs, period_ms);
+    return (local < 0) ? -1 : bus * RS485_POLL_MAX_SENSORS + local;
+}
+
+int rs485_bus_set_period(rs485_bus_registry_t *r, int sensor_id, uint32_t period_ms) {
+    if (r == NULL) return -1;
+    int local;
+    pthread_mutex_lock(&r->lock);
+    int bus = split_sensor_id(r, sensor_id, &local);
+    rs485_poller_t *p = (bus == RS485_BUS_NONE) ? NULL : r->buses[bus];
+    pthread_mutex_unlock(&r->lock);
+    if (p == NULL) return -1;
+    return rs485_poller_set_period(p, local, period_ms);
+}
+
+int rs485_bus_start(rs485_bus_registry_t *r) {
+    if (r == NULL) return -1;
+
+    pthread_mutex_lock(&r->lock);
+    for (int i = 0; i < r->n_buses; i++) {
+        if (rs485_poller_start(r->buses[i]) != 0) {
+            for (int j = 0; j < i; j++) rs485_poller_stop(r->buses[j]);
+            pthread_mutex_unlock(&r->lock);
+            return -1;
+        }
+    }
+    r->running = 1;
+    pthread_mutex_unlock(&r->lock);
+    return 0;
+}
+
+void rs485_bus_stop(rs485_bus_registry_t *r) {
+    if (r == NULL) return;
+
+    pthread_mutex_lock(&r->lock);
+    for (int i = 0; i < r->n_buses; i++) rs485_poller_stop(r->buses[i]);
+    r->running = 0;
+    pthread_mutex_unlock(&r->lock);
+}
+
+int rs485_bus_get_samples(rs485_bus_registry_t *r, rs485_sample_t *out, int max, int timeout_ms) {
+    if (r == NULL) return -1;
+
+    int n = rs485_sample_queue_get(r->queue, out, max, timeout_ms);
+    for (int i = 0; i < n; i++) {
+        out[i].sensor_id += out[i].bus_id * RS485_POLL_MAX_SENSORS;  // Local to global ID
+    }
+    return n;
+}
+
+uint64_t rs485_bus_dropped(rs485_bus_registry_t *r) {
+    return r ? rs485_sample_queue_dropped(r->queue) : 0;
+}
+
+int rs485_bus_submit(rs485_bus_registry_t *r, int slave_id, rs485_job_fn fn, void *arg) {
+    if (r == NULL) return -1;
+
+    pthread_mutex_lock(&r->lock);
+    int bus = route(r, slave_id);
+    rs485_poller_t *p = (bus == RS485_BUS_NONE) ? NULL : r->buses[bus];
+    pthread_mutex_unlock(&r->lock);
+    if (p == NULL) return -1;
+    return rs485_poller_submit(p, fn, arg);
+}
+
+int rs485_bus_slave_health(rs485_bus_registry_t *r, int slave_id, rs485_slave_health_t *out) {
+    if (r == NULL) return -1;
+
+    pthread_mutex_lock(&r->lock);
+    int bus = route(r, slave_id);
+    rs485_poller_t *p = (bus == RS485_BUS_NONE) ? NULL : r->buses[bus];
+    pthread_mutex_unlock(&r->lock);
+    return rs485_poller_slave_health(p, slave_id, out);
+}
+
+int rs485_bus_negotiate_baud(rs485_bus_registry_t *r, int bus_id, uint16_t baud_reg, uint16_t probe_reg,
+                             const rs485_baud_option_t *options, int n_options) {
+    return rs485_poller_negotiate_baud(rs485_bus_poller(r, bus_id), baud_reg, probe_reg, options, n_options);
+}
+
+rs485_poller_t* rs485_bus_poller(rs485_bus_registry_t *r, int bus_id) {
+    if (r == NULL || bus_id < 0) return NULL;
+
+    pthread_mutex_lock(&r->lock);
+    rs485_poller_t *p = (bus_id < r->n_buses) ? r->buses[bus_id] : NULL;
+    pthread_mutex_unlock(&r->lock);
+    return p;
+}
+
+int rs485_bus_count(rs485_bus_registry_t *r) {
+    if (r == NULL) return 0;
+
+    pthread_mutex_lock(&r->lock);
+    int n = r->n_buses;
+    pthread_mutex_unlock(&r->lock);
+    return n;
+}
+
+void rs485_bus_registry_destroy(rs485_bus_registry_t *r) {
+    if (r == NULL) return;
+    rs485_bus_stop(r);
+    for (int i = 0; i < r->n_buses; i++) rs485_poller_destroy(r->buses[i]);
+    rs485_sample_queue_destroy(r->queue);
+    pthread_mutex_destroy(&r->lock);
+    free(r);
+}
@@ -0,0 +1,248 @@
+#include "rs485_discovery.h"
+#include "rs485_timing.h"
+#include "logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+#define FIRST_SLAVE_ID 1            // 0 is the broadcast address, nobody answers it
+#define LAST_SLAVE_ID 247
+#define REG_SLAVE_ID 0x0100
+#define READ_REQ_BYTES 8
+
+// One slice of a bus scan, run on the thread that owns the context
+typedef struct {
+    uint32_t baud;
+    int first_id;
+    int last_id;
+    uint32_t turnaround_us;
+    int bus_id;
+    rs485_device_map_t *map;
+} scan_job_t;
+
+typedef struct {
+    rs485_poller_t *poller;
+    int bus_id;
+    int first_id;
+    int last_id;
+    uint32_t turnaround_us;
+    rs485_device_map_t map;     // Devices of this bus only
+    pthread_t thread;
+    int started;
+} bus_scan_t;
+
+/*---------------------------- Private Function --------------------------------*/
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void set_timeouts(modbus_t *ctx, uint32_t response_us, uint32_t byte_us) {
+    modbus_set_response_timeout(ctx, response_us / 1000000u, response_us % 1000000u);
+    modbus_set_byte_timeout(ctx, byte_us / 1000000u, byte_us % 1000000u);
+}
+
+// Reads the configuration registers. Returns 0 on a valid answer, else the errno of the failure.
+static int read_config(modbus_t *ctx, int slave_id, uint16_t *regs) {
+    if (modbus_set_slave(ctx, slave_id) == -1) return EINVAL;
+    errno = 0;
+    if (modbus_read_registers(ctx, REG_SLAVE_ID, 2, regs) == 2) return 0;
+    return errno ? errno : EIO;
+}
+
+static int is_exception(int err) {
+    return err >= EMBXILFUN && err <= EMBXGTAR;
+}
+
+// Models whose data block the slave answers. Called with the normal timeouts in place.
+static uint32_t match_models(modbus_t *ctx, int slave_id) {
+    uint32_t candidates = 0;
+    uint16_t block[MODBUS_MAX_READ_REGISTERS];
+    if (modbus_set_slave(ctx, slave_id) == -1) return 0;
+    for (int i = 0; i < rs485_driver_count(); i++) {
+        const rs485_sensor_desc_t *d = rs485_driver_get(i);
+        if (modbus_read_registers(ctx, d->block_start, d->block_count, block) == d->block_count) candidates |= 1u << i;
+    }
+    return candidates;
+}
+
+// A device answering a wide block also answers the narrower blocks inside it: the widest wins,
+// a tie (same layout, e.g. two gas sensors) leaves the model to the caller
+static const rs485_sensor_desc_t* best_candidate(uint32_t candidates) {
+    const rs485_sensor_desc_t *best = NULL;
+    int tie = 0;
+    for (int i = 0; i < rs485_driver_count(); i++) {
+        const rs485_sensor_desc_t *d = rs485_driver_get(i);
+        if (!(candidates & (1u << i))) continue;
+        if (best == NULL || d->block_count > best->block_count) {
+            best = d;
+            tie = 0;
+        } else if (d->block_count == best->block_count) {
+            tie = 1;
+        }
+    }
+    return tie ? NULL : best;
+}
+
+static int scan_range(modbus_t *ctx, const scan_job_t *job) {
+    rs485_timing_t wire;
+    rs485_timing_init(&wire, job->baud);
+    // libmodbus starts the response clock when write() returns, before the request has left the UART
+    uint32_t quick_us = (READ_REQ_BYTES + 1) * wire.char_us + job->turnaround_us + wire.slack_us;
+    uint32_t byte_us = 4 * wire.char_us + wire.slack_us;
+
+    uint32_t saved_s, saved_us, saved_byte_s, saved_byte_us;
+    modbus_get_response_timeout(ctx, &saved_s, &saved_us);
+    modbus_get_byte_timeout(ctx, &saved_byte_s, &saved_byte_us);
+
+    int found = 0;
+    for (int id = job->first_id; id <= job->last_id; id++) {
+        uint16_t regs[2] = { 0, 0 };
+        set_timeouts(ctx, quick_us, byte_us);
+        int err = read_config(ctx, id, regs);
+        if (err == ETIMEDOUT) continue;     // Nobody there: the common case, one short timeout
+
+        // Something answered: let the line settle, then confirm with the normal timeouts
+        modbus_flush(ctx);
+        usleep(wire.frame_gap_us);
+        rs485_timing_apply_defaults(ctx, job->baud);
+        err = read_config(ctx, id, regs);
+        if (err != 0 && !is_exception(err)) continue;   // Late answer of another address, or noise
+
+        if (job->map->n_devices >= RS485_DISCOVERY_MAX_DEVICES) {
+            LOGGER_W(LOGGER_COMP_RS485, "Discovery: more than %d devices, 0x%02X and above ignored",
+                     RS485_DISCOVERY_MAX_DEVICES, id);
+            break;
+        }
+        rs485_device_t *dev = &job->map->devices[job->map->n_devices++];
+        memset(dev, 0, sizeof(*dev));
+        dev->bus_id = job->bus_id;
+        dev->slave_id = (uint8_t)id;
+        dev->addr_value = regs[0];
+        dev->baud_code = regs[1];
+        dev->signature = (err == 0 && regs[0] == id);
+        dev->candidates = dev->signature ? match_models(ctx, id) : 0;
+        dev->model = best_candidate(dev->candidates);
+        dev->period_ms = RS485_DISCOVERY_PERIOD_MS;
+        dev->sensor_id = -1;
+        found++;
+    }
+
+    modbus_set_response_timeout(ctx, saved_s, saved_us);
+    modbus_set_byte_timeout(ctx, saved_byte_s, saved_byte_us);
+    return found;
+}
+
+static int scan_job(modbus_t *ctx, void *arg) {
+    return (ctx == NULL) ? -1 : scan_range(ctx, (const scan_job_t*)arg);
+}
+
+// One thread per bus; chunks go through the poller so a running bus keeps polling in between
+static void* bus_scan_thread(void *arg) {
+    bus_scan_t *scan = (bus_scan_t*)arg;
+    for (int first = scan->first_id; first <= scan->last_id; first += RS485_DISCOVERY_CHUNK) {
+        int last = first + RS485_DISCOVERY_CHUNK - 1;
+        scan_job_t job = {
+            .baud = (uint32_t)rs485_poller_baud(scan->poller),
+            .first_id = first,
+            .last_id = (last < scan->last_id) ? last : scan->last_id,
+            .turnaround_us = scan->turnaround_us,
+            .bus_id = scan->bus_id,
+            .map = &scan->map,
+        };
+        if (rs485_poller_submit(scan->poller, scan_job, &job) < 0) break;
+        if (scan->map.n_devices >= RS485_DISCOVERY_MAX_DEVICES) break;
+    }
+    return NULL;
+}
+
+static void clamp_range(int *first_id, int *last_id) {
+    if (*first_id < FIRST_SLAVE_ID) *first_id = FIRST_SLAVE_ID;
+    if (*last_id > LAST_SLAVE_ID) *last_id = LAST_SLAVE_ID;
+}
+
+/*------------------------ Public Function -----------------------------*/
+int rs485_discovery_scan(modbus_t *ctx, uint32_t baud, int first_id, int last_id, uint32_t turnaround_us,
+                         int bus_id, rs485_device_map_t *map) {
+    if (ctx == NULL || map == NULL || baud == 0) return -1;
+    clamp_range(&first_id, &last_id);
+    scan_job_t job = {
+        .baud = baud,
+        .first_id = first_id,
+        .last_id = last_id,
+        .turnaround_us = turnaround_us ? turnaround_us : RS485_DISCOVERY_TURNAROUND_US,
+        .bus_id = bus_id,
+        .map = map,
+    };
+    return (first_id > last_id) ? 0 : scan_range(ctx, &job);
+}
+
+int rs485_bus_discover(rs485_bus_registry_t *r, int first_id, int last_id, uint32_t turnaround_us,
+                       rs485_device_map_t *map) {
+    if (r == NULL || map == NULL) return -1;
+    clamp_range(&first_id, &last_id);
+    map->n_devices = 0;
+
+    int n_buses = rs485_bus_count(r);
+    if (n_buses == 0 || first_id > last_id) return 0;
+    bus_scan_t *scans = calloc((size_t)n_buses, sizeof(*scans));
+    if (scans == NULL) return -1;
+
+    uint64_t start = now_ns();
+    for (int b = 0; b < n_buses; b++) {
+        scans[b].poller = rs485_bus_poller(r, b);
+        scans[b].bus_id = b;
+        scans[b].first_id = first_id;
+        scans[b].last_id = last_id;
+        scans[b].turnaround_us = turnaround_us ? turnaround_us : RS485_DISCOVERY_TURNAROUND_US;
+        scans[b].started = (pthread_create(&scans[b].thread, NULL, bus_scan_thread, &scans[b]) == 0);
+        if (!scans[b].started) bus_scan_thread(&scans[b]);     // Scan this bus on the caller instead
+    }
+
+    // Buses in order, each already sorted by address
+    for (int b = 0; b < n_buses; b++) {
+        if (scans[b].started) pthread_join(scans[b].thread, NULL);
+        for (int i = 0; i < scans[b].map.n_devices && map->n_devices < RS485_DISCOVERY_MAX_DEVICES; i++) {
+            rs485_device_t *dev = &map->devices[map->n_devices++];
+            *dev = scans[b].map.devices[i];
+            rs485_bus_route_slave(r, dev->slave_id, dev->bus_id);
+        }
+    }
+    free(scans);
+
+    LOGGER_I(LOGGER_COMP_RS485, "Discovery: %d device(s) at 0x%02X..0x%02X on %d bus(es) in %llu ms",
+             map->n_devices, first_id, last_id, n_buses, (unsigned long long)((now_ns() - start) / 1000000ULL));
+    return map->n_devices;
+}
+
+int rs485_bus_load_map(rs485_bus_registry_t *r, rs485_device_map_t *map) {
+    if (r == NULL || map == NULL) return -1;
+
+    int added = 0;
+    for (int i = 0; i < map->n_devices; i++) {
+        rs485_device_t *dev = &map->devices[i];
+        if (dev->model == NULL || dev->sensor_id >= 0) continue;
+        // A re-scan finds the devices already polled too; only new ones are added
+        if (rs485_poller_has_slave(rs485_bus_poller(r, dev->bus_id), dev->slave_id)) continue;
+
+        uint16_t regs[RS485_DRIVER_MAX_VALUES];
+        for (int v = 0; v < dev->model->n_values; v++) regs[v] = dev->model->values[v].reg_addr;
+        if (rs485_bus_route_slave(r, dev->slave_id, dev->bus_id) != 0) continue;
+        uint32_t period_ms = dev->period_ms ? dev->period_ms : RS485_DISCOVERY_PERIOD_MS;
+        dev->sensor_id = rs485_bus_add_sensor(r, dev->slave_id, regs, dev->model->n_values, period_ms);
+        if (dev->sensor_id >= 0) added++;
+    }
+    return added;
+}
+
+const rs485_device_t* rs485_device_map_find(const rs485_device_map_t *map, const rs485_sensor_desc_t *desc) {
+    if (map == NULL || desc == NULL) return NULL;
+    for (int i = 0; i < map->n_devices; i++) {
+        if (map->devices[i].model == desc) return &map->devices[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,113 @@
+#include "rs485_driver.h"
+#include "air_rs485.h"
+#include "logger.h"
+#include <string.h>
+
+#define REG_SLAVE_ID 0x0100     // Configuration registers shared by the EP sensor family
+#define REG_BAUD 0x0101
+
+const rs485_sensor_desc_t rs485_sensor_epam = {
+    .model = "EPAM",
+    .block_start = 0x0004,
+    .block_count = 6,           // 0x0004 .. 0x0009
+    .addr_reg = REG_SLAVE_ID,
+    .baud_reg = REG_BAUD,
+    .n_values = 2,
+    .values = {
+        { "pm25", "ug/m3", 0x0004, 1.0f, 0.0f },
+        { "pm10", "ug/m3", 0x0009, 1.0f, 0.0f },
+    },
+};
+
+const rs485_sensor_desc_t rs485_sensor_epco = {
+    .model = "EPCO",
+    .block_start = 0x0006,
+    .block_count = 1,
+    .addr_reg = REG_SLAVE_ID,
+    .baud_reg = REG_BAUD,
+    .n_values = 1,
+    .values = {
+        { "co", "ppm", 0x0006, 0.01f, -0.5f },
+    },
+};
+
+const rs485_sensor_desc_t rs485_sensor_epno2 = {
+    .model = "EPNO2",
+    .block_start = 0x0006,
+    .block_count = 1,
+    .addr_reg = REG_SLAVE_ID,
+    .baud_reg = REG_BAUD,
+    .n_values = 1,
+    .values = {
+        { "no2", "ppm", 0x0006, 0.01f, 0.0f },
+    },
+};
+
+static const rs485_sensor_desc_t *const models[] = {
+    &rs485_sensor_epam,
+    &rs485_sensor_epco,
+    &rs485_sensor_epno2,
+};
+
+#define N_MODELS ((int)(sizeof(models) / sizeof(models[0])))
+
+/*---------------------------- Private Function --------------------------------*/
+static int read_values(modbus_t *ctx, int slave_id, const rs485_sensor_desc_t *desc, float *out_values) {
+    uint16_t block[MODBUS_MAX_READ_REGISTERS];
+    if (ctx == NULL || desc == NULL || out_values == NULL) {
+        return AIR_RS485_E_INVALID;
+    }
+    if (rs485_read_block(ctx, slave_id, desc->block_start, desc->block_count, block) != 0) {
+        LOGGER_W(LOGGER_COMP_RS485, "%s 0x%02X: read failed", desc->model, slave_id);
+        return AIR_RS485_E_BUS;
+    }
+    rs485_driver_decode(desc, block, out_values);
+    return AIR_RS485_SUCCESS;
+}
+
+/*------------------------ Public Function -----------------------------*/
+const rs485_sensor_desc_t* rs485_driver_find(const char *model) {
+    if (model == NULL) return NULL;
+    for (int i = 0; i < N_MODELS; i++) {
+        if (strcmp(models[i]->model, model) == 0) return models[i];
+    }
+    return NULL;
+}
+
+int rs485_driver_count(void) {
+    return N_MODELS;
+}
+
+const rs485_sensor_desc_t* rs485_driver_get(int index) {
+    return (index >= 0 && index < N_MODELS) ? models[index] : NULL;
+}
+
+void rs485_driver_decode(const rs485_sensor_desc_t *desc, const uint16_t *block, float *out_values) {
+    for (int i = 0; i < desc->n_values; i++) {
+        const rs485_value_desc_t *v = &desc->values[i];
+        out_values[i] = (float)block[v->reg_addr - desc->block_start] * v->scale + v->offset;
+    }
+}
+
+int rs485_driver_read(modbus_t *ctx, int slave_id, const rs485_sensor_desc_t *desc, float *out_values) {
+    return read_values(ctx, slave_id, desc, out_values) == AIR_RS485_SUCCESS ? 0 : -1;
+}
+
+int air_rs485_read_epam(modbus_t *ctx, int slave_id, float *pm25, float *pm10) {
+    float values[2];
+    if (pm25 == NULL || pm10 == NULL) return AIR_RS485_E_INVALID;
+    int rc = read_values(ctx, slave_id, &rs485_sensor_epam, values);
+    if (rc == AIR_RS485_SUCCESS) {
+        *pm25 = values[0];
+        *pm10 = values[1];
+    }
+    return rc;
+}
+
+int air_rs485_read_epco(modbus_t *ctx, int slave_id, float *co_ppm) {
+    return read_values(ctx, slave_id, &rs485_sensor_epco, co_ppm);
+}
+
+int air_rs485_read_epno2(modbus_t *ctx, int slave_id, float *no2_ppm) {
+    return read_values(ctx, slave_id, &rs485_sensor_epno2, no2_ppm);
+}
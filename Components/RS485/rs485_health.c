@@ -0,0 +1,84 @@
+#include "rs485_health.h"
+#include "logger.h"
+#include <string.h>
+
+/*---------------------------- Private Function --------------------------------*/
+static rs485_slave_health_t* slave_of(rs485_health_t *h, int slave_id) {
+    if (h == NULL || slave_id < 0 || slave_id > RS485_HEALTH_MAX_SLAVE) return NULL;
+    return &h->slaves[slave_id];
+}
+
+static void schedule_probe(rs485_slave_health_t *s, uint64_t now_ns) {
+    s->next_probe_ns = now_ns + (uint64_t)s->probe_interval_ms * 1000000ULL;
+}
+
+/*------------------------ Public Function -----------------------------*/
+void rs485_health_init(rs485_health_t *h, uint32_t fail_threshold, uint32_t probe_min_ms, uint32_t probe_max_ms) {
+    if (h == NULL) return;
+    memset(h->slaves, 0, sizeof(h->slaves));
+    h->fail_threshold = fail_threshold ? fail_threshold : RS485_HEALTH_FAIL_THRESHOLD;
+    h->probe_min_ms = probe_min_ms ? probe_min_ms : RS485_HEALTH_PROBE_MIN_MS;
+    h->probe_max_ms = probe_max_ms ? probe_max_ms : RS485_HEALTH_PROBE_MAX_MS;
+    if (h->probe_max_ms < h->probe_min_ms) h->probe_max_ms = h->probe_min_ms;
+}
+
+int rs485_health_check(rs485_health_t *h, int slave_id, uint64_t now_ns) {
+    rs485_slave_health_t *s = slave_of(h, slave_id);
+    if (s == NULL || s->state != RS485_SLAVE_OFFLINE) return RS485_HEALTH_POLL;
+    if (now_ns >= s->next_probe_ns) return RS485_HEALTH_PROBE;
+    s->skipped++;
+    return RS485_HEALTH_SKIP;
+}
+
+int rs485_health_record(rs485_health_t *h, int slave_id, int ok, uint64_t now_ns) {
+    rs485_slave_health_t *s = slave_of(h, slave_id);
+    if (s == NULL) return 0;
+
+    if (ok) {
+        s->state = RS485_SLAVE_HEALTHY;
+        s->consecutive_failures = 0;
+        return 0;
+    }
+
+    s->consecutive_failures++;
+    if (s->state == RS485_SLAVE_OFFLINE || s->consecutive_failures < h->fail_threshold) {
+        if (s->state != RS485_SLAVE_OFFLINE) s->state = RS485_SLAVE_FAILING;
+        return 0;
+    }
+
+    s->state = RS485_SLAVE_OFFLINE;
+    s->outages++;
+    s->offline_since_ns = now_ns;
+    s->probe_interval_ms = h->probe_min_ms;
+    schedule_probe(s, now_ns);
+    LOGGER_W(LOGGER_COMP_RS485, "Slave 0x%02X offline after %u failed polls, probing every %u ms",
+             slave_id, s->consecutive_failures, s->probe_interval_ms);
+    return 1;
+}
+
+int rs485_health_probe_done(rs485_health_t *h, int slave_id, int ok, uint64_t now_ns) {
+    rs485_slave_health_t *s = slave_of(h, slave_id);
+    if (s == NULL || s->state != RS485_SLAVE_OFFLINE) return 0;
+    s->probes++;
+
+    if (ok) {
+        LOGGER_I(LOGGER_COMP_RS485, "Slave 0x%02X back online after %llu ms", slave_id,
+                 (unsigned long long)((now_ns - s->offline_since_ns) / 1000000ULL));
+        s->state = RS485_SLAVE_HEALTHY;
+        s->consecutive_failures = 0;
+        s->offline_since_ns = 0;
+        return 1;
+    }
+
+    s->probe_interval_ms = (s->probe_interval_ms > h->probe_max_ms / 2) ? h->probe_max_ms : s->probe_interval_ms * 2;
+    schedule_probe(s, now_ns);
+    return 0;
+}
+
+int rs485_health_probe(modbus_t *ctx, rs485_timing_t *t, int slave_id) {
+    uint16_t dummy;
+    if (ctx == NULL || slave_id < 0 || slave_id > RS485_HEALTH_MAX_SLAVE) return -1;
+    // The timeouts of the failed polls raised the backoff; the probe must stay cheap
+    if (t != NULL && slave_id <= RS485_TIMING_MAX_SLAVE) t->slaves[slave_id].backoff = 1;
+    return (rs485_read_block_timed(ctx, t, slave_id, RS485_HEALTH_PROBE_REG, 1, &dummy) == 0) ? 0 : -1;
+}
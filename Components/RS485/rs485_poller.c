@@ -0,0 +1,707 @@
+#define _GNU_SOURCE
+#include "rs485_poller.h"
+#include "rs485_timing.h"
+#include "rs485_health.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>   // mlockall
+#include <sys/prctl.h>  // PR_SET_TIMERSLACK
+#include <sys/timerfd.h>
+
+typedef struct {
+    uint8_t slave_id;
+    int n_regs;
+    uint32_t period_ms;
+    uint64_t next_deadline_ns;   // CLOCK_MONOTONIC
+    uint64_t last_lateness_us;   // Of the previous poll, for the jitter
+    int polled;                  // The sensor has been polled at least once
+    rs485_read_plan_t plan;
+} poll_sensor_t;
+
+struct rs485_sample_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    rs485_sample_t buf[RS485_SAMPLE_QUEUE_LEN];
+    int head;
+    int len;
+    uint64_t dropped;
+};
+
+// Transaction submitted from another thread, executed by the poller thread between polls
+typedef struct poll_job {
+    rs485_job_fn fn;
+    void *arg;
+    int result;
+    int done;
+    struct poll_job *next;
+} poll_job_t;
+
+struct rs485_poller {
+    modbus_t *ctx;
+    int bus_id;
+
+    // Port settings, kept to reopen the port after a baud change
+    char device[64];
+    int baud;                   // Atomic: changed by negotiate_job(), read by discovery threads
+    char parity;
+    int data_bit;
+    int stop_bit;
+    rs485_timing_t timing;      // Only touched by the thread that owns ctx
+    rs485_health_t health;      // Updated by the thread that owns ctx, under lock so it can be queried
+
+    // Schedule (protected by lock)
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    poll_sensor_t sensors[RS485_POLL_MAX_SENSORS];
+    int n_sensors;
+    int heap[RS485_POLL_MAX_SENSORS];   // Min-heap of sensor IDs ordered by next_deadline_ns
+    int heap_len;
+    int running;
+    pthread_t thread;
+
+    rs485_sample_cb cb;
+    void *cb_data;
+
+    // Pending jobs (protected by lock), FIFO
+    poll_job_t *jobs_head;
+    poll_job_t *jobs_tail;
+    pthread_cond_t job_done;
+
+    // Real-time mode: the thread sleeps in poll() on both descriptors instead of on the condition
+    rs485_rt_config_t rt;
+    int timer_fd;               // Armed with the next deadline, -1 outside real-time mode
+    int event_fd;               // Signalled whenever the condition is, -1 outside real-time mode
+    rs485_poll_timing_t timing_stats;  // Protected by lock
+
+    // Finished samples: own queue, or one shared with other pollers
+    rs485_sample_queue_t *queue;
+    rs485_sample_queue_t *own_queue;
+    uint32_t seq;       // Only touched by the poller thread
+};
+
+/*---------------------------- Private Function --------------------------------*/
+static uint64_t now_ns(clockid_t clk) {
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static struct timespec ns_to_timespec(uint64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+// Wakes the poller thread. Called with p->lock held.
+static void wake_thread(rs485_poller_t *p) {
+    pthread_cond_signal(&p->wake);
+    if (p->event_fd >= 0) {
+        uint64_t one = 1;
+        if (write(p->event_fd, &one, sizeof(one)) < 0) {}  // Counter already non-zero: a wakeup is pending
+    }
+}
+
+// Sleeps until deadline_ns (CLOCK_MONOTONIC, 0 for no deadline) or until woken.
+// Called and returns with p->lock held.
+static void wait_until(rs485_poller_t *p, uint64_t deadline_ns) {
+    if (p->timer_fd < 0) {
+        struct timespec until = ns_to_timespec(deadline_ns);
+        if (deadline_ns == 0) pthread_cond_wait(&p->wake, &p->lock);
+        else pthread_cond_timedwait(&p->wake, &p->lock, &until);
+        return;
+    }
+
+    // An absolute timer cannot drift and is not delayed by the time spent here; zero disarms it
+    struct itimerspec its = { .it_interval = { 0, 0 }, .it_value = ns_to_timespec(deadline_ns) };
+    timerfd_settime(p->timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+    pthread_mutex_unlock(&p->lock);
+
+    // A wakeup sent after the unlock stays counted in the eventfd, so none is lost
+    struct pollfd fds[2] = { { .fd = p->timer_fd, .events = POLLIN }, { .fd = p->event_fd, .events = POLLIN } };
+    uint64_t count;
+    if (poll(fds, 2, -1) > 0) {
+        if ((fds[0].revents & POLLIN) && read(p->timer_fd, &count, sizeof(count)) < 0) {}
+        if ((fds[1].revents & POLLIN) && read(p->event_fd, &count, sizeof(count)) < 0) {}
+    }
+    pthread_mutex_lock(&p->lock);
+}
+
+// Applies the real-time settings to the calling (poller) thread and records what took effect
+static void apply_realtime(rs485_poller_t *p) {
+    int cpu = -1, priority = 0;
+
+    // Default slack lets the kernel fire a timer up to 50 us late to batch wakeups
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+
+    if (p->rt.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(p->rt.cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err == 0) cpu = p->rt.cpu;
+        else LOGGER_W(LOGGER_COMP_RS485, "Poller %s: cannot pin to CPU %d: %s", p->device, p->rt.cpu, strerror(err));
+    }
+    if (p->rt.priority > 0) {
+        struct sched_param sp = { .sched_priority = p->rt.priority };
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+        if (err == 0) priority = p->rt.priority;
+        else LOGGER_W(LOGGER_COMP_RS485, "Poller %s: cannot use SCHED_FIFO %d: %s", p->device, p->rt.priority, strerror(err));
+    }
+
+    pthread_mutex_lock(&p->lock);
+    p->timing_stats.cpu = cpu;
+    p->timing_stats.priority = priority;
+    pthread_mutex_unlock(&p->lock);
+    LOGGER_I(LOGGER_COMP_RS485, "Poller %s: real-time mode (cpu %d, SCHED_FIFO %d)", p->device, cpu, priority);
+}
+
+// Accounts a poll starting at now_ns. Called with p->lock held.
+static void record_start(rs485_poller_t *p, poll_sensor_t *s, uint64_t now) {
+    rs485_poll_timing_t *t = &p->timing_stats;
+    uint64_t lateness_us = (now - s->next_deadline_ns) / 1000ULL;
+
+    t->cycles++;
+    t->lateness_sum_us += lateness_us;
+    if (lateness_us > t->lateness_max_us) t->lateness_max_us = lateness_us;
+    t->lateness_hist[rs485_stats_bucket(lateness_us > UINT32_MAX ? UINT32_MAX : (uint32_t)lateness_us)]++;
+
+    if (s->polled) {
+        uint64_t jitter_us = (lateness_us > s->last_lateness_us) ? lateness_us - s->last_lateness_us
+                                                                 : s->last_lateness_us - lateness_us;
+        t->jitter_count++;
+        t->jitter_sum_us += jitter_us;
+        if (jitter_us > t->jitter_max_us) t->jitter_max_us = jitter_us;
+    }
+    s->last_lateness_us = lateness_us;
+    s->polled = 1;
+}
+
+static void timing_clear(rs485_poll_timing_t *t) {
+    int32_t cpu = t->cpu, priority = t->priority;
+    memset(t, 0, sizeof(*t));
+    t->cpu = cpu;
+    t->priority = priority;
+}
+
+static int deadline_less(const rs485_poller_t *p, int a, int b) {
+    return p->sensors[a].next_deadline_ns < p->sensors[b].next_deadline_ns;
+}
+
+static void heap_push(rs485_poller_t *p, int id) {
+    int i = p->heap_len++;
+    p->heap[i] = id;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!deadline_less(p, p->heap[i], p->heap[parent])) break;
+        int tmp = p->heap[i];
+        p->heap[i] = p->heap[parent];
+        p->heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+static int heap_pop(rs485_poller_t *p) {
+    int top = p->heap[0];
+    p->heap[0] = p->heap[--p->heap_len];
+    int i = 0;
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, min = i;
+        if (l < p->heap_len && deadline_less(p, p->heap[l], p->heap[min])) min = l;
+        if (r < p->heap_len && deadline_less(p, p->heap[r], p->heap[min])) min = r;
+        if (min == i) break;
+        int tmp = p->heap[i];
+        p->heap[i] = p->heap[min];
+        p->heap[min] = tmp;
+        i = min;
+    }
+    return top;
+}
+
+static void queue_push(rs485_sample_queue_t *q, const rs485_sample_t *sample) {
+    pthread_mutex_lock(&q->lock);
+    if (q->len == RS485_SAMPLE_QUEUE_LEN) {
+        // Consumer is behind: overwrite the oldest sample rather than stall the bus
+        q->head = (q->head + 1) % RS485_SAMPLE_QUEUE_LEN;
+        q->len--;
+        q->dropped++;
+    }
+    q->buf[(q->head + q->len) % RS485_SAMPLE_QUEUE_LEN] = *sample;
+    q->len++;
+    pthread_cond_signal(&q->ready);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static void publish_sample(rs485_poller_t *p, rs485_sample_t *sample) {
+    sample->seq = p->seq++;
+    queue_push(p->queue, sample);
+}
+
+// Runs every pending job. Called and returns with p->lock held.
+static void run_jobs(rs485_poller_t *p) {
+    while (p->jobs_head != NULL) {
+        poll_job_t *job = p->jobs_head;
+        p->jobs_head = job->next;
+        if (p->jobs_head == NULL) p->jobs_tail = NULL;
+        pthread_mutex_unlock(&p->lock);
+
+        int result = job->fn(p->ctx, job->arg);
+
+        pthread_mutex_lock(&p->lock);
+        job->result = result;
+        job->done = 1;
+        pthread_cond_broadcast(&p->job_done);
+    }
+}
+
+// action is the rs485_health_check() verdict for the sensor's slave; cb/cb_data were copied under p->lock
+static void poll_one(rs485_poller_t *p, int id, const poll_sensor_t *s, int action, rs485_sample_cb cb, void *cb_data) {
+    rs485_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.sensor_id = id;
+    sample.bus_id = p->bus_id;
+    sample.slave_id = s->slave_id;
+    sample.n_values = s->n_regs;
+
+    uint64_t start = now_ns(CLOCK_MONOTONIC);
+    if (action == RS485_HEALTH_PROBE) {
+        int ok = (rs485_health_probe(p->ctx, &p->timing, s->slave_id) == 0);
+        pthread_mutex_lock(&p->lock);
+        rs485_health_probe_done(&p->health, s->slave_id, ok, now_ns(CLOCK_MONOTONIC));
+        pthread_mutex_unlock(&p->lock);
+        if (ok) action = RS485_HEALTH_POLL;
+    }
+    // Offline slave: nothing was read, so there is no sample. The failed poll that took it
+    // offline was published; rs485_poller_slave_health() tells when it is back.
+    if (action != RS485_HEALTH_POLL) return;
+
+    sample.status = rs485_plan_execute_timed(p->ctx, &p->timing, &s->plan, sample.values, sample.valid);
+    int answered = 0;
+    for (int i = 0; i < s->n_regs; i++) answered |= sample.valid[i];
+    pthread_mutex_lock(&p->lock);
+    rs485_health_record(&p->health, s->slave_id, answered, now_ns(CLOCK_MONOTONIC));
+    pthread_mutex_unlock(&p->lock);
+
+    sample.duration_us = (uint32_t)((now_ns(CLOCK_MONOTONIC) - start) / 1000ULL);
+    sample.timestamp_ms = now_ns(CLOCK_REALTIME) / 1000000ULL;
+
+    if (cb != NULL) cb(&sample, cb_data);
+    publish_sample(p, &sample);
+}
+
+static void* poller_thread(void *arg) {
+    rs485_poller_t *p = (rs485_poller_t*)arg;
+
+    if (p->timer_fd >= 0) apply_realtime(p);
+
+    pthread_mutex_lock(&p->lock);
+    while (p->running) {
+        if (p->jobs_head != NULL) {
+            run_jobs(p);
+            continue;
+        }
+        if (p->heap_len == 0) {
+            wait_until(p, 0);
+            continue;
+        }
+
+        int id = p->heap[0];
+        uint64_t now = now_ns(CLOCK_MONOTONIC);
+        if (now < p->sensors[id].next_deadline_ns) {
+            // Sleep until the earliest deadline, or until a sensor / job is added or stop is requested
+            wait_until(p, p->sensors[id].next_deadline_ns);
+            continue;
+        }
+
+        heap_pop(p);
+        record_start(p, &p->sensors[id], now);
+        int action = rs485_health_check(&p->health, p->sensors[id].slave_id, now);
+        poll_sensor_t snapshot = p->sensors[id];
+        rs485_sample_cb cb = p->cb;
+        void *cb_data = p->cb_data;
+        pthread_mutex_unlock(&p->lock);
+
+        poll_one(p, id, &snapshot, action, cb, cb_data);
+
+        pthread_mutex_lock(&p->lock);
+        // Keep the sensor on its own grid; skip the slots we overran instead of bursting
+        poll_sensor_t *s = &p->sensors[id];
+        uint64_t period_ns = (uint64_t)s->period_ms * 1000000ULL;
+        uint64_t after = now_ns(CLOCK_MONOTONIC);
+        s->next_deadline_ns += period_ns;
+        if (s->next_deadline_ns <= after) {
+            uint64_t missed = (after - s->next_deadline_ns) / period_ns + 1;
+            s->next_deadline_ns += missed * period_ns;
+            p->timing_stats.overruns++;
+            p->timing_stats.missed_slots += missed;
+        }
+        heap_push(p, id);
+    }
+    run_jobs(p);  // Nobody may be left waiting once the thread is gone
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+static rs485_sample_queue_t* queue_create(void) {
+    rs485_sample_queue_t *q = calloc(1, sizeof(*q));
+    if (q == NULL) return NULL;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->ready, &attr);
+    pthread_condattr_destroy(&attr);
+    return q;
+}
+
+typedef struct {
+    rs485_poller_t *p;
+    uint8_t slaves[RS485_POLL_MAX_SENSORS];
+    int n_slaves;
+    uint16_t baud_reg;
+    uint16_t probe_reg;
+    const rs485_baud_option_t *options;
+    int n_options;
+} negotiate_job_t;
+
+// Runs on the owner thread: the context may be replaced
+static int negotiate_job(modbus_t *ctx, void *arg) {
+    negotiate_job_t *job = (negotiate_job_t*)arg;
+    rs485_poller_t *p = job->p;
+    (void)ctx;
+
+    int baud = rs485_negotiate_baud(&p->ctx, &p->timing, p->device, p->parity, p->data_bit, p->stop_bit,
+                                    (uint32_t)rs485_poller_baud(p), job->slaves, job->n_slaves, job->baud_reg,
+                                    job->probe_reg, job->options, job->n_options);
+    // Not under p->lock: an idle poller runs this job from rs485_poller_submit() with the lock held
+    if (baud > 0) __atomic_store_n(&p->baud, baud, __ATOMIC_RELAXED);
+    return baud;
+}
+
+/*------------------------ Public Function -----------------------------*/
+rs485_poller_t* rs485_poller_create(const char* device, int baud, char parity, int data_bit, int stop_bit) {
+    rs485_poller_t *p = calloc(1, sizeof(*p));
+    if (p == NULL) return NULL;
+
+    p->ctx = rs485_init(device, baud, parity, data_bit, stop_bit);
+    if (p->ctx == NULL) {
+        LOGGER_E(LOGGER_COMP_RS485, "Poller: unable to open %s", device);
+        free(p);
+        return NULL;
+    }
+
+    snprintf(p->device, sizeof(p->device), "%s", device);
+    p->baud = baud;
+    p->parity = parity;
+    p->data_bit = data_bit;
+    p->stop_bit = stop_bit;
+    rs485_timing_init(&p->timing, (uint32_t)baud);
+    rs485_health_init(&p->health, 0, 0, 0);
+    p->timer_fd = -1;
+    p->event_fd = -1;
+    p->timing_stats.cpu = -1;
+
+    p->own_queue = queue_create();
+    if (p->own_queue == NULL) {
+        rs485_close(p->ctx);
+        free(p);
+        return NULL;
+    }
+    p->queue = p->own_queue;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->wake, &attr);
+    pthread_cond_init(&p->job_done, &attr);
+    pthread_condattr_destroy(&attr);
+    return p;
+}
+
+int rs485_poller_add_sensor(rs485_poller_t *p, int slave_id, const uint16_t *regs, int n_regs, uint32_t period_ms) {
+    if (p == NULL || regs == NULL || n_regs <= 0 || n_regs > RS485_POLL_MAX_REGS || period_ms == 0) return -1;
+
+    rs485_reg_ref_t refs[RS485_POLL_MAX_REGS];
+    for (int i = 0; i < n_regs; i++) {
+        refs[i].slave_id = (uint8_t)slave_id;
+        refs[i].reg_addr = regs[i];
+    }
+
+    pthread_mutex_lock(&p->lock);
+    if (p->n_sensors >= RS485_POLL_MAX_SENSORS) {
+        pthread_mutex_unlock(&p->lock);
+        return -1;
+    }
+    int id = p->n_sensors;
+    poll_sensor_t *s = &p->sensors[id];
+    if (rs485_plan_build(&s->plan, refs, n_regs, RS485_PLAN_DEFAULT_GAP) < 0) {
+        pthread_mutex_unlock(&p->lock);
+        return -1;
+    }
+    s->slave_id = (uint8_t)slave_id;
+    s->n_regs = n_regs;
+    s->period_ms = period_ms;
+    s->next_deadline_ns = now_ns(CLOCK_MONOTONIC);
+    p->n_sensors++;
+    heap_push(p, id);
+    wake_thread(p);
+    pthread_mutex_unlock(&p->lock);
+    return id;
+}
+
+int rs485_poller_has_slave(rs485_poller_t *p, int slave_id) {
+    if (p == NULL) return 0;
+    int found = 0;
+    pthread_mutex_lock(&p->lock);
+    for (int i = 0; i < p->n_sensors && !found; i++) found = (p->sensors[i].slave_id == slave_id);
+    pthread_mutex_unlock(&p->lock);
+    return found;
+}
+
+int rs485_poller_set_period(rs485_poller_t *p, int sensor_id, uint32_t period_ms) {
+    if (p == NULL || period_ms == 0) return -1;
+    pthread_mutex_lock(&p->lock);
+    if (sensor_id < 0 || sensor_id >= p->n_sensors) {
+        pthread_mutex_unlock(&p->lock);
+        return -1;
+    }
+    p->sensors[sensor_id].period_ms = period_ms;
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+void rs485_poller_set_callback(rs485_poller_t *p, rs485_sample_cb cb, void *user_data) {
+    if (p == NULL) return;
+    pthread_mutex_lock(&p->lock);
+    p->cb = cb;
+    p->cb_data = user_data;
+    pthread_mutex_unlock(&p->lock);
+}
+
+void rs485_poller_set_health(rs485_poller_t *p, uint32_t fail_threshold, uint32_t probe_min_ms, uint32_t probe_max_ms) {
+    if (p == NULL) return;
+    pthread_mutex_lock(&p->lock);
+    rs485_health_init(&p->health, fail_threshold, probe_min_ms, probe_max_ms);
+    pthread_mutex_unlock(&p->lock);
+}
+
+int rs485_poller_slave_health(rs485_poller_t *p, int slave_id, rs485_slave_health_t *out) {
+    if (p == NULL || out == NULL || slave_id < 0 || slave_id > RS485_HEALTH_MAX_SLAVE) return -1;
+    pthread_mutex_lock(&p->lock);
+    *out = p->health.slaves[slave_id];
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+int rs485_poller_set_realtime(rs485_poller_t *p, const rs485_rt_config_t *cfg) {
+    if (p == NULL) return -1;
+    pthread_mutex_lock(&p->lock);
+    if (p->running) {
+        pthread_mutex_unlock(&p->lock);
+        return -1;
+    }
+
+    if (cfg == NULL) {
+        if (p->timer_fd >= 0) close(p->timer_fd);
+        if (p->event_fd >= 0) close(p->event_fd);
+        p->timer_fd = p->event_fd = -1;
+        pthread_mutex_unlock(&p->lock);
+        return 0;
+    }
+
+    if (p->timer_fd < 0) {
+        p->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        p->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (p->timer_fd < 0 || p->event_fd < 0) {
+            LOGGER_E(LOGGER_COMP_RS485, "Poller %s: timerfd/eventfd failed: %s", p->device, strerror(errno));
+            if (p->timer_fd >= 0) close(p->timer_fd);
+            if (p->event_fd >= 0) close(p->event_fd);
+            p->timer_fd = p->event_fd = -1;
+            pthread_mutex_unlock(&p->lock);
+            return -1;
+        }
+    }
+    p->rt = *cfg;
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+int rs485_poller_timing(rs485_poller_t *p, rs485_poll_timing_t *out) {
+    if (p == NULL || out == NULL) return -1;
+    pthread_mutex_lock(&p->lock);
+    *out = p->timing_stats;
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+void rs485_poller_timing_reset(rs485_poller_t *p) {
+    if (p == NULL) return;
+    pthread_mutex_lock(&p->lock);
+    timing_clear(&p->timing_stats);
+    for (int i = 0; i < p->n_sensors; i++) p->sensors[i].polled = 0;
+    pthread_mutex_unlock(&p->lock);
+}
+
+int rs485_poller_start(rs485_poller_t *p) {
+    if (p == NULL) return -1;
+    pthread_mutex_lock(&p->lock);
+    if (p->running) {
+        pthread_mutex_unlock(&p->lock);
+        return 0;
+    }
+    // Locks what is mapped now and everything mapped later, the poller stack included
+    if (p->timer_fd >= 0 && p->rt.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        LOGGER_W(LOGGER_COMP_RS485, "Poller %s: mlockall failed: %s", p->device, strerror(errno));
+    }
+    p->running = 1;
+    if (pthread_create(&p->thread, NULL, poller_thread, p) != 0) {
+        p->running = 0;
+        pthread_mutex_unlock(&p->lock);
+        LOGGER_E(LOGGER_COMP_RS485, "Poller: unable to start polling thread");
+        return -1;
+    }
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+void rs485_poller_stop(rs485_poller_t *p) {
+    if (p == NULL) return;
+    pthread_mutex_lock(&p->lock);
+    if (!p->running) {
+        pthread_mutex_unlock(&p->lock);
+        return;
+    }
+    p->running = 0;
+    wake_thread(p);
+    pthread_mutex_unlock(&p->lock);
+    pthread_join(p->thread, NULL);
+}
+
+int rs485_poller_submit(rs485_poller_t *p, rs485_job_fn fn, void *arg) {
+    if (p == NULL || fn == NULL) return -1;
+
+    pthread_mutex_lock(&p->lock);
+    if (!p->running) {
+        // No owner thread: the context is idle, run the job here (still serialised by the lock)
+        int result = fn(p->ctx, arg);
+        pthread_mutex_unlock(&p->lock);
+        return result;
+    }
+
+    poll_job_t job = { .fn = fn, .arg = arg, .result = -1, .done = 0, .next = NULL };
+    if (p->jobs_tail != NULL) p->jobs_tail->next = &job;
+    else p->jobs_head = &job;
+    p->jobs_tail = &job;
+    wake_thread(p);
+    while (!job.done) pthread_cond_wait(&p->job_done, &p->lock);
+    pthread_mutex_unlock(&p->lock);
+    return job.result;
+}
+
+int rs485_poller_negotiate_baud(rs485_poller_t *p, uint16_t baud_reg, uint16_t probe_reg,
+                                const rs485_baud_option_t *options, int n_options) {
+    if (p == NULL || options == NULL || n_options <= 0) return -1;
+
+    negotiate_job_t job = { .p = p, .baud_reg = baud_reg, .probe_reg = probe_reg,
+                            .options = options, .n_options = n_options };
+    pthread_mutex_lock(&p->lock);
+    for (int i = 0; i < p->n_sensors; i++) {
+        int seen = 0;
+        for (int j = 0; j < job.n_slaves; j++) seen |= (job.slaves[j] == p->sensors[i].slave_id);
+        if (!seen) job.slaves[job.n_slaves++] = p->sensors[i].slave_id;
+    }
+    pthread_mutex_unlock(&p->lock);
+    if (job.n_slaves == 0) return rs485_poller_baud(p);
+
+    return rs485_poller_submit(p, negotiate_job, &job);
+}
+
+int rs485_poller_baud(rs485_poller_t *p) {
+    return p ? __atomic_load_n(&p->baud, __ATOMIC_RELAXED) : -1;
+}
+
+void rs485_poller_attach_queue(rs485_poller_t *p, rs485_sample_queue_t *q, int bus_id) {
+    if (p == NULL) return;
+    pthread_mutex_lock(&p->lock);
+    p->queue = (q != NULL) ? q : p->own_queue;
+    p->bus_id = bus_id;
+    pthread_mutex_unlock(&p->lock);
+}
+
+int rs485_poller_get_samples(rs485_poller_t *p, rs485_sample_t *out, int max, int timeout_ms) {
+    if (p == NULL) return -1;
+    return rs485_sample_queue_get(p->own_queue, out, max, timeout_ms);
+}
+
+uint64_t rs485_poller_dropped(rs485_poller_t *p) {
+    if (p == NULL) return 0;
+    return rs485_sample_queue_dropped(p->own_queue);
+}
+
+void rs485_poller_destroy(rs485_poller_t *p) {
+    if (p == NULL) return;
+    rs485_poller_stop(p);
+    rs485_close(p->ctx);
+    rs485_sample_queue_destroy(p->own_queue);
+    if (p->timer_fd >= 0) close(p->timer_fd);
+    if (p->event_fd >= 0) close(p->event_fd);
+    pthread_cond_destroy(&p->wake);
+    pthread_cond_destroy(&p->job_done);
+    pthread_mutex_destroy(&p->lock);
+    free(p);
+}
+
+rs485_sample_queue_t* rs485_sample_queue_create(void) {
+    return queue_create();
+}
+
+int rs485_sample_queue_get(rs485_sample_queue_t *q, rs485_sample_t *out, int max, int timeout_ms) {
+    if (q == NULL || out == NULL || max <= 0) return -1;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->len == 0 && timeout_ms != 0) {
+        if (timeout_ms < 0) {
+            while (q->len == 0) pthread_cond_wait(&q->ready, &q->lock);
+        } else {
+            struct timespec until = ns_to_timespec(now_ns(CLOCK_MONOTONIC) + (uint64_t)timeout_ms * 1000000ULL);
+            while (q->len == 0) {
+                if (pthread_cond_timedwait(&q->ready, &q->lock, &until) != 0) break;
+            }
+        }
+    }
+
+    int n = 0;
+    while (n < max && q->len > 0) {
+        out[n++] = q->buf[q->head];
+        q->head = (q->head + 1) % RS485_SAMPLE_QUEUE_LEN;
+        q->len--;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+uint64_t rs485_sample_queue_dropped(rs485_sample_queue_t *q) {
+    if (q == NULL) return 0;
+    pthread_mutex_lock(&q->lock);
+    uint64_t dropped = q->dropped;
+    pthread_mutex_unlock(&q->lock);
+    return dropped;
+}
+
+void rs485_sample_queue_destroy(rs485_sample_queue_t *q) {
+    if (q == NULL) return;
+    pthread_cond_destroy(&q->ready);
+    pthread_mutex_destroy(&q->lock);
+    free(q);
+}
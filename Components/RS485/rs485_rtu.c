@@ -0,0 +1,608 @@
+#include "rs485_rtu.h"
+#include "rs485_stats.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+
+#define BITS_PER_CHAR 11            // Same worst case framing as rs485_timing.c
+#define FAST_BAUD_FRAME_GAP_US 1750
+#define RTU_SLACK_US 4000           // USB-serial delivery latency (RS485_TIMING_SLACK_US)
+#define RTU_TURNAROUND_US 100000    // Device turnaround budget (RS485_TIMING_COLD_LATENCY_US)
+#define REQ_BYTES 8                 // FC03 and FC06 requests are both 8 bytes
+#define EXCEPTION_BYTES 5           // addr, fc | 0x80, code, crc(2)
+#define MAX_EVENTS 32
+
+#define FC_READ_HOLDING 0x03
+#define FC_WRITE_SINGLE 0x06
+
+enum { PORT_IDLE, PORT_SENDING, PORT_WAITING, PORT_RECEIVING };
+
+struct rtu_tag {
+    rs485_rtu_port_t *port;
+    int is_timer;
+};
+
+struct rs485_rtu_port {
+    rs485_rtu_engine_t *engine;
+    int fd;
+    int timer_fd;
+    struct rtu_tag fd_tag;          // epoll user data for fd
+    struct rtu_tag timer_tag;       // epoll user data for timer_fd
+    uint32_t events;                // Events currently registered for fd
+
+    uint32_t char_us;
+    uint32_t frame_gap_us;
+    uint32_t response_us;
+
+    int state;
+    uint8_t tx[REQ_BYTES];
+    int tx_off;
+    uint8_t rx[RS485_RTU_MAX_ADU];
+    int rx_len;
+    int expect_len;                 // Length of a normal response
+    uint8_t slave_id;
+    uint8_t function;
+    uint16_t count;
+    rs485_rtu_done_fn done;
+    void *user;
+    int stats_bus;
+    uint64_t start_us;              // Submit time, for the latency histogram
+    int closed;                     // Closed from a callback, freed when the poll batch ends
+    rs485_rtu_port_t *next_closed;
+};
+
+struct rs485_rtu_engine {
+    int epoll_fd;
+    rs485_rtu_port_t *ports[RS485_RTU_MAX_PORTS];
+    int n_ports;
+    int pending;
+    uint64_t completed;
+    int poll_depth;                 // rs485_rtu_engine_poll() calls in progress (callbacks may nest them)
+    rs485_rtu_port_t *closed;       // Ports closed during a poll, their events may still be in the batch
+};
+
+static uint16_t crc_table[8][256];
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+/*---------------------------- Private Function --------------------------------*/
+static void crc_table_init(void) {
+    for (int i = 0; i < 256; i++) {
+        uint16_t crc = (uint16_t)i;
+        for (int b = 0; b < 8; b++) crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+        crc_table[0][i] = crc;
+    }
+    // Table k advances a byte through k further zero bytes
+    for (int k = 1; k < 8; k++) {
+        for (int i = 0; i < 256; i++) {
+            uint16_t prev = crc_table[k - 1][i];
+            crc_table[k][i] = (uint16_t)((prev >> 8) ^ crc_table[0][prev & 0xFF]);
+        }
+    }
+}
+
+static speed_t baud_to_speed(int baud) {
+    switch (baud) {
+        case 1200: return B1200;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        default: return 0;
+    }
+}
+
+static int configure_tty(int fd, int baud, char parity, int data_bit, int stop_bit) {
+    speed_t speed = baud_to_speed(baud);
+    if (speed == 0 || (data_bit != 7 && data_bit != 8) || (stop_bit != 1 && stop_bit != 2)) return -1;
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) return -1;
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB);
+    tio.c_cflag |= (data_bit == 7) ? CS7 : CS8;
+    if (stop_bit == 2) tio.c_cflag |= CSTOPB;
+    if (parity == 'E' || parity == 'O') {
+        tio.c_cflag |= PARENB;
+        if (parity == 'O') tio.c_cflag |= PARODD;
+    } else if (parity != 'N') {
+        return -1;
+    }
+    // Non-blocking reads: epoll reports readiness, timers report silence
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    return tcsetattr(fd, TCSANOW, &tio);
+}
+
+static int set_events(rs485_rtu_port_t *port, uint32_t events) {
+    if (port->events == events) return 0;
+    struct epoll_event ev = { .events = events, .data.ptr = &port->fd_tag };
+    if (epoll_ctl(port->engine->epoll_fd, EPOLL_CTL_MOD, port->fd, &ev) != 0) return -1;
+    port->events = events;
+    return 0;
+}
+
+static void arm_timer(rs485_rtu_port_t *port, uint32_t us) {
+    struct itimerspec its = { 0 };
+    its.it_value.tv_sec = us / 1000000u;
+    its.it_value.tv_nsec = (long)(us % 1000000u) * 1000L;
+    if (us == 0) its.it_value.tv_nsec = 1;  // 0 would disarm
+    timerfd_settime(port->timer_fd, 0, &its, NULL);
+}
+
+static void disarm_timer(rs485_rtu_port_t *port) {
+    struct itimerspec its = { 0 };
+    timerfd_settime(port->timer_fd, 0, &its, NULL);
+}
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static int stats_result(int status) {
+    switch (status) {
+        case RS485_RTU_OK: return RS485_RESULT_OK;
+        case RS485_RTU_ERR_TIMEOUT: return RS485_RESULT_TIMEOUT;
+        case RS485_RTU_ERR_CRC: return RS485_RESULT_CRC;
+        case RS485_RTU_ERR_EXCEPTION: return RS485_RESULT_EXCEPTION;
+        case RS485_RTU_ERR_FRAME: return RS485_RESULT_FRAME;
+        default: return RS485_RESULT_IO;
+    }
+}
+
+static void finish(rs485_rtu_port_t *port, int status, const uint16_t *values, int count) {
+    rs485_stats_record(port->stats_bus, port->slave_id, stats_result(status), (uint32_t)port->tx_off,
+                       (uint32_t)port->rx_len, (uint32_t)(now_us() - port->start_us));
+    disarm_timer(port);
+    port->state = PORT_IDLE;
+    port->engine->pending--;
+    port->engine->completed++;
+
+    rs485_rtu_done_fn done = port->done;
+    void *user = port->user;
+    port->done = NULL;
+    // Port is idle again, so the callback may submit the next transaction
+    if (done != NULL) done(port, status, values, count, user);
+}
+
+static void complete_frame(rs485_rtu_port_t *port) {
+    const uint8_t *f = port->rx;
+    int len = port->rx_len;
+
+    if (len < EXCEPTION_BYTES) {
+        finish(port, RS485_RTU_ERR_FRAME, NULL, 0);
+        return;
+    }
+    uint16_t crc = (uint16_t)(f[len - 2] | (f[len - 1] << 8));
+    if (rs485_rtu_crc16(f, (size_t)(len - 2)) != crc) {
+        finish(port, RS485_RTU_ERR_CRC, NULL, 0);
+        return;
+    }
+    if (f[0] != port->slave_id) {
+        finish(port, RS485_RTU_ERR_FRAME, NULL, 0);
+        return;
+    }
+    if (f[1] == (port->function | 0x80)) {
+        finish(port, RS485_RTU_ERR_EXCEPTION, NULL, 0);
+        return;
+    }
+    if (f[1] != port->function || len != port->expect_len) {
+        finish(port, RS485_RTU_ERR_FRAME, NULL, 0);
+        return;
+    }
+
+    uint16_t values[RS485_RTU_MAX_READ];
+    int n;
+    if (port->function == FC_READ_HOLDING) {
+        if (f[2] != 2 * port->count) {
+            finish(port, RS485_RTU_ERR_FRAME, NULL, 0);
+            return;
+        }
+        n = port->count;
+        for (int i = 0; i < n; i++) values[i] = (uint16_t)((f[3 + 2 * i] << 8) | f[4 + 2 * i]);
+    } else {
+        // FC06 echoes the request
+        if (memcmp(f, port->tx, REQ_BYTES - 2) != 0) {
+            finish(port, RS485_RTU_ERR_FRAME, NULL, 0);
+            return;
+        }
+        n = 1;
+        values[0] = (uint16_t)((f[4] << 8) | f[5]);
+    }
+    finish(port, RS485_RTU_OK, values, n);
+}
+
+static void start_wait(rs485_rtu_port_t *port) {
+    port->state = PORT_WAITING;
+    port->rx_len = 0;
+    arm_timer(port, port->response_us);
+}
+
+static void on_writable(rs485_rtu_port_t *port) {
+    if (port->state != PORT_SENDING) {
+        set_events(port, EPOLLIN);
+        return;
+    }
+    ssize_t n = write(port->fd, port->tx + port->tx_off, (size_t)(REQ_BYTES - port->tx_off));
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EINTR) return;
+        set_events(port, EPOLLIN);
+        finish(port, RS485_RTU_ERR_IO, NULL, 0);
+        return;
+    }
+    port->tx_off += (int)n;
+    if (port->tx_off == REQ_BYTES) {
+        set_events(port, EPOLLIN);
+        start_wait(port);
+    }
+}
+
+static void on_readable(rs485_rtu_port_t *port) {
+    for (;;) {
+        uint8_t scratch[64];
+        int receiving = (port->state == PORT_WAITING || port->state == PORT_RECEIVING);
+        uint8_t *dst = receiving ? port->rx + port->rx_len : scratch;
+        size_t room = receiving ? (size_t)(RS485_RTU_MAX_ADU - port->rx_len) : sizeof(scratch);
+        if (room == 0) {
+            // Longer than any RTU frame: line noise or a baud mismatch
+            finish(port, RS485_RTU_ERR_FRAME, NULL, 0);
+            if (port->closed) return;
+            continue;
+        }
+
+        ssize_t n = read(port->fd, dst, room);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;  // EAGAIN, or nothing more
+        if (!receiving) continue;  // Stray bytes outside a transaction
+
+        port->rx_len += (int)n;
+        port->state = PORT_RECEIVING;
+    }
+
+    if (port->state != PORT_RECEIVING) return;
+
+    // A complete response (or exception) ends the frame without waiting for the gap
+    int exception = (port->rx_len >= 2 && port->rx[1] == (port->function | 0x80));
+    if (port->rx_len == port->expect_len || (exception && port->rx_len == EXCEPTION_BYTES)) {
+        complete_frame(port);
+        return;
+    }
+    // Otherwise the frame ends after frame_gap_us of silence
+    arm_timer(port, port->frame_gap_us);
+}
+
+static void on_timer(rs485_rtu_port_t *port) {
+    uint64_t expirations;
+    if (read(port->timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+
+    if (port->state == PORT_WAITING || port->state == PORT_SENDING) {
+        set_events(port, EPOLLIN);
+        finish(port, RS485_RTU_ERR_TIMEOUT, NULL, 0);
+    } else if (port->state == PORT_RECEIVING) {
+        complete_frame(port);
+    }
+}
+
+static void on_hangup(rs485_rtu_port_t *port) {
+    // Stop watching the fd until the next submit, or a dead line would spin the loop
+    set_events(port, 0);
+    if (port->state != PORT_IDLE) finish(port, RS485_RTU_ERR_IO, NULL, 0);
+}
+
+static int submit(rs485_rtu_port_t *port, uint8_t slave_id, uint8_t function, uint16_t addr, uint16_t arg,
+                  int expect_len, rs485_rtu_done_fn done, void *user) {
+    if (port->state != PORT_IDLE) return RS485_RTU_ERR_BUSY;
+
+    uint8_t *f = port->tx;
+    f[0] = slave_id;
+    f[1] = function;
+    f[2] = (uint8_t)(addr >> 8);
+    f[3] = (uint8_t)addr;
+    f[4] = (uint8_t)(arg >> 8);
+    f[5] = (uint8_t)arg;
+    uint16_t crc = rs485_rtu_crc16(f, REQ_BYTES - 2);
+    f[6] = (uint8_t)crc;            // CRC goes low byte first
+    f[7] = (uint8_t)(crc >> 8);
+
+    port->slave_id = slave_id;
+    port->function = function;
+    port->count = (function == FC_READ_HOLDING) ? arg : 1;
+    port->expect_len = expect_len;
+    port->done = done;
+    port->user = user;
+    port->tx_off = 0;
+    port->rx_len = 0;
+    port->start_us = now_us();
+
+    tcflush(port->fd, TCIFLUSH);    // Late bytes from a previous timeout must not start this frame
+    ssize_t n = write(port->fd, f, REQ_BYTES);
+    if (n < 0) {
+        if (errno != EAGAIN) return RS485_RTU_ERR_IO;
+        n = 0;
+    }
+    port->tx_off = (int)n;
+    port->engine->pending++;
+
+    if (port->tx_off < REQ_BYTES) {
+        port->state = PORT_SENDING;
+        set_events(port, EPOLLIN | EPOLLOUT);
+        arm_timer(port, port->response_us);
+    } else {
+        set_events(port, EPOLLIN);
+        start_wait(port);
+    }
+    return 0;
+}
+
+struct sync_call {
+    int done;
+    int status;
+    uint16_t *out;
+    int count;
+};
+
+static void sync_done(rs485_rtu_port_t *port, int status, const uint16_t *values, int count, void *user) {
+    (void)port;
+    struct sync_call *c = user;
+    c->status = status;
+    if (status == RS485_RTU_OK && c->out != NULL) memcpy(c->out, values, (size_t)count * sizeof(uint16_t));
+    c->done = 1;
+}
+
+static int wait_sync(rs485_rtu_port_t *port, struct sync_call *c, int submitted) {
+    if (submitted != 0) return submitted;
+    while (!c->done) {
+        if (rs485_rtu_engine_poll(port->engine, -1) < 0) return RS485_RTU_ERR_IO;
+    }
+    return c->status;
+}
+
+static const char* status_str(int status) {
+    switch (status) {
+        case RS485_RTU_ERR_IO: return "I/O error";
+        case RS485_RTU_ERR_TIMEOUT: return "Timeout";
+        case RS485_RTU_ERR_CRC: return "Invalid CRC";
+        case RS485_RTU_ERR_FRAME: return "Invalid frame";
+        case RS485_RTU_ERR_EXCEPTION: return "Slave exception";
+        case RS485_RTU_ERR_BUSY: return "Port busy";
+        default: return "Success";
+    }
+}
+
+/*------------------------ Public Function -----------------------------*/
+uint16_t rs485_rtu_crc16(const uint8_t *data, size_t len) {
+    pthread_once(&crc_once, crc_table_init);
+
+    uint16_t crc = 0xFFFF;
+    // Eight bytes per step: the CRC only overlaps the first two
+    while (len >= 8) {
+        crc = crc_table[7][(crc ^ data[0]) & 0xFF] ^ crc_table[6][((crc >> 8) ^ data[1]) & 0xFF] ^
+              crc_table[5][data[2]] ^ crc_table[4][data[3]] ^
+              crc_table[3][data[4]] ^ crc_table[2][data[5]] ^
+              crc_table[1][data[6]] ^ crc_table[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+    while (len--) crc = (uint16_t)((crc >> 8) ^ crc_table[0][(crc ^ *data++) & 0xFF]);
+    return crc;
+}
+
+uint16_t rs485_rtu_crc16_bitwise(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+    }
+    return crc;
+}
+
+rs485_rtu_engine_t* rs485_rtu_engine_create(void) {
+    rs485_rtu_engine_t *e = calloc(1, sizeof(*e));
+    if (e == NULL) return NULL;
+
+    e->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (e->epoll_fd < 0) {
+        free(e);
+        return NULL;
+    }
+    pthread_once(&crc_once, crc_table_init);
+    return e;
+}
+
+void rs485_rtu_engine_destroy(rs485_rtu_engine_t *e) {
+    if (e == NULL) return;
+    while (e->n_ports > 0) rs485_rtu_close(e->ports[e->n_ports - 1]);
+    close(e->epoll_fd);
+    free(e);
+}
+
+rs485_rtu_port_t* rs485_rtu_open(rs485_rtu_engine_t *e, const char *device, int baud, char parity, int data_bit, int stop_bit) {
+    if (e == NULL || device == NULL) return NULL;
+    if (e->n_ports == RS485_RTU_MAX_PORTS) {
+        LOGGER_E(LOGGER_COMP_RS485, "RTU: engine full, cannot open %s", device);
+        return NULL;
+    }
+
+    rs485_rtu_port_t *port = calloc(1, sizeof(*port));
+    if (port == NULL) return NULL;
+    port->engine = e;
+    port->timer_fd = -1;
+
+    port->fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (port->fd < 0) {
+        LOGGER_E(LOGGER_COMP_RS485, "RTU: unable to open %s - %s", device, strerror(errno));
+        free(port);
+        return NULL;
+    }
+    if (configure_tty(port->fd, baud, parity, data_bit, stop_bit) != 0) {
+        LOGGER_E(LOGGER_COMP_RS485, "RTU: unable to configure %s (%d %c%d%d)", device, baud, parity, data_bit, stop_bit);
+        goto fail;
+    }
+    port->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (port->timer_fd < 0) goto fail;
+
+    port->fd_tag = (struct rtu_tag){ port, 0 };
+    port->timer_tag = (struct rtu_tag){ port, 1 };
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &port->fd_tag };
+    if (epoll_ctl(e->epoll_fd, EPOLL_CTL_ADD, port->fd, &ev) != 0) goto fail;
+    port->events = EPOLLIN;
+    ev.data.ptr = &port->timer_tag;
+    if (epoll_ctl(e->epoll_fd, EPOLL_CTL_ADD, port->timer_fd, &ev) != 0) {
+        epoll_ctl(e->epoll_fd, EPOLL_CTL_DEL, port->fd, NULL);
+        goto fail;
+    }
+
+    port->char_us = (BITS_PER_CHAR * 1000000u + (uint32_t)baud - 1) / (uint32_t)baud;
+    uint32_t t35 = (baud > 19200) ? FAST_BAUD_FRAME_GAP_US : (port->char_us * 7 + 1) / 2;
+    port->frame_gap_us = t35 + RTU_SLACK_US;
+    // write() returns once the request is queued, so the clock includes its wire time
+    port->response_us = (REQ_BYTES + 1) * port->char_us + RTU_TURNAROUND_US + RTU_SLACK_US;
+    port->state = PORT_IDLE;
+    port->stats_bus = rs485_stats_bus_open(device);
+    rs485_stats_bind(port, port->stats_bus);
+
+    e->ports[e->n_ports++] = port;
+    return port;
+
+fail:
+    if (port->timer_fd >= 0) close(port->timer_fd);
+    close(port->fd);
+    free(port);
+    return NULL;
+}
+
+void rs485_rtu_close(rs485_rtu_port_t *port) {
+    if (port == NULL) return;
+    rs485_rtu_engine_t *e = port->engine;
+
+    if (port->state != PORT_IDLE) e->pending--;
+    rs485_stats_unbind(port);
+    epoll_ctl(e->epoll_fd, EPOLL_CTL_DEL, port->fd, NULL);
+    epoll_ctl(e->epoll_fd, EPOLL_CTL_DEL, port->timer_fd, NULL);
+    close(port->timer_fd);
+    close(port->fd);
+
+    for (int i = 0; i < e->n_ports; i++) {
+        if (e->ports[i] == port) {
+            e->ports[i] = e->ports[--e->n_ports];
+            break;
+        }
+    }
+    if (e->poll_depth > 0) {
+        // Called from a done callback: later events of the batch still point at the port
+        port->closed = 1;
+        port->next_closed = e->closed;
+        e->closed = port;
+        return;
+    }
+    free(port);
+}
+
+void rs485_rtu_set_response_timeout(rs485_rtu_port_t *port, uint32_t timeout_us) {
+    if (port != NULL && timeout_us > 0) port->response_us = timeout_us;
+}
+
+void rs485_rtu_set_frame_gap(rs485_rtu_port_t *port, uint32_t gap_us) {
+    if (port != NULL && gap_us > 0) port->frame_gap_us = gap_us;
+}
+
+int rs485_rtu_submit_read(rs485_rtu_port_t *port, int slave_id, int start_addr, int count,
+                          rs485_rtu_done_fn done, void *user) {
+    if (port == NULL || slave_id < 0 || slave_id > 247 || start_addr < 0 || start_addr > 0xFFFF) return RS485_RTU_ERR_FRAME;
+    if (count <= 0 || count > RS485_RTU_MAX_READ) return RS485_RTU_ERR_FRAME;
+    return submit(port, (uint8_t)slave_id, FC_READ_HOLDING, (uint16_t)start_addr, (uint16_t)count,
+                  5 + 2 * count, done, user);
+}
+
+int rs485_rtu_submit_write(rs485_rtu_port_t *port, int slave_id, int reg_addr, uint16_t value,
+                           rs485_rtu_done_fn done, void *user) {
+    if (port == NULL || slave_id < 0 || slave_id > 247 || reg_addr < 0 || reg_addr > 0xFFFF) return RS485_RTU_ERR_FRAME;
+    return submit(port, (uint8_t)slave_id, FC_WRITE_SINGLE, (uint16_t)reg_addr, value, REQ_BYTES, done, user);
+}
+
+int rs485_rtu_busy(const rs485_rtu_port_t *port) {
+    return port != NULL && port->state != PORT_IDLE;
+}
+
+int rs485_rtu_engine_poll(rs485_rtu_engine_t *e, int timeout_ms) {
+    if (e == NULL) return -1;
+
+    struct epoll_event evs[MAX_EVENTS];
+    int n = epoll_wait(e->epoll_fd, evs, MAX_EVENTS, timeout_ms);
+    if (n < 0) return (errno == EINTR) ? 0 : -1;
+
+    uint64_t before = e->completed;
+    e->poll_depth++;
+    for (int i = 0; i < n; i++) {
+        struct rtu_tag *tag = evs[i].data.ptr;
+        rs485_rtu_port_t *port = tag->port;
+        // Every handler may complete a transaction, and its callback may close the port
+        if (port->closed) continue;
+        if (tag->is_timer) {
+            on_timer(port);
+            continue;
+        }
+        if (evs[i].events & EPOLLIN) on_readable(port);
+        if (!port->closed && (evs[i].events & EPOLLOUT)) on_writable(port);
+        if (!port->closed && (evs[i].events & (EPOLLERR | EPOLLHUP)) && !(evs[i].events & EPOLLIN)) on_hangup(port);
+    }
+    if (--e->poll_depth == 0) {
+        while (e->closed != NULL) {
+            rs485_rtu_port_t *port = e->closed;
+            e->closed = port->next_closed;
+            free(port);
+        }
+    }
+    return (int)(e->completed - before);
+}
+
+int rs485_rtu_engine_pending(const rs485_rtu_engine_t *e) {
+    return e ? e->pending : 0;
+}
+
+int rs485_rtu_read_raw(rs485_rtu_port_t *port, int slave_id, int reg_addr, uint16_t *out_value) {
+    return rs485_rtu_read_block(port, slave_id, reg_addr, 1, out_value);
+}
+
+int rs485_rtu_read_block(rs485_rtu_port_t *port, int slave_id, int start_addr, int count, uint16_t *out_values) {
+    if (port == NULL || out_values == NULL) return -1;
+
+    struct sync_call c = { 0, 0, out_values, count };
+    int status = wait_sync(port, &c, rs485_rtu_submit_read(port, slave_id, start_addr, count, sync_done, &c));
+    if (status != RS485_RTU_OK) {
+        LOGGER_E(LOGGER_COMP_RS485, "RTU: slave 0x%02X, Reg 0x%04X (x%d) - %s",
+                 slave_id, start_addr, count, status_str(status));
+        return -1;
+    }
+    return 0;
+}
+
+int rs485_rtu_write_raw(rs485_rtu_port_t *port, int slave_id, int reg_addr, uint16_t value) {
+    if (port == NULL) return -1;
+
+    struct sync_call c = { 0, 0, NULL, 1 };
+    int status = wait_sync(port, &c, rs485_rtu_submit_write(port, slave_id, reg_addr, value, sync_done, &c));
+    if (status != RS485_RTU_OK) {
+        LOGGER_E(LOGGER_COMP_RS485, "RTU write: slave 0x%02X, Reg 0x%04X - %s", slave_id, reg_addr, status_str(status));
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include "rs485_stats.h"
+#include "logger.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>    // O_RDWR, O_CREAT
+#include <sys/mman.h> // shm_open, mmap
+#include <sys/stat.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <modbus/modbus.h>
+
+#define MAX_BINDINGS 16     // Open transport handles (contexts and RTU ports)
+
+_Static_assert(sizeof(rs485_stats_bus_t) % sizeof(uint64_t) == 0, "bus stats must be copyable as 64-bit words");
+_Static_assert(sizeof(rs485_stats_counters_t) % sizeof(uint64_t) == 0, "counters must be 64-bit words");
+
+struct binding {
+    const void *handle;
+    int bus;
+};
+
+static rs485_stats_page_t local_page = { .magic = RS485_STATS_MAGIC, .version = RS485_STATS_VERSION };
+static rs485_stats_page_t *page = &local_page;     // Switched once by rs485_stats_export_shm()
+static pthread_mutex_t reg_lock = PTHREAD_MUTEX_INITIALIZER; // Bus, slave and binding allocation only
+static struct binding bindings[MAX_BINDINGS];
+
+/*---------------------------- Private Function --------------------------------*/
+static rs485_stats_page_t* current_page(void) {
+    return __atomic_load_n(&page, __ATOMIC_ACQUIRE);
+}
+
+static void add(uint64_t *counter, uint64_t v) {
+    __atomic_fetch_add(counter, v, __ATOMIC_RELAXED);
+}
+
+static void raise_max(uint64_t *counter, uint64_t v) {
+    uint64_t cur = __atomic_load_n(counter, __ATOMIC_RELAXED);
+    while (v > cur && !__atomic_compare_exchange_n(counter, &cur, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+// Word-wise relaxed copy: no torn 64-bit counters, no lock against writers
+static void copy_words(void *dst, const void *src, size_t bytes) {
+    uint64_t *d = dst;
+    const uint64_t *s = src;
+    for (size_t i = 0; i < bytes / sizeof(uint64_t); i++) d[i] = __atomic_load_n(&s[i], __ATOMIC_RELAXED);
+}
+
+static void clear_words(void *dst, size_t bytes) {
+    uint64_t *d = dst;
+    for (size_t i = 0; i < bytes / sizeof(uint64_t); i++) __atomic_store_n(&d[i], 0, __ATOMIC_RELAXED);
+}
+
+static void count(rs485_stats_counters_t *c, int result, uint32_t tx_bytes, uint32_t rx_bytes,
+                  uint32_t latency_us, int bucket) {
+    add(&c->requests, 1);
+    add(&c->results[result], 1);
+    add(&c->tx_bytes, tx_bytes);
+    add(&c->rx_bytes, rx_bytes);
+    add(&c->latency_sum_us, latency_us);
+    raise_max(&c->latency_max_us, latency_us);
+    add(&c->latency_hist[bucket], 1);
+}
+
+// Counters of a slave, assigned on first use. NULL once the bus table is full.
+static rs485_stats_counters_t* slave_counters(rs485_stats_bus_t *b, int slave_id) {
+    if (slave_id < 0 || slave_id >= RS485_STATS_SLAVE_IDS) return NULL;
+
+    uint8_t idx = __atomic_load_n(&b->slave_index[slave_id], __ATOMIC_ACQUIRE);
+    if (idx != 0) return &b->slaves[idx - 1];
+
+    pthread_mutex_lock(&reg_lock);
+    idx = b->slave_index[slave_id];
+    if (idx == 0 && b->n_slaves < RS485_STATS_MAX_SLAVES) {
+        b->slave_id[b->n_slaves] = (uint8_t)slave_id;
+        idx = (uint8_t)(b->n_slaves + 1);
+        __atomic_store_n(&b->n_slaves, b->n_slaves + 1, __ATOMIC_RELEASE);
+        __atomic_store_n(&b->slave_index[slave_id], idx, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&reg_lock);
+    return idx ? &b->slaves[idx - 1] : NULL;
+}
+
+static void* map_segment(const char *name, int writer) {
+    int fd = writer ? shm_open(name, O_RDWR | O_CREAT, 0644) : shm_open(name, O_RDONLY, 0);
+    if (fd == -1) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 ||
+        (writer && (size_t)st.st_size < sizeof(rs485_stats_page_t) && ftruncate(fd, sizeof(rs485_stats_page_t)) == -1) ||
+        (!writer && (size_t)st.st_size < sizeof(rs485_stats_page_t))) {
+        close(fd);
+        return NULL;
+    }
+    void *addr = mmap(NULL, sizeof(rs485_stats_page_t), writer ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the segment alive
+    return (addr == MAP_FAILED) ? NULL : addr;
+}
+
+/*------------------------ Public Function -----------------------------*/
+int rs485_stats_bus_open(const char *device) {
+    if (device == NULL) return -1;
+    rs485_stats_page_t *pg = current_page();
+
+    pthread_mutex_lock(&reg_lock);
+    int bus = -1;
+    for (uint32_t i = 0; i < pg->n_buses; i++) {
+        if (strncmp(pg->buses[i].device, device, sizeof(pg->buses[i].device) - 1) == 0) bus = (int)i;
+    }
+    if (bus < 0 && pg->n_buses < RS485_STATS_MAX_BUSES) {
+        bus = (int)pg->n_buses;
+        snprintf(pg->buses[bus].device, sizeof(pg->buses[bus].device), "%s", device);
+        __atomic_store_n(&pg->n_buses, pg->n_buses + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&reg_lock);
+
+    if (bus < 0) LOGGER_W(LOGGER_COMP_RS485, "Stats: no room for %s, not counted", device);
+    return bus;
+}
+
+int rs485_stats_bind(const void *handle, int bus) {
+    if (handle == NULL || bus < 0 || bus >= RS485_STATS_MAX_BUSES) return -1;
+
+    int ret = -1;
+    pthread_mutex_lock(&reg_lock);
+    for (int i = 0; i < MAX_BINDINGS; i++) {
+        if (bindings[i].handle == NULL || bindings[i].handle == handle) {
+            __atomic_store_n(&bindings[i].bus, bus, __ATOMIC_RELAXED);
+            __atomic_store_n(&bindings[i].handle, handle, __ATOMIC_RELEASE);
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&reg_lock);
+    return ret;
+}
+
+void rs485_stats_unbind(const void *handle) {
+    if (handle == NULL) return;
+    pthread_mutex_lock(&reg_lock);
+    for (int i = 0; i < MAX_BINDINGS; i++) {
+        if (bindings[i].handle == handle) __atomic_store_n(&bindings[i].handle, NULL, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&reg_lock);
+}
+
+int rs485_stats_bus_of(const void *handle) {
+    if (handle == NULL) return -1;
+    for (int i = 0; i < MAX_BINDINGS; i++) {
+        if (__atomic_load_n(&bindings[i].handle, __ATOMIC_ACQUIRE) == handle) {
+            return __atomic_load_n(&bindings[i].bus, __ATOMIC_RELAXED);
+        }
+    }
+    return -1;
+}
+
+int rs485_stats_bucket(uint32_t latency_us) {
+    if (latency_us < 2) return 0;
+    int bucket = 31 - __builtin_clz(latency_us);
+    return (bucket >= RS485_STATS_HIST_BUCKETS) ? RS485_STATS_HIST_BUCKETS - 1 : bucket;
+}
+
+void rs485_stats_record(int bus, int slave_id, int result, uint32_t tx_bytes, uint32_t rx_bytes, uint32_t latency_us) {
+    rs485_stats_page_t *pg = current_page();
+    if (bus < 0 || (uint32_t)bus >= __atomic_load_n(&pg->n_buses, __ATOMIC_ACQUIRE)) return;
+    if (result < 0 || result >= RS485_RESULT_COUNT) result = RS485_RESULT_IO;
+
+    rs485_stats_bus_t *b = &pg->buses[bus];
+    int bucket = rs485_stats_bucket(latency_us);
+    count(&b->total, result, tx_bytes, rx_bytes, latency_us, bucket);
+
+    rs485_stats_counters_t *s = slave_counters(b, slave_id);
+    if (s != NULL) count(s, result, tx_bytes, rx_bytes, latency_us, bucket);
+    else add(&b->untracked, 1);
+}
+
+int rs485_stats_bus_snapshot(int bus, rs485_stats_bus_t *out) {
+    rs485_stats_page_t *pg = current_page();
+    if (out == NULL || bus < 0 || (uint32_t)bus >= __atomic_load_n(&pg->n_buses, __ATOMIC_ACQUIRE)) {
+        return RS485_STATS_E_GENERIC_FAIL;
+    }
+    copy_words(out, &pg->buses[bus], sizeof(*out));
+    return RS485_STATS_SUCCESS;
+}
+
+int rs485_stats_bus_count(void) {
+    return (int)__atomic_load_n(&current_page()->n_buses, __ATOMIC_ACQUIRE);
+}
+
+void rs485_stats_reset(void) {
+    rs485_stats_page_t *pg = current_page();
+    uint32_t n = __atomic_load_n(&pg->n_buses, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < n; i++) {
+        rs485_stats_bus_t *b = &pg->buses[i];
+        clear_words(&b->total, sizeof(b->total));
+        clear_words(&b->untracked, sizeof(b->untracked));
+        clear_words(b->slaves, sizeof(b->slaves));
+    }
+}
+
+int rs485_stats_export_shm(const char *name) {
+    if (name == NULL) return RS485_STATS_E_GENERIC_FAIL;
+    if (current_page() != &local_page) return RS485_STATS_SUCCESS;   // Already exported
+
+    rs485_stats_page_t *shm = map_segment(name, 1);
+    if (shm == NULL) {
+        LOGGER_E(LOGGER_COMP_RS485, "rs485_stats_export_shm: shm_open/mmap failed: %s", strerror(errno));
+        return RS485_STATS_E_OPEN;
+    }
+
+    // Counters so far carry over; whatever the segment held from a previous run is replaced
+    pthread_mutex_lock(&reg_lock);
+    copy_words(shm, &local_page, sizeof(*shm));
+    __atomic_store_n(&page, shm, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&reg_lock);
+    return RS485_STATS_SUCCESS;
+}
+
+int rs485_stats_shm_read(const char *name, rs485_stats_page_t *out) {
+    if (name == NULL || out == NULL) return RS485_STATS_E_GENERIC_FAIL;
+
+    rs485_stats_page_t *shm = map_segment(name, 0);
+    if (shm == NULL) return RS485_STATS_E_OPEN;
+
+    int ret = RS485_STATS_SUCCESS;
+    if (shm->magic != RS485_STATS_MAGIC || shm->version != RS485_STATS_VERSION) ret = RS485_STATS_E_LAYOUT;
+    else copy_words(out, shm, sizeof(*out));
+    munmap(shm, sizeof(rs485_stats_page_t));
+    return ret;
+}
+
+int rs485_stats_result_from_errno(int err) {
+    if (err == ETIMEDOUT) return RS485_RESULT_TIMEOUT;
+    if (err == EMBBADCRC) return RS485_RESULT_CRC;
+    if (err >= EMBXILFUN && err <= EMBXGTAR) return RS485_RESULT_EXCEPTION;
+    if (err == EMBBADDATA || err == EMBBADEXC || err == EMBUNKEXC || err == EMBMDATA || err == EMBBADSLAVE) {
+        return RS485_RESULT_FRAME;
+    }
+    return RS485_RESULT_IO;
+}
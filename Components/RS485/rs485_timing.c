@@ -0,0 +1,221 @@
+#include "rs485_timing.h"
+#include "logger.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BITS_PER_CHAR 11            // Start + 8 data + parity/stop + stop: worst case framing
+#define FAST_BAUD_FRAME_GAP_US 1750 // Fixed gap above 19200 baud (Modbus over serial line spec)
+#define READ_REQ_BYTES 8            // FC03 request: addr, fc, start(2), count(2), crc(2)
+#define READ_RESP_BYTES(n) (5 + 2 * (n))
+#define PROBE_RETRIES 3
+
+/*---------------------------- Private Function --------------------------------*/
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t wire_us(const rs485_timing_t *t, int bytes) {
+    return (uint32_t)bytes * t->char_us;
+}
+
+static int valid_slave(int slave_id) {
+    return slave_id >= 0 && slave_id <= RS485_TIMING_MAX_SLAVE;
+}
+
+static void set_timeout(modbus_t *ctx, uint32_t us, int byte_timeout) {
+    if (byte_timeout) modbus_set_byte_timeout(ctx, us / 1000000u, us % 1000000u);
+    else modbus_set_response_timeout(ctx, us / 1000000u, us % 1000000u);
+}
+
+static int reopen(modbus_t **ctx, rs485_timing_t *t, const char *device, uint32_t baud,
+                  char parity, int data_bit, int stop_bit) {
+    rs485_close(*ctx);
+    *ctx = rs485_init(device, (int)baud, parity, data_bit, stop_bit);
+    if (*ctx == NULL) {
+        LOGGER_E(LOGGER_COMP_RS485, "Timing: unable to reopen %s at %u baud", device, baud);
+        return -1;
+    }
+    if (t != NULL) rs485_timing_set_baud(t, baud);
+    else rs485_timing_apply_defaults(*ctx, baud);
+    return 0;
+}
+
+static int probe_all(modbus_t *ctx, rs485_timing_t *t, const uint8_t *slaves, int n, uint16_t probe_reg) {
+    for (int i = 0; i < n; i++) {
+        uint16_t dummy;
+        int ok = 0;
+        for (int attempt = 0; attempt < PROBE_RETRIES && !ok; attempt++) {
+            ok = (rs485_read_block_timed(ctx, t, slaves[i], probe_reg, 1, &dummy) == 0);
+        }
+        if (!ok) return -1;
+    }
+    return 0;
+}
+
+static void write_code_all(modbus_t *ctx, const uint8_t *slaves, int n, uint16_t baud_reg, uint16_t code) {
+    for (int i = 0; i < n; i++) rs485_write_raw(ctx, slaves[i], baud_reg, code);
+}
+
+/*------------------------ Public Function -----------------------------*/
+void rs485_timing_init(rs485_timing_t *t, uint32_t baud) {
+    if (t == NULL) return;
+    memset(t, 0, sizeof(*t));
+    t->slack_us = RS485_TIMING_SLACK_US;
+    for (int i = 0; i <= RS485_TIMING_MAX_SLAVE; i++) t->slaves[i].backoff = 1;
+    rs485_timing_set_baud(t, baud);
+}
+
+void rs485_timing_set_baud(rs485_timing_t *t, uint32_t baud) {
+    if (t == NULL || baud == 0) return;
+    t->baud = baud;
+    t->char_us = (BITS_PER_CHAR * 1000000u + baud - 1) / baud;
+    t->frame_gap_us = (baud > 19200) ? FAST_BAUD_FRAME_GAP_US : (t->char_us * 7 + 1) / 2;
+}
+
+uint32_t rs485_timing_response_us(const rs485_timing_t *t, int slave_id, int req_bytes, int resp_bytes) {
+    (void)resp_bytes;  // Only the first response byte has to arrive within the response timeout
+    if (t == NULL || !valid_slave(slave_id)) return RS485_TIMING_MAX_RESPONSE_US;
+
+    const rs485_slave_timing_t *s = &t->slaves[slave_id];
+    uint32_t turnaround = s->latency_us ? s->latency_us + 4 * s->latency_var_us : RS485_TIMING_COLD_LATENCY_US;
+    // libmodbus starts the clock when write() returns, before the request has left the UART
+    uint64_t us = (uint64_t)wire_us(t, req_bytes + 1) + turnaround + t->slack_us;
+    us *= s->backoff;
+    return (us > RS485_TIMING_MAX_RESPONSE_US) ? RS485_TIMING_MAX_RESPONSE_US : (uint32_t)us;
+}
+
+void rs485_timing_begin(rs485_timing_t *t, modbus_t *ctx, int slave_id, int req_bytes, int resp_bytes) {
+    if (t == NULL || ctx == NULL) return;
+
+    // Keep the bus silent for one frame gap after the previous transaction
+    uint64_t now = now_ns();
+    uint64_t free_at = t->last_frame_end_ns + (uint64_t)t->frame_gap_us * 1000ULL;
+    if (now < free_at) {
+        struct timespec gap = { 0, (long)(free_at - now) };
+        nanosleep(&gap, NULL);
+    }
+
+    set_timeout(ctx, rs485_timing_response_us(t, slave_id, req_bytes, resp_bytes), 0);
+    // Between response chunks: a few characters plus the adapter's delivery latency
+    set_timeout(ctx, 4 * t->char_us + t->slack_us, 1);
+    t->txn_start_ns = now_ns();
+}
+
+void rs485_timing_end(rs485_timing_t *t, int slave_id, int req_bytes, int resp_bytes, int ok) {
+    if (t == NULL) return;
+    uint64_t end = now_ns();
+    t->last_frame_end_ns = end;
+    if (!valid_slave(slave_id)) return;
+
+    rs485_slave_timing_t *s = &t->slaves[slave_id];
+    if (!ok) {
+        // Karn: no RTT sample from a failed exchange, just widen the window
+        s->n_timeout++;
+        if (s->backoff < RS485_TIMING_MAX_BACKOFF) s->backoff *= 2;
+        return;
+    }
+
+    uint64_t elapsed_us = (end - t->txn_start_ns) / 1000ULL;
+    uint32_t wire = wire_us(t, req_bytes + resp_bytes);
+    uint32_t sample = (elapsed_us > wire) ? (uint32_t)(elapsed_us - wire) : 0;
+
+    if (s->n_ok == 0) {
+        s->latency_us = sample ? sample : 1;
+        s->latency_var_us = sample / 2;
+    } else {
+        // Jacobson/Karels smoothing: gain 1/8 for the mean, 1/4 for the deviation
+        int32_t err = (int32_t)sample - (int32_t)s->latency_us;
+        int32_t abs_err = err < 0 ? -err : err;
+        s->latency_us = (uint32_t)((int32_t)s->latency_us + err / 8);
+        if (s->latency_us == 0) s->latency_us = 1;
+        s->latency_var_us = (uint32_t)((int32_t)s->latency_var_us + (abs_err - (int32_t)s->latency_var_us) / 4);
+    }
+    s->n_ok++;
+    s->backoff = 1;
+}
+
+void rs485_timing_apply_defaults(modbus_t *ctx, uint32_t baud) {
+    if (ctx == NULL || baud == 0) return;
+    uint32_t char_us = (BITS_PER_CHAR * 1000000u + baud - 1) / baud;
+    uint32_t response = (READ_REQ_BYTES + 1) * char_us + RS485_TIMING_COLD_LATENCY_US + RS485_TIMING_SLACK_US;
+    set_timeout(ctx, response, 0);
+    set_timeout(ctx, 4 * char_us + RS485_TIMING_SLACK_US, 1);
+}
+
+int rs485_read_block_timed(modbus_t *ctx, rs485_timing_t *t, int slave_id, int start_addr, int count, uint16_t *out_values) {
+    if (t == NULL) return rs485_read_block(ctx, slave_id, start_addr, count, out_values);
+
+    rs485_timing_begin(t, ctx, slave_id, READ_REQ_BYTES, READ_RESP_BYTES(count));
+    int ret = rs485_read_block(ctx, slave_id, start_addr, count, out_values);
+    rs485_timing_end(t, slave_id, READ_REQ_BYTES, READ_RESP_BYTES(count), ret == 0);
+    return ret;
+}
+
+int rs485_plan_execute_timed(modbus_t *ctx, rs485_timing_t *t, const rs485_read_plan_t *plan,
+                             uint16_t *out_values, uint8_t *out_valid) {
+    if (ctx == NULL || plan == NULL || out_values == NULL) return -1;
+
+    int status = 0;
+    uint16_t buffer[MODBUS_MAX_READ_REGISTERS];
+
+    for (int b = 0; b < plan->n_blocks; b++) {
+        const rs485_block_t *blk = &plan->blocks[b];
+        int ok = (rs485_read_block_timed(ctx, t, blk->slave_id, blk->start_addr, blk->count, buffer) == 0);
+        if (!ok) status = -1;
+
+        // Scatter this block back to every register that maps into it
+        for (int i = 0; i < plan->n_regs; i++) {
+            if (plan->ref_block[i] != b) continue;
+            if (ok) out_values[i] = buffer[plan->ref_offset[i]];
+            if (out_valid != NULL) out_valid[i] = (uint8_t)ok;
+        }
+    }
+    return status;
+}
+
+int rs485_negotiate_baud(modbus_t **ctx, rs485_timing_t *t, const char *device, char parity, int data_bit, int stop_bit,
+                         uint32_t current_baud, const uint8_t *slaves, int n_slaves, uint16_t baud_reg, uint16_t probe_reg,
+                         const rs485_baud_option_t *options, int n_options) {
+    if (ctx == NULL || *ctx == NULL || device == NULL || slaves == NULL || n_slaves <= 0 || options == NULL) return -1;
+
+    int current_code = -1;
+    for (int i = 0; i < n_options; i++) {
+        if (options[i].baud == current_baud) current_code = options[i].code;
+    }
+    if (current_code < 0) {
+        LOGGER_E(LOGGER_COMP_RS485, "Timing: current baud %u is not a listed option, cannot roll back", current_baud);
+        return (int)current_baud;
+    }
+
+    uint32_t ceiling = UINT32_MAX;  // Rates at or above this were rejected
+    for (;;) {
+        // Fastest untried option above the current rate
+        const rs485_baud_option_t *next = NULL;
+        for (int i = 0; i < n_options; i++) {
+            if (options[i].baud > current_baud && options[i].baud < ceiling &&
+                (next == NULL || options[i].baud > next->baud)) next = &options[i];
+        }
+        if (next == NULL) return (int)current_baud;
+
+        // 1. Tell every slave, at the current speed
+        write_code_all(*ctx, slaves, n_slaves, baud_reg, next->code);
+
+        // 2. Host follows and checks that every slave answers
+        if (reopen(ctx, t, device, next->baud, parity, data_bit, stop_bit) != 0) return -1;
+        if (probe_all(*ctx, t, slaves, n_slaves, probe_reg) == 0) {
+            LOGGER_I(LOGGER_COMP_RS485, "Bus %s moved to %u baud", device, next->baud);
+            return (int)next->baud;
+        }
+
+        // 3. Roll back: revert the slaves that did switch, then the ones that kept the old speed
+        write_code_all(*ctx, slaves, n_slaves, baud_reg, (uint16_t)current_code);
+        if (reopen(ctx, t, device, current_baud, parity, data_bit, stop_bit) != 0) return -1;
+        write_code_all(*ctx, slaves, n_slaves, baud_reg, (uint16_t)current_code);
+        LOGGER_W(LOGGER_COMP_RS485, "%u baud not supported by every slave on %s, staying at %u",
+                 next->baud, device, current_baud);
+        ceiling = next->baud;
+    }
+}
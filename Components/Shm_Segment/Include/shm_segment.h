@@ -0,0 +1,88 @@
+#ifndef SHM_SEGMENT_H
+#define SHM_SEGMENT_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * POSIX shared memory pages with one writer process and lock-free readers (snapshot, rollups).
+ *
+ * A segment starts with a shm_segment_header_t. The writer creates and sizes it and stamps
+ * the header the first time; readers attach read-only and refuse any other magic/version.
+ * Payloads are published under a seqlock (shm_seqlock_*), kept in the segment itself.
+ */
+
+// --- Error codes ---
+#define SHM_SEGMENT_SUCCESS 0
+#define SHM_SEGMENT_E_OPEN -1       // shm_open/ftruncate/mmap failed
+#define SHM_SEGMENT_E_LAYOUT -2     // Segment is too small or has another magic/version
+
+/**
+ * @brief First member of every segment layout. Only append fields after it and bump the version.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+} shm_segment_header_t;
+
+/**
+ * @brief Maps a segment, creating and stamping it for a fresh writer.
+ * @param name POSIX shm name, or NULL for a private page (always the writer).
+ * @param size Size of the whole layout, header included.
+ * @param init Optional, fills the rest of a fresh header before the magic is published.
+ * @param component LOGGER_COMP_* the errors are reported under.
+ * @param err Optional pointer receiving a SHM_SEGMENT_E_* code on failure.
+ * @return Mapping of size bytes, or NULL on failure.
+ */
+void* shm_segment_open(const char *name, size_t size, int writer, uint32_t magic, uint32_t version,
+                       void (*init)(void *addr), int component, int *err);
+
+/**
+ * @brief Unmaps a segment. A shared one stays in /dev/shm.
+ */
+void shm_segment_close(void *addr, size_t size);
+
+/**
+ * @brief Removes a shared segment (the writer's shutdown, or tests).
+ * @return SHM_SEGMENT_SUCCESS or SHM_SEGMENT_E_OPEN.
+ */
+int shm_segment_unlink(const char *name, int component);
+
+// --- Seqlock: the counter is odd while the writer is inside ---
+static inline void shm_seqlock_write_begin(_Atomic uint32_t *seq) {
+    uint32_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void shm_seqlock_write_end(_Atomic uint32_t *seq) {
+    uint32_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+/**
+ * @brief Counter to pass to shm_seqlock_read_valid(). Odd: the writer is inside, try again.
+ */
+static inline uint32_t shm_seqlock_read_begin(const _Atomic uint32_t *seq) {
+    return atomic_load_explicit((_Atomic uint32_t*)seq, memory_order_acquire);
+}
+
+/**
+ * @brief 1 if nothing was written since shm_seqlock_read_begin(): the copy is consistent.
+ */
+static inline int shm_seqlock_read_valid(const _Atomic uint32_t *seq, uint32_t begin) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit((_Atomic uint32_t*)seq, memory_order_relaxed) == begin;
+}
+
+/**
+ * @brief Writer attach: a previous writer that died inside a write left the counter odd, so
+ *        readers would spin to E_BUSY forever and accept torn data once the parity flips back.
+ */
+static inline void shm_seqlock_recover(_Atomic uint32_t *seq) {
+    uint32_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    if (s & 1U) atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+#endif
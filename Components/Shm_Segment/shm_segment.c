@@ -0,0 +1,80 @@
+#include "shm_segment.h"
+#include "logger.h"
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>    // O_RDWR, O_CREAT
+#include <sys/mman.h> // shm_open, mmap
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*------------------------ Public Function -----------------------------*/
+void* shm_segment_open(const char *name, size_t size, int writer, uint32_t magic, uint32_t version,
+                       void (*init)(void *addr), int component, int *err) {
+    int code = SHM_SEGMENT_SUCCESS;
+    void *addr;
+
+    if (name == NULL) {
+        // Private page: only this process reads it, so it is always the writer
+        writer = 1;
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    } else {
+        int fd = writer ? shm_open(name, O_RDWR | O_CREAT, 0644) : shm_open(name, O_RDONLY, 0);
+        if (fd == -1) {
+            LOGGER_E(component, "shm_segment_open: shm_open %s failed: %s", name, strerror(errno));
+            code = SHM_SEGMENT_E_OPEN;
+            goto fail;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) == -1 || (writer && (size_t)st.st_size < size && ftruncate(fd, size) == -1)) {
+            LOGGER_E(component, "shm_segment_open: sizing %s failed: %s", name, strerror(errno));
+            close(fd);
+            code = SHM_SEGMENT_E_OPEN;
+            goto fail;
+        }
+        if (!writer && (size_t)st.st_size < size) {
+            close(fd);
+            code = SHM_SEGMENT_E_LAYOUT;
+            goto fail;
+        }
+
+        addr = mmap(NULL, size, writer ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // The mapping keeps the segment alive
+    }
+    if (addr == MAP_FAILED) {
+        LOGGER_E(component, "shm_segment_open: mmap failed: %s", strerror(errno));
+        code = SHM_SEGMENT_E_OPEN;
+        goto fail;
+    }
+
+    shm_segment_header_t *hdr = (shm_segment_header_t*)addr;
+    if (writer && hdr->magic != magic) {
+        // Fresh segment (zero-filled): stamp the header, the magic last
+        hdr->version = version;
+        if (init != NULL) init(addr);
+        hdr->magic = magic;
+    }
+    if (hdr->magic != magic || hdr->version != version) {
+        LOGGER_E(component, "shm_segment_open: %s has an unknown layout", name ? name : "private page");
+        munmap(addr, size);
+        code = SHM_SEGMENT_E_LAYOUT;
+        goto fail;
+    }
+    return addr;
+
+fail:
+    if (err != NULL) *err = code;
+    return NULL;
+}
+
+void shm_segment_close(void *addr, size_t size) {
+    if (addr != NULL) munmap(addr, size);
+}
+
+int shm_segment_unlink(const char *name, int component) {
+    if (shm_unlink(name) == -1) {
+        LOGGER_E(component, "shm_segment_unlink: shm_unlink %s failed: %s", name, strerror(errno));
+        return SHM_SEGMENT_E_OPEN;
+    }
+    return SHM_SEGMENT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+
+// --- Constants ---
+#define SNAPSHOT_SHM_NAME_DEFAULT "/lsmy_snapshot"
+#define SNAPSHOT_MAGIC 0x504E534CU   // "LSNP"
+#define SNAPSHOT_VERSION 1
+
+// --- Channels ---
+#define SNAPSHOT_CH_CO 0
+#define SNAPSHOT_CH_PM25 1
+#define SNAPSHOT_CH_PM10 2
+#define SNAPSHOT_CH_COUNT 3
+
+// --- Quality flags (per channel) ---
+#define SNAPSHOT_Q_VALID 0x01        // Channel has been written at least once
+#define SNAPSHOT_Q_SENSOR_ERROR 0x02 // Last poll of the sensor failed, value is the last good one
+#define SNAPSHOT_Q_ALERT 0x04        // Channel is currently in alert state
+
+// --- Error codes ---
+#define SNAPSHOT_SUCCESS 0
+#define SNAPSHOT_E_GENERIC_FAIL -1
+#define SNAPSHOT_E_OPEN -2      // shm_open/mmap failed
+#define SNAPSHOT_E_LAYOUT -3    // Segment exists but has another magic/version
+#define SNAPSHOT_E_BUSY -4      // Reader kept colliding with the writer
+
+/**
+ * @brief Latest sensor values, as seen by readers.
+ */
+typedef struct {
+    double value[SNAPSHOT_CH_COUNT];
+    uint64_t timestamp_ms[SNAPSHOT_CH_COUNT]; // Wall clock of the last write of each channel
+    uint32_t quality[SNAPSHOT_CH_COUNT];      // SNAPSHOT_Q_* flags
+    uint64_t sequence;                        // Number of published updates
+} snapshot_data_t;
+
+typedef struct snapshot snapshot_t;
+
+/**
+ * @brief Maps the snapshot segment in /dev/shm.
+ *
+ * The writer creates (or re-uses) the segment; readers only attach to an existing one.
+ * There must be a single writer process. Inside it, writes are serialised by the handle.
+ * A writer re-attaching after a crash releases the seqlock its predecessor may have held.
+ *
+ * @param name POSIX shm name (e.g., "/lsmy_snapshot").
+ * @param writer 1 to open read-write and create if missing, 0 to open read-only.
+ * @param err Optional pointer receiving a SNAPSHOT_E_* code on failure.
+ * @return Handle, or NULL on failure.
+ */
+snapshot_t* snapshot_open(const char *name, int writer, int *err);
+
+/**
+ * @brief Publishes one channel. Lock-free for readers.
+ * @param channel SNAPSHOT_CH_* index.
+ * @param timestamp_ms Wall clock of the sample (ms since epoch).
+ * @param quality SNAPSHOT_Q_* flags (SNAPSHOT_Q_VALID is always added).
+ * @return SNAPSHOT_SUCCESS or a negative error code.
+ */
+int snapshot_update(snapshot_t *s, int channel, double value, uint64_t timestamp_ms, uint32_t quality);
+
+/**
+ * @brief Publishes several channels as one consistent update.
+ * @param channels, values, timestamps_ms, qualities Arrays of n entries.
+ * @return SNAPSHOT_SUCCESS or a negative error code.
+ */
+int snapshot_update_many(snapshot_t *s, const int *channels, const double *values,
+                         const uint64_t *timestamps_ms, const uint32_t *qualities, int n);
+
+/**
+ * @brief Replaces the quality flags of a channel, keeping its value and timestamp
+ *        (e.g. SNAPSHOT_Q_SENSOR_ERROR when a poll fails). A channel never written stays invalid.
+ * @return SNAPSHOT_SUCCESS or a negative error code.
+ */
+int snapshot_set_quality(snapshot_t *s, int channel, uint32_t quality);
+
+/**
+ * @brief Copies a consistent snapshot. No locks, no syscalls.
+ * @return SNAPSHOT_SUCCESS, or SNAPSHOT_E_BUSY if the writer kept interfering.
+ */
+int snapshot_read(snapshot_t *s, snapshot_data_t *out);
+
+/**
+ * @brief Unmaps the segment and frees the handle. The segment itself stays in /dev/shm.
+ */
+void snapshot_close(snapshot_t *s);
+
+/**
+ * @brief Removes the segment from /dev/shm.
+ * @return SNAPSHOT_SUCCESS or SNAPSHOT_E_GENERIC_FAIL.
+ */
+int snapshot_cleanup(const char *name);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "snapshot.h"
+
+/*
+ * Telemetry encoder: serialises sensor samples into a caller buffer, no allocation.
+ *
+ * JSON output is CoreIoT's {"ts":ms,"values":{"co":..,"pm25":..,"pm10":..}} shape and is
+ * byte-for-byte what Python's json.dumps(obj, separators=(',', ':')) produces for the same
+ * dict (floats as repr(), channels without a value as null). CBOR output (RFC 8949) has
+ * the same structure, with every float in the shortest of half/single/double that keeps
+ * its value.
+ */
+
+// --- Formats ---
+#define TELEMETRY_FMT_JSON 0
+#define TELEMETRY_FMT_CBOR 1
+
+// --- Error codes ---
+#define TELEMETRY_SUCCESS 0
+#define TELEMETRY_E_GENERIC_FAIL -1
+#define TELEMETRY_E_SPACE -2        // Buffer too small
+#define TELEMETRY_E_SNAPSHOT -3     // Snapshot could not be read
+
+/**
+ * @brief One telemetry record: a timestamp and a value per snapshot channel.
+ */
+typedef struct {
+    uint64_t ts_ms;
+    double value[SNAPSHOT_CH_COUNT];
+    uint32_t valid;                 // Bit per SNAPSHOT_CH_*; cleared channels are encoded as null
+} telemetry_sample_t;
+
+/**
+ * @brief Encodes n samples: one object when as_array is 0 (n must be 1), else an array.
+ * @param format TELEMETRY_FMT_*.
+ * @return Bytes written (no terminator), or a negative TELEMETRY_E_* code.
+ */
+int telemetry_encode(const telemetry_sample_t *samples, int n, int as_array, int format, uint8_t *buf, size_t size);
+
+/**
+ * @brief Encodes the current snapshot values as one object stamped ts_ms (0 = now).
+ *        Channels never written or flagged SNAPSHOT_Q_SENSOR_ERROR are null.
+ * @return Bytes written, or a negative TELEMETRY_E_* code.
+ */
+int telemetry_encode_snapshot(snapshot_t *s, uint64_t ts_ms, int format, uint8_t *buf, size_t size);
+
+/**
+ * @brief Formats a double as Python's repr() (shortest round-trip digits).
+ * @return Length written (without the terminating NUL), or TELEMETRY_E_SPACE.
+ */
+int telemetry_format_double(double v, char *buf, size_t size);
+
+#endif
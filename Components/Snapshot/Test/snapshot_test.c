@@ -0,0 +1,163 @@
+#define _GNU_SOURCE
+#include "snapshot.h"
+#include "shm_segment.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+ * Snapshot segment built on Shm_Segment: a reader attached to a writer's segment.
+ *
+ * Covers publishing and quality flags, the layout checks at attach, recovery of a seqlock
+ * left odd by a writer killed mid-update, and reads racing a live writer, which must only
+ * ever see whole updates.
+ */
+
+#define RACE_UPDATES 1000000
+
+// Seqlock word: right after the segment header (see snapshot.c)
+#define SEQ_WORD (sizeof(shm_segment_header_t) / sizeof(uint32_t))
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __func__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+static const int CHANNELS[SNAPSHOT_CH_COUNT] = { SNAPSHOT_CH_CO, SNAPSHOT_CH_PM25, SNAPSHOT_CH_PM10 };
+
+static uint32_t* map_words(const char *name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+    uint32_t *words = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return (words == MAP_FAILED) ? NULL : words;
+}
+
+static void test_publish(const char *name) {
+    int err = 0;
+    snapshot_t *w = snapshot_open(name, 1, &err);
+    snapshot_t *rd = snapshot_open(name, 0, &err);
+    CHECK(w != NULL && rd != NULL, "open: %d", err);
+    if (w == NULL || rd == NULL) return;
+
+    snapshot_data_t d;
+    CHECK(snapshot_read(rd, &d) == SNAPSHOT_SUCCESS && d.sequence == 0 && d.quality[0] == 0, "fresh segment");
+
+    double values[2] = { 1.5, 12.0 };
+    uint64_t ts[2] = { 1000, 2000 };
+    uint32_t q[2] = { 0, SNAPSHOT_Q_ALERT };
+    CHECK(snapshot_update_many(w, CHANNELS, values, ts, q, 2) == SNAPSHOT_SUCCESS, "update_many");
+    CHECK(snapshot_read(rd, &d) == SNAPSHOT_SUCCESS, "read");
+    CHECK(d.sequence == 1 && d.value[0] == 1.5 && d.value[1] == 12.0 && d.timestamp_ms[1] == 2000,
+          "published: sequence %llu", (unsigned long long)d.sequence);
+    CHECK(d.quality[0] == SNAPSHOT_Q_VALID && d.quality[1] == (SNAPSHOT_Q_VALID | SNAPSHOT_Q_ALERT) && d.quality[2] == 0,
+          "quality %u %u %u", d.quality[0], d.quality[1], d.quality[2]);
+    CHECK(snapshot_update(rd, 0, 9.0, 1, 0) == SNAPSHOT_E_GENERIC_FAIL, "reader could write");
+    CHECK(snapshot_update(w, SNAPSHOT_CH_COUNT, 9.0, 1, 0) == SNAPSHOT_E_GENERIC_FAIL, "channel range");
+
+    // Quality only: value and timestamp stay, a never-written channel stays invalid
+    CHECK(snapshot_set_quality(w, 0, SNAPSHOT_Q_SENSOR_ERROR) == SNAPSHOT_SUCCESS, "set_quality");
+    CHECK(snapshot_set_quality(w, 2, SNAPSHOT_Q_SENSOR_ERROR) == SNAPSHOT_SUCCESS, "set_quality unwritten");
+    CHECK(snapshot_set_quality(rd, 0, 0) == SNAPSHOT_E_GENERIC_FAIL, "reader could set quality");
+    snapshot_read(rd, &d);
+    CHECK(d.quality[0] == (SNAPSHOT_Q_VALID | SNAPSHOT_Q_SENSOR_ERROR) && d.value[0] == 1.5 && d.timestamp_ms[0] == 1000,
+          "after set_quality: quality %u value %g", d.quality[0], d.value[0]);
+    CHECK(d.quality[2] == 0 && d.sequence == 3, "unwritten quality %u sequence %llu", d.quality[2], (unsigned long long)d.sequence);
+    snapshot_close(w);
+
+    // Writer killed inside an update: the seqlock stays odd until the next writer attaches
+    uint32_t *words = map_words(name);
+    CHECK(words != NULL, "map segment");
+    if (words == NULL) return;
+    words[SEQ_WORD] |= 1U;
+    CHECK(snapshot_read(rd, &d) == SNAPSHOT_E_BUSY, "odd seqlock not reported busy");
+    w = snapshot_open(name, 1, &err);
+    CHECK(w != NULL && (words[SEQ_WORD] & 1U) == 0, "writer reattach: %d", err);
+    CHECK(snapshot_read(rd, &d) == SNAPSHOT_SUCCESS && d.value[1] == 12.0 && d.sequence == 3, "data after recovery");
+
+    snapshot_close(rd);
+    snapshot_close(w);
+    munmap(words, 4096);
+    snapshot_cleanup(name);
+}
+
+static void test_layout(const char *name) {
+    int err = 0;
+    snapshot_t *s = snapshot_open("/snapshot_test_missing", 0, &err);
+    CHECK(s == NULL && err == SNAPSHOT_E_OPEN, "missing segment: err %d", err);
+
+    // Another layout version already in place: neither side may use it
+    s = snapshot_open(name, 1, &err);
+    uint32_t *words = map_words(name);
+    CHECK(s != NULL && words != NULL, "open");
+    if (s == NULL || words == NULL) return;
+    snapshot_close(s);
+    words[1] = SNAPSHOT_VERSION + 1;
+    err = 0;
+    s = snapshot_open(name, 0, &err);
+    CHECK(s == NULL && err == SNAPSHOT_E_LAYOUT, "reader attached to version %u: err %d", words[1], err);
+    err = 0;
+    s = snapshot_open(name, 1, &err);
+    CHECK(s == NULL && err == SNAPSHOT_E_LAYOUT, "writer attached to version %u: err %d", words[1], err);
+    snapshot_close(s);
+    munmap(words, 4096);
+    snapshot_cleanup(name);
+}
+
+static void* race_writer(void *arg) {
+    snapshot_t *w = (snapshot_t*)arg;
+    for (int i = 1; i <= RACE_UPDATES; i++) {
+        double values[SNAPSHOT_CH_COUNT] = { i, i, i };
+        uint64_t ts[SNAPSHOT_CH_COUNT] = { i, i, i };
+        snapshot_update_many(w, CHANNELS, values, ts, NULL, SNAPSHOT_CH_COUNT);
+    }
+    return NULL;
+}
+
+// Every update writes i to all channels as update number i: a whole copy agrees everywhere
+static void test_race(const char *name) {
+    int err = 0;
+    snapshot_t *w = snapshot_open(name, 1, &err);
+    snapshot_t *rd = snapshot_open(name, 0, &err);
+    CHECK(w != NULL && rd != NULL, "open: %d", err);
+    if (w == NULL || rd == NULL) return;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, race_writer, w);
+    int reads = 0, torn = 0;
+    snapshot_data_t d = { 0 };
+    while (d.sequence < RACE_UPDATES) {
+        if (snapshot_read(rd, &d) != SNAPSHOT_SUCCESS) continue;
+        reads++;
+        double v = (double)d.sequence;
+        if (d.sequence > 0 && (d.value[0] != v || d.value[1] != v || d.value[2] != v ||
+                               d.timestamp_ms[0] != d.sequence || d.timestamp_ms[2] != d.sequence)) torn++;
+    }
+    pthread_join(thread, NULL);
+    CHECK(torn == 0, "%d torn reads of %d", torn, reads);
+
+    snapshot_close(rd);
+    snapshot_close(w);
+    snapshot_cleanup(name);
+}
+
+int main(void) {
+    char name[64];
+    snprintf(name, sizeof(name), "/snapshot_test_%d", (int)getpid());
+
+    test_publish(name);
+    test_layout(name);
+    test_race(name);
+
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,225 @@
+import ctypes
+import json
+import math
+import random
+import struct
+import sys
+import unittest
+
+"""
+telemetry.c against Python: JSON must be byte-for-byte json.dumps(obj, separators=(',', ':')),
+CBOR must decode back to the same samples with every float in its shortest exact width.
+
+    python3 Test/telemetry_test.py <path to libsnapshot.so>     (ctest passes the built library)
+"""
+
+SNAPSHOT_CH_COUNT = 3
+TELEMETRY_FMT_JSON = 0
+TELEMETRY_FMT_CBOR = 1
+TELEMETRY_E_SPACE = -2
+KEYS = ("co", "pm25", "pm10")   # Same order as telemetry.c
+RANDOM_DOUBLES = 200000
+
+lib = None
+
+
+class TelemetrySample(ctypes.Structure):
+    _fields_ = [("ts_ms", ctypes.c_uint64),
+                ("value", ctypes.c_double * SNAPSHOT_CH_COUNT),
+                ("valid", ctypes.c_uint32)]
+
+
+def load(path):
+    global lib
+    lib = ctypes.CDLL(path)
+    lib.telemetry_encode.argtypes = [ctypes.POINTER(TelemetrySample), ctypes.c_int, ctypes.c_int, ctypes.c_int,
+                                     ctypes.c_char_p, ctypes.c_size_t]
+    lib.telemetry_encode.restype = ctypes.c_int
+    lib.telemetry_format_double.argtypes = [ctypes.c_double, ctypes.c_char_p, ctypes.c_size_t]
+    lib.telemetry_format_double.restype = ctypes.c_int
+
+
+def format_double(v):
+    buf = ctypes.create_string_buffer(64)
+    n = lib.telemetry_format_double(v, buf, len(buf))
+    assert n >= 0
+    return buf.raw[:n].decode()
+
+
+def encode(samples, fmt, as_array=True, size=None):
+    """samples: [(ts, [value or None per channel])]. Returns bytes, or the negative error code."""
+    records = (TelemetrySample * max(len(samples), 1))()
+    for record, (ts, values) in zip(records, samples):
+        record.ts_ms = ts
+        for ch, value in enumerate(values):
+            if value is not None:
+                record.value[ch] = value
+                record.valid |= 1 << ch
+    size = 64 + 256 * len(samples) if size is None else size
+    buf = ctypes.create_string_buffer(max(size, 1))
+    n = lib.telemetry_encode(records, len(samples), 1 if as_array else 0, fmt, buf, size)
+    return n if n < 0 else buf.raw[:n]
+
+
+def as_objects(samples):
+    return [{"ts": ts, "values": dict(zip(KEYS, values))} for ts, values in samples]
+
+
+# --- Minimal CBOR decoder (RFC 8949 subset used by telemetry.c) ---
+def cbor_decode(data):
+    value, pos, widths = _cbor_item(data, 0, [])
+    if pos != len(data):
+        raise ValueError(f"{len(data) - pos} trailing bytes")
+    return value, widths
+
+
+def _cbor_item(data, pos, widths):
+    head = data[pos]
+    major, info = head >> 5, head & 0x1F
+    pos += 1
+    if major == 7:
+        if info == 22:
+            return None, pos, widths
+        size = {25: 2, 26: 4, 27: 8}[info]
+        raw = data[pos:pos + size]
+        value = struct.unpack({2: ">e", 4: ">f", 8: ">d"}[size], raw)[0]
+        widths.append((value, size))
+        return value, pos + size, widths
+    if info < 24:
+        arg = info
+    else:
+        size = {24: 1, 25: 2, 26: 4, 27: 8}[info]
+        arg = int.from_bytes(data[pos:pos + size], "big")
+        if arg < (24 if size == 1 else 1 << (4 * size)):
+            raise ValueError(f"argument {arg} not in its shortest form")
+        pos += size
+    if major == 0:
+        return arg, pos, widths
+    if major == 3:
+        return data[pos:pos + arg].decode(), pos + arg, widths
+    if major == 4:
+        items = []
+        for _ in range(arg):
+            item, pos, widths = _cbor_item(data, pos, widths)
+            items.append(item)
+        return items, pos, widths
+    if major == 5:
+        items = {}
+        for _ in range(arg):
+            key, pos, widths = _cbor_item(data, pos, widths)
+            items[key], pos, widths = _cbor_item(data, pos, widths)
+        return items, pos, widths
+    raise ValueError(f"unexpected major type {major}")
+
+
+def shortest_width(v):
+    """Bytes of the shortest IEEE float that holds v exactly (NaN is canonical half)."""
+    if math.isnan(v):
+        return 2
+    for size, fmt in ((2, ">e"), (4, ">f")):
+        try:
+            if struct.unpack(fmt, struct.pack(fmt, v))[0] == v:
+                return size
+        except OverflowError:
+            pass
+    return 8
+
+
+def same_double(a, b):
+    if a is None or b is None:
+        return a is b
+    if math.isnan(a):
+        return math.isnan(b)
+    return a == b and math.copysign(1.0, a) == math.copysign(1.0, b)
+
+
+# --- Values ---
+def special_doubles():
+    values = [0.0, -0.0, 1.0, -1.0, 0.1, 0.2, 0.3, 1.5, 2.5, 100.0, 12.5, 65504.0, 65505.0, 65520.0,
+              1e-4, 1e-5, 0.0001, 0.00011, 9.999999999999999e-05, 1e15, 1e16, 1e17, 9999999999999998.0,
+              1.0000000000000002e16, 123456789012345678.0, 1e22, 1e23, 1.7976931348623157e308,
+              5e-324, 2.2250738585072014e-308, 2.225073858507201e-308, 2.0 ** -14, 2.0 ** -24, 1.5 * 2.0 ** -24, 2.0 ** -25,
+              3.4028234663852886e38, 3.4028235677973366e38, 1.401298464324817e-45, 1.1754943508222875e-38,
+              math.pi, math.e, 1 / 3, 2 / 3, float("inf"), float("-inf"), float("nan")]
+    for e in range(-1074, 1024):
+        values.append(math.ldexp(1.0, e))   # Every power of two, subnormals included
+    for v in list(values):
+        values.append(-v)
+    for e in range(-6, 20):
+        for m in (1.0, 9.999999999999998, 5.0):
+            values.append(m * 10.0 ** e)
+    return values
+
+
+def random_doubles(rng, n):
+    out = []
+    for _ in range(n):
+        bits = rng.getrandbits(64)
+        v = struct.unpack("<d", bits.to_bytes(8, "little"))[0]
+        out.append(v)
+        out.append(round(rng.uniform(-1000, 1000), rng.randint(0, 6)))     # Sensor-like values
+    return out
+
+
+class TelemetryJsonTest(unittest.TestCase):
+    def test_doubles_match_repr(self):
+        rng = random.Random(2024)
+        values = special_doubles() + random_doubles(rng, RANDOM_DOUBLES)
+        mismatches = [(v, format_double(v)) for v in values if format_double(v) != json.dumps(v)]
+        self.assertEqual(mismatches[:10], [], f"{len(mismatches)} of {len(values)} doubles differ from repr()")
+
+    def test_samples_match_json_dumps(self):
+        rng = random.Random(7)
+        pool = special_doubles() + random_doubles(rng, 2000)
+        for n in (1, 2, 5, 30):
+            for _ in range(200):
+                samples = [(rng.randint(0, 1 << 53), [rng.choice(pool) if rng.random() > 0.2 else None
+                                                      for _ in KEYS]) for _ in range(n)]
+                expected = json.dumps(as_objects(samples), separators=(',', ':')).encode()
+                self.assertEqual(encode(samples, TELEMETRY_FMT_JSON), expected)
+
+    def test_single_object_and_null_channels(self):
+        samples = [(1700000000123, [None, None, None])]
+        self.assertEqual(encode(samples, TELEMETRY_FMT_JSON, as_array=False),
+                         b'{"ts":1700000000123,"values":{"co":null,"pm25":null,"pm10":null}}')
+        self.assertEqual(encode([], TELEMETRY_FMT_JSON), b"[]")
+
+    def test_buffer_too_small(self):
+        samples = [(1, [1.0, 2.0, None])]
+        full = encode(samples, TELEMETRY_FMT_JSON)
+        self.assertEqual(encode(samples, TELEMETRY_FMT_JSON, size=len(full) - 1), TELEMETRY_E_SPACE)
+        self.assertEqual(encode(samples, TELEMETRY_FMT_JSON, size=len(full)), full)
+
+
+class TelemetryCborTest(unittest.TestCase):
+    def test_round_trip(self):
+        rng = random.Random(11)
+        pool = special_doubles() + random_doubles(rng, 5000)
+        for n in (1, 3, 30):
+            for _ in range(300):
+                samples = [(rng.choice((0, 23, 24, 255, 256, 65535, 65536, 1 << 32, rng.randint(0, 1 << 63))),
+                            [rng.choice(pool) if rng.random() > 0.2 else None for _ in KEYS]) for _ in range(n)]
+                decoded, widths = cbor_decode(encode(samples, TELEMETRY_FMT_CBOR))
+                self.assertEqual(len(decoded), n)
+                for obj, (ts, values) in zip(decoded, samples):
+                    self.assertEqual(list(obj), ["ts", "values"])
+                    self.assertEqual(obj["ts"], ts)
+                    self.assertEqual(list(obj["values"]), list(KEYS))
+                    for key, value in zip(KEYS, values):
+                        self.assertTrue(same_double(obj["values"][key], value), f"{key}: {obj['values'][key]!r} != {value!r}")
+                for value, size in widths:
+                    self.assertEqual(size, shortest_width(value), f"{value!r} encoded in {size} bytes")
+
+    def test_single_object(self):
+        decoded, _ = cbor_decode(encode([(5, [1.5, None, -0.0])], TELEMETRY_FMT_CBOR, as_array=False))
+        self.assertEqual(decoded["ts"], 5)
+        self.assertEqual(decoded["values"]["co"], 1.5)
+        self.assertIsNone(decoded["values"]["pm25"])
+        self.assertTrue(same_double(decoded["values"]["pm10"], -0.0))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        sys.exit(f"usage: {sys.argv[0]} <libsnapshot.so> [unittest args]")
+    load(sys.argv.pop(1))
+    unittest.main()
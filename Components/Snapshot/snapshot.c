@@ -0,0 +1,120 @@
+#include "snapshot.h"
+#include "shm_segment.h"
+#include "logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define READ_MAX_RETRIES 1000
+
+// Layout of the shared segment. Only append fields and bump SNAPSHOT_VERSION.
+typedef struct {
+    shm_segment_header_t hdr;
+    _Atomic uint32_t seq;   // Seqlock: odd while the writer is inside
+    uint32_t reserved;
+    snapshot_data_t data;
+} snapshot_shm_t;
+
+struct snapshot {
+    snapshot_shm_t *shm;
+    int writer;
+    pthread_mutex_t write_lock;
+};
+
+/*---------------------------- Private Function --------------------------------*/
+static int open_error(int code) {
+    return (code == SHM_SEGMENT_E_LAYOUT) ? SNAPSHOT_E_LAYOUT : SNAPSHOT_E_OPEN;
+}
+
+/*------------------------ Public Function -----------------------------*/
+snapshot_t* snapshot_open(const char *name, int writer, int *err) {
+    int code = SNAPSHOT_SUCCESS;
+    snapshot_t *s = calloc(1, sizeof(*s));
+    if (s == NULL) {
+        code = SNAPSHOT_E_GENERIC_FAIL;
+        goto fail;
+    }
+
+    int seg_err = SHM_SEGMENT_SUCCESS;
+    s->shm = shm_segment_open(name, sizeof(snapshot_shm_t), writer, SNAPSHOT_MAGIC, SNAPSHOT_VERSION,
+                              NULL, LOGGER_COMP_SNAPSHOT, &seg_err);
+    if (s->shm == NULL) {
+        code = open_error(seg_err);
+        goto fail;
+    }
+    s->writer = writer;
+    if (writer) shm_seqlock_recover(&s->shm->seq);
+
+    pthread_mutex_init(&s->write_lock, NULL);
+    return s;
+
+fail:
+    free(s);
+    if (err != NULL) *err = code;
+    return NULL;
+}
+
+int snapshot_update(snapshot_t *s, int channel, double value, uint64_t timestamp_ms, uint32_t quality) {
+    return snapshot_update_many(s, &channel, &value, &timestamp_ms, &quality, 1);
+}
+
+int snapshot_update_many(snapshot_t *s, const int *channels, const double *values,
+                         const uint64_t *timestamps_ms, const uint32_t *qualities, int n) {
+    if (s == NULL || !s->writer || channels == NULL || values == NULL || timestamps_ms == NULL) {
+        return SNAPSHOT_E_GENERIC_FAIL;
+    }
+    for (int i = 0; i < n; i++) {
+        if (channels[i] < 0 || channels[i] >= SNAPSHOT_CH_COUNT) return SNAPSHOT_E_GENERIC_FAIL;
+    }
+
+    pthread_mutex_lock(&s->write_lock);
+    shm_seqlock_write_begin(&s->shm->seq);
+    for (int i = 0; i < n; i++) {
+        int ch = channels[i];
+        s->shm->data.value[ch] = values[i];
+        s->shm->data.timestamp_ms[ch] = timestamps_ms[i];
+        s->shm->data.quality[ch] = (qualities != NULL ? qualities[i] : 0) | SNAPSHOT_Q_VALID;
+    }
+    s->shm->data.sequence++;
+    shm_seqlock_write_end(&s->shm->seq);
+    pthread_mutex_unlock(&s->write_lock);
+    return SNAPSHOT_SUCCESS;
+}
+
+int snapshot_set_quality(snapshot_t *s, int channel, uint32_t quality) {
+    if (s == NULL || !s->writer || channel < 0 || channel >= SNAPSHOT_CH_COUNT) return SNAPSHOT_E_GENERIC_FAIL;
+
+    pthread_mutex_lock(&s->write_lock);
+    shm_seqlock_write_begin(&s->shm->seq);
+    uint32_t valid = s->shm->data.quality[channel] & SNAPSHOT_Q_VALID;
+    s->shm->data.quality[channel] = valid ? (quality | SNAPSHOT_Q_VALID) : 0;
+    s->shm->data.sequence++;
+    shm_seqlock_write_end(&s->shm->seq);
+    pthread_mutex_unlock(&s->write_lock);
+    return SNAPSHOT_SUCCESS;
+}
+
+int snapshot_read(snapshot_t *s, snapshot_data_t *out) {
+    if (s == NULL || out == NULL) return SNAPSHOT_E_GENERIC_FAIL;
+
+    for (int attempt = 0; attempt < READ_MAX_RETRIES; attempt++) {
+        uint32_t begin = shm_seqlock_read_begin(&s->shm->seq);
+        if (begin & 1U) continue; // Writer inside, try again
+
+        memcpy(out, &s->shm->data, sizeof(*out));
+        if (shm_seqlock_read_valid(&s->shm->seq, begin)) return SNAPSHOT_SUCCESS;
+    }
+    return SNAPSHOT_E_BUSY;
+}
+
+void snapshot_close(snapshot_t *s) {
+    if (s == NULL) return;
+    shm_segment_close(s->shm, sizeof(snapshot_shm_t));
+    pthread_mutex_destroy(&s->write_lock);
+    free(s);
+}
+
+int snapshot_cleanup(const char *name) {
+    return (shm_segment_unlink(name, LOGGER_COMP_SNAPSHOT) == SHM_SEGMENT_SUCCESS) ? SNAPSHOT_SUCCESS
+                                                                                    : SNAPSHOT_E_GENERIC_FAIL;
+}
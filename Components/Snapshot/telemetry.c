@@ -0,0 +1,426 @@
+#include "telemetry.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DOUBLE_TEXT_MAX 32      // Longest repr(): "-1.2345678901234567e-308"
+#define FAST_DECIMALS 6         // Decimals tried by the exact m / 10^k fast path
+
+// Keys of the "values" object, indexed by SNAPSHOT_CH_* (same order as the Python formatter)
+static const char *const channel_keys[SNAPSHOT_CH_COUNT] = { "co", "pm25", "pm10" };
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    int overflow;
+} out_t;
+
+/*---------------------------- Private Function --------------------------------*/
+static void put(out_t *o, const void *data, size_t n) {
+    if (o->overflow || n > o->size - o->len) {
+        o->overflow = 1;
+        return;
+    }
+    memcpy(o->buf + o->len, data, n);
+    o->len += n;
+}
+
+static void put_byte(out_t *o, uint8_t b) {
+    put(o, &b, 1);
+}
+
+static void put_str(out_t *o, const char *s) {
+    put(o, s, strlen(s));
+}
+
+static void put_u64(out_t *o, uint64_t v) {
+    char tmp[20];
+    int i = sizeof(tmp);
+    do {
+        tmp[--i] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    put(o, tmp + i, sizeof(tmp) - i);
+}
+
+// Splits "%e" output into its significant digits (returned count) and decimal exponent
+static int split_exp_text(const char *text, char *digits, int *exp10) {
+    int n = 0;
+    const char *p = text;
+    for (; *p != 'e'; p++) {
+        if (*p != '.') {
+            digits[n++] = *p;
+        }
+    }
+    *exp10 = atoi(p + 1);
+    return n;
+}
+
+// Reads digits (d1.d2d3... * 10^exp10) back as a double
+static double digits_value(const char *digits, int n, int exp10) {
+    char text[DOUBLE_TEXT_MAX];
+    snprintf(text, sizeof(text), "%.1s.%.*se%d", digits, n - 1, digits + 1, exp10);
+    return strtod(text, NULL);
+}
+
+/**
+ * Shortest decimal digits that read back as v (v finite and > 0), as Python's repr picks them:
+ * the fewest significant digits that round-trip, correctly rounded. Round-tripping is monotonic
+ * in the precision, so the precision is bisected over 1..17.
+ * @return Number of digits written to digits (no trailing zeros); *decpt receives the position of
+ *         the decimal point relative to the first digit (value = 0.d1d2... * 10^decpt).
+ */
+static int shortest_digits(double v, char *digits, int *decpt) {
+    char tmp[DOUBLE_TEXT_MAX];
+    int exp10;
+
+    // Fast path for sensor readings (few decimals): v is exactly m / 10^k with m below 10^15.
+    // Decimals of at most 15 digits map to distinct doubles, so m's digits are the shortest.
+    if (v < 1e15) {
+        static const double pow10[FAST_DECIMALS + 1] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6 };
+        for (int k = 0; k <= FAST_DECIMALS; k++) {
+            double scaled = nearbyint(v * pow10[k]);
+            if (scaled >= 1e15) {
+                break;
+            }
+            if (scaled > 0 && scaled / pow10[k] == v) {
+                uint64_t m = (uint64_t)scaled;
+                int n = 0;
+                for (uint64_t t = m; t != 0; t /= 10) {
+                    n++;
+                }
+                for (int i = n - 1; i >= 0; i--) {
+                    digits[i] = (char)('0' + m % 10);
+                    m /= 10;
+                }
+                *decpt = n - k;
+                while (n > 1 && digits[n - 1] == '0') {
+                    n--;
+                }
+                return n;
+            }
+        }
+    }
+
+    int lo = 1, hi = 17;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        snprintf(tmp, sizeof(tmp), "%.*e", mid - 1, v);
+        if (strtod(tmp, NULL) == v) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    snprintf(tmp, sizeof(tmp), "%.*e", lo - 1, v);
+    int n = split_exp_text(tmp, digits, &exp10);
+
+    // A power of two has a narrower rounding interval below it than above: the nearest
+    // shorter candidate can miss it while the next one up still reads back as v
+    int e2;
+    if (frexp(v, &e2) == 0.5) {
+        for (int q = 1; q < lo; q++) {
+            char cand[17];
+            int cexp;
+            snprintf(tmp, sizeof(tmp), "%.*e", q - 1, v);
+            split_exp_text(tmp, cand, &cexp);
+            int i = q - 1;
+            while (i >= 0 && cand[i] == '9') {
+                cand[i--] = '0';
+            }
+            if (i < 0) {
+                cand[0] = '1';
+                cexp++;
+            } else {
+                cand[i]++;
+            }
+            if (digits_value(cand, q, cexp) == v) {
+                memcpy(digits, cand, q);
+                n = q;
+                exp10 = cexp;
+                break;
+            }
+        }
+    }
+
+    while (n > 1 && digits[n - 1] == '0') {
+        n--;
+    }
+    *decpt = exp10 + 1;
+    return n;
+}
+
+static void put_double_json(out_t *o, double v) {
+    char text[DOUBLE_TEXT_MAX];
+    int n = telemetry_format_double(v, text, sizeof(text));
+    if (n < 0) {
+        o->overflow = 1;
+        return;
+    }
+    put(o, text, (size_t)n);
+}
+
+static void put_sample_json(out_t *o, const telemetry_sample_t *s) {
+    put_str(o, "{\"ts\":");
+    put_u64(o, s->ts_ms);
+    put_str(o, ",\"values\":{");
+    for (int ch = 0; ch < SNAPSHOT_CH_COUNT; ch++) {
+        if (ch > 0) {
+            put_byte(o, ',');
+        }
+        put_byte(o, '"');
+        put_str(o, channel_keys[ch]);
+        put_str(o, "\":");
+        if (s->valid & (1U << ch)) {
+            put_double_json(o, s->value[ch]);
+        } else {
+            put_str(o, "null");
+        }
+    }
+    put_str(o, "}}");
+}
+
+// CBOR head: major type and argument in the shortest form (RFC 8949, 3.)
+static void put_cbor_head(out_t *o, uint8_t major, uint64_t arg) {
+    uint8_t head[9];
+    int n;
+    if (arg < 24) {
+        head[0] = (uint8_t)(major << 5 | arg);
+        n = 1;
+    } else if (arg <= 0xFF) {
+        head[0] = (uint8_t)(major << 5 | 24);
+        head[1] = (uint8_t)arg;
+        n = 2;
+    } else if (arg <= 0xFFFF) {
+        head[0] = (uint8_t)(major << 5 | 25);
+        n = 3;
+    } else if (arg <= 0xFFFFFFFFU) {
+        head[0] = (uint8_t)(major << 5 | 26);
+        n = 5;
+    } else {
+        head[0] = (uint8_t)(major << 5 | 27);
+        n = 9;
+    }
+    for (int i = n - 1; i >= 1 && n > 2; i--) {
+        head[i] = (uint8_t)arg;
+        arg >>= 8;
+    }
+    put(o, head, (size_t)n);
+}
+
+static void put_cbor_text(out_t *o, const char *s) {
+    size_t n = strlen(s);
+    put_cbor_head(o, 3, n);
+    put(o, s, n);
+}
+
+// Half-precision bits of v if it is exactly representable, else -1
+static int half_bits(double v) {
+    int sign = signbit(v) ? 0x8000 : 0;
+    double a = fabs(v);
+    if (a == 0.0) {
+        return sign;
+    }
+    if (isinf(a)) {
+        return sign | 0x7C00;
+    }
+    if (a > 65504.0) {
+        return -1;
+    }
+    if (a >= 0x1p-14) {
+        int e;
+        double m = frexp(a, &e) * 2048.0;       // 11 significant bits, implicit one included
+        if (m != floor(m)) {
+            return -1;
+        }
+        return sign | (e - 1 + 15) << 10 | ((int)m - 1024);
+    }
+    double sub = a * 0x1p24;                    // Subnormal: multiples of 2^-24
+    if (sub != floor(sub)) {
+        return -1;
+    }
+    return sign | (int)sub;
+}
+
+static void put_cbor_double(out_t *o, double v) {
+    uint8_t b[9];
+    if (isnan(v)) {
+        const uint8_t nan[3] = { 0xF9, 0x7E, 0x00 };
+        put(o, nan, sizeof(nan));
+        return;
+    }
+    int half = half_bits(v);
+    if (half >= 0) {
+        b[0] = 0xF9;
+        b[1] = (uint8_t)(half >> 8);
+        b[2] = (uint8_t)half;
+        put(o, b, 3);
+        return;
+    }
+    if (fabs(v) <= FLT_MAX && (double)(float)v == v) {
+        float f = (float)v;
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        b[0] = 0xFA;
+        for (int i = 0; i < 4; i++) {
+            b[1 + i] = (uint8_t)(bits >> (24 - 8 * i));
+        }
+        put(o, b, 5);
+        return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    b[0] = 0xFB;
+    for (int i = 0; i < 8; i++) {
+        b[1 + i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    put(o, b, 9);
+}
+
+static void put_sample_cbor(out_t *o, const telemetry_sample_t *s) {
+    put_cbor_head(o, 5, 2);
+    put_cbor_text(o, "ts");
+    put_cbor_head(o, 0, s->ts_ms);
+    put_cbor_text(o, "values");
+    put_cbor_head(o, 5, SNAPSHOT_CH_COUNT);
+    for (int ch = 0; ch < SNAPSHOT_CH_COUNT; ch++) {
+        put_cbor_text(o, channel_keys[ch]);
+        if (s->valid & (1U << ch)) {
+            put_cbor_double(o, s->value[ch]);
+        } else {
+            put_byte(o, 0xF6);                  // null
+        }
+    }
+}
+
+/*------------------------ Public Function -----------------------------*/
+int telemetry_format_double(double v, char *buf, size_t size) {
+    char text[DOUBLE_TEXT_MAX];
+    int len = 0;
+
+    if (isnan(v)) {
+        strcpy(text, "NaN");
+        len = 3;
+    } else if (isinf(v)) {
+        len = snprintf(text, sizeof(text), "%s", v < 0 ? "-Infinity" : "Infinity");
+    } else {
+        if (signbit(v)) {
+            text[len++] = '-';
+            v = -v;
+        }
+        if (v == 0.0) {
+            memcpy(text + len, "0.0", 3);
+            len += 3;
+        } else {
+            char digits[17];
+            int decpt;
+            int n = shortest_digits(v, digits, &decpt);
+            if (decpt > -4 && decpt <= 16) {
+                // Fixed notation: 0.000ddd, ddd00.0 or dd.ddd
+                if (decpt <= 0) {
+                    text[len++] = '0';
+                    text[len++] = '.';
+                    for (int i = decpt; i < 0; i++) {
+                        text[len++] = '0';
+                    }
+                    memcpy(text + len, digits, n);
+                    len += n;
+                } else if (decpt >= n) {
+                    memcpy(text + len, digits, n);
+                    len += n;
+                    for (int i = n; i < decpt; i++) {
+                        text[len++] = '0';
+                    }
+                    text[len++] = '.';
+                    text[len++] = '0';
+                } else {
+                    memcpy(text + len, digits, decpt);
+                    len += decpt;
+                    text[len++] = '.';
+                    memcpy(text + len, digits + decpt, n - decpt);
+                    len += n - decpt;
+                }
+            } else {
+                // Exponent notation: d.ddde+XX, at least two exponent digits
+                text[len++] = digits[0];
+                if (n > 1) {
+                    text[len++] = '.';
+                    memcpy(text + len, digits + 1, n - 1);
+                    len += n - 1;
+                }
+                len += snprintf(text + len, sizeof(text) - len, "e%c%02d", decpt - 1 < 0 ? '-' : '+',
+                                abs(decpt - 1));
+            }
+        }
+    }
+
+    if ((size_t)len + 1 > size) {
+        return TELEMETRY_E_SPACE;
+    }
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+    return len;
+}
+
+int telemetry_encode(const telemetry_sample_t *samples, int n, int as_array, int format, uint8_t *buf, size_t size) {
+    if ((samples == NULL && n > 0) || n < 0 || (!as_array && n != 1) || buf == NULL ||
+        (format != TELEMETRY_FMT_JSON && format != TELEMETRY_FMT_CBOR)) {
+        return TELEMETRY_E_GENERIC_FAIL;
+    }
+
+    out_t o = { buf, size, 0, 0 };
+    if (format == TELEMETRY_FMT_JSON) {
+        if (as_array) {
+            put_byte(&o, '[');
+        }
+        for (int i = 0; i < n && !o.overflow; i++) {
+            if (i > 0) {
+                put_byte(&o, ',');
+            }
+            put_sample_json(&o, &samples[i]);
+        }
+        if (as_array) {
+            put_byte(&o, ']');
+        }
+    } else {
+        if (as_array) {
+            put_cbor_head(&o, 4, (uint64_t)n);
+        }
+        for (int i = 0; i < n && !o.overflow; i++) {
+            put_sample_cbor(&o, &samples[i]);
+        }
+    }
+
+    if (o.overflow) {
+        return TELEMETRY_E_SPACE;
+    }
+    return (int)o.len;
+}
+
+int telemetry_encode_snapshot(snapshot_t *s, uint64_t ts_ms, int format, uint8_t *buf, size_t size) {
+    snapshot_data_t data;
+    if (s == NULL || snapshot_read(s, &data) != SNAPSHOT_SUCCESS) {
+        return TELEMETRY_E_SNAPSHOT;
+    }
+
+    telemetry_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+    if (ts_ms == 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        ts_ms = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+    }
+    sample.ts_ms = ts_ms;
+    for (int ch = 0; ch < SNAPSHOT_CH_COUNT; ch++) {
+        sample.value[ch] = data.value[ch];
+        // A failed sensor's last value is not reported as current
+        if ((data.quality[ch] & (SNAPSHOT_Q_VALID | SNAPSHOT_Q_SENSOR_ERROR)) == SNAPSHOT_Q_VALID) {
+            sample.valid |= 1U << ch;
+        }
+    }
+    return telemetry_encode(&sample, 1, 0, format, buf, size);
+}
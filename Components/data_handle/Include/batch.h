@@ -0,0 +1,42 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+/*
+ * Multi-channel kernels. A block holds `window` rows of `channels` samples:
+ *
+ *     block[w * stride + k]   = sample w of channel k   (0 <= w < window, 0 <= k < channels)
+ *
+ * Rows are contiguous across channels, so one SIMD register covers several
+ * channels at the same window position. stride >= channels allows padding.
+ */
+
+/**
+ * @brief Name of the SIMD path compiled in ("neon", "avx", "sse2" or "scalar").
+ */
+const char* batch_simd_name(void);
+
+/**
+ * @brief Mean of every channel over the window (pairwise summation).
+ * @param out Array of `channels` results.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int batch_average(const float* block, int channels, int window, int stride, float* out);
+
+/**
+ * @brief Median of every channel over the window. The block is not modified.
+ *
+ * Windows of 5, 7 and 9 use vectorised median networks; other sizes fall back to a per-channel selection.
+ * Even windows return the mean of the two middle samples, like calculate_median().
+ *
+ * @param out Array of `channels` results.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int batch_median(const float* block, int channels, int window, int stride, float* out);
+
+/**
+ * @brief Scalar reference versions (double accumulation / full sort) used to validate the SIMD paths.
+ */
+int batch_average_ref(const float* block, int channels, int window, int stride, float* out);
+int batch_median_ref(const float* block, int channels, int window, int stride, float* out);
+
+#endif
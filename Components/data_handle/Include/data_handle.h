@@ -5,10 +5,11 @@
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
+#include "logger.h"
 
-//Error Logging Macro
-#define LOG_ERR(msg, ...) fprintf(stderr, "[DATA HANDLE ERROR] " msg "\n", ##__VA_ARGS__)
-#define LOG_INFO(msg, ...) fprintf(stdout, "[DATA HANDLE INFO] " msg "\n", ##__VA_ARGS__)
+//Error Logging Macro (asynchronous, see Components/Logger)
+#define LOG_ERR(msg, ...) logger_write(LOGGER_COMP_DATA_HANDLE, LOGGER_ERROR, msg, ##__VA_ARGS__)
+#define LOG_INFO(msg, ...) logger_write(LOGGER_COMP_DATA_HANDLE, LOGGER_INFO, msg, ##__VA_ARGS__)
 
 float calculate_median(float* values, int size);
 float calculate_average(float* values, int size);
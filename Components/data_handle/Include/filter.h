@@ -0,0 +1,53 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+
+// Filter kinds accepted by filter_create()
+typedef enum {
+    FILTER_MOVING_AVERAGE = 0, // Running sum over the last `window` samples, O(1) per push
+    FILTER_MEDIAN = 1,         // Sliding-window median (indexed two-heap), O(log window) per push
+    FILTER_EMA = 2,            // Exponential moving average with weight `alpha`, O(1) per push
+    FILTER_MIN = 3,            // Sliding-window minimum (monotonic deque), amortised O(1) per push
+    FILTER_MAX = 4             // Sliding-window maximum (monotonic deque), amortised O(1) per push
+} filter_type_t;
+
+#define FILTER_MAX_WINDOW 65536
+
+typedef struct filter filter_t;
+
+/**
+ * @brief Creates a stateful filter. The sample window lives inside the object.
+ * @param type One of filter_type_t.
+ * @param window Window length in samples (1..FILTER_MAX_WINDOW), ignored by FILTER_EMA.
+ * @param alpha Weight of the newest sample for FILTER_EMA (0 < alpha <= 1), ignored otherwise.
+ * @return Filter handle, or NULL on invalid arguments / allocation failure.
+ */
+filter_t* filter_create(filter_type_t type, int window, float alpha);
+
+/**
+ * @brief Feeds one sample and returns the filtered value.
+ *
+ * Until the window is full, the result covers the samples seen so far
+ * (same behaviour as calculate_average/calculate_median on a growing deque).
+ */
+float filter_push(filter_t* f, float value);
+
+/**
+ * @brief Last value returned by filter_push(), or 0 if nothing was pushed yet.
+ */
+float filter_value(const filter_t* f);
+
+/**
+ * @brief Number of samples currently inside the window.
+ */
+int filter_count(const filter_t* f);
+
+/**
+ * @brief Forgets every sample; the window size and type are kept.
+ */
+void filter_reset(filter_t* f);
+
+void filter_destroy(filter_t* f);
+
+#endif
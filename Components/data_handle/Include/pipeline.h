@@ -0,0 +1,51 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+
+#define PIPELINE_MAX_CHANNELS 16
+
+/**
+ * @brief Processing applied to one raw register:
+ *        raw -> raw * scale + offset -> + calibration -> moving average -> median.
+ *        Thresholds are evaluated on the output by the Alert component (alert_eval.h).
+ */
+typedef struct {
+    float scale;          // Raw to physical unit
+    float offset;
+    float calibration;    // Sensor-specific calibration offset
+    int avg_window;       // Moving-average window in samples (0 = stage disabled)
+    int median_window;    // Median window applied to the averages (0 = stage disabled)
+} pipeline_channel_cfg_t;
+
+typedef struct pipeline pipeline_t;
+
+/**
+ * @brief Builds a pipeline of n_channels independent channels.
+ * @return Pipeline handle, or NULL on invalid configuration.
+ */
+pipeline_t* pipeline_create(const pipeline_channel_cfg_t* cfgs, int n_channels);
+
+/**
+ * @brief Runs one poll cycle through every stage of every channel.
+ *
+ * Channels whose valid flag is 0 keep their last output.
+ *
+ * @param raw n_channels raw register values (same order as the configs).
+ * @param valid Optional n_channels flags (NULL = all valid).
+ * @param out n_channels filtered values.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int pipeline_process(pipeline_t* p, const uint16_t* raw, const uint8_t* valid, float* out);
+
+/**
+ * @brief Changes the calibration offset of one channel.
+ * @return 0 on success, -1 on invalid channel.
+ */
+int pipeline_set_calibration(pipeline_t* p, int channel, float calibration);
+
+int pipeline_channel_count(const pipeline_t* p);
+
+void pipeline_destroy(pipeline_t* p);
+
+#endif
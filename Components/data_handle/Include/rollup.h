@@ -0,0 +1,109 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stdint.h>
+
+/*
+ * Multi-resolution rollups: min/max/sum/count per channel in 1 s, 1 min and 1 h buckets.
+ *
+ * Each resolution is a fixed ring of buckets indexed by timestamp / bucket length, so a
+ * sample updates one bucket per resolution (O(1)) and memory is fixed whatever the uptime.
+ * A bucket whose slot is reused by a later period is reset first; one stamped in the future
+ * (clock set back) is discarded. Queries aggregate at most one ring of buckets and never
+ * touch raw samples.
+ *
+ * Like the snapshot, the rollups live in a POSIX shared memory page with one writer process;
+ * other processes (web server, CoreIoT) attach read-only and read without locks (a seqlock
+ * per channel). A NULL name keeps them in private process memory.
+ */
+
+// --- Constants ---
+#define ROLLUP_SHM_NAME_DEFAULT "/lsmy_rollup"
+#define ROLLUP_MAGIC 0x4C4C4F52U    // "ROLL"
+#define ROLLUP_VERSION 1
+#define ROLLUP_MAX_CHANNELS 16
+
+// --- Resolutions ---
+#define ROLLUP_RES_SECOND 0         // 1 s buckets, last 2 minutes
+#define ROLLUP_RES_MINUTE 1         // 1 min buckets, last 2 hours
+#define ROLLUP_RES_HOUR 2           // 1 h buckets, last 7 days
+#define ROLLUP_RES_COUNT 3
+
+#define ROLLUP_SECOND_BUCKETS 120
+#define ROLLUP_MINUTE_BUCKETS 120
+#define ROLLUP_HOUR_BUCKETS 168
+
+// --- Error codes ---
+#define ROLLUP_SUCCESS 0
+#define ROLLUP_E_GENERIC_FAIL -1
+#define ROLLUP_E_OPEN -2            // shm_open/mmap failed
+#define ROLLUP_E_LAYOUT -3          // Segment exists but has another magic/version
+#define ROLLUP_E_BUSY -4            // Reader kept colliding with the writer
+
+/**
+ * @brief Aggregate over one or more buckets.
+ */
+typedef struct {
+    double min;
+    double max;
+    double avg;
+    double sum;
+    uint64_t count;                 // Samples aggregated (0: no data, min/max/avg are 0)
+    uint64_t start_ms;              // Wall clock start of the first bucket covered
+} rollup_stats_t;
+
+typedef struct rollup rollup_t;
+
+/**
+ * @brief Maps the rollup page.
+ * @param name POSIX shm name (e.g. ROLLUP_SHM_NAME_DEFAULT), or NULL for a private page.
+ * @param writer 1 to open read-write and create if missing, 0 to attach read-only.
+ * @param err Optional pointer receiving a ROLLUP_E_* code on failure.
+ * @return Handle, or NULL on failure.
+ */
+rollup_t* rollup_open(const char *name, int writer, int *err);
+
+/**
+ * @brief Adds one sample to every resolution of a channel. O(1).
+ *        Samples older than a ring are dropped from that resolution only.
+ * @param timestamp_ms Wall clock of the sample (ms since epoch).
+ * @return ROLLUP_SUCCESS or a negative error code.
+ */
+int rollup_add(rollup_t *r, int channel, double value, uint64_t timestamp_ms);
+
+/**
+ * @brief rollup_add() for n channels sampled at the same time.
+ */
+int rollup_add_many(rollup_t *r, const int *channels, const double *values, int n, uint64_t timestamp_ms);
+
+/**
+ * @brief Aggregate of the last n_buckets buckets of a resolution, the one holding now_ms included
+ *        (e.g. ROLLUP_RES_MINUTE, 15: the last 15 minutes).
+ * @param now_ms Wall clock the window ends at, 0 for the current time.
+ * @return ROLLUP_SUCCESS, or a negative error code (n_buckets is capped to the ring length).
+ */
+int rollup_query(rollup_t *r, int channel, int resolution, int n_buckets, uint64_t now_ms, rollup_stats_t *out);
+
+/**
+ * @brief The last n_buckets buckets one by one, oldest first (chart series). Empty buckets have count 0.
+ * @param out Array of n_buckets entries.
+ * @return Number of entries written, or a negative error code.
+ */
+int rollup_series(rollup_t *r, int channel, int resolution, int n_buckets, uint64_t now_ms, rollup_stats_t *out);
+
+/**
+ * @brief Ring length of a resolution, 0 if invalid.
+ */
+int rollup_capacity(int resolution);
+
+/**
+ * @brief Unmaps the page and frees the handle. A shared segment stays in /dev/shm.
+ */
+void rollup_close(rollup_t *r);
+
+/**
+ * @brief Removes the shared segment (the writer's shutdown, or tests).
+ */
+int rollup_cleanup(const char *name);
+
+#endif
@@ -0,0 +1,114 @@
+#include "batch.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * SIMD batch kernels against the scalar references, on random channel/window/stride shapes.
+ *
+ * Channel counts are not multiples of the vector width, so every shape runs both the vector
+ * body and the scalar tail. Medians must match the full-sort reference exactly. Averages must
+ * be within the pairwise summation bound of the double reference, and bit-identical whether a
+ * channel falls in a vector lane or in the tail.
+ */
+
+#define SHAPES 3000
+#define MAX_CHANNELS 37
+#define MAX_WINDOW 70
+#define MAX_PAD 5
+
+static uint32_t rng = 0x2545F491U;
+
+static uint32_t next_rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static int rand_range(int lo, int hi) {
+    return lo + (int)(next_rand() % (uint32_t)(hi - lo + 1));
+}
+
+static float rand_value(int ties) {
+    // Coarse values produce many equal samples, the worst case for median networks
+    if (ties) return (float)rand_range(-4, 4);
+    return ((float)next_rand() / 4294967296.0f - 0.5f) * 2000.0f;
+}
+
+static int check_shape(int channels, int window, int stride, int ties) {
+    size_t n = (size_t)window * stride;
+    float *block = malloc(n * sizeof(float));
+    float got[MAX_CHANNELS], ref[MAX_CHANNELS], alone;
+    if (block == NULL) return 1;
+    for (size_t i = 0; i < n; i++) block[i] = rand_value(ties);
+
+    int failed = 0;
+    if (batch_median(block, channels, window, stride, got) != 0 ||
+        batch_median_ref(block, channels, window, stride, ref) != 0) {
+        printf("batch_median failed: channels %d window %d stride %d\n", channels, window, stride);
+        failed = 1;
+    }
+    for (int k = 0; k < channels && !failed; k++) {
+        if (memcmp(&got[k], &ref[k], sizeof(float)) != 0) {
+            printf("median mismatch: channels %d window %d stride %d channel %d: %.9g != %.9g\n",
+                   channels, window, stride, k, got[k], ref[k]);
+            failed = 1;
+        }
+    }
+
+    if (batch_average(block, channels, window, stride, got) != 0 ||
+        batch_average_ref(block, channels, window, stride, ref) != 0) {
+        printf("batch_average failed: channels %d window %d stride %d\n", channels, window, stride);
+        failed = 1;
+    }
+    for (int k = 0; k < channels && !failed; k++) {
+        double abs_sum = 0.0;
+        for (int i = 0; i < window; i++) abs_sum += fabs(block[(size_t)i * stride + k]);
+        // Pairwise float summation: error <= ~log2(window) ulps of the absolute sum, plus the final scaling
+        double bound = (log2((double)window) + 2.0) * 1.2e-7 * abs_sum / window + 1e-30;
+        if (fabs((double)got[k] - (double)ref[k]) > bound) {
+            printf("average off: channels %d window %d stride %d channel %d: %.9g vs %.9g\n",
+                   channels, window, stride, k, got[k], ref[k]);
+            failed = 1;
+        }
+        // The same channel alone only takes the scalar tail: lanes and tail must agree bit for bit
+        batch_average(block + k, 1, window, stride, &alone);
+        if (memcmp(&got[k], &alone, sizeof(float)) != 0) {
+            printf("lane/tail mismatch: channels %d window %d stride %d channel %d: %.9g != %.9g\n",
+                   channels, window, stride, k, got[k], alone);
+            failed = 1;
+        }
+    }
+
+    free(block);
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) rng = (uint32_t)strtoul(argv[1], NULL, 0) | 1U;
+    printf("SIMD path: %s, seed 0x%08X\n", batch_simd_name(), rng);
+
+    int failures = 0;
+    for (int i = 0; i < SHAPES; i++) {
+        int channels = rand_range(1, MAX_CHANNELS);
+        // Half the shapes use the median network windows
+        int window = (i & 1) ? 5 + 2 * rand_range(0, 2) : rand_range(1, MAX_WINDOW);
+        int stride = channels + rand_range(0, MAX_PAD);
+        failures += check_shape(channels, window, stride, i % 4 == 0);
+    }
+    // Windows beyond the stack scratch of the selection fallback
+    failures += check_shape(13, 600, 16, 0);
+    failures += check_shape(3, 601, 3, 1);
+
+    float dummy[1] = { 0.0f }, out[1];
+    if (batch_average(dummy, 0, 1, 1, out) != -1 || batch_median(dummy, 2, 1, 1, out) != -1) {
+        printf("invalid arguments accepted\n");
+        failures++;
+    }
+
+    printf("%d shapes, %d failures\n", SHAPES + 2, failures);
+    return failures ? 1 : 0;
+}
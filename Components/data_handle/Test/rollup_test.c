@@ -0,0 +1,190 @@
+#define _GNU_SOURCE
+#include "rollup.h"
+#include "shm_segment.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Rollups: window sums on a private page, then a reader attached to a writer's segment.
+ *
+ * The shared cases cover what a restarted writer must repair at attach (a seqlock left odd
+ * by a writer killed mid-update, buckets stamped while the clock was ahead) and reads racing
+ * a live writer, which must never see a half-written channel.
+ */
+
+#define HOUR_MS 3600000ULL
+#define RACE_ADDS 2000000
+
+// Channel 0's seqlock: after the segment header, n_channels and reserved (see rollup.c)
+#define SEQ0_WORD (sizeof(shm_segment_header_t) / sizeof(uint32_t) + 2)
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __func__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+static uint64_t wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static void test_windows(void) {
+    int err = 0;
+    rollup_t *r = rollup_open(NULL, 1, &err);
+    CHECK(r != NULL, "private open: %d", err);
+    if (r == NULL) return;
+
+    // Three hours of one sample a second, 0..59 repeating, starting on an hour boundary
+    uint64_t t0 = 1700000000000ULL / HOUR_MS * HOUR_MS;
+    for (int i = 0; i < 3 * 3600; i++) rollup_add(r, 2, (double)(i % 60), t0 + (uint64_t)i * 1000ULL);
+    uint64_t now = t0 + 3 * HOUR_MS - 1000ULL;
+    rollup_stats_t s;
+
+    CHECK(rollup_query(r, 2, ROLLUP_RES_SECOND, 60, now, &s) == ROLLUP_SUCCESS, "second query");
+    CHECK(s.count == 60 && s.sum == 1770.0 && s.min == 0.0 && s.max == 59.0 && s.avg == 29.5,
+          "60 s: count %llu sum %g min %g max %g avg %g", (unsigned long long)s.count, s.sum, s.min, s.max, s.avg);
+    CHECK(s.start_ms == now - 59000ULL, "60 s start %llu", (unsigned long long)s.start_ms);
+
+    // Capped to the ring: 120 minutes
+    CHECK(rollup_query(r, 2, ROLLUP_RES_MINUTE, 500, now, &s) == ROLLUP_SUCCESS, "minute query");
+    CHECK(s.count == 7200 && s.sum == 120 * 1770.0, "2 h: count %llu sum %g", (unsigned long long)s.count, s.sum);
+
+    CHECK(rollup_query(r, 2, ROLLUP_RES_HOUR, 24, now, &s) == ROLLUP_SUCCESS, "hour query");
+    CHECK(s.count == 10800 && s.sum == 180 * 1770.0 && s.start_ms == now / HOUR_MS * HOUR_MS - 23 * HOUR_MS,
+          "24 h: count %llu sum %g start %llu", (unsigned long long)s.count, s.sum, (unsigned long long)s.start_ms);
+
+    rollup_stats_t series[5];
+    CHECK(rollup_series(r, 2, ROLLUP_RES_MINUTE, 5, now, series) == 5, "series length");
+    for (int i = 0; i < 5; i++) {
+        CHECK(series[i].count == 60 && series[i].sum == 1770.0, "minute %d: count %llu", i, (unsigned long long)series[i].count);
+        CHECK(series[i].start_ms == (now / 60000ULL - 4 + (uint64_t)i) * 60000ULL, "minute %d start", i);
+    }
+
+    // Older than the seconds ring: dropped there, still counted in the hour it belongs to
+    rollup_add(r, 2, 999.0, t0);
+    CHECK(rollup_query(r, 2, ROLLUP_RES_SECOND, 120, now, &s) == ROLLUP_SUCCESS && s.max == 59.0, "seconds max %g", s.max);
+    CHECK(rollup_query(r, 2, ROLLUP_RES_HOUR, 24, now, &s) == ROLLUP_SUCCESS && s.max == 999.0 && s.count == 10801,
+          "hours max %g count %llu", s.max, (unsigned long long)s.count);
+
+    // Untouched channel, bad arguments
+    CHECK(rollup_query(r, 3, ROLLUP_RES_HOUR, 24, now, &s) == ROLLUP_SUCCESS && s.count == 0 && s.avg == 0.0, "empty channel");
+    CHECK(rollup_query(r, ROLLUP_MAX_CHANNELS, ROLLUP_RES_HOUR, 1, now, &s) == ROLLUP_E_GENERIC_FAIL, "channel range");
+    CHECK(rollup_query(r, 0, ROLLUP_RES_COUNT, 1, now, &s) == ROLLUP_E_GENERIC_FAIL, "resolution range");
+    CHECK(rollup_capacity(ROLLUP_RES_HOUR) == ROLLUP_HOUR_BUCKETS && rollup_capacity(-1) == 0, "capacity");
+    rollup_close(r);
+}
+
+static void test_attach(const char *name) {
+    int err = 0;
+    rollup_t *w = rollup_open(name, 1, &err);
+    rollup_t *rd = rollup_open(name, 0, &err);
+    CHECK(w != NULL && rd != NULL, "open: %d", err);
+    if (w == NULL || rd == NULL) return;
+
+    uint64_t now = wall_ms();
+    rollup_stats_t s;
+    rollup_add(w, 0, 5.0, now);
+    CHECK(rollup_query(rd, 0, ROLLUP_RES_SECOND, 1, now, &s) == ROLLUP_SUCCESS && s.count == 1 && s.avg == 5.0,
+          "reader sees the write: count %llu", (unsigned long long)s.count);
+    CHECK(rollup_add(rd, 0, 1.0, now) == ROLLUP_E_GENERIC_FAIL, "reader could write");
+
+    // Same minute slot two hours ahead, then now: the future bucket is reset while running
+    rollup_add(w, 1, 50.0, now + 120 * 60000ULL);
+    rollup_add(w, 1, 7.0, now);
+    CHECK(rollup_query(rd, 1, ROLLUP_RES_MINUTE, 1, now, &s) == ROLLUP_SUCCESS && s.count == 1 && s.avg == 7.0,
+          "runtime future reset: count %llu avg %g", (unsigned long long)s.count, s.avg);
+
+    // A future hour bucket left behind by the clock, kept until the next writer attach
+    uint64_t ahead = now + 3 * HOUR_MS;
+    rollup_add(w, 3, 42.0, ahead);
+    CHECK(rollup_query(rd, 3, ROLLUP_RES_HOUR, 1, ahead, &s) == ROLLUP_SUCCESS && s.count == 1, "future bucket written");
+    rollup_close(w);
+
+    // Writer killed inside a channel update: its seqlock stays odd
+    int fd = shm_open(name, O_RDWR, 0);
+    uint32_t *words = (fd >= 0) ? mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (fd >= 0) close(fd);
+    CHECK(words != MAP_FAILED, "map segment");
+    if (words == MAP_FAILED) return;
+    words[SEQ0_WORD] |= 1U;
+    CHECK(rollup_query(rd, 0, ROLLUP_RES_SECOND, 1, now, &s) == ROLLUP_E_BUSY, "odd seqlock not reported busy");
+
+    w = rollup_open(name, 1, &err);
+    CHECK(w != NULL, "writer reattach: %d", err);
+    CHECK((words[SEQ0_WORD] & 1U) == 0, "seqlock still odd after attach");
+    CHECK(rollup_query(rd, 0, ROLLUP_RES_SECOND, 120, now, &s) == ROLLUP_SUCCESS && s.count == 1 && s.avg == 5.0,
+          "data after recovery: count %llu", (unsigned long long)s.count);
+    CHECK(rollup_query(rd, 3, ROLLUP_RES_HOUR, 1, ahead, &s) == ROLLUP_SUCCESS && s.count == 0,
+          "future bucket kept at attach: count %llu", (unsigned long long)s.count);
+    munmap(words, 4096);
+
+    rollup_t *missing = rollup_open("/rollup_test_missing", 0, &err);
+    CHECK(missing == NULL && err == ROLLUP_E_OPEN, "missing segment: err %d", err);
+
+    rollup_close(rd);
+    rollup_close(w);
+    rollup_cleanup(name);
+}
+
+typedef struct {
+    rollup_t *w;
+    uint64_t ts;
+} race_arg_t;
+
+static void* race_writer(void *arg) {
+    race_arg_t *a = (race_arg_t*)arg;
+    for (int i = 0; i < RACE_ADDS; i++) rollup_add(a->w, 4, (double)i, a->ts);
+    return NULL;
+}
+
+// Values 0, 1, 2... into one bucket: any consistent copy has sum = count(count-1)/2 and max = count-1
+static void test_race(const char *name) {
+    int err = 0;
+    race_arg_t a = { rollup_open(name, 1, &err), wall_ms() };
+    rollup_t *rd = rollup_open(name, 0, &err);
+    CHECK(a.w != NULL && rd != NULL, "open: %d", err);
+    if (a.w == NULL || rd == NULL) return;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, race_writer, &a);
+    int reads = 0, torn = 0;
+    uint64_t last = 0;
+    while (last < RACE_ADDS) {
+        rollup_stats_t s;
+        if (rollup_query(rd, 4, ROLLUP_RES_SECOND, 1, a.ts, &s) != ROLLUP_SUCCESS) continue;
+        reads++;
+        double c = (double)s.count;
+        if (s.count > 0 && (s.sum != c * (c - 1.0) / 2.0 || s.max != c - 1.0 || s.min != 0.0)) torn++;
+        last = s.count;
+    }
+    pthread_join(thread, NULL);
+    CHECK(torn == 0, "%d torn reads of %d", torn, reads);
+
+    rollup_close(rd);
+    rollup_close(a.w);
+    rollup_cleanup(name);
+}
+
+int main(void) {
+    char name[64];
+    snprintf(name, sizeof(name), "/rollup_test_%d", (int)getpid());
+
+    test_windows();
+    test_attach(name);
+    test_race(name);
+
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+#include "batch.h"
+#include "data_handle.h"
+#include <stdlib.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+typedef float32x4_t vfloat;
+#define VLANES 4
+#define SIMD_NAME "neon"
+#define V_LOAD(p) vld1q_f32(p)
+#define V_STORE(p, v) vst1q_f32((p), (v))
+#define V_ADD(a, b) vaddq_f32((a), (b))
+#define V_MUL(a, b) vmulq_f32((a), (b))
+#define V_MIN(a, b) vminq_f32((a), (b))
+#define V_MAX(a, b) vmaxq_f32((a), (b))
+#define V_SET1(x) vdupq_n_f32(x)
+#elif defined(__AVX__)
+#include <immintrin.h>
+typedef __m256 vfloat;
+#define VLANES 8
+#define SIMD_NAME "avx"
+#define V_LOAD(p) _mm256_loadu_ps(p)
+#define V_STORE(p, v) _mm256_storeu_ps((p), (v))
+#define V_ADD(a, b) _mm256_add_ps((a), (b))
+#define V_MUL(a, b) _mm256_mul_ps((a), (b))
+#define V_MIN(a, b) _mm256_min_ps((a), (b))
+#define V_MAX(a, b) _mm256_max_ps((a), (b))
+#define V_SET1(x) _mm256_set1_ps(x)
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+typedef __m128 vfloat;
+#define VLANES 4
+#define SIMD_NAME "sse2"
+#define V_LOAD(p) _mm_loadu_ps(p)
+#define V_STORE(p, v) _mm_storeu_ps((p), (v))
+#define V_ADD(a, b) _mm_add_ps((a), (b))
+#define V_MUL(a, b) _mm_mul_ps((a), (b))
+#define V_MIN(a, b) _mm_min_ps((a), (b))
+#define V_MAX(a, b) _mm_max_ps((a), (b))
+#define V_SET1(x) _mm_set1_ps(x)
+#else
+typedef float vfloat;
+#define VLANES 1
+#define SIMD_NAME "scalar"
+#define V_LOAD(p) (*(p))
+#define V_STORE(p, v) (*(p) = (v))
+#define V_ADD(a, b) ((a) + (b))
+#define V_MUL(a, b) ((a) * (b))
+#define V_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define V_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define V_SET1(x) (x)
+#endif
+
+#define PAIRWISE_LEAF 8     // Rows summed sequentially before switching to pairwise halves
+#define MAX_NET_WINDOW 9
+#define STACK_WINDOW 512    // Scratch size kept on the stack for the selection fallback
+
+// Median selection networks (compare-exchange pairs), after Paeth / Devillard.
+// After applying every pair with (lo, hi) = (min, max), the median sits at index window / 2.
+static const unsigned char net5[][2] = {
+    {0, 1}, {3, 4}, {0, 3}, {1, 4}, {1, 2}, {2, 3}, {1, 2}
+};
+static const unsigned char net7[][2] = {
+    {0, 5}, {0, 3}, {1, 6}, {2, 4}, {0, 1}, {3, 5}, {2, 6},
+    {2, 3}, {3, 6}, {4, 5}, {1, 4}, {1, 3}, {3, 4}
+};
+static const unsigned char net9[][2] = {
+    {1, 2}, {4, 5}, {7, 8}, {0, 1}, {3, 4}, {6, 7}, {1, 2}, {4, 5}, {7, 8}, {0, 3},
+    {5, 8}, {4, 7}, {3, 6}, {1, 4}, {2, 5}, {4, 7}, {2, 4}, {4, 6}, {2, 4}
+};
+
+/*---------------------------- Private Function --------------------------------*/
+static int check_args(const float* block, int channels, int window, int stride, const float* out) {
+    if (block == NULL || out == NULL || channels <= 0 || window <= 0 || stride < channels) {
+        LOG_ERR("Invalid batch shape (channels=%d, window=%d, stride=%d)", channels, window, stride);
+        return -1;
+    }
+    return 0;
+}
+
+static const unsigned char (*median_net(int window, int* n_pairs))[2] {
+    switch (window) {
+    case 5: *n_pairs = (int)(sizeof(net5) / sizeof(net5[0])); return net5;
+    case 7: *n_pairs = (int)(sizeof(net7) / sizeof(net7[0])); return net7;
+    case 9: *n_pairs = (int)(sizeof(net9) / sizeof(net9[0])); return net9;
+    default: *n_pairs = 0; return NULL;
+    }
+}
+
+// Pairwise sum of n rows of VLANES channels: error grows with log(n) instead of n
+static vfloat vsum_rows(const float* p, int stride, int n) {
+    if (n <= PAIRWISE_LEAF) {
+        vfloat s = V_LOAD(p);
+        for (int i = 1; i < n; i++) s = V_ADD(s, V_LOAD(p + (size_t)i * stride));
+        return s;
+    }
+    int half = n / 2;
+    return V_ADD(vsum_rows(p, stride, half), vsum_rows(p + (size_t)half * stride, stride, n - half));
+}
+
+static float sum_rows(const float* p, int stride, int n) {
+    if (n <= PAIRWISE_LEAF) {
+        float s = p[0];
+        for (int i = 1; i < n; i++) s += p[(size_t)i * stride];
+        return s;
+    }
+    int half = n / 2;
+    return sum_rows(p, stride, half) + sum_rows(p + (size_t)half * stride, stride, n - half);
+}
+
+static float scalar_net_median(const float* col, int stride, const unsigned char (*net)[2], int n_pairs, int window) {
+    float v[MAX_NET_WINDOW];
+    for (int i = 0; i < window; i++) v[i] = col[(size_t)i * stride];
+    for (int i = 0; i < n_pairs; i++) {
+        float a = v[net[i][0]], b = v[net[i][1]];
+        v[net[i][0]] = a < b ? a : b;
+        v[net[i][1]] = a < b ? b : a;
+    }
+    return v[window / 2];
+}
+
+// Hoare quickselect: k-th smallest of v[0..n-1], partially reorders v
+static float select_kth(float* v, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        float pivot = v[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) i++;
+            while (v[j] > pivot) j--;
+            if (i <= j) {
+                float t = v[i]; v[i] = v[j]; v[j] = t;
+                i++; j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+    return v[k];
+}
+
+static float select_median(const float* col, int stride, int window, float* scratch) {
+    for (int i = 0; i < window; i++) scratch[i] = col[(size_t)i * stride];
+    float upper = select_kth(scratch, window, window / 2);
+    if (window % 2 != 0) return upper;
+    // Even window: the lower middle is the largest value left of the upper middle
+    float lower = scratch[0];
+    for (int i = 1; i < window / 2; i++) if (scratch[i] > lower) lower = scratch[i];
+    return (lower + upper) / 2.0f;
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float fa = *(const float*)a;
+    float fb = *(const float*)b;
+    if (fa < fb) return -1;
+    if (fa > fb) return 1;
+    return 0;
+}
+
+/*------------------------ Public Function -----------------------------*/
+const char* batch_simd_name(void) {
+    return SIMD_NAME;
+}
+
+int batch_average(const float* block, int channels, int window, int stride, float* out) {
+    if (check_args(block, channels, window, stride, out) != 0) return -1;
+
+    float inv = 1.0f / (float)window;
+    int k = 0;
+    for (; k + VLANES <= channels; k += VLANES) {
+        V_STORE(out + k, V_MUL(vsum_rows(block + k, stride, window), V_SET1(inv)));
+    }
+    for (; k < channels; k++) {
+        out[k] = sum_rows(block + k, stride, window) * inv;
+    }
+    return 0;
+}
+
+int batch_median(const float* block, int channels, int window, int stride, float* out) {
+    if (check_args(block, channels, window, stride, out) != 0) return -1;
+
+    int n_pairs;
+    const unsigned char (*net)[2] = median_net(window, &n_pairs);
+    int k = 0;
+
+    if (net != NULL) {
+        for (; k + VLANES <= channels; k += VLANES) {
+            vfloat v[MAX_NET_WINDOW];
+            for (int i = 0; i < window; i++) v[i] = V_LOAD(block + (size_t)i * stride + k);
+            for (int i = 0; i < n_pairs; i++) {
+                vfloat a = v[net[i][0]], b = v[net[i][1]];
+                v[net[i][0]] = V_MIN(a, b);
+                v[net[i][1]] = V_MAX(a, b);
+            }
+            V_STORE(out + k, v[window / 2]);
+        }
+        for (; k < channels; k++) {
+            out[k] = scalar_net_median(block + k, stride, net, n_pairs, window);
+        }
+        return 0;
+    }
+
+    float stack_scratch[STACK_WINDOW];
+    float* scratch = stack_scratch;
+    if (window > STACK_WINDOW) {
+        scratch = malloc((size_t)window * sizeof(float));
+        if (scratch == NULL) {
+            LOG_ERR("Out of memory for median window %d", window);
+            return -1;
+        }
+    }
+    for (; k < channels; k++) {
+        out[k] = select_median(block + k, stride, window, scratch);
+    }
+    if (scratch != stack_scratch) free(scratch);
+    return 0;
+}
+
+int batch_average_ref(const float* block, int channels, int window, int stride, float* out) {
+    if (check_args(block, channels, window, stride, out) != 0) return -1;
+    for (int k = 0; k < channels; k++) {
+        double sum = 0.0;
+        for (int i = 0; i < window; i++) sum += block[(size_t)i * stride + k];
+        out[k] = (float)(sum / window);
+    }
+    return 0;
+}
+
+int batch_median_ref(const float* block, int channels, int window, int stride, float* out) {
+    if (check_args(block, channels, window, stride, out) != 0) return -1;
+    float* column = malloc((size_t)window * sizeof(float));
+    if (column == NULL) return -1;
+    for (int k = 0; k < channels; k++) {
+        for (int i = 0; i < window; i++) column[i] = block[(size_t)i * stride + k];
+        qsort(column, (size_t)window, sizeof(float), compare_floats);
+        out[k] = (window % 2 != 0) ? column[window / 2]
+                                   : (column[(window - 1) / 2] + column[window / 2]) / 2.0f;
+    }
+    free(column);
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include "filter.h"
+#include "data_handle.h"
+#include <stdlib.h>
+
+// Re-add the window from scratch every N pushes so float rounding cannot accumulate in the running sum
+#define RESUM_INTERVAL 4096
+
+struct filter {
+    filter_type_t type;
+    int window;
+    int count;          // Samples currently in the window
+    int idx;            // Next write position in `data`
+    float last;         // Last output
+    float* data;        // Circular window of raw samples
+
+    // FILTER_MOVING_AVERAGE
+    double sum;
+    int since_resum;
+
+    // FILTER_MEDIAN: data[] is indexed by a two-sided heap; heap[0] is the median,
+    // heap[-1..-max_ct] is a max-heap of the lower half, heap[1..min_ct] a min-heap of the upper half.
+    int* pos;           // Heap slot of every data[] entry
+    int* heap;          // Points at the middle of the heap storage
+    int* heap_base;
+    int min_ct;
+    int max_ct;
+
+    // FILTER_EMA
+    float alpha;
+
+    // FILTER_MIN / FILTER_MAX: monotonic deque of sample sequence numbers
+    uint64_t* dq;
+    int dq_head;
+    int dq_len;
+    uint64_t seq;
+};
+
+/*---------------------------- Median (two heaps) --------------------------------*/
+static int med_less(const filter_t* f, int i, int j) {
+    return f->data[f->heap[i]] < f->data[f->heap[j]];
+}
+
+static int med_exchange(filter_t* f, int i, int j) {
+    int t = f->heap[i];
+    f->heap[i] = f->heap[j];
+    f->heap[j] = t;
+    f->pos[f->heap[i]] = i;
+    f->pos[f->heap[j]] = j;
+    return 1;
+}
+
+// Swaps heap slots i and j when data at i < data at j
+static int med_cmp_exch(filter_t* f, int i, int j) {
+    return med_less(f, i, j) && med_exchange(f, i, j);
+}
+
+static void min_sort_down(filter_t* f, int i) {
+    for (i *= 2; i <= f->min_ct; i *= 2) {
+        if (i < f->min_ct && med_less(f, i + 1, i)) ++i;
+        if (!med_cmp_exch(f, i, i / 2)) break;
+    }
+}
+
+static void max_sort_down(filter_t* f, int i) {
+    for (i *= 2; i >= -f->max_ct; i *= 2) {
+        if (i > -f->max_ct && med_less(f, i, i - 1)) --i;
+        if (!med_cmp_exch(f, i / 2, i)) break;
+    }
+}
+
+// Both return 1 when the item bubbled all the way to the median slot
+static int min_sort_up(filter_t* f, int i) {
+    while (i > 0 && med_cmp_exch(f, i, i / 2)) i /= 2;
+    return i == 0;
+}
+
+static int max_sort_up(filter_t* f, int i) {
+    while (i < 0 && med_cmp_exch(f, i / 2, i)) i /= 2;
+    return i == 0;
+}
+
+static void median_init(filter_t* f) {
+    // Fill pattern: slot 0 -> median, 1 -> max heap, 2 -> min heap, 3 -> max heap, ...
+    for (int n = f->window - 1; n >= 0; n--) {
+        f->pos[n] = ((n + 1) / 2) * ((n & 1) ? -1 : 1);
+        f->heap[f->pos[n]] = n;
+    }
+    f->min_ct = 0;
+    f->max_ct = 0;
+}
+
+static float median_push(filter_t* f, float v) {
+    int p = f->pos[f->idx];
+    float old = f->data[f->idx];
+    f->data[f->idx] = v;
+
+    if (p > 0) {            // Slot belongs to the min heap
+        if (f->min_ct < (f->window - 1) / 2) f->min_ct++;
+        else if (v > old) { min_sort_down(f, p); goto done; }
+        if (min_sort_up(f, p) && med_cmp_exch(f, 0, -1)) max_sort_down(f, -1);
+    } else if (p < 0) {     // Slot belongs to the max heap
+        if (f->max_ct < f->window / 2) f->max_ct++;
+        else if (v < old) { max_sort_down(f, p); goto done; }
+        if (max_sort_up(f, p) && f->min_ct && med_cmp_exch(f, 1, 0)) min_sort_down(f, 1);
+    } else {                // Slot is the median itself
+        if (f->max_ct && max_sort_up(f, -1)) max_sort_down(f, -1);
+        if (f->min_ct && min_sort_up(f, 1)) min_sort_down(f, 1);
+    }
+
+done:;
+    float median = f->data[f->heap[0]];
+    if (f->min_ct < f->max_ct) median = (median + f->data[f->heap[-1]]) / 2.0f; // Even count
+    return median;
+}
+
+/*---------------------------- Moving average --------------------------------*/
+static float average_push(filter_t* f, float v) {
+    if (f->count == f->window) f->sum -= f->data[f->idx];
+    f->data[f->idx] = v;
+    f->sum += v;
+
+    if (++f->since_resum >= RESUM_INTERVAL) {
+        int n = (f->count == f->window) ? f->window : f->count + 1;
+        double exact = 0.0;
+        for (int i = 0; i < n; i++) exact += f->data[i];
+        f->sum = exact;
+        f->since_resum = 0;
+    }
+    int n = (f->count == f->window) ? f->window : f->count + 1;
+    return (float)(f->sum / n);
+}
+
+/*---------------------------- Sliding min / max --------------------------------*/
+static float extreme_push(filter_t* f, float v) {
+    int want_max = (f->type == FILTER_MAX);
+    uint64_t s = f->seq++;
+    f->data[f->idx] = v;
+
+    // Expire the front once it leaves the window
+    if (f->dq_len > 0 && f->dq[f->dq_head] + (uint64_t)f->window <= s) {
+        f->dq_head = (f->dq_head + 1) % f->window;
+        f->dq_len--;
+    }
+    // Drop samples from the back that can never be the extreme again
+    while (f->dq_len > 0) {
+        int back = (f->dq_head + f->dq_len - 1) % f->window;
+        float bv = f->data[f->dq[back] % (uint64_t)f->window];
+        if (want_max ? (bv > v) : (bv < v)) break;
+        f->dq_len--;
+    }
+    f->dq[(f->dq_head + f->dq_len) % f->window] = s;
+    f->dq_len++;
+    return f->data[f->dq[f->dq_head] % (uint64_t)f->window];
+}
+
+/*------------------------ Public Function -----------------------------*/
+filter_t* filter_create(filter_type_t type, int window, float alpha) {
+    if (type == FILTER_EMA) {
+        if (!(alpha > 0.0f && alpha <= 1.0f)) {
+            LOG_ERR("Invalid EMA weight (%f)", alpha);
+            return NULL;
+        }
+        window = 1;
+    } else if (window <= 0 || window > FILTER_MAX_WINDOW) {
+        LOG_ERR("Invalid window (%d) for filter", window);
+        return NULL;
+    }
+    if (type < FILTER_MOVING_AVERAGE || type > FILTER_MAX) {
+        LOG_ERR("Unknown filter type (%d)", (int)type);
+        return NULL;
+    }
+
+    filter_t* f = calloc(1, sizeof(*f));
+    if (f == NULL) return NULL;
+    f->type = type;
+    f->window = window;
+    f->alpha = alpha;
+    f->data = calloc((size_t)window, sizeof(float));
+    if (type == FILTER_MEDIAN) {
+        f->pos = calloc((size_t)window, sizeof(int));
+        f->heap_base = calloc((size_t)window, sizeof(int));
+    } else if (type == FILTER_MIN || type == FILTER_MAX) {
+        f->dq = calloc((size_t)window, sizeof(uint64_t));
+    }
+    if (f->data == NULL || (type == FILTER_MEDIAN && (f->pos == NULL || f->heap_base == NULL)) ||
+        ((type == FILTER_MIN || type == FILTER_MAX) && f->dq == NULL)) {
+        LOG_ERR("Out of memory for filter window %d", window);
+        filter_destroy(f);
+        return NULL;
+    }
+    if (type == FILTER_MEDIAN) f->heap = f->heap_base + window / 2;
+    filter_reset(f);
+    return f;
+}
+
+float filter_push(filter_t* f, float value) {
+    if (f == NULL) return 0.0f;
+
+    switch (f->type) {
+    case FILTER_MOVING_AVERAGE:
+        f->last = average_push(f, value);
+        break;
+    case FILTER_MEDIAN:
+        f->last = median_push(f, value);
+        break;
+    case FILTER_EMA:
+        f->last = (f->count == 0) ? value : f->last + f->alpha * (value - f->last);
+        break;
+    case FILTER_MIN:
+    case FILTER_MAX:
+        f->last = extreme_push(f, value);
+        break;
+    }
+
+    if (f->count < f->window) f->count++;
+    f->idx = (f->idx + 1) % f->window;
+    return f->last;
+}
+
+float filter_value(const filter_t* f) {
+    return f ? f->last : 0.0f;
+}
+
+int filter_count(const filter_t* f) {
+    return f ? f->count : 0;
+}
+
+void filter_reset(filter_t* f) {
+    if (f == NULL) return;
+    f->count = 0;
+    f->idx = 0;
+    f->last = 0.0f;
+    f->sum = 0.0;
+    f->since_resum = 0;
+    f->dq_head = 0;
+    f->dq_len = 0;
+    f->seq = 0;
+    if (f->type == FILTER_MEDIAN) median_init(f);
+}
+
+void filter_destroy(filter_t* f) {
+    if (f == NULL) return;
+    free(f->data);
+    free(f->pos);
+    free(f->heap_base);
+    free(f->dq);
+    free(f);
+}
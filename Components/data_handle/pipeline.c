@@ -0,0 +1,79 @@
+#include "pipeline.h"
+#include "filter.h"
+#include "data_handle.h"
+#include <stdlib.h>
+
+typedef struct {
+    pipeline_channel_cfg_t cfg;
+    filter_t* average;
+    filter_t* median;
+    float last;           // Last filtered output
+} pipeline_channel_t;
+
+struct pipeline {
+    int n_channels;
+    pipeline_channel_t ch[PIPELINE_MAX_CHANNELS];
+};
+
+/*------------------------ Public Function -----------------------------*/
+pipeline_t* pipeline_create(const pipeline_channel_cfg_t* cfgs, int n_channels) {
+    if (cfgs == NULL || n_channels <= 0 || n_channels > PIPELINE_MAX_CHANNELS) {
+        LOG_ERR("Invalid pipeline channel count (%d)", n_channels);
+        return NULL;
+    }
+
+    pipeline_t* p = calloc(1, sizeof(*p));
+    if (p == NULL) return NULL;
+    p->n_channels = n_channels;
+
+    for (int i = 0; i < n_channels; i++) {
+        pipeline_channel_t* c = &p->ch[i];
+        c->cfg = cfgs[i];
+        if (c->cfg.avg_window > 0) c->average = filter_create(FILTER_MOVING_AVERAGE, c->cfg.avg_window, 0.0f);
+        if (c->cfg.median_window > 0) c->median = filter_create(FILTER_MEDIAN, c->cfg.median_window, 0.0f);
+        if ((c->cfg.avg_window > 0 && c->average == NULL) || (c->cfg.median_window > 0 && c->median == NULL)) {
+            LOG_ERR("Invalid filter windows on pipeline channel %d", i);
+            pipeline_destroy(p);
+            return NULL;
+        }
+    }
+    return p;
+}
+
+int pipeline_process(pipeline_t* p, const uint16_t* raw, const uint8_t* valid, float* out) {
+    if (p == NULL || raw == NULL || out == NULL) return -1;
+
+    for (int i = 0; i < p->n_channels; i++) {
+        pipeline_channel_t* c = &p->ch[i];
+        if (valid != NULL && !valid[i]) {
+            out[i] = c->last;
+            continue;
+        }
+
+        float v = (float)raw[i] * c->cfg.scale + c->cfg.offset + c->cfg.calibration;
+        if (c->average != NULL) v = filter_push(c->average, v);
+        if (c->median != NULL) v = filter_push(c->median, v);
+        c->last = v;
+        out[i] = v;
+    }
+    return 0;
+}
+
+int pipeline_set_calibration(pipeline_t* p, int channel, float calibration) {
+    if (p == NULL || channel < 0 || channel >= p->n_channels) return -1;
+    p->ch[channel].cfg.calibration = calibration;
+    return 0;
+}
+
+int pipeline_channel_count(const pipeline_t* p) {
+    return p ? p->n_channels : 0;
+}
+
+void pipeline_destroy(pipeline_t* p) {
+    if (p == NULL) return;
+    for (int i = 0; i < p->n_channels; i++) {
+        filter_destroy(p->ch[i].average);
+        filter_destroy(p->ch[i].median);
+    }
+    free(p);
+}
@@ -0,0 +1,241 @@
+#include "rollup.h"
+#include "data_handle.h"
+#include "shm_segment.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define READ_MAX_RETRIES 1000
+#define RING_TOTAL (ROLLUP_SECOND_BUCKETS + ROLLUP_MINUTE_BUCKETS + ROLLUP_HOUR_BUCKETS)
+
+// A bucket is valid for the period index it holds; a zero-filled one (period 0, 1970) never matches a query
+typedef struct {
+    int64_t index;          // timestamp_ms / bucket length
+    double min;
+    double max;
+    double sum;
+    uint64_t count;
+} rollup_bucket_t;
+
+typedef struct {
+    _Atomic uint32_t seq;   // Seqlock: odd while the writer is inside
+    uint32_t reserved;
+    rollup_bucket_t buckets[RING_TOTAL];    // Seconds, then minutes, then hours
+} rollup_channel_t;
+
+// Layout of the shared segment. Only append fields and bump ROLLUP_VERSION.
+typedef struct {
+    shm_segment_header_t hdr;
+    uint32_t n_channels;
+    uint32_t reserved;
+    rollup_channel_t channels[ROLLUP_MAX_CHANNELS];
+} rollup_shm_t;
+
+struct rollup {
+    rollup_shm_t *shm;
+    int writer;
+    pthread_mutex_t write_lock;
+};
+
+static const uint64_t RES_MS[ROLLUP_RES_COUNT] = { 1000ULL, 60000ULL, 3600000ULL };
+static const int RES_LEN[ROLLUP_RES_COUNT] = { ROLLUP_SECOND_BUCKETS, ROLLUP_MINUTE_BUCKETS, ROLLUP_HOUR_BUCKETS };
+static const int RES_OFFSET[ROLLUP_RES_COUNT] = { 0, ROLLUP_SECOND_BUCKETS, ROLLUP_SECOND_BUCKETS + ROLLUP_MINUTE_BUCKETS };
+
+/*---------------------------- Private Function --------------------------------*/
+static uint64_t wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static void stamp_header(void *addr) {
+    ((rollup_shm_t*)addr)->n_channels = ROLLUP_MAX_CHANNELS;
+}
+
+static void bucket_add(rollup_channel_t *c, int res, double value, uint64_t timestamp_ms, int64_t now_index) {
+    int64_t index = (int64_t)(timestamp_ms / RES_MS[res]);
+    rollup_bucket_t *b = &c->buckets[RES_OFFSET[res] + (int)(index % RES_LEN[res])];
+
+    if (b->index != index) {
+        // Slot already reused by a later period: too old for this ring. A period past now_index
+        // came from a clock that was ahead (RTC set back by NTP) and would block the slot for good.
+        if (b->index > index && b->index <= now_index) return;
+        b->index = index;
+        b->min = value;
+        b->max = value;
+        b->sum = 0.0;
+        b->count = 0;
+    }
+    if (value < b->min) b->min = value;
+    if (value > b->max) b->max = value;
+    b->sum += value;
+    b->count++;
+}
+
+/*
+ * Writer attach: buckets stamped past the current period were written while the clock was
+ * ahead. Drop them so they are neither reported nor merged with real samples later.
+ */
+static void discard_future(rollup_shm_t *shm) {
+    uint64_t now_ms = wall_ms();
+    for (int ch = 0; ch < ROLLUP_MAX_CHANNELS; ch++) {
+        rollup_channel_t *c = &shm->channels[ch];
+        shm_seqlock_write_begin(&c->seq);
+        for (int res = 0; res < ROLLUP_RES_COUNT; res++) {
+            int64_t now_index = (int64_t)(now_ms / RES_MS[res]);
+            for (int i = 0; i < RES_LEN[res]; i++) {
+                rollup_bucket_t *b = &c->buckets[RES_OFFSET[res] + i];
+                if (b->index > now_index) memset(b, 0, sizeof(*b));
+            }
+        }
+        shm_seqlock_write_end(&c->seq);
+    }
+}
+
+static void stats_clear(rollup_stats_t *s, uint64_t start_ms) {
+    memset(s, 0, sizeof(*s));
+    s->start_ms = start_ms;
+}
+
+static void stats_merge(rollup_stats_t *s, const rollup_bucket_t *b) {
+    if (s->count == 0 || b->min < s->min) s->min = b->min;
+    if (s->count == 0 || b->max > s->max) s->max = b->max;
+    s->sum += b->sum;
+    s->count += b->count;
+}
+
+static void stats_finish(rollup_stats_t *s) {
+    s->avg = s->count ? s->sum / (double)s->count : 0.0;
+}
+
+static int check_args(rollup_t *r, int channel, int resolution, int *n_buckets) {
+    if (r == NULL || channel < 0 || channel >= ROLLUP_MAX_CHANNELS) return ROLLUP_E_GENERIC_FAIL;
+    if (resolution < 0 || resolution >= ROLLUP_RES_COUNT || *n_buckets <= 0) return ROLLUP_E_GENERIC_FAIL;
+    if (*n_buckets > RES_LEN[resolution]) *n_buckets = RES_LEN[resolution];
+    return ROLLUP_SUCCESS;
+}
+
+/*
+ * Visits the buckets of the last n periods ending at now_ms under the channel seqlock.
+ * series != NULL: one entry per period; otherwise everything is merged into total.
+ */
+static int read_window(rollup_t *r, int channel, int res, int n, uint64_t now_ms,
+                       rollup_stats_t *series, rollup_stats_t *total) {
+    const rollup_channel_t *c = &r->shm->channels[channel];
+    const rollup_bucket_t *ring = &c->buckets[RES_OFFSET[res]];
+    int64_t last = (int64_t)((now_ms ? now_ms : wall_ms()) / RES_MS[res]);
+    int64_t first = last - n + 1;
+    if (first < 0) first = 0;
+
+    for (int attempt = 0; attempt < READ_MAX_RETRIES; attempt++) {
+        uint32_t begin = shm_seqlock_read_begin(&c->seq);
+        if (begin & 1U) continue; // Writer inside, try again
+
+        if (total != NULL) stats_clear(total, (uint64_t)first * RES_MS[res]);
+        for (int64_t index = first; index <= last; index++) {
+            const rollup_bucket_t *b = &ring[index % RES_LEN[res]];
+            rollup_stats_t *s = total;
+            if (series != NULL) {
+                s = &series[index - first];
+                stats_clear(s, (uint64_t)index * RES_MS[res]);
+            }
+            if (b->index == index && b->count > 0) stats_merge(s, b);
+            if (series != NULL) stats_finish(s);
+        }
+        if (total != NULL) stats_finish(total);
+        if (shm_seqlock_read_valid(&c->seq, begin)) return (int)(last - first + 1);
+    }
+    return ROLLUP_E_BUSY;
+}
+
+/*------------------------ Public Function -----------------------------*/
+rollup_t* rollup_open(const char *name, int writer, int *err) {
+    int code = ROLLUP_SUCCESS;
+    rollup_t *r = calloc(1, sizeof(*r));
+    if (r == NULL) {
+        code = ROLLUP_E_GENERIC_FAIL;
+        goto fail;
+    }
+
+    int seg_err = SHM_SEGMENT_SUCCESS;
+    r->shm = shm_segment_open(name, sizeof(rollup_shm_t), writer, ROLLUP_MAGIC, ROLLUP_VERSION,
+                              stamp_header, LOGGER_COMP_DATA_HANDLE, &seg_err);
+    if (r->shm == NULL) {
+        code = (seg_err == SHM_SEGMENT_E_LAYOUT) ? ROLLUP_E_LAYOUT : ROLLUP_E_OPEN;
+        goto fail;
+    }
+    if (r->shm->n_channels != ROLLUP_MAX_CHANNELS) {
+        LOG_ERR("rollup_open: segment has %u channels, expected %d", r->shm->n_channels, ROLLUP_MAX_CHANNELS);
+        shm_segment_close(r->shm, sizeof(rollup_shm_t));
+        code = ROLLUP_E_LAYOUT;
+        goto fail;
+    }
+    r->writer = writer || name == NULL;
+    if (r->writer) {
+        // A previous writer may have died inside a channel write, leaving its seqlock odd
+        for (int ch = 0; ch < ROLLUP_MAX_CHANNELS; ch++) shm_seqlock_recover(&r->shm->channels[ch].seq);
+        discard_future(r->shm);
+    }
+
+    pthread_mutex_init(&r->write_lock, NULL);
+    return r;
+
+fail:
+    free(r);
+    if (err != NULL) *err = code;
+    return NULL;
+}
+
+int rollup_add(rollup_t *r, int channel, double value, uint64_t timestamp_ms) {
+    return rollup_add_many(r, &channel, &value, 1, timestamp_ms);
+}
+
+int rollup_add_many(rollup_t *r, const int *channels, const double *values, int n, uint64_t timestamp_ms) {
+    if (r == NULL || !r->writer || channels == NULL || values == NULL) return ROLLUP_E_GENERIC_FAIL;
+    for (int i = 0; i < n; i++) {
+        if (channels[i] < 0 || channels[i] >= ROLLUP_MAX_CHANNELS) return ROLLUP_E_GENERIC_FAIL;
+    }
+
+    uint64_t now_ms = wall_ms();
+    if (timestamp_ms > now_ms) now_ms = timestamp_ms;   // Never discard the bucket being written
+
+    pthread_mutex_lock(&r->write_lock);
+    for (int i = 0; i < n; i++) {
+        rollup_channel_t *c = &r->shm->channels[channels[i]];
+        shm_seqlock_write_begin(&c->seq);
+        for (int res = 0; res < ROLLUP_RES_COUNT; res++) {
+            bucket_add(c, res, values[i], timestamp_ms, (int64_t)(now_ms / RES_MS[res]));
+        }
+        shm_seqlock_write_end(&c->seq);
+    }
+    pthread_mutex_unlock(&r->write_lock);
+    return ROLLUP_SUCCESS;
+}
+
+int rollup_query(rollup_t *r, int channel, int resolution, int n_buckets, uint64_t now_ms, rollup_stats_t *out) {
+    if (out == NULL || check_args(r, channel, resolution, &n_buckets) != ROLLUP_SUCCESS) return ROLLUP_E_GENERIC_FAIL;
+    int ret = read_window(r, channel, resolution, n_buckets, now_ms, NULL, out);
+    return (ret < 0) ? ret : ROLLUP_SUCCESS;
+}
+
+int rollup_series(rollup_t *r, int channel, int resolution, int n_buckets, uint64_t now_ms, rollup_stats_t *out) {
+    if (out == NULL || check_args(r, channel, resolution, &n_buckets) != ROLLUP_SUCCESS) return ROLLUP_E_GENERIC_FAIL;
+    return read_window(r, channel, resolution, n_buckets, now_ms, out, NULL);
+}
+
+int rollup_capacity(int resolution) {
+    return (resolution >= 0 && resolution < ROLLUP_RES_COUNT) ? RES_LEN[resolution] : 0;
+}
+
+void rollup_close(rollup_t *r) {
+    if (r == NULL) return;
+    shm_segment_close(r->shm, sizeof(rollup_shm_t));
+    pthread_mutex_destroy(&r->write_lock);
+    free(r);
+}
+
+int rollup_cleanup(const char *name) {
+    return (shm_segment_unlink(name, LOGGER_COMP_DATA_HANDLE) == SHM_SEGMENT_SUCCESS) ? ROLLUP_SUCCESS
+                                                                                       : ROLLUP_E_GENERIC_FAIL;
+}
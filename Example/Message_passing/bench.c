@@ -0,0 +1,169 @@
+#include "msg.h"
+#include "msg_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define BENCH_QUEUE "/msg_bench_queue"
+#define BENCH_RING "/msg_bench_ring"
+#define MSG_PAYLOAD 32
+#define BATCH 8
+
+static int n_messages = 20000;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*--------------------- Legacy API: open/close per message ---------------------*/
+static void* legacy_reader(void* arg) {
+    char buffer[MAX_MSG_SIZE_DEFAULT];
+    size_t len;
+    for (int i = 0; i < n_messages; i++) {
+        if (msg_read(BENCH_QUEUE, buffer, sizeof(buffer), &len) != MSG_SUCCESS) break;
+    }
+    return arg;
+}
+
+static double bench_legacy(void) {
+    char payload[MSG_PAYLOAD] = "sensor sample";
+    pthread_t reader;
+    double start = now_sec();
+    pthread_create(&reader, NULL, legacy_reader, NULL);
+    for (int i = 0; i < n_messages; i++) {
+        msg_write(BENCH_QUEUE, payload, sizeof(payload));
+    }
+    pthread_join(reader, NULL);
+    return now_sec() - start;
+}
+
+/*--------------------- Handle API: one message per call ---------------------*/
+static void* handle_reader(void* arg) {
+    msg_handle_t *rx = msg_open(BENCH_QUEUE, MSG_O_READ, 0, 0, NULL);
+    char buffer[MAX_MSG_SIZE_DEFAULT];
+    size_t len;
+    for (int i = 0; rx && i < n_messages; i++) {
+        if (msg_receive(rx, buffer, sizeof(buffer), &len, NULL) != MSG_SUCCESS) break;
+    }
+    msg_close(rx);
+    return arg;
+}
+
+static double bench_handle(void) {
+    char payload[MSG_PAYLOAD] = "sensor sample";
+    msg_handle_t *tx = msg_open(BENCH_QUEUE, MSG_O_WRITE, 0, 0, NULL);
+    pthread_t reader;
+    double start = now_sec();
+    pthread_create(&reader, NULL, handle_reader, NULL);
+    for (int i = 0; i < n_messages; i++) {
+        msg_send(tx, payload, sizeof(payload), 0);
+    }
+    pthread_join(reader, NULL);
+    double elapsed = now_sec() - start;
+    msg_close(tx);
+    return elapsed;
+}
+
+/*--------------------- Handle API: batches ---------------------*/
+static void* batch_reader(void* arg) {
+    msg_handle_t *rx = msg_open(BENCH_QUEUE, MSG_O_READ, 0, 0, NULL);
+    static char buffers[BATCH * MAX_MSG_SIZE_DEFAULT];
+    size_t lens[BATCH];
+    int total = 0;
+    while (rx && total < n_messages) {
+        int got = msg_receive_batch(rx, buffers, MAX_MSG_SIZE_DEFAULT, lens, BATCH, MSG_WAIT_FOREVER);
+        if (got < 0) break;
+        total += got;
+    }
+    msg_close(rx);
+    return arg;
+}
+
+static double bench_batch(void) {
+    char payload[MSG_PAYLOAD] = "sensor sample";
+    const char *messages[BATCH];
+    size_t lens[BATCH];
+    for (int i = 0; i < BATCH; i++) {
+        messages[i] = payload;
+        lens[i] = sizeof(payload);
+    }
+
+    msg_handle_t *tx = msg_open(BENCH_QUEUE, MSG_O_WRITE, 0, 0, NULL);
+    pthread_t reader;
+    double start = now_sec();
+    pthread_create(&reader, NULL, batch_reader, NULL);
+    int sent = 0;
+    while (sent < n_messages) {
+        int chunk = (n_messages - sent < BATCH) ? n_messages - sent : BATCH;
+        int rc = msg_send_batch(tx, messages, lens, chunk, 0, MSG_WAIT_FOREVER);
+        if (rc < 0) break;
+        sent += rc;
+    }
+    pthread_join(reader, NULL);
+    double elapsed = now_sec() - start;
+    msg_close(tx);
+    return elapsed;
+}
+
+/*--------------------- Shared-memory ring: zero copy ---------------------*/
+static void* ring_reader(void* arg) {
+    msg_ring_t *rx = msg_ring_open(BENCH_RING, 0, 0, 0, NULL);
+    size_t len;
+    for (int i = 0; rx && i < n_messages; i++) {
+        const void *msg = msg_ring_peek(rx, &len, MSG_WAIT_FOREVER, NULL);
+        if (msg == NULL) break;
+        msg_ring_release(rx, msg);
+    }
+    msg_ring_close(rx);
+    return arg;
+}
+
+static double bench_ring(void) {
+    // Same depth and slot size as the mqueue runs, to compare like with like
+    msg_ring_t *tx = msg_ring_open(BENCH_RING, MSG_O_CREATE, MAX_MSGS_DEFAULT, MAX_MSG_SIZE_DEFAULT, NULL);
+    if (tx == NULL) return -1.0;
+    pthread_t reader;
+    double start = now_sec();
+    pthread_create(&reader, NULL, ring_reader, NULL);
+    for (int i = 0; i < n_messages; i++) {
+        char *slot = msg_ring_reserve(tx, MSG_WAIT_FOREVER, NULL);
+        if (slot == NULL) break;
+        strcpy(slot, "sensor sample");
+        msg_ring_commit(tx, slot, MSG_PAYLOAD);
+    }
+    pthread_join(reader, NULL);
+    double elapsed = now_sec() - start;
+    msg_ring_close(tx);
+    msg_ring_cleanup(BENCH_RING);
+    return elapsed;
+}
+
+static void report(const char *name, double elapsed) {
+    printf("%-22s %8.3f s  %10.0f msg/s\n", name, elapsed, n_messages / elapsed);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) n_messages = atoi(argv[1]);
+
+    // Create the queue once with the same attributes msg_read() would use
+    msg_cleanup(BENCH_QUEUE);
+    msg_handle_t *owner = msg_open(BENCH_QUEUE, MSG_O_READ | MSG_O_CREATE, MAX_MSGS_DEFAULT, MAX_MSG_SIZE_DEFAULT, NULL);
+    if (owner == NULL) {
+        fprintf(stderr, "Unable to create %s\n", BENCH_QUEUE);
+        return EXIT_FAILURE;
+    }
+
+    printf("%d messages of %d bytes\n", n_messages, MSG_PAYLOAD);
+    report("msg_write/msg_read", bench_legacy());
+    report("msg_send/msg_receive", bench_handle());
+    report("msg_*_batch (8)", bench_batch());
+    report("msg_ring (shm)", bench_ring());
+
+    msg_close(owner);
+    msg_cleanup(BENCH_QUEUE);
+    return EXIT_SUCCESS;
+}
@@ -5,13 +5,21 @@
 size_t received_len = 10;
 int main (int argc, char* argv[]){
 	char buffer[BUFFER_SIZE];
+	// Open the queue once (create it if needed) instead of on every message
+	msg_handle_t *queue = msg_open("/my_queue", MSG_O_READ | MSG_O_CREATE, 0, 0, NULL);
+	if (queue == NULL){
+		perror ("Error when opening queue");
+		return 1;
+	}
 	while (1){
-		int re_msg = msg_read("/my_queue", buffer, BUFFER_SIZE, (size_t*) &received_len);
+		int re_msg = msg_receive(queue, buffer, BUFFER_SIZE - 1, (size_t*) &received_len, NULL);
 		if (re_msg == MSG_SUCCESS){
+			buffer[received_len] = '\0';
 			printf("Read process: %s\n", buffer);
 		}
 		else {
 			perror ("Error when reading");
 		}
 	}
+	msg_close(queue);
 }
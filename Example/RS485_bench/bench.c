@@ -0,0 +1,195 @@
+#include "air_rs485.h"
+#include "rs485_rtu.h"
+#include "modbus_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+/*
+ * Compares the libmodbus transport with the epoll-driven RTU transport.
+ * Each bus is a simulated PM sensor on its own pseudo-terminal (see modbus_sim.h)
+ * that waits a fixed turnaround before replying.
+ */
+
+#define MAX_BUSES 8
+#define SLAVE_ID 0x24
+#define START_REG 0x0004
+#define CRC_FRAME 256
+
+static int n_buses = 4;
+static int n_txn = 300;             // Transactions per bus
+static int n_regs = 6;
+static int turnaround_us = 2000;
+
+struct bus {
+    modbus_sim_t *sim;
+    const char *device;
+    modbus_t *ctx;                  // libmodbus runs
+    rs485_rtu_port_t *port;         // RTU engine run
+    int remaining;
+    int failed;
+};
+
+static struct bus buses[MAX_BUSES];
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int open_buses(void) {
+    modbus_sim_config_t cfg;
+    modbus_sim_default_config(&cfg);
+    cfg.delay_us = (uint32_t)turnaround_us;
+
+    for (int i = 0; i < n_buses; i++) {
+        struct bus *b = &buses[i];
+        memset(b, 0, sizeof(*b));
+        b->sim = modbus_sim_create(&cfg);
+        if (b->sim == NULL || modbus_sim_add_slave(b->sim, SLAVE_ID, MODBUS_SIM_PM) != 0 ||
+            modbus_sim_start(b->sim) != 0) return -1;
+        b->device = modbus_sim_device(b->sim);
+    }
+    return 0;
+}
+
+static void close_buses(void) {
+    for (int i = 0; i < n_buses; i++) modbus_sim_destroy(buses[i].sim);
+}
+
+/*--------------------- CRC: bit-serial vs slice-by-8 ---------------------*/
+static void bench_crc(void) {
+    uint8_t frame[CRC_FRAME];
+    for (int i = 0; i < CRC_FRAME; i++) frame[i] = (uint8_t)(i * 31 + 7);
+    const int rounds = 200000;
+    volatile uint16_t sink = 0;
+
+    double t0 = now_sec();
+    for (int i = 0; i < rounds; i++) sink ^= rs485_rtu_crc16_bitwise(frame, sizeof(frame));
+    double t_bit = now_sec() - t0;
+
+    t0 = now_sec();
+    for (int i = 0; i < rounds; i++) sink ^= rs485_rtu_crc16(frame, sizeof(frame));
+    double t_slice = now_sec() - t0;
+
+    double mb = (double)rounds * CRC_FRAME / 1e6;
+    printf("CRC16 bit-serial : %8.1f MB/s\n", mb / t_bit);
+    printf("CRC16 slice-by-8 : %8.1f MB/s (match: %s)\n", mb / t_slice,
+           rs485_rtu_crc16(frame, sizeof(frame)) == rs485_rtu_crc16_bitwise(frame, sizeof(frame)) ? "yes" : "NO");
+    (void)sink;
+}
+
+/*--------------------- libmodbus: one blocking call at a time ---------------------*/
+static void* modbus_worker(void *arg) {
+    struct bus *b = arg;
+    uint16_t values[RS485_RTU_MAX_READ];
+    for (int i = 0; i < n_txn; i++) {
+        if (rs485_read_block(b->ctx, SLAVE_ID, START_REG, n_regs, values) != 0) b->failed++;
+    }
+    return NULL;
+}
+
+static double bench_modbus(int threaded) {
+    for (int i = 0; i < n_buses; i++) {
+        buses[i].failed = 0;
+        buses[i].ctx = rs485_init(buses[i].device, 115200, 'N', 8, 1);
+        if (buses[i].ctx == NULL) return -1;
+    }
+
+    double start = now_sec();
+    if (threaded) {
+        pthread_t workers[MAX_BUSES];
+        for (int i = 0; i < n_buses; i++) pthread_create(&workers[i], NULL, modbus_worker, &buses[i]);
+        for (int i = 0; i < n_buses; i++) pthread_join(workers[i], NULL);
+    } else {
+        uint16_t values[RS485_RTU_MAX_READ];
+        for (int t = 0; t < n_txn; t++) {
+            for (int i = 0; i < n_buses; i++) {
+                if (rs485_read_block(buses[i].ctx, SLAVE_ID, START_REG, n_regs, values) != 0) buses[i].failed++;
+            }
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    for (int i = 0; i < n_buses; i++) rs485_close(buses[i].ctx);
+    return elapsed;
+}
+
+/*--------------------- RTU engine: every bus in flight from one thread ---------------------*/
+static void rtu_done(rs485_rtu_port_t *port, int status, const uint16_t *values, int count, void *user) {
+    (void)values;
+    (void)count;
+    struct bus *b = user;
+    if (status != RS485_RTU_OK) b->failed++;
+    if (--b->remaining > 0) rs485_rtu_submit_read(port, SLAVE_ID, START_REG, n_regs, rtu_done, b);
+}
+
+static double bench_rtu(void) {
+    rs485_rtu_engine_t *e = rs485_rtu_engine_create();
+    if (e == NULL) return -1;
+    for (int i = 0; i < n_buses; i++) {
+        buses[i].failed = 0;
+        buses[i].remaining = n_txn;
+        buses[i].port = rs485_rtu_open(e, buses[i].device, 115200, 'N', 8, 1);
+        if (buses[i].port == NULL) {
+            rs485_rtu_engine_destroy(e);
+            return -1;
+        }
+    }
+
+    double start = now_sec();
+    for (int i = 0; i < n_buses; i++) rs485_rtu_submit_read(buses[i].port, SLAVE_ID, START_REG, n_regs, rtu_done, &buses[i]);
+    while (rs485_rtu_engine_pending(e) > 0) {
+        if (rs485_rtu_engine_poll(e, -1) < 0) break;
+    }
+    double elapsed = now_sec() - start;
+
+    rs485_rtu_engine_destroy(e);
+    return elapsed;
+}
+
+static void report(const char *name, double elapsed, int threads) {
+    int failed = 0;
+    for (int i = 0; i < n_buses; i++) failed += buses[i].failed;
+    if (elapsed < 0) {
+        printf("%-30s : setup failed\n", name);
+        return;
+    }
+    printf("%-30s : %8.0f txn/s  (%d thread%s, %d failed)\n", name,
+           (double)n_buses * n_txn / elapsed, threads, threads > 1 ? "s" : "", failed);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "b:n:r:d:")) != -1) {
+        switch (opt) {
+            case 'b': n_buses = atoi(optarg); break;
+            case 'n': n_txn = atoi(optarg); break;
+            case 'r': n_regs = atoi(optarg); break;
+            case 'd': turnaround_us = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-b buses] [-n txn per bus] [-r registers] [-d turnaround us]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (n_buses < 1 || n_buses > MAX_BUSES || n_regs < 1 || START_REG + n_regs > MODBUS_SIM_DATA_REGS || n_txn < 1) {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    bench_crc();
+    if (open_buses() != 0) {
+        perror("pty");
+        return 1;
+    }
+    printf("%d bus(es), %d x FC03(%d regs) each, %d us turnaround\n", n_buses, n_txn, n_regs, turnaround_us);
+    report("libmodbus, one thread", bench_modbus(0), 1);
+    report("libmodbus, thread per bus", bench_modbus(1), n_buses);
+    report("RTU engine, one thread", bench_rtu(), 1);
+    close_buses();
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "air_rs485.h"
+#include "pm_sensor.h"
+#include "modbus_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+/*
+ * Drives air_rs485 and pm_sensor against the pty simulator and reports
+ * throughput and latency percentiles for each bus path.
+ */
+
+#define PM_ID 0x24
+#define CO_ID 0x01
+#define PM_BLOCK 6                  // PM2.5 (0x0004) .. PM10 (0x0009)
+#define CO_REG 0x0006
+#define BENCH_BAUD 9600
+
+static int n_txn = 1000;
+
+struct result {
+    double *lat_us;
+    int n;
+    int failed;
+    double elapsed;
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int n, double p) {
+    if (n == 0) return 0;
+    int idx = (int)(p * n + 0.999999) - 1;
+    if (idx < 0) idx = 0;
+    if (idx >= n) idx = n - 1;
+    return sorted[idx];
+}
+
+static void report(const char *name, struct result *r) {
+    qsort(r->lat_us, (size_t)r->n, sizeof(double), cmp_double);
+    printf("%-28s %8.1f txn/s  p50 %8.0f us  p99 %8.0f us  p999 %8.0f us  failed %d/%d\n",
+           name, r->n / r->elapsed, percentile(r->lat_us, r->n, 0.50), percentile(r->lat_us, r->n, 0.99),
+           percentile(r->lat_us, r->n, 0.999), r->failed, r->n);
+}
+
+/*--------------------- air_rs485 ---------------------*/
+static void bench_block(modbus_t *ctx, struct result *r, int slave_id, int reg, int count) {
+    uint16_t values[PM_BLOCK];
+    double start = now_sec();
+    for (int i = 0; i < r->n; i++) {
+        double t0 = now_sec();
+        if (rs485_read_block(ctx, slave_id, reg, count, values) != 0) r->failed++;
+        r->lat_us[i] = (now_sec() - t0) * 1e6;
+    }
+    r->elapsed = now_sec() - start;
+}
+
+/*--------------------- pm_sensor ---------------------*/
+static int bench_pm_sensor(const char *device, struct result *r) {
+    char config[] = "/tmp/pm_bench_XXXXXX";
+    int fd = mkstemp(config);
+    if (fd < 0) return -1;
+    FILE *f = fdopen(fd, "w");
+    fprintf(f, "ADDR=%02x\nBAUD=%u\nPATH=%s", PM_ID, BENCH_BAUD, device);
+    fclose(f);
+
+    PMSensor_t s;
+    memset(&s, 0, sizeof(s));
+    int ok = (pm_sensor_init(&s, config) == 0);
+    unlink(config);
+    if (!ok) return -1;
+
+    float pm25, pm10;
+    double start = now_sec();
+    for (int i = 0; i < r->n; i++) {
+        double t0 = now_sec();
+        if (pm_sensor_read_data(&s, &pm25, &pm10) != 0) r->failed++;
+        r->lat_us[i] = (now_sec() - t0) * 1e6;
+    }
+    r->elapsed = now_sec() - start;
+
+    modbus_close(s.ctx);
+    modbus_free(s.ctx);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    modbus_sim_config_t cfg;
+    modbus_sim_default_config(&cfg);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:d:j:e:s:b:")) != -1) {
+        switch (opt) {
+            case 'n': n_txn = atoi(optarg); break;
+            case 'd': cfg.delay_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'j': cfg.jitter_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'e': cfg.error_rate = atof(optarg); break;
+            case 's': cfg.silence_rate = atof(optarg); break;
+            case 'b': cfg.baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "Usage: %s [-n txn] [-d delay_us] [-j jitter_us] [-e error_rate] [-s silence_rate] [-b wire_baud]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (n_txn < 1) return 1;
+
+    modbus_sim_t *sim = modbus_sim_create(&cfg);
+    if (sim == NULL || modbus_sim_add_slave(sim, PM_ID, MODBUS_SIM_PM) != 0 ||
+        modbus_sim_add_slave(sim, CO_ID, MODBUS_SIM_CO) != 0 || modbus_sim_start(sim) != 0) {
+        fprintf(stderr, "Simulator setup failed\n");
+        modbus_sim_destroy(sim);
+        return 1;
+    }
+    const char *device = modbus_sim_device(sim);
+    printf("Simulator on %s: delay %u us, jitter %u us, error %.3f, silence %.3f, wire %u baud, %d txn per test\n",
+           device, cfg.delay_us, cfg.jitter_us, cfg.error_rate, cfg.silence_rate, cfg.baud, n_txn);
+
+    struct result r;
+    r.lat_us = malloc((size_t)n_txn * sizeof(double));
+    if (r.lat_us == NULL) return 1;
+
+    modbus_t *ctx = rs485_init(device, BENCH_BAUD, 'N', 8, 1);
+    if (ctx == NULL) {
+        fprintf(stderr, "rs485_init failed on %s\n", device);
+        return 1;
+    }
+    r.n = n_txn; r.failed = 0;
+    bench_block(ctx, &r, PM_ID, PM_REG_PM25, PM_BLOCK);
+    report("air_rs485 PM block (x6)", &r);
+
+    r.n = n_txn; r.failed = 0;
+    bench_block(ctx, &r, CO_ID, CO_REG, 1);
+    report("air_rs485 CO raw", &r);
+    rs485_close(ctx);
+
+    r.n = n_txn; r.failed = 0;
+    if (bench_pm_sensor(device, &r) == 0) report("pm_sensor_read_data", &r);
+    else fprintf(stderr, "pm_sensor_init failed on %s\n", device);
+
+    modbus_sim_stats_t st;
+    modbus_sim_get_stats(sim, &st);
+    printf("Simulator: %llu requests, %llu responses, %llu corrupted, %llu silenced\n",
+           (unsigned long long)st.requests, (unsigned long long)st.responses,
+           (unsigned long long)st.corrupted, (unsigned long long)st.silenced);
+
+    free(r.lat_us);
+    modbus_sim_destroy(sim);
+    return 0;
+}
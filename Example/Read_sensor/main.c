@@ -3,8 +3,10 @@
 #include <unistd.h>
 #include <errno.h>
 #include "air_rs485.h" // Our new library
+#include "rs485_timing.h"
+#include "rs485_discovery.h"
 
-// --- Configuration: Slave IDs ---
+// --- Configuration: Slave IDs (defaults, replaced by what the start-up scan identifies) ---
 #define EPAM_SLAVE_ID_CFG   0x24  // Default ID for PM2.5/PM10 sensor
 #define EPCO_SLAVE_ID_CFG   0x25  // Default ID for CO sensor
 #define EPNO2_SLAVE_ID_CFG  0x23  // Default ID for NO2 sensor
@@ -20,8 +22,8 @@ modbus_t* setup_modbus_connection() {
         return NULL;
     }
     
-    // You can set timeouts here if needed
-    // modbus_set_response_timeout(ctx, 0, 500000); // e.g., 500ms timeout
+    // Response/byte timeouts sized for the baud rate (libmodbus defaults to 500 ms each)
+    rs485_timing_apply_defaults(ctx, BAUD_RATE);
 
     if (modbus_connect(ctx) == -1) {
         fprintf(stderr, "FATAL ERROR: Unable to connect to Modbus port %s.\n", DEVICE_PORT);
@@ -33,12 +35,32 @@ modbus_t* setup_modbus_connection() {
     return ctx;
 }
 
+// Address of the only device identified as desc, or the configured default
+static int pick_slave(const rs485_device_map_t *map, const rs485_sensor_desc_t *desc, int default_id) {
+    const rs485_device_t *dev = rs485_device_map_find(map, desc);
+    if (dev == NULL || dev->slave_id == default_id) return default_id;
+    printf("%s found at 0x%02X instead of 0x%02X\n", desc->model, dev->slave_id, default_id);
+    return dev->slave_id;
+}
+
 int main(void) {
     modbus_t *ctx = setup_modbus_connection();
     if (!ctx) {
         return EXIT_FAILURE;
     }
 
+    // Scan every address with short timeouts (a few seconds at 9600 baud)
+    static rs485_device_map_t map;
+    int found = rs485_discovery_scan(ctx, BAUD_RATE, 1, 247, 0, 0, &map);
+    printf("Discovery: %d device(s) on %s\n", found, DEVICE_PORT);
+    for (int i = 0; i < map.n_devices; i++) {
+        const rs485_device_t *dev = &map.devices[i];
+        printf("  0x%02X: %s\n", dev->slave_id, dev->model ? dev->model->model : (dev->signature ? "EP sensor" : "unknown device"));
+    }
+    int epam_id = pick_slave(&map, &rs485_sensor_epam, EPAM_SLAVE_ID_CFG);
+    int epco_id = pick_slave(&map, &rs485_sensor_epco, EPCO_SLAVE_ID_CFG);
+    int epno2_id = pick_slave(&map, &rs485_sensor_epno2, EPNO2_SLAVE_ID_CFG);
+
     float pm2_5, pm10, co_value, no2_value;
 
     while (1) {
@@ -46,21 +68,21 @@ int main(void) {
         int status;
 
         // 1. Read EPAM Sensor (PM2.5/PM10)
-        status = air_rs485_read_epam(ctx, EPAM_SLAVE_ID_CFG, &pm2_5, &pm10);
+        status = air_rs485_read_epam(ctx, epam_id, &pm2_5, &pm10);
         if (status == AIR_RS485_SUCCESS) {
-            printf("[EPAM - 0x%02X] PM2.5: %.2f µg/m³, PM10: %.2f µg/m³\n", EPAM_SLAVE_ID_CFG, pm2_5, pm10);
+            printf("[EPAM - 0x%02X] PM2.5: %.2f µg/m³, PM10: %.2f µg/m³\n", epam_id, pm2_5, pm10);
         } // Error details logged by the library
 
         // 2. Read EPCO Sensor (CO)
-        status = air_rs485_read_epco(ctx, EPCO_SLAVE_ID_CFG, &co_value);
+        status = air_rs485_read_epco(ctx, epco_id, &co_value);
         if (status == AIR_RS485_SUCCESS) {
-            printf("[EPCO - 0x%02X] CO: %.2f ppm\n", EPCO_SLAVE_ID_CFG, co_value);
+            printf("[EPCO - 0x%02X] CO: %.2f ppm\n", epco_id, co_value);
         } // Error details logged by the library
 
         // 3. Read EPNO2 Sensor (NO2)
-        status = air_rs485_read_epno2(ctx, EPNO2_SLAVE_ID_CFG, &no2_value);
+        status = air_rs485_read_epno2(ctx, epno2_id, &no2_value);
         if (status == AIR_RS485_SUCCESS) {
-            printf("[EPNO2 - 0x%02X] NO2: %.2f ppm\n", EPNO2_SLAVE_ID_CFG, no2_value);
+            printf("[EPNO2 - 0x%02X] NO2: %.2f ppm\n", epno2_id, no2_value);
         } // Error details logged by the library
 
         sleep(1);
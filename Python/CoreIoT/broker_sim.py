@@ -0,0 +1,179 @@
+import argparse
+import json
+import socket
+import socketserver
+import struct
+import threading
+import time
+
+"""
+Local stand-in for the CoreIoT MQTT broker (MQTT 3.1.1 subset: CONNECT, PUBLISH QoS 0/1,
+SUBSCRIBE, PINGREQ, DISCONNECT). It counts messages, telemetry samples and bytes, can
+simulate link outages by dropping and refusing clients, and can record every payload.
+
+    python3 -m CoreIoT.broker_sim --port 1884 --down-every 120 --down-for 30 --record /tmp/telemetry.jsonl
+"""
+
+CONNECT, CONNACK, PUBLISH, PUBACK, SUBSCRIBE, SUBACK = 1, 2, 3, 4, 8, 9
+PINGREQ, PINGRESP, DISCONNECT = 12, 13, 14
+
+
+class BrokerState:
+    def __init__(self, down_every=0.0, down_for=0.0, record=None):
+        self.lock = threading.Lock()
+        self.messages = 0
+        self.samples = 0
+        self.bytes = 0
+        self.connects = 0
+        self.down_every = down_every
+        self.down_for = down_for
+        self.started = time.monotonic()
+        self.forced_down = False
+        self.clients = set()
+        self.record = open(record, "a") if record else None
+
+    def is_down(self):
+        if self.forced_down:
+            return True
+        if self.down_every <= 0:
+            return False
+        return (time.monotonic() - self.started) % self.down_every >= self.down_every - self.down_for
+
+    def set_down(self, down):
+        """Forces an outage (tests); connected clients are dropped."""
+        self.forced_down = down
+        if down:
+            with self.lock:
+                clients = list(self.clients)
+            for sock in clients:
+                try:
+                    sock.shutdown(socket.SHUT_RDWR)
+                except OSError:
+                    pass
+
+    def on_publish(self, topic, payload):
+        try:
+            data = json.loads(payload)
+            n = len(data) if isinstance(data, list) else 1
+        except ValueError:
+            n = 0
+        with self.lock:
+            self.messages += 1
+            self.samples += n
+            self.bytes += len(payload)
+            if self.record is not None:
+                self.record.write(json.dumps({"topic": topic, "payload": payload.decode('utf-8', 'replace')}) + "\n")
+                self.record.flush()
+
+    def summary(self):
+        with self.lock:
+            return {"connects": self.connects, "messages": self.messages, "samples": self.samples, "bytes": self.bytes}
+
+
+def _read_exact(sock, n):
+    buf = b""
+    while len(buf) < n:
+        chunk = sock.recv(n - len(buf))
+        if not chunk:
+            raise ConnectionError("closed")
+        buf += chunk
+    return buf
+
+
+def _read_packet(sock):
+    header = _read_exact(sock, 1)[0]
+    length, shift = 0, 0
+    while True:
+        byte = _read_exact(sock, 1)[0]
+        length |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            break
+        shift += 7
+    return header >> 4, header & 0x0F, _read_exact(sock, length) if length else b""
+
+
+class _Handler(socketserver.BaseRequestHandler):
+    def handle(self):
+        state = self.server.state
+        sock = self.request
+        if state.is_down():
+            return                      # Refused: the client sees the link as down
+        with state.lock:
+            state.clients.add(sock)
+        try:
+            ptype, _, _ = _read_packet(sock)
+            if ptype != CONNECT:
+                return
+            sock.sendall(bytes([CONNACK << 4, 2, 0, 0]))
+            with state.lock:
+                state.connects += 1
+            sock.settimeout(1.0)
+            while True:
+                if state.is_down():
+                    return              # Outage: drop the connection
+                try:
+                    ptype, flags, body = _read_packet(sock)
+                except socket.timeout:
+                    continue
+                if ptype == PUBLISH:
+                    qos = (flags >> 1) & 0x03
+                    topic_len = struct.unpack(">H", body[:2])[0]
+                    topic = body[2:2 + topic_len].decode('utf-8', 'replace')
+                    pos = 2 + topic_len
+                    packet_id = body[pos:pos + 2] if qos > 0 else None
+                    if packet_id is not None:
+                        pos += 2
+                    state.on_publish(topic, body[pos:])     # Stored before the ack, like a real broker
+                    if packet_id is not None:
+                        sock.sendall(bytes([PUBACK << 4, 2]) + packet_id)
+                elif ptype == SUBSCRIBE:
+                    n_topics = body[2:].count(b"\x00") or 1
+                    sock.sendall(bytes([SUBACK << 4, 2 + n_topics]) + body[:2] + bytes(n_topics))
+                elif ptype == PINGREQ:
+                    sock.sendall(bytes([PINGRESP << 4, 0]))
+                elif ptype == DISCONNECT:
+                    return
+        except (ConnectionError, OSError):
+            return
+        finally:
+            with state.lock:
+                state.clients.discard(sock)
+
+
+class BrokerSim(socketserver.ThreadingTCPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+    def __init__(self, host="127.0.0.1", port=1884, **kwargs):
+        super().__init__((host, port), _Handler)
+        self.state = BrokerState(**kwargs)
+
+    def start(self):
+        """Serves in a background thread (for tests embedding the broker)."""
+        threading.Thread(target=self.serve_forever, daemon=True).start()
+        return self
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local MQTT broker stand-in for CoreIoT telemetry")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=1884)
+    parser.add_argument("--down-every", type=float, default=0.0, help="Outage period in seconds (0: never)")
+    parser.add_argument("--down-for", type=float, default=0.0, help="Outage length in seconds")
+    parser.add_argument("--record", default=None, help="Append every payload to this JSON lines file")
+    parser.add_argument("--report", type=float, default=10.0, help="Seconds between counter reports")
+    args = parser.parse_args()
+
+    broker = BrokerSim(args.host, args.port, down_every=args.down_every, down_for=args.down_for,
+                       record=args.record).start()
+    print(f"Broker stand-in on {args.host}:{args.port}")
+    try:
+        while True:
+            time.sleep(args.report)
+            print(broker.state.summary(), "(down)" if broker.state.is_down() else "")
+    except KeyboardInterrupt:
+        broker.shutdown()
+
+
+if __name__ == "__main__":
+    main()
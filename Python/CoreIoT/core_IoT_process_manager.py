@@ -1,38 +1,59 @@
 import logging
 from .mqtt_client import CoreIoTMQTTClient
-from .data_formatter import format_coreiot_telemetry
+from .data_formatter import encode_coreiot_telemetry
+from .uplink import TelemetryUplink
 
 log = logging.getLogger(__name__)
 
+SPOOL_DIR = "/var/lib/lsmy/telemetry_spool"   # Batches waiting for the link
+IDLE_WAIT_S = 10.0
+
 class CoreIoTProcessManager:
-    def __init__(self, global_store, stop_signal, data_ready_cv, token):
+    def __init__(self, global_store, stop_signal, data_ready_cv, token,
+                 broker="app.coreiot.io", port=1883, spool_dir=SPOOL_DIR):
         self.global_store = global_store
         self.stop_signal = stop_signal
         self.data_ready_cv = data_ready_cv
-        self.client = CoreIoTMQTTClient(token=token)
+        self.client = CoreIoTMQTTClient(broker=broker, port=port, token=token)
+        # Samples are published in batches; while offline they wait on disk
+        self.uplink = TelemetryUplink(self.client.publish_telemetry, self.client.is_connected, spool_dir)
+        self.snapshot = None
+
+    def _open_snapshot(self):
+        """Attaches to the sensor snapshot (created by the RS485 process) for native encoding."""
+        if self.snapshot is None:
+            try:
+                from Snapshot.snapshot_wrapper import SnapshotStore
+                self.snapshot = SnapshotStore()
+            except (OSError, ImportError):
+                return None     # Not published yet (or no library): Python formatter meanwhile
+        return self.snapshot
 
     def run_main_process(self):
         """FSM Implementation for Cloud Connection"""
         log.info("CoreIoT Process Started")
         
-        # Initial Connection (CHECK_CONNECTION state)
+        # Initial Connection (CHECK_CONNECTION state); the client keeps retrying in the background
         if not self.client.connect():
             log.warning("Starting with offline mode, will retry later")
 
         while not self.stop_signal.is_set():
-            # State: WAITING_DATA
+            # State: WAITING_DATA (or until a batch ages out / the spool may drain)
+            timeout = self.uplink.timeout()
             with self.data_ready_cv:
                 # Wait for sensor thread to signal that new data is in GlobalStore
-                data_update = self.data_ready_cv.wait(timeout=10.0) 
+                data_update = self.data_ready_cv.wait(timeout=IDLE_WAIT_S if timeout is None else min(timeout, IDLE_WAIT_S))
 
             if data_update:
                 # State: DATA_PROCESSING 
-                telemetry = format_coreiot_telemetry(self.global_store)
+                self.uplink.add(encode_coreiot_telemetry(self.global_store, self._open_snapshot()))
 
-                # State: SEND_TO_SERVER
-                success = self.client.publish_telemetry(telemetry)
-                if not success:
-                    log.error("Failed to send telemetry to CoreIoT")
+            # State: SEND_TO_SERVER (full or aged batch, spool drain at the rate cap)
+            self.uplink.poll()
             
+        self.uplink.close()
+        log.info(f"CoreIoT uplink: {self.uplink.stats}")
         self.client.disconnect()
-        log.info("CoreIoT Process Terminated")
\ No newline at end of file
+        if self.snapshot is not None:
+            self.snapshot.close()
+        log.info("CoreIoT Process Terminated")
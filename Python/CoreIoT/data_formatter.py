@@ -1,17 +1,40 @@
+import json
 import time
 
+# CoreIoT telemetry key -> internal GlobalStore key
+SENSOR_KEYS = (("co", "co_level"), ("pm25", "pm_2_5_level"), ("pm10", "pm_10_level"))
+EXTRA_KEYS = (("people_count", "people_count"), ("wifi_status", "wifi_status"))
+
 def format_coreiot_telemetry(global_store):
     """
     Maps internal GlobalStore keys to CoreIoT telemetry keys.
     Uses time-series format for historical analysis[cite: 398].
+    Sensor channels without a value are null; extra keys are only sent once they have one.
     """
+    values = {key: global_store.get(store_key) for key, store_key in SENSOR_KEYS}
+    for key, store_key in EXTRA_KEYS:
+        value = global_store.get(store_key)
+        if value is not None:
+            values[key] = value
     return {
         "ts": int(time.time() * 1000),  # CoreIoT expects ms [cite: 397]
-        "values": {
-            "co": global_store.get("co_level"),
-            "pm25": global_store.get("pm_2_5_level"),
-            "pm10": global_store.get("pm_10_level"),
-            "people_count": global_store.get("people_count"),
-            "wifi_status": global_store.get("wifi_status")
-        }
-    }
\ No newline at end of file
+        "values": values
+    }
+
+def encode_coreiot_telemetry(global_store, snapshot=None):
+    """
+    Compact JSON text of format_coreiot_telemetry(). With a snapshot reader the sensor part is
+    encoded natively from shared memory (same bytes as json.dumps), extras are appended to it.
+    """
+    if snapshot is not None:
+        payload = snapshot.telemetry()
+        if payload is not None:
+            text = payload.decode('ascii')
+            extras = ""
+            for key, store_key in EXTRA_KEYS:
+                value = global_store.get(store_key)
+                if value is not None:
+                    extras += f',"{key}":' + json.dumps(value, separators=(',', ':'))
+            # Extras go inside "values", after the sensor keys (the dict order of the Python path)
+            return text[:-2] + extras + "}}" if extras else text
+    return json.dumps(format_coreiot_telemetry(global_store), separators=(',', ':'))
@@ -12,22 +12,32 @@ class CoreIoTMQTTClient:
         # CoreIoT uses the Access Token as the username 
         if token:
             self.client.username_pw_set(token)
+        # The network thread keeps retrying after a failed connect or a dropped link
+        self.client.reconnect_delay_set(min_delay=1, max_delay=120)
 
     def connect(self):
         try:
-            self.client.connect(self.broker, self.port, keepalive=60)
+            self.client.connect_async(self.broker, self.port, keepalive=60)
             self.client.loop_start() # Start background thread for network traffic
             return True
         except Exception as e:
             log.error(f"CoreIoT Connection Failed: {e}")
             return False
 
+    def is_connected(self):
+        return self.client.is_connected()
+
     def publish_telemetry(self, payload):
-        """Publishes JSON data to the standard ThingsBoard telemetry topic."""
+        """
+        Publishes to the standard ThingsBoard telemetry topic.
+            @param payload: One {"ts", "values"} dict, a list of them, or an already serialised JSON string
+        """
         topic = "v1/devices/me/telemetry"
-        result = self.client.publish(topic, json.dumps(payload))
+        if not isinstance(payload, str):
+            payload = json.dumps(payload)
+        result = self.client.publish(topic, payload, qos=1)
         return result.rc == mqtt.MQTT_ERR_SUCCESS
 
     def disconnect(self):
         self.client.loop_stop()
-        self.client.disconnect()
\ No newline at end of file
+        self.client.disconnect()
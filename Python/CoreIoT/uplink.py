@@ -0,0 +1,200 @@
+import json
+import logging
+import os
+import time
+
+log = logging.getLogger(__name__)
+
+"""
+Batching store-and-forward uplink for telemetry.
+
+Samples ({"ts": ms, "values": {...}}, or that object already encoded as compact JSON text) are
+collected into one ThingsBoard telemetry array and published when the batch reaches max_samples,
+max_bytes or max_age_s. A batch that cannot be
+published goes to a bounded on-disk spool (one JSON line per batch, in numbered files); once the
+link is back the spool is drained oldest first, at most drain_rate batches per second, before
+any live batch. Delivery is at-least-once: a spool file interrupted mid-drain is replayed.
+"""
+
+SPOOL_FILE_BYTES = 64 * 1024    # Spool file size before starting the next one
+
+
+class TelemetryUplink:
+    def __init__(self, publish, is_connected, spool_dir, max_samples=30, max_age_s=30.0,
+                 max_bytes=16 * 1024, spool_max_bytes=4 * 1024 * 1024, drain_rate=2.0):
+        """
+            @param publish: Callable taking the JSON payload (str), returning True once accepted.
+            @param is_connected: Callable returning the link state.
+            @param spool_dir: Directory of the on-disk queue (created if missing).
+            @param max_samples, max_age_s, max_bytes: Flush thresholds of a batch.
+            @param spool_max_bytes: Spool bound; the oldest files are dropped beyond it.
+            @param drain_rate: Spooled batches published per second once connected.
+        """
+        self._publish = publish
+        self._is_connected = is_connected
+        self.max_samples = max_samples
+        self.max_age_s = max_age_s
+        self.max_bytes = max_bytes
+        self.spool_max_bytes = spool_max_bytes
+        self.drain_interval = 1.0 / drain_rate
+
+        self._batch = []                # Encoded samples
+        self._batch_bytes = 2           # "[]"
+        self._batch_started = None
+        self._next_drain = 0.0
+        self.stats = {"samples": 0, "published": 0, "spooled": 0, "drained": 0, "dropped_batches": 0}
+
+        self._spool_dir = spool_dir
+        os.makedirs(spool_dir, exist_ok=True)
+        self._spool_files = sorted(int(f[:-6]) for f in os.listdir(spool_dir)
+                                   if f.endswith(".spool") and f[:-6].isdigit())
+        self._spool_bytes = sum(os.path.getsize(self._spool_path(n)) for n in self._spool_files)
+        self._writer = None             # Newest spool file, open for append
+        self._reader = None             # Oldest spool file, being drained
+        if self._spool_files:
+            log.info(f"Telemetry spool holds {self._spool_bytes} bytes from a previous run")
+
+    # --- Batching ---
+    def add(self, sample, now=None):
+        """Queues one sample (dict, or its compact JSON text); publishes the batch when it is full."""
+        now = time.monotonic() if now is None else now
+        if not isinstance(sample, str):
+            sample = json.dumps(sample, separators=(',', ':'))
+        size = len(sample) + 1
+        if self._batch and self._batch_bytes + size > self.max_bytes:
+            self.flush()
+        if not self._batch:
+            self._batch_started = now
+        self._batch.append(sample)
+        self._batch_bytes += size
+        self.stats["samples"] += 1
+        if len(self._batch) >= self.max_samples or self._batch_bytes >= self.max_bytes:
+            self.flush()
+
+    def flush(self):
+        """Publishes (or spools) the pending batch."""
+        if not self._batch:
+            return
+        payload = self._payload()
+        self._batch = []
+        self._batch_bytes = 2
+        self._batch_started = None
+        # Spooled data goes first: publishing live data now would reorder the series
+        if not self._spool_files and self._send(payload):
+            self.stats["published"] += 1
+        else:
+            self._spool(payload)
+
+    def poll(self, now=None):
+        """Flushes an aged batch and drains the spool at the rate cap. Call it on every wakeup."""
+        now = time.monotonic() if now is None else now
+        if self._batch and now - self._batch_started >= self.max_age_s:
+            self.flush()
+        if self._spool_files and now >= self._next_drain:
+            if self._is_connected():
+                self._drain_one()
+            # Link down: look again one drain interval later instead of a zero wait timeout
+            self._next_drain = now + self.drain_interval
+
+    def timeout(self, now=None):
+        """Seconds until poll() has work to do (the caller's wait timeout)."""
+        now = time.monotonic() if now is None else now
+        deadlines = []
+        if self._batch:
+            deadlines.append(self._batch_started + self.max_age_s)
+        if self._spool_files:
+            deadlines.append(self._next_drain)
+        return max(0.0, min(deadlines) - now) if deadlines else None
+
+    def close(self):
+        """Spools whatever is pending (nothing is lost at shutdown) and closes the spool files."""
+        if self._batch:
+            payload = self._payload()
+            self._batch = []
+            self._spool(payload)
+        for f in (self._writer, self._reader):
+            if f is not None:
+                f[1].close()
+        self._writer = self._reader = None
+
+    def _payload(self):
+        # Same text as json.dumps(batch, separators=(',', ':')) of the sample objects
+        return "[" + ",".join(self._batch) + "]"
+
+    # --- Spool ---
+    def _spool_path(self, n):
+        return os.path.join(self._spool_dir, f"{n:08d}.spool")
+
+    def _send(self, payload):
+        try:
+            return self._is_connected() and self._publish(payload)
+        except Exception as e:
+            log.error(f"Telemetry publish failed: {e}")
+            return False
+
+    def _spool(self, payload):
+        line = (payload + "\n").encode('utf-8')
+        if self._writer is None or self._writer[1].tell() + len(line) > SPOOL_FILE_BYTES:
+            if self._writer is not None:
+                self._writer[1].close()
+            n = self._spool_files[-1] + 1 if self._spool_files else 0
+            self._spool_files.append(n)
+            self._writer = (n, open(self._spool_path(n), "ab"))
+        self._writer[1].write(line)
+        self._writer[1].flush()         # One write() per batch, no fsync: spare the SD card
+        self._spool_bytes += len(line)
+        self.stats["spooled"] += 1
+
+        # Bounded: drop the oldest files (never the one being written)
+        while self._spool_bytes > self.spool_max_bytes and len(self._spool_files) > 1:
+            oldest = self._spool_files[0]
+            if self._reader is not None and self._reader[0] == oldest:
+                self._reader[1].close()
+                self._reader = None
+            self._remove_oldest()
+            self.stats["dropped_batches"] += 1
+            log.warning("Telemetry spool full, oldest file dropped")
+
+    def _remove_oldest(self):
+        n = self._spool_files.pop(0)
+        path = self._spool_path(n)
+        try:
+            self._spool_bytes -= os.path.getsize(path)
+            os.remove(path)
+        except OSError:
+            pass
+        if self._writer is not None and self._writer[0] == n:
+            self._writer[1].close()
+            self._writer = None
+
+    def _drain_one(self):
+        if self._reader is None:
+            self._reader = (self._spool_files[0], open(self._spool_path(self._spool_files[0]), "rb"))
+        n, f = self._reader
+        pos = f.tell()
+        line = f.readline()
+        if line.endswith(b"\n"):
+            if not self._send(line[:-1].decode('utf-8')):
+                f.seek(pos)             # Retry the same batch next time
+                return
+            self.stats["drained"] += 1
+            return
+        f.seek(pos)                     # Partial line: still being written, or torn by a crash
+        if self._writer is not None and self._writer[0] == n:
+            if not line:
+                # Fully drained the file being written: close both and start a fresh one
+                f.close()
+                self._reader = None
+                self._remove_oldest()
+            return
+        f.close()
+        self._reader = None
+        self._remove_oldest()
+
+    @property
+    def spool_bytes(self):
+        return self._spool_bytes
+
+    @property
+    def pending(self):
+        return len(self._batch)
@@ -0,0 +1,124 @@
+import ctypes
+import os
+import time
+
+# --- Configuration and Initialization ---
+HISTORY_LIB_PATH = "/usr/lib/libhistory.so"
+HISTORY_ROOT = "/var/lib/lsmy/history"
+
+# Check if library exists
+if not os.path.exists(HISTORY_LIB_PATH):
+    raise FileNotFoundError("Required shared library (.so) is missing.")
+
+# Load the shared library
+lib_history = ctypes.CDLL(HISTORY_LIB_PATH)
+
+# --- Constants (must match history.h) ---
+HISTORY_MAX_CHANNELS = 64
+HISTORY_F_READONLY = 0x01
+
+HISTORY_E_ORDER = -4
+
+class HistoryConfig(ctypes.Structure):
+    _fields_ = [("block_ms", ctypes.c_uint32), ("segment_bytes", ctypes.c_uint32)]
+
+class HistoryPoint(ctypes.Structure):
+    _fields_ = [("timestamp_ms", ctypes.c_int64), ("value", ctypes.c_double)]
+
+class HistoryBucket(ctypes.Structure):
+    _fields_ = [("start_ms", ctypes.c_int64), ("count", ctypes.c_uint32), ("reserved", ctypes.c_uint32),
+                ("min", ctypes.c_double), ("max", ctypes.c_double), ("avg", ctypes.c_double)]
+
+class HistoryChannelStats(ctypes.Structure):
+    _fields_ = [("segments", ctypes.c_uint32), ("reserved", ctypes.c_uint32),
+                ("samples", ctypes.c_uint64), ("data_bytes", ctypes.c_uint64),
+                ("first_ms", ctypes.c_int64), ("last_ms", ctypes.c_int64)]
+
+# --- Define C Signatures ---
+lib_history.history_open.argtypes = [ctypes.c_char_p, ctypes.POINTER(HistoryConfig), ctypes.c_int, ctypes.POINTER(ctypes.c_int)]
+lib_history.history_open.restype = ctypes.c_void_p
+
+lib_history.history_append.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int64, ctypes.c_double]
+lib_history.history_append.restype = ctypes.c_int
+
+lib_history.history_query.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int64, ctypes.c_int64, ctypes.POINTER(HistoryPoint), ctypes.c_int]
+lib_history.history_query.restype = ctypes.c_int
+
+lib_history.history_query_buckets.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int64, ctypes.c_int64, ctypes.c_uint32, ctypes.POINTER(HistoryBucket), ctypes.c_int]
+lib_history.history_query_buckets.restype = ctypes.c_int
+
+lib_history.history_sync.argtypes = [ctypes.c_void_p]
+lib_history.history_sync.restype = ctypes.c_int
+
+lib_history.history_prune.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+lib_history.history_prune.restype = ctypes.c_int
+
+lib_history.history_channel_stats.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(HistoryChannelStats)]
+lib_history.history_channel_stats.restype = ctypes.c_int
+
+lib_history.history_close.argtypes = [ctypes.c_void_p]
+lib_history.history_close.restype = None
+
+# --- Exported Class ---
+class HistoryStore:
+    QUERY_CHUNK = 4096
+
+    def __init__(self, root=HISTORY_ROOT, writer=False):
+        """
+        Compressed on-device history, one series per channel (use the Snapshot channel numbers).
+            @param root: Directory holding the segment files
+            @param writer: True only in the process that owns the sensors (RS485 process)
+        """
+        err = ctypes.c_int(0)
+        flags = 0 if writer else HISTORY_F_READONLY
+        if writer:
+            os.makedirs(os.path.dirname(root.rstrip('/')) or '.', exist_ok=True)
+        self.__handle = lib_history.history_open(root.encode('utf-8'), None, flags, ctypes.byref(err))
+        if not self.__handle:
+            raise OSError(f"Unable to open history {root} (error {err.value})")
+        self.__points = (HistoryPoint * self.QUERY_CHUNK)()
+
+    def append(self, channel, value, timestamp_ms=None):
+        """Appends one sample. Returns False for an invalid channel or a timestamp not after the last one."""
+        if timestamp_ms is None:
+            timestamp_ms = int(time.time() * 1000)
+        return lib_history.history_append(self.__handle, channel, timestamp_ms, value) == 0
+
+    def query(self, channel, from_ms, to_ms):
+        """Returns [(timestamp_ms, value), ...] for [from_ms, to_ms]."""
+        out = []
+        while from_ms <= to_ms:
+            n = lib_history.history_query(self.__handle, channel, from_ms, to_ms, self.__points, self.QUERY_CHUNK)
+            if n <= 0:
+                break
+            out.extend((self.__points[i].timestamp_ms, self.__points[i].value) for i in range(n))
+            if n < self.QUERY_CHUNK:
+                break
+            from_ms = self.__points[n - 1].timestamp_ms + 1
+        return out
+
+    def buckets(self, channel, from_ms, to_ms, step_ms, max_buckets=1000):
+        """Returns [(start_ms, count, min, max, avg), ...], one entry per step_ms (count 0 = no data)."""
+        buf = (HistoryBucket * max_buckets)()
+        n = lib_history.history_query_buckets(self.__handle, channel, from_ms, to_ms, step_ms, buf, max_buckets)
+        return [(b.start_ms, b.count, b.min, b.max, b.avg) for b in buf[:max(n, 0)]]
+
+    def sync(self):
+        """Makes everything appended so far durable (one batched write per open segment)."""
+        return lib_history.history_sync(self.__handle) == 0
+
+    def prune(self, before_ms):
+        """Deletes the segments older than before_ms. Returns the number of files removed."""
+        return lib_history.history_prune(self.__handle, before_ms)
+
+    def stats(self, channel):
+        st = HistoryChannelStats()
+        if lib_history.history_channel_stats(self.__handle, channel, ctypes.byref(st)) != 0:
+            return None
+        return {"segments": st.segments, "samples": st.samples, "bytes": st.data_bytes,
+                "first_ms": st.first_ms, "last_ms": st.last_ms}
+
+    def close(self):
+        if self.__handle:
+            lib_history.history_close(self.__handle)
+            self.__handle = None
@@ -1,4 +1,5 @@
 from . import alert_wrapper 
+import threading
 import time
 from enum import Enum
 class AlertType(Enum):
@@ -23,6 +24,7 @@ class Alert:
         self.last_alert_time = None
         self.type_alert = type_alert
         self.triggered_status = False
+        self.rule_id = None  # Native evaluator rule, see register_alert()
 
 def check_and_trigger_alert (alert, value):
     """Checks if the alert condition is met and triggers the alert if necessary."""
@@ -33,30 +35,65 @@ def check_and_trigger_alert (alert, value):
            (alert.type_alert == AlertType.high_threshold and value > alert.threshold):
             alert.alert_count += 1
             if alert.alert_count >= alert.persistence:
-                # Trigger the alert
-                alert_wrapper.set_led(1)  # Turn on LED
-                # alert_wrapper.set_buzzer(1)  # Turn on buzzer (if implemented)
-                alert.last_alert_time = time.time()
-                alert.triggered_status = True
-                message = f"Alert '{alert.name}' triggered with value {value}, exceeded {alert.type_alert} of {alert.threshold}"
-                log_alert(alert, message) # Log the alert event
-                core_iot_send_alert(message) # Send alert to Core IoT connection module 
+                raise_alert(alert, value)
         else:
             # Reset alert count if condition is not met
             alert.alert_count = 0   
 
+def register_alert(alert, channel, outputs):
+    """
+    Hands the alert to the native evaluator: samples fed with alert_wrapper.feed()/feed_many() on
+    `channel` switch the outputs from C, and raised alerts are reported through alert_wrapper.wait_events().
+        @param outputs: Output indexes the alert drives (alert_wrapper.OUTPUT_LED / OUTPUT_BUZZER),
+                        initialised beforehand with alert_wrapper.init_outputs()
+    """
+    alert.rule_id = alert_wrapper.add_rule(channel, alert.type_alert.value, alert.threshold, alert.persistence, outputs)
+    if alert.rule_id < 0:
+        alert.rule_id = None
+        raise RuntimeError(f"Could not register native rule for alert '{alert.name}'")
+    return alert.rule_id
+
+def raise_alert(alert, value, drive_outputs=True):
+    """Records and reports a raised alert. drive_outputs=False when the native evaluator already switched the outputs."""
+    if drive_outputs:
+        alert_wrapper.set_led(1)  # Turn on LED
+        # alert_wrapper.set_buzzer(1)  # Turn on buzzer (if implemented)
+    alert.last_alert_time = time.time()
+    alert.triggered_status = True
+    message = f"Alert '{alert.name}' triggered with value {value}, exceeded {alert.type_alert} of {alert.threshold}"
+    log_alert(alert, message) # Log the alert event
+    core_iot_send_alert(message) # Send alert to Core IoT connection module 
+
 def turn_off_alert(alert):
     """Turns off the alert and resets its status."""
-    alert_wrapper.set_led(0)  # Turn off LED
+    if alert.rule_id is not None:
+        alert_wrapper.clear_rule(alert.rule_id)  # Releases the outputs unless another raised rule holds them
+    else:
+        alert_wrapper.set_led(0)  # Turn off LED
     # alert_wrapper.set_buzzer(0)  # Turn off buzzer (if implemented)
     alert.triggered_status = False
     alert.alert_count = 0
 
+# Alert log files stay open for the process lifetime (line buffered: one write per event, no reopen)
+_log_files = {}
+_log_lock = threading.Lock()
+
 def log_alert(alert, message):
     """Logs the alert event to the specified log file."""
-    with open(alert.log_file, 'a') as f:
+    with _log_lock:
+        f = _log_files.get(alert.log_file)
+        if f is None:
+            f = open(alert.log_file, 'a', buffering=1)
+            _log_files[alert.log_file] = f
         f.write(f"{time.ctime()}: {message}\n")
 
+def close_alert_logs():
+    """Closes the alert log files opened by log_alert()."""
+    with _log_lock:
+        for f in _log_files.values():
+            f.close()
+        _log_files.clear()
+
 def core_iot_send_alert(message):
     """Sends the alert message to the Core IoT connection module (placeholder function)."""
     # This function would contain logic to send the alert message to the Core IoT system.
@@ -11,6 +11,43 @@ if not os.path.exists(ALERT_LIB_PATH):
 # Load the shared library
 lib_alert = ctypes.CDLL(ALERT_LIB_PATH)
 
+# Compiled bindings (Components/PyNative) for the per-sample calls, when installed
+try:
+    import lsmy_native as native
+except ImportError:
+    native = None
+
+# Output indexes (order of the offsets given to init_alerts / init_outputs)
+OUTPUT_LED = 0
+OUTPUT_BUZZER = 1
+
+# Rule directions (same values as AlertType)
+EVAL_LOW = 1
+EVAL_HIGH = 2
+
+class AlertRule(ctypes.Structure):
+    """Mirror of alert_rule_t (alert_eval.h)."""
+    _fields_ = [
+        ("channel", ctypes.c_int),
+        ("type", ctypes.c_int),
+        ("threshold", ctypes.c_float),
+        ("hysteresis", ctypes.c_float),
+        ("persistence", ctypes.c_int),
+        ("latch", ctypes.c_int),
+        ("output_mask", ctypes.c_uint32),
+        ("on_ms", ctypes.c_uint),
+        ("off_ms", ctypes.c_uint),
+    ]
+
+class AlertEvalEvent(ctypes.Structure):
+    """Mirror of alert_eval_event_t (alert_eval.h)."""
+    _fields_ = [
+        ("rule", ctypes.c_int),
+        ("active", ctypes.c_int),
+        ("value", ctypes.c_float),
+        ("timestamp_ms", ctypes.c_uint64),
+    ]
+
 # --- Define C Signatures (Stateless Functional Logic) ---
 
 # Alert Init 
@@ -28,25 +65,78 @@ lib_alert.alert_get_led_state.restype = ctypes.c_int
 lib_alert.alert_set_buzzer.argtypes = [ctypes.c_int]
 lib_alert.alert_set_buzzer.restype = None
 
-# # Alert get buzzer status
-# lib_alert.alert_get_buzzer_state.argtypes = []
-# lib_alert.alert_get_buzzer_state.restype = ctypes.c_int
+# Alert get buzzer status
+lib_alert.alert_get_buzzer_state.argtypes = []
+lib_alert.alert_get_buzzer_state.restype = ctypes.c_int
+
+# Alert all on / off (single line update)
+lib_alert.alert_all_on.argtypes = []
+lib_alert.alert_all_on.restype = None
+lib_alert.alert_all_off.argtypes = []
+lib_alert.alert_all_off.restype = None
+
+# Multi-output line request
+lib_alert.alert_init_outputs.argtypes = [ctypes.POINTER(ctypes.c_uint), ctypes.c_int]
+lib_alert.alert_init_outputs.restype = ctypes.c_int
+lib_alert.alert_close.argtypes = []
+lib_alert.alert_close.restype = None
+lib_alert.alert_set_output.argtypes = [ctypes.c_int, ctypes.c_int]
+lib_alert.alert_set_output.restype = ctypes.c_int
+lib_alert.alert_set_outputs.argtypes = [ctypes.c_uint32, ctypes.c_uint32]
+lib_alert.alert_set_outputs.restype = ctypes.c_int
+lib_alert.alert_get_output.argtypes = [ctypes.c_int]
+lib_alert.alert_get_output.restype = ctypes.c_int
+
+# Pattern engine (runs in a C thread)
+lib_alert.alert_pattern_start.argtypes = [ctypes.c_int, ctypes.c_uint, ctypes.c_uint, ctypes.c_uint]
+lib_alert.alert_pattern_start.restype = ctypes.c_int
+lib_alert.alert_pattern_stop.argtypes = [ctypes.c_int]
+lib_alert.alert_pattern_stop.restype = ctypes.c_int
+lib_alert.alert_pattern_active.argtypes = [ctypes.c_int]
+lib_alert.alert_pattern_active.restype = ctypes.c_int
+
+# Native alert evaluator
+lib_alert.alert_eval_add_rule.argtypes = [ctypes.POINTER(AlertRule)]
+lib_alert.alert_eval_add_rule.restype = ctypes.c_int
+lib_alert.alert_eval_feed.argtypes = [ctypes.c_int, ctypes.c_float]
+lib_alert.alert_eval_feed.restype = ctypes.c_int
+lib_alert.alert_eval_feed_many.argtypes = [ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_float), ctypes.c_int]
+lib_alert.alert_eval_feed_many.restype = ctypes.c_int
+lib_alert.alert_eval_rule_active.argtypes = [ctypes.c_int]
+lib_alert.alert_eval_rule_active.restype = ctypes.c_int
+lib_alert.alert_eval_clear.argtypes = [ctypes.c_int]
+lib_alert.alert_eval_clear.restype = ctypes.c_int
+lib_alert.alert_eval_get_fd.argtypes = []
+lib_alert.alert_eval_get_fd.restype = ctypes.c_int
+lib_alert.alert_eval_wait_events.argtypes = [ctypes.POINTER(AlertEvalEvent), ctypes.c_int, ctypes.c_int]
+lib_alert.alert_eval_wait_events.restype = ctypes.c_int
 
 # --- Exported Functions ---
 def set_led(state):
     """Sets the alert LED state (0 for off, 1 for on)."""
+    if native is not None:
+        native.set_output(OUTPUT_LED, state)
+        return
     lib_alert.alert_set_led(state)
 
 def get_led_state():
     """Returns the current state of the alert LED (0 for off, 1 for on)."""
+    if native is not None:
+        return native.get_output(OUTPUT_LED)
     return lib_alert.alert_get_led_state()
 
 def set_buzzer(state):
     """Sets the alert buzzer state (0 for off, 1 for on)."""
+    if native is not None:
+        native.set_output(OUTPUT_BUZZER, state)
+        return
     lib_alert.alert_set_buzzer(state)
-# def get_buzzer_state():
-#     """Returns the current state of the alert buzzer (0 for off, 1 for on)."""
-#     return lib_alert.alert_get_buzzer_state()
+
+def get_buzzer_state():
+    """Returns the current state of the alert buzzer (0 for off, 1 for on)."""
+    if native is not None:
+        return native.get_output(OUTPUT_BUZZER)
+    return lib_alert.alert_get_buzzer_state()
 
 def setall():
     """Sets both LED and buzzer to the same state (0 for off, 1 for on)."""
@@ -58,4 +148,88 @@ def clearall():
 
 def init_alerts(led_state=0, buzzer_state=0):
     """Initializes the alert system with specified LED and buzzer states."""
-    lib_alert.alert_init(led_state, buzzer_state)   
\ No newline at end of file
+    lib_alert.alert_init(led_state, buzzer_state)   
+
+def init_outputs(offsets):
+    """Requests all output lines (BCM offsets) in one GPIO request. offsets[0] is the LED, offsets[1] the buzzer."""
+    arr = (ctypes.c_uint * len(offsets))(*offsets)
+    return lib_alert.alert_init_outputs(arr, len(offsets)) == 0
+
+def close_alerts():
+    """Stops patterns, drives every output low and releases the lines."""
+    lib_alert.alert_close()
+
+def set_output(index, state):
+    """Sets one output (cancels a pattern running on it)."""
+    if native is not None:
+        return native.set_output(index, state)
+    return lib_alert.alert_set_output(index, state) == 0
+
+def set_outputs(states):
+    """Updates several outputs in one line update. states: {output_index: 0/1}."""
+    mask = values = 0
+    for index, state in states.items():
+        mask |= 1 << index
+        if state:
+            values |= 1 << index
+    if native is not None:
+        return native.set_outputs(mask, values)
+    return lib_alert.alert_set_outputs(mask, values) == 0
+
+def get_output(index):
+    if native is not None:
+        return native.get_output(index)
+    return lib_alert.alert_get_output(index)
+
+def start_pattern(index, on_ms, off_ms, cycles=0):
+    """Blinks/beeps an output from the C pattern thread. cycles=0 repeats until stop_pattern()."""
+    return lib_alert.alert_pattern_start(index, on_ms, off_ms, cycles) == 0
+
+def stop_pattern(index):
+    """Stops the pattern and turns the output off."""
+    return lib_alert.alert_pattern_stop(index) == 0
+
+def pattern_active(index):
+    return lib_alert.alert_pattern_active(index) == 1
+
+def add_rule(channel, type_alert, threshold, persistence, outputs=(OUTPUT_LED,), hysteresis=0.0, latch=True, on_ms=0, off_ms=0):
+    """
+    Adds a native threshold rule. The C evaluator switches the outputs itself when the rule is raised.
+    Returns the rule id, or -1 on error.
+    """
+    mask = 0
+    for index in outputs:
+        mask |= 1 << index
+    rule = AlertRule(channel, type_alert, threshold, hysteresis, persistence, int(latch), mask, on_ms, off_ms)
+    return lib_alert.alert_eval_add_rule(ctypes.byref(rule))
+
+def feed(channel, value):
+    """Evaluates the rules of one channel. Returns the number of transitions."""
+    return lib_alert.alert_eval_feed(channel, value)
+
+def feed_many(channel_values):
+    """Evaluates several (channel, value) pairs in one call."""
+    if native is not None:
+        return native.feed_many(channel_values)
+    n = len(channel_values)
+    channels = (ctypes.c_int * n)(*[c for c, _ in channel_values])
+    values = (ctypes.c_float * n)(*[v for _, v in channel_values])
+    return lib_alert.alert_eval_feed_many(channels, values, n)
+
+def rule_active(rule):
+    return lib_alert.alert_eval_rule_active(rule) == 1
+
+def clear_rule(rule):
+    """Clears a (latched) rule and releases its outputs."""
+    return lib_alert.alert_eval_clear(rule) == 0
+
+def wait_events(timeout_ms=1000, max_events=16):
+    """
+    Waits (in C, without the GIL) for rule transitions.
+    Returns a list of (rule_id, active, value, timestamp_ms).
+    """
+    if native is not None:
+        return native.wait_events(timeout_ms, max_events)
+    buf = (AlertEvalEvent * max_events)()
+    count = lib_alert.alert_eval_wait_events(buf, max_events, timeout_ms)
+    return [(buf[i].rule, bool(buf[i].active), buf[i].value, buf[i].timestamp_ms) for i in range(max(count, 0))]
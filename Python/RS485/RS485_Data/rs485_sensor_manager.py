@@ -1,18 +1,14 @@
 from . import rs485_wrapper as RS485Wrapper
-from collections import deque
 
-## ------------ Register Addresses ------------##
-CO_CONCENTRATION_REGISTER_ADDRESS = 0x0006   # Register holding CO concentration data
-CO_SLAVEID_REGISTER_ADDRESS = 0x0100  # Register holding CO sensor slave ID (Use this for read or change slave ID)
-CO_BAUDRATE_REGISTER_ADDRESS = 0x0101  # Register holding CO sensor baudrate (Use this for read or change baudrate (must be changed to same with baudrate at manager))
-
-PM25_CONCENTRATION_REGISTER_ADDRESS = 0x0004  # Register holding PM2.5 concentration data
-PM10_CONCENTRATION_REGISTER_ADDRESS = 0x0009  # Register holding PM10 concentration data
-PM_SLAVEID_REGISTER_ADDRESS = 0x0100  # Register holding PM sensor slave ID (Use this for read or change slave ID)
-PM_BAUDRATE_REGISTER_ADDRESS = 0x0101  # Register holding PM sensor baudrate (Use this for read or change baudrate (must be changed to same with baudrate at manager))
+## ------------ Sensor models ------------##
+# Register layouts and unit conversions live in the C descriptor table (rs485_driver.h)
+PM_SENSOR_MODEL = "EPAM"    # PM2.5 / PM10
+CO_SENSOR_MODEL = "EPCO"    # CO
+NO2_SENSOR_MODEL = "EPNO2"  # NO2
 
 class SensorDevice:
-    def __init__(self, slave_id, num_value, register_data_address, register_config_address, name, unit=""):
+    def __init__(self, slave_id, num_value, register_data_address, register_config_address, name, unit="", window_size=5,
+                 conversions=None):
         """
         Base class for a Modbus sensor device. Handles raw data processing and integrity checks.
             @param slave_id: Modbus slave ID (address) for the sensor
@@ -21,87 +17,124 @@ class SensorDevice:
             @param register_config_address: Modbus register address for sensor configuration (Baudrate, ID address, etc.)
             @param name: Human-readable name for the sensor (e.g., "CO Sensor")
             @param unit: Unit of measurement for the sensor data (e.g., "ppm", "µg/m³")
+            @param window_size: Number of samples used by the moving average and the median filter
+            @param conversions: One (scale, offset) pair per value, physical = raw * scale + offset
         """
         self._slave_id = slave_id
         self._num_values = num_value
+        if isinstance(register_data_address, int):
+            register_data_address = [register_data_address]
         self.register_data_address = register_data_address
         self.register_config_address = register_config_address
 
         self._name = name
         self._unit = unit
+        self._conversions = conversions or [(1.0, 0.0)] * num_value
         
         # Private variables for data integrity
-        self.__window_size = 5
-        self.__history = deque (maxlen=self.__window_size)  # Store last N values for moving average
-        self.__filtered_history = deque (maxlen=self.__window_size)  # Store last N values for median filtering
-        self.__last_clean_value = 0.0  # Last value that passed integrity checks
+        self.__window_size = window_size
+        # One filter chain per value: moving average followed by a median over the averages (windows live in C)
+        self.__average_filters = [RS485Wrapper.StreamFilter(RS485Wrapper.FILTER_MOVING_AVERAGE, window_size) for _ in range(num_value)]
+        self.__median_filters = [RS485Wrapper.StreamFilter(RS485Wrapper.FILTER_MEDIAN, window_size) for _ in range(num_value)]
+        self.__last_clean_value = [0.0] * num_value  # Last value that passed integrity checks
         self.__calibration_offset = 0.0  # Sensor-specific offset for calibration
+        self.__read_plan = None  # Coalesced block reads, built on first use
+        self.pipeline = None  # Native raw-to-value pipeline, see create_pipeline()
     
     ##------------ Private Methods for Data Integrity and Processing ------------##
-    def _raw_to_physical(self, num_values, raw_value):
+    def _raw_to_physical(self, raw_value):
+        """
+            Converts raw register values (register order) to physical units. Can be overridden for specific sensors.
         """
-            Virtual method to convert raw sensor datas to physical units. Can be overridden for specific sensors.
+        return tuple(float(raw) * scale + offset for raw, (scale, offset) in zip(raw_value, self._linear_conversion()))
+
+    def _linear_conversion(self):
+        """
+            Returns one (scale, offset) pair per value, physical = raw * scale + offset.
+            Used by the native pipeline. Must match _raw_to_physical.
         """
+        return self._conversions
         
-    def _calculate_moving_average(self, new_value):
+    def _calculate_moving_average(self, new_value, channel=0):
         """Helper method to calculate moving average for smoothing."""
-        self.__history.append(new_value)
-        # Use moving average for smoothing
-        moving_average_value = RS485Wrapper.calculate_average(self.__history)
-        self.__filtered_history.append(moving_average_value)
+        return self.__average_filters[channel].push(new_value)
     
-    def _calculate_median(self) -> float: 
+    def _calculate_median(self, new_value, channel=0) -> float: 
         """Helper method to calculate median for outlier rejection."""
-        if len(self.__filtered_history) == 0:
-            return self.__last_clean_value
-        return RS485Wrapper.calculate_median(self.__filtered_history)
+        return self.__median_filters[channel].push(new_value)
     
     ##------------ Public Methods for Sensor Interaction ------------##
     def read_raw_value(self, ctx):
         """
         Virtual method to read raw values from the sensor. Can be overridden for specific sensors if needed.
+        All data registers are fetched with as few Modbus transactions as possible.
         """
-        raw_value = []
-        for i in range(self._num_values):
-            raw_value.append (RS485Wrapper.read_data(ctx, self._slave_id, self.register_data_address[i]))
-        return raw_value
+        if self.__read_plan is None:
+            refs = [(self._slave_id, self.register_data_address[i]) for i in range(self._num_values)]
+            self.__read_plan = RS485Wrapper.build_read_plan(refs)
+        return RS485Wrapper.read_plan(ctx, self.__read_plan)
     
-    def process_physical_value(self, physical_value):
+    def process_physical_value(self, physical_value, channel=0):
+        """
+        Calibrates and filters one value.
+            @param channel: Index of the value for multi-value sensors (e.g., 0 = PM2.5, 1 = PM10)
+        """
         if physical_value is None:
-            return self.__last_clean_value
+            return self.__last_clean_value[channel]
         # Apply calibration offset
         calibrated_value = physical_value + self.__calibration_offset
-        # Update moving average and median filtering
-        self._calculate_moving_average(calibrated_value)
-        # Use median filtering to reject outliers
-        median_value = self._calculate_median()
-        self.__last_clean_value = median_value
-        return self.__last_clean_value
+        # Update moving average, then use median filtering to reject outliers
+        moving_average_value = self._calculate_moving_average(calibrated_value, channel)
+        median_value = self._calculate_median(moving_average_value, channel)
+        self.__last_clean_value[channel] = median_value
+        return median_value
+
+    def create_pipeline(self):
+        """
+        Builds the native pipeline (conversion, calibration, average, median) for this sensor.
+        Alert thresholds are evaluated on its output by the native alert evaluator (register_alert()).
+        """
+        cfgs = []
+        for scale, offset in self._linear_conversion():
+            cfgs.append(RS485Wrapper.PipelineChannelCfg(
+                scale=scale, offset=offset, calibration=self.__calibration_offset,
+                avg_window=self.__window_size, median_window=self.__window_size))
+        self.pipeline = RS485Wrapper.SamplePipeline(cfgs)
+        return self.pipeline
 
     def set_calibration_offset(self, offset) -> None:
         self.__calibration_offset = offset
+        if self.pipeline is not None:
+            for channel in range(self._num_values):
+                self.pipeline.set_calibration(channel, offset)
     
     def get_calibration_offset(self) -> float:
         return self.__calibration_offset
 
-class PMSensor(SensorDevice):
-    def __init__(self, slave_id, name):
-        """PM sensor provides two values (PM2.5 and PM10), so we set num_value=2 and provide two register addresses."""
-        super().__init__(slave_id, num_value=2, register_data_address=[PM25_CONCENTRATION_REGISTER_ADDRESS, PM10_CONCENTRATION_REGISTER_ADDRESS], register_config_address = [PM_SLAVEID_REGISTER_ADDRESS, PM_BAUDRATE_REGISTER_ADDRESS], name= name, unit= ["µg/m³", "µg/m³"])
+class ModelSensor(SensorDevice):
+    """Sensor whose registers and conversions come from a built-in C driver descriptor."""
+    def __init__(self, slave_id, name, model):
+        desc = RS485Wrapper.sensor_model(model)
+        if desc is None:
+            raise ValueError(f"Unknown sensor model {model}")
+        self.model = model
+        super().__init__(slave_id, num_value=len(desc["registers"]), register_data_address=desc["registers"],
+                         register_config_address=desc["config_registers"], name=name,
+                         unit=desc["units"] if len(desc["units"]) > 1 else desc["units"][0],
+                         conversions=desc["conversions"])
 
-    def _raw_to_physical(self, raw_value):
-        # Example conversion for PM2.5 and PM10 sensors
-        raw_PM10, raw_PM2_5 = raw_value
-        return float(raw_PM2_5) * 0.1, float(raw_PM10) * 0.1  # Placeholder conversion factors
+class PMSensor(ModelSensor):
+    def __init__(self, slave_id, name):
+        """PM sensor provides two values (PM2.5 and PM10), read in one block."""
+        super().__init__(slave_id, name, PM_SENSOR_MODEL)
 
-class COSensor(SensorDevice):
+class COSensor(ModelSensor):
     def __init__(self, slave_id, name):
-        """CO sensor might have different conversion logic, so we override the base class."""
-        super().__init__(slave_id, num_value=1, register_data_address=CO_CONCENTRATION_REGISTER_ADDRESS, register_config_address = [CO_SLAVEID_REGISTER_ADDRESS, CO_BAUDRATE_REGISTER_ADDRESS], name= name, unit= "ppm")
+        super().__init__(slave_id, name, CO_SENSOR_MODEL)
 
-    def _raw_to_physical(self, raw_value):
-        """Override: CO sensor might have an offset or different scale"""
-        return (raw_value / 100.0) - 0.5   # Placeholder conversion factor
+class NO2Sensor(ModelSensor):
+    def __init__(self, slave_id, name):
+        super().__init__(slave_id, name, NO2_SENSOR_MODEL)
 
 class SensorManager:
     def __init__(self, device_path="/dev/ttyUSB0", baud=9600):
@@ -125,4 +158,91 @@ class SensorManager:
     def shutdown(self):
         if self.__ctx:
             RS485Wrapper.close_bus(self.__ctx)
-            self.__ctx = None
\ No newline at end of file
+            self.__ctx = None
+
+class SensorPoller:
+    def __init__(self, device_path="/dev/ttyUSB0", baud=9600):
+        """
+        Native polling engine: one C thread per serial port polls every sensor on its own period.
+            @param device_path: Serial port of the first RS485 adapter (bus 0)
+            @param baud: Baudrate of that bus
+        """
+        self.__registry = RS485Wrapper.bus_registry_create()
+        self.__sensors = {}  # sensor_id -> SensorDevice
+        self.baudrate = baud
+        if self.add_bus(device_path, baud) < 0:
+            raise RuntimeError(f"Unable to open RS485 bus {device_path}")
+
+    def add_bus(self, device_path, baud=9600, parity=b'N', data_bit=8, stop_bit=1):
+        """Opens another adapter. Must be called before start(). Returns the bus id, or -1."""
+        return RS485Wrapper.bus_add(self.__registry, device_path, baud, parity, data_bit, stop_bit)
+
+    def add_sensor(self, sensor, period_ms, bus=None):
+        """
+        Schedules all data registers of a SensorDevice every period_ms. Returns the sensor id.
+            @param bus: Bus id the sensor's slave is wired to (default: where it is already routed, else bus 0)
+        """
+        if bus is not None and not RS485Wrapper.bus_route_slave(self.__registry, sensor._slave_id, bus):
+            return -1
+        sensor_id = RS485Wrapper.bus_add_sensor(self.__registry, sensor._slave_id,
+                                                sensor.register_data_address[:sensor._num_values], period_ms)
+        if sensor_id >= 0:
+            self.__sensors[sensor_id] = sensor
+        return sensor_id
+
+    def set_period(self, sensor_id, period_ms):
+        return RS485Wrapper.bus_set_period(self.__registry, sensor_id, period_ms)
+
+    def discover(self, first_id=1, last_id=247, turnaround_us=0):
+        """
+        Finds the slaves of every bus (in parallel, seconds for the whole range) and routes them
+        to their bus. Also usable after start() to re-scan after a hot-plug (see RS485Wrapper.bus_discover).
+        """
+        return RS485Wrapper.bus_discover(self.__registry, first_id, last_id, turnaround_us)
+
+    def set_realtime(self, bus=0, priority=0, cpu=-1, lock_memory=True):
+        """
+        Opt-in real-time polling of one bus, before start(): absolute-deadline wakeups,
+        SCHED_FIFO priority, pinning to an isolated core and locked memory (see RS485Wrapper.poller_set_realtime).
+        """
+        return RS485Wrapper.poller_set_realtime(RS485Wrapper.bus_poller(self.__registry, bus), priority, cpu, lock_memory)
+
+    def start(self):
+        return RS485Wrapper.bus_start(self.__registry)
+
+    def wait_samples(self, timeout_ms=1000):
+        """Blocks (without holding the GIL) until samples of any bus arrive. Returns a list of (SensorDevice, Sample)."""
+        samples = RS485Wrapper.bus_get_samples(self.__registry, timeout_ms)
+        return [(self.__sensors[smp.sensor_id], smp) for smp in samples if smp.sensor_id in self.__sensors]
+
+    def negotiate_baud(self, bus, baud_reg, probe_reg, options):
+        """
+        Moves a bus to the fastest rate every sensor on it supports (rolled back on failure).
+            @param options: list of (baud, register_code) accepted by the devices
+        Returns the baud rate in use afterwards.
+        """
+        baud = RS485Wrapper.bus_negotiate_baud(self.__registry, bus, baud_reg, probe_reg, options)
+        if bus == 0 and baud > 0:
+            self.baudrate = baud
+        return baud
+
+    def dropped(self):
+        return RS485Wrapper.bus_dropped(self.__registry)
+
+    def stats(self):
+        """Per-bus and per-slave transaction counters and latency histograms (see RS485Wrapper.stats_snapshot)."""
+        return RS485Wrapper.stats_snapshot()
+
+    def health(self, sensor):
+        """Circuit-breaker state of a sensor's slave (see RS485Wrapper.bus_slave_health), None if unknown."""
+        return RS485Wrapper.bus_slave_health(self.__registry, sensor._slave_id)
+
+    def timing(self):
+        """Schedule accuracy of every bus: list of RS485Wrapper.poller_timing() dicts, indexed by bus id."""
+        return [RS485Wrapper.poller_timing(RS485Wrapper.bus_poller(self.__registry, bus))
+                for bus in range(RS485Wrapper.bus_count(self.__registry))]
+
+    def shutdown(self):
+        if self.__registry:
+            RS485Wrapper.bus_registry_destroy(self.__registry)
+            self.__registry = None
@@ -1,17 +1,161 @@
+import array
 import ctypes
 import os
 
 # --- Configuration and Initialization ---
 SENS_LIB_PATH = "/usr/lib/libair_485.so"
 DATA_HANDLE_PATH = "/usr/lib/libdatahandle.so"
+LOGGER_LIB_PATH = "/usr/lib/liblogger.so"
 
 # Check if libraries exist
-if not os.path.exists(SENS_LIB_PATH) or not os.path.exists(DATA_HANDLE_PATH):
+if not all(os.path.exists(p) for p in (SENS_LIB_PATH, DATA_HANDLE_PATH, LOGGER_LIB_PATH)):
     raise FileNotFoundError("One or more required shared libraries (.so) are missing.")
 
 # Load the shared libraries
 lib_air = ctypes.CDLL(SENS_LIB_PATH)
 lib_data_handle = ctypes.CDLL(DATA_HANDLE_PATH)
+lib_logger = ctypes.CDLL(LOGGER_LIB_PATH)  # Same instance the C components log through
+
+# Compiled bindings (Components/PyNative): no per-call marshalling, buffers filled in place.
+# When installed, init_bus() returns a native Bus and build_read_plan() a native ReadPlan.
+try:
+    import lsmy_native as native
+except ImportError:
+    native = None
+
+# --- Read plan structures (must match air_rs485.h) ---
+RS485_PLAN_MAX_REGS = 64
+RS485_PLAN_MAX_BLOCKS = 32
+RS485_PLAN_DEFAULT_GAP = 8
+
+class RegRef(ctypes.Structure):
+    _fields_ = [("slave_id", ctypes.c_uint8), ("reg_addr", ctypes.c_uint16)]
+
+class Block(ctypes.Structure):
+    _fields_ = [("slave_id", ctypes.c_uint8), ("start_addr", ctypes.c_uint16), ("count", ctypes.c_uint16)]
+
+class ReadPlan(ctypes.Structure):
+    _fields_ = [("blocks", Block * RS485_PLAN_MAX_BLOCKS),
+                ("n_blocks", ctypes.c_int),
+                ("ref_block", ctypes.c_uint8 * RS485_PLAN_MAX_REGS),
+                ("ref_offset", ctypes.c_uint8 * RS485_PLAN_MAX_REGS),
+                ("n_regs", ctypes.c_int)]
+
+# --- Typed sensor drivers (must match rs485_driver.h) ---
+RS485_DRIVER_MAX_VALUES = 4
+
+class ValueDesc(ctypes.Structure):
+    _fields_ = [("name", ctypes.c_char_p),
+                ("unit", ctypes.c_char_p),
+                ("reg_addr", ctypes.c_uint16),
+                ("scale", ctypes.c_float),
+                ("offset", ctypes.c_float)]
+
+class SensorDesc(ctypes.Structure):
+    _fields_ = [("model", ctypes.c_char_p),
+                ("block_start", ctypes.c_uint16),
+                ("block_count", ctypes.c_uint16),
+                ("addr_reg", ctypes.c_uint16),
+                ("baud_reg", ctypes.c_uint16),
+                ("n_values", ctypes.c_int),
+                ("values", ValueDesc * RS485_DRIVER_MAX_VALUES)]
+
+# --- Discovery (must match rs485_discovery.h) ---
+RS485_DISCOVERY_MAX_DEVICES = 64
+
+class Device(ctypes.Structure):
+    _fields_ = [("bus_id", ctypes.c_int),
+                ("slave_id", ctypes.c_uint8),
+                ("signature", ctypes.c_uint8),
+                ("addr_value", ctypes.c_uint16),
+                ("baud_code", ctypes.c_uint16),
+                ("candidates", ctypes.c_uint32),
+                ("model", ctypes.POINTER(SensorDesc)),
+                ("period_ms", ctypes.c_uint32),
+                ("sensor_id", ctypes.c_int)]
+
+class DeviceMap(ctypes.Structure):
+    _fields_ = [("n_devices", ctypes.c_int),
+                ("devices", Device * RS485_DISCOVERY_MAX_DEVICES)]
+
+# --- Poller structures (must match rs485_poller.h) ---
+RS485_POLL_MAX_REGS = 16
+
+class Sample(ctypes.Structure):
+    _fields_ = [("sensor_id", ctypes.c_int),
+                ("bus_id", ctypes.c_int),
+                ("slave_id", ctypes.c_uint8),
+                ("status", ctypes.c_int),
+                ("seq", ctypes.c_uint32),
+                ("timestamp_ms", ctypes.c_uint64),
+                ("duration_us", ctypes.c_uint32),
+                ("n_values", ctypes.c_int),
+                ("values", ctypes.c_uint16 * RS485_POLL_MAX_REGS),
+                ("valid", ctypes.c_uint8 * RS485_POLL_MAX_REGS)]
+
+class BaudOption(ctypes.Structure):
+    """Mirror of rs485_baud_option_t: baud rate and the device's register code for it."""
+    _fields_ = [("baud", ctypes.c_uint32),
+                ("code", ctypes.c_uint16)]
+
+# --- Transaction statistics (must match rs485_stats.h) ---
+RS485_STATS_MAX_SLAVES = 32
+RS485_STATS_SLAVE_IDS = 248
+RS485_STATS_HIST_BUCKETS = 20
+
+# --- Slave health (must match rs485_health.h) ---
+RS485_SLAVE_STATE_NAMES = ["healthy", "failing", "offline"]
+
+class SlaveHealth(ctypes.Structure):
+    _fields_ = [("state", ctypes.c_uint32),
+                ("consecutive_failures", ctypes.c_uint32),
+                ("probe_interval_ms", ctypes.c_uint32),
+                ("outages", ctypes.c_uint32),
+                ("next_probe_ns", ctypes.c_uint64),
+                ("offline_since_ns", ctypes.c_uint64),
+                ("skipped", ctypes.c_uint64),
+                ("probes", ctypes.c_uint64)]
+
+class RtConfig(ctypes.Structure):
+    """Mirror of rs485_rt_config_t."""
+    _fields_ = [("priority", ctypes.c_int),
+                ("cpu", ctypes.c_int),
+                ("lock_memory", ctypes.c_int)]
+
+class PollTiming(ctypes.Structure):
+    """Mirror of rs485_poll_timing_t."""
+    _fields_ = [("cycles", ctypes.c_uint64),
+                ("overruns", ctypes.c_uint64),
+                ("missed_slots", ctypes.c_uint64),
+                ("lateness_sum_us", ctypes.c_uint64),
+                ("lateness_max_us", ctypes.c_uint64),
+                ("lateness_hist", ctypes.c_uint64 * RS485_STATS_HIST_BUCKETS),
+                ("jitter_count", ctypes.c_uint64),
+                ("jitter_sum_us", ctypes.c_uint64),
+                ("jitter_max_us", ctypes.c_uint64),
+                ("cpu", ctypes.c_int32),
+                ("priority", ctypes.c_int32)]
+RS485_STATS_SHM_NAME_DEFAULT = "/lsmy_rs485_stats"
+RS485_RESULT_NAMES = ["ok", "timeout", "crc", "exception", "frame", "io"]
+
+class StatsCounters(ctypes.Structure):
+    _fields_ = [("requests", ctypes.c_uint64),
+                ("results", ctypes.c_uint64 * len(RS485_RESULT_NAMES)),
+                ("tx_bytes", ctypes.c_uint64),
+                ("rx_bytes", ctypes.c_uint64),
+                ("latency_sum_us", ctypes.c_uint64),
+                ("latency_max_us", ctypes.c_uint64),
+                ("latency_hist", ctypes.c_uint64 * RS485_STATS_HIST_BUCKETS)]
+
+class StatsBus(ctypes.Structure):
+    _fields_ = [("device", ctypes.c_char * 32),
+                ("total", StatsCounters),
+                ("n_slaves", ctypes.c_uint32),
+                ("reserved", ctypes.c_uint32),
+                ("untracked", ctypes.c_uint64),
+                ("slave_index", ctypes.c_uint8 * RS485_STATS_SLAVE_IDS),
+                ("slave_id", ctypes.c_uint8 * RS485_STATS_MAX_SLAVES),
+                ("slaves", StatsCounters * RS485_STATS_MAX_SLAVES)]
 
 # --- Define C Signatures (Stateless Functional Logic) ---
 
@@ -23,6 +167,135 @@ lib_air.rs485_init.restype = ctypes.c_void_p
 lib_air.rs485_read_raw.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.POINTER(ctypes.c_uint16)]
 lib_air.rs485_read_raw.restype = ctypes.c_int
 
+# RS485 read plan (coalesced block reads)
+lib_air.rs485_plan_build.argtypes = [ctypes.POINTER(ReadPlan), ctypes.POINTER(RegRef), ctypes.c_int, ctypes.c_int]
+lib_air.rs485_plan_build.restype = ctypes.c_int
+
+lib_air.rs485_plan_execute.argtypes = [ctypes.c_void_p, ctypes.POINTER(ReadPlan), ctypes.POINTER(ctypes.c_uint16), ctypes.POINTER(ctypes.c_uint8)]
+lib_air.rs485_plan_execute.restype = ctypes.c_int
+
+# RS485 typed sensor drivers
+lib_air.rs485_driver_find.argtypes = [ctypes.c_char_p]
+lib_air.rs485_driver_find.restype = ctypes.POINTER(SensorDesc)
+
+lib_air.rs485_driver_count.argtypes = []
+lib_air.rs485_driver_count.restype = ctypes.c_int
+
+lib_air.rs485_driver_get.argtypes = [ctypes.c_int]
+lib_air.rs485_driver_get.restype = ctypes.POINTER(SensorDesc)
+
+# RS485 bus discovery
+lib_air.rs485_bus_discover.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_uint32, ctypes.POINTER(DeviceMap)]
+lib_air.rs485_bus_discover.restype = ctypes.c_int
+
+# RS485 poller (native polling thread)
+lib_air.rs485_poller_create.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_char, ctypes.c_int, ctypes.c_int]
+lib_air.rs485_poller_create.restype = ctypes.c_void_p
+
+lib_air.rs485_poller_add_sensor.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(ctypes.c_uint16), ctypes.c_int, ctypes.c_uint32]
+lib_air.rs485_poller_add_sensor.restype = ctypes.c_int
+
+lib_air.rs485_poller_set_period.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_uint32]
+lib_air.rs485_poller_set_period.restype = ctypes.c_int
+
+lib_air.rs485_poller_start.argtypes = [ctypes.c_void_p]
+lib_air.rs485_poller_start.restype = ctypes.c_int
+
+lib_air.rs485_poller_stop.argtypes = [ctypes.c_void_p]
+lib_air.rs485_poller_stop.restype = None
+
+lib_air.rs485_poller_get_samples.argtypes = [ctypes.c_void_p, ctypes.POINTER(Sample), ctypes.c_int, ctypes.c_int]
+lib_air.rs485_poller_get_samples.restype = ctypes.c_int
+
+lib_air.rs485_poller_dropped.argtypes = [ctypes.c_void_p]
+lib_air.rs485_poller_dropped.restype = ctypes.c_uint64
+
+lib_air.rs485_poller_destroy.argtypes = [ctypes.c_void_p]
+lib_air.rs485_poller_destroy.restype = None
+
+lib_air.rs485_poller_set_realtime.argtypes = [ctypes.c_void_p, ctypes.POINTER(RtConfig)]
+lib_air.rs485_poller_set_realtime.restype = ctypes.c_int
+
+lib_air.rs485_poller_timing.argtypes = [ctypes.c_void_p, ctypes.POINTER(PollTiming)]
+lib_air.rs485_poller_timing.restype = ctypes.c_int
+
+lib_air.rs485_poller_timing_reset.argtypes = [ctypes.c_void_p]
+lib_air.rs485_poller_timing_reset.restype = None
+
+# RS485 bus registry (one poller thread per serial port)
+lib_air.rs485_bus_registry_create.argtypes = []
+lib_air.rs485_bus_registry_create.restype = ctypes.c_void_p
+
+lib_air.rs485_bus_add.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int, ctypes.c_char, ctypes.c_int, ctypes.c_int]
+lib_air.rs485_bus_add.restype = ctypes.c_int
+
+lib_air.rs485_bus_route_slave.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+lib_air.rs485_bus_route_slave.restype = ctypes.c_int
+
+lib_air.rs485_bus_add_sensor.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(ctypes.c_uint16), ctypes.c_int, ctypes.c_uint32]
+lib_air.rs485_bus_add_sensor.restype = ctypes.c_int
+
+lib_air.rs485_bus_set_period.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_uint32]
+lib_air.rs485_bus_set_period.restype = ctypes.c_int
+
+lib_air.rs485_bus_start.argtypes = [ctypes.c_void_p]
+lib_air.rs485_bus_start.restype = ctypes.c_int
+
+lib_air.rs485_bus_stop.argtypes = [ctypes.c_void_p]
+lib_air.rs485_bus_stop.restype = None
+
+lib_air.rs485_bus_get_samples.argtypes = [ctypes.c_void_p, ctypes.POINTER(Sample), ctypes.c_int, ctypes.c_int]
+lib_air.rs485_bus_get_samples.restype = ctypes.c_int
+
+lib_air.rs485_bus_dropped.argtypes = [ctypes.c_void_p]
+lib_air.rs485_bus_dropped.restype = ctypes.c_uint64
+
+lib_air.rs485_bus_negotiate_baud.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_uint16, ctypes.c_uint16, ctypes.POINTER(BaudOption), ctypes.c_int]
+lib_air.rs485_bus_negotiate_baud.restype = ctypes.c_int
+
+lib_air.rs485_bus_slave_health.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(SlaveHealth)]
+lib_air.rs485_bus_slave_health.restype = ctypes.c_int
+
+lib_air.rs485_poller_set_health.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32, ctypes.c_uint32]
+lib_air.rs485_poller_set_health.restype = None
+
+lib_air.rs485_bus_poller.argtypes = [ctypes.c_void_p, ctypes.c_int]
+lib_air.rs485_bus_poller.restype = ctypes.c_void_p
+
+lib_air.rs485_bus_count.argtypes = [ctypes.c_void_p]
+lib_air.rs485_bus_count.restype = ctypes.c_int
+
+lib_air.rs485_bus_registry_destroy.argtypes = [ctypes.c_void_p]
+lib_air.rs485_bus_registry_destroy.restype = None
+
+# RS485 transaction statistics
+lib_air.rs485_stats_bus_count.argtypes = []
+lib_air.rs485_stats_bus_count.restype = ctypes.c_int
+
+lib_air.rs485_stats_bus_snapshot.argtypes = [ctypes.c_int, ctypes.POINTER(StatsBus)]
+lib_air.rs485_stats_bus_snapshot.restype = ctypes.c_int
+
+lib_air.rs485_stats_reset.argtypes = []
+lib_air.rs485_stats_reset.restype = None
+
+lib_air.rs485_stats_export_shm.argtypes = [ctypes.c_char_p]
+lib_air.rs485_stats_export_shm.restype = ctypes.c_int
+
+# Native asynchronous logger (must match logger.h)
+LOGGER_ERROR = 0
+LOGGER_WARN = 1
+LOGGER_INFO = 2
+LOGGER_DEBUG = 3
+
+lib_logger.logger_init.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_uint32, ctypes.c_int]
+lib_logger.logger_init.restype = ctypes.c_int
+
+lib_logger.logger_shutdown.argtypes = []
+lib_logger.logger_shutdown.restype = None
+
+lib_logger.logger_dropped.argtypes = []
+lib_logger.logger_dropped.restype = ctypes.c_uint64
+
 # RS485 close
 lib_air.rs485_close.argtypes = [ctypes.c_void_p]
 lib_air.rs485_close.restype = None
@@ -34,10 +307,58 @@ lib_data_handle.calculate_median.restype = ctypes.c_float
 lib_data_handle.calculate_average.argtypes = [ctypes.POINTER(ctypes.c_float), ctypes.c_int]
 lib_data_handle.calculate_average.restype = ctypes.c_float
 
+# Stateful streaming filters from data_handle (window kept in C)
+FILTER_MOVING_AVERAGE = 0
+FILTER_MEDIAN = 1
+FILTER_EMA = 2
+FILTER_MIN = 3
+FILTER_MAX = 4
+
+lib_data_handle.filter_create.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_float]
+lib_data_handle.filter_create.restype = ctypes.c_void_p
+
+lib_data_handle.filter_push.argtypes = [ctypes.c_void_p, ctypes.c_float]
+lib_data_handle.filter_push.restype = ctypes.c_float
+
+lib_data_handle.filter_count.argtypes = [ctypes.c_void_p]
+lib_data_handle.filter_count.restype = ctypes.c_int
+
+lib_data_handle.filter_reset.argtypes = [ctypes.c_void_p]
+lib_data_handle.filter_reset.restype = None
+
+lib_data_handle.filter_destroy.argtypes = [ctypes.c_void_p]
+lib_data_handle.filter_destroy.restype = None
+
+# Fused raw-to-value pipeline from data_handle (thresholds are evaluated by alert_wrapper)
+class PipelineChannelCfg(ctypes.Structure):
+    _fields_ = [("scale", ctypes.c_float),
+                ("offset", ctypes.c_float),
+                ("calibration", ctypes.c_float),
+                ("avg_window", ctypes.c_int),
+                ("median_window", ctypes.c_int)]
+
+lib_data_handle.pipeline_create.argtypes = [ctypes.POINTER(PipelineChannelCfg), ctypes.c_int]
+lib_data_handle.pipeline_create.restype = ctypes.c_void_p
+
+lib_data_handle.pipeline_process.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint16), ctypes.POINTER(ctypes.c_uint8),
+                                             ctypes.POINTER(ctypes.c_float)]
+lib_data_handle.pipeline_process.restype = ctypes.c_int
+
+lib_data_handle.pipeline_set_calibration.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_float]
+lib_data_handle.pipeline_set_calibration.restype = ctypes.c_int
+
+lib_data_handle.pipeline_destroy.argtypes = [ctypes.c_void_p]
+lib_data_handle.pipeline_destroy.restype = None
+
 # --- Exported Functions ---
 
 def init_bus(device="/dev/ttyS0", baud=9600):
     """Initializes the RS485 bus via C library."""
+    if native is not None:
+        try:
+            return native.Bus(device, baud)
+        except OSError:
+            return None
     device_bytes = device.encode('utf-8')
     ctx = lib_air.rs485_init(device_bytes, baud, b'N', 8, 1)
     return ctx
@@ -46,19 +367,299 @@ def read_data(ctx, slave_id, address):
     """Reads raw data from a Modbus slave."""
     if not ctx:
         return None
+    if native is not None:
+        return ctx.read(slave_id, address)
     raw_val = ctypes.c_uint16(0)
     result = lib_air.rs485_read_raw(ctx, slave_id, address, ctypes.byref(raw_val))
     return raw_val.value if result == 0 else None
 
+def build_read_plan(refs, max_gap=RS485_PLAN_DEFAULT_GAP):
+    """Merges a list of (slave_id, register) pairs into contiguous block reads. Returns None on failure."""
+    size = len(refs)
+    if size <= 0 or size > RS485_PLAN_MAX_REGS: return None
+    if native is not None:
+        try:
+            return native.ReadPlan(refs, max_gap)
+        except ValueError:
+            return None
+    c_refs = (RegRef * size)(*[RegRef(slave, reg) for slave, reg in refs])
+    plan = ReadPlan()
+    if lib_air.rs485_plan_build(ctypes.byref(plan), c_refs, size, max_gap) < 0:
+        return None
+    return plan
+
+def read_plan(ctx, plan):
+    """Executes a read plan. Returns a list in request order, None for registers that failed."""
+    if not ctx or plan is None:
+        return None
+    if native is not None:
+        values = array.array('H', bytes(2 * plan.n_regs))
+        valid = bytearray(plan.n_regs)
+        ctx.execute(plan, values, valid)
+        return [values[i] if valid[i] else None for i in range(plan.n_regs)]
+    values = (ctypes.c_uint16 * plan.n_regs)()
+    valid = (ctypes.c_uint8 * plan.n_regs)()
+    lib_air.rs485_plan_execute(ctx, ctypes.byref(plan), values, valid)
+    return [values[i] if valid[i] else None for i in range(plan.n_regs)]
+
+def read_plan_into(ctx, plan, values, valid=None):
+    """
+    Executes a read plan into caller buffers (no Python objects per register):
+    values is a writable uint16 buffer (e.g. array('H')) and valid a bytearray, plan.n_regs long.
+    Returns True if every block was read. Needs the compiled bindings.
+    """
+    if native is None:
+        raise RuntimeError("lsmy_native is not installed")
+    return ctx.execute(plan, values, valid)
+
+def batch_median(block, channels, window, out=None):
+    """Median of every channel of a float32 block laid out block[w * channels + k] (see batch.h)."""
+    if native is None:
+        raise RuntimeError("lsmy_native is not installed")
+    return native.batch_median(block, channels, window, out=out)
+
+def batch_average(block, channels, window, out=None):
+    """Mean of every channel of a float32 block laid out block[w * channels + k] (see batch.h)."""
+    if native is None:
+        raise RuntimeError("lsmy_native is not installed")
+    return native.batch_average(block, channels, window, out=out)
+
+def sensor_model(model):
+    """
+    Register layout and conversions of a built-in sensor model (e.g. "EPAM"), from the C descriptor table.
+    Returns {"names", "units", "registers", "conversions": [(scale, offset)], "config_registers"}, or None.
+    """
+    desc = lib_air.rs485_driver_find(model.encode('utf-8'))
+    if not desc:
+        return None
+    d = desc.contents
+    values = d.values[:d.n_values]
+    return {"names": [v.name.decode('utf-8') for v in values],
+            "units": [v.unit.decode('utf-8') for v in values],
+            "registers": [v.reg_addr for v in values],
+            "conversions": [(v.scale, v.offset) for v in values],
+            "config_registers": [d.addr_reg, d.baud_reg]}
+
+def poller_create(device="/dev/ttyUSB0", baud=9600):
+    """Creates a native poller that owns the bus. Returns None on failure."""
+    return lib_air.rs485_poller_create(device.encode('utf-8'), baud, b'N', 8, 1)
+
+def poller_add_sensor(poller, slave_id, registers, period_ms):
+    """Schedules a sensor's data registers every period_ms. Returns the sensor id, or -1."""
+    size = len(registers)
+    c_regs = (ctypes.c_uint16 * size)(*registers)
+    return lib_air.rs485_poller_add_sensor(poller, slave_id, c_regs, size, period_ms)
+
+def poller_set_period(poller, sensor_id, period_ms):
+    return lib_air.rs485_poller_set_period(poller, sensor_id, period_ms) == 0
+
+def poller_start(poller):
+    return lib_air.rs485_poller_start(poller) == 0
+
+def poller_get_samples(poller, timeout_ms=1000, max_samples=32):
+    """
+    Waits up to timeout_ms for finished samples (the wait happens in C).
+    Returns a list of Sample structures (use sample_values() for a Python list).
+    """
+    buf = (Sample * max_samples)()
+    count = lib_air.rs485_poller_get_samples(poller, buf, max_samples, timeout_ms)
+    return [buf[i] for i in range(max(count, 0))]
+
+def sample_values(sample):
+    """Raw register values of a Sample, None for registers that failed."""
+    return [sample.values[j] if sample.valid[j] else None for j in range(sample.n_values)]
+
+def poller_dropped(poller):
+    return lib_air.rs485_poller_dropped(poller)
+
+def poller_set_realtime(poller, priority=0, cpu=-1, lock_memory=True):
+    """
+    Real-time mode for a poller that is not running yet: absolute timerfd deadlines,
+    SCHED_FIFO priority (0 keeps the default scheduler), pinning to cpu (-1 for any core)
+    and mlockall(). Settings the system refuses are logged and skipped.
+    """
+    cfg = RtConfig(priority, cpu, 1 if lock_memory else 0)
+    return lib_air.rs485_poller_set_realtime(poller, ctypes.byref(cfg)) == 0
+
+def poller_timing(poller):
+    """Schedule accuracy of a poller: lateness of each poll after its deadline, period jitter and overruns (us)."""
+    t = PollTiming()
+    if not poller or lib_air.rs485_poller_timing(poller, ctypes.byref(t)) != 0:
+        return None
+    return {"cycles": t.cycles,
+            "overruns": t.overruns,
+            "missed_slots": t.missed_slots,
+            "lateness_avg_us": t.lateness_sum_us / t.cycles if t.cycles else 0.0,
+            "lateness_max_us": t.lateness_max_us,
+            "lateness_hist": list(t.lateness_hist),
+            "jitter_avg_us": t.jitter_sum_us / t.jitter_count if t.jitter_count else 0.0,
+            "jitter_max_us": t.jitter_max_us,
+            "cpu": t.cpu,
+            "priority": t.priority}
+
+def poller_timing_reset(poller):
+    if poller:
+        lib_air.rs485_poller_timing_reset(poller)
+
+def poller_destroy(poller):
+    """Stops the polling thread and closes the bus."""
+    if poller:
+        lib_air.rs485_poller_destroy(poller)
+
+def bus_registry_create():
+    """Creates an empty bus registry. Returns None on failure."""
+    return lib_air.rs485_bus_registry_create()
+
+def bus_add(registry, device="/dev/ttyUSB0", baud=9600, parity=b'N', data_bit=8, stop_bit=1):
+    """Opens a serial port in the registry. Returns the bus id, or -1."""
+    return lib_air.rs485_bus_add(registry, device.encode('utf-8'), baud, parity, data_bit, stop_bit)
+
+def bus_route_slave(registry, slave_id, bus_id):
+    return lib_air.rs485_bus_route_slave(registry, slave_id, bus_id) == 0
+
+def bus_add_sensor(registry, slave_id, registers, period_ms):
+    """Schedules a sensor on the bus of its slave. Returns the global sensor id, or -1."""
+    size = len(registers)
+    c_regs = (ctypes.c_uint16 * size)(*registers)
+    return lib_air.rs485_bus_add_sensor(registry, slave_id, c_regs, size, period_ms)
+
+def bus_set_period(registry, sensor_id, period_ms):
+    return lib_air.rs485_bus_set_period(registry, sensor_id, period_ms) == 0
+
+def bus_start(registry):
+    return lib_air.rs485_bus_start(registry) == 0
+
+def bus_get_samples(registry, timeout_ms=1000, max_samples=32):
+    """Waits up to timeout_ms (in C) for samples of any bus. Returns a list of Sample structures."""
+    buf = (Sample * max_samples)()
+    count = lib_air.rs485_bus_get_samples(registry, buf, max_samples, timeout_ms)
+    return [buf[i] for i in range(max(count, 0))]
+
+def bus_dropped(registry):
+    return lib_air.rs485_bus_dropped(registry)
+
+def bus_negotiate_baud(registry, bus_id, baud_reg, probe_reg, options):
+    """
+    Moves every slave of a bus (and the port) to the highest baud rate they all support.
+    options: list of (baud, register_code). Returns the baud rate in use, or -1 if the port was lost.
+    """
+    c_opts = (BaudOption * len(options))(*[BaudOption(b, c) for b, c in options])
+    return lib_air.rs485_bus_negotiate_baud(registry, bus_id, baud_reg, probe_reg, c_opts, len(options))
+
+def bus_slave_health(registry, slave_id):
+    """
+    Circuit-breaker state of a slave: "healthy", "failing" (still polled) or "offline"
+    (polls skipped, probed every probe_interval_ms). Returns None if the slave has no bus.
+    """
+    h = SlaveHealth()
+    if lib_air.rs485_bus_slave_health(registry, slave_id, ctypes.byref(h)) != 0:
+        return None
+    return {"state": RS485_SLAVE_STATE_NAMES[h.state] if h.state < len(RS485_SLAVE_STATE_NAMES) else "unknown",
+            "consecutive_failures": h.consecutive_failures,
+            "probe_interval_ms": h.probe_interval_ms,
+            "outages": h.outages,
+            "skipped": h.skipped,
+            "probes": h.probes}
+
+def poller_set_health(poller, fail_threshold=0, probe_min_ms=0, probe_max_ms=0):
+    """Tunes the dead-slave circuit breaker of a poller (0 keeps the default of a setting)."""
+    if poller:
+        lib_air.rs485_poller_set_health(poller, fail_threshold, probe_min_ms, probe_max_ms)
+
+def bus_discover(registry, first_id=1, last_id=247, turnaround_us=0):
+    """
+    Scans an address range on every bus of the registry in parallel (before or after bus_start)
+    and routes each responder to its bus. turnaround_us is the answer budget of the quick pass
+    (0 for the C default). Returns a list of {"bus", "slave_id", "signature", "addr_value",
+    "baud_code", "candidates": [model names], "model": name or None}.
+    """
+    dmap = DeviceMap()
+    count = lib_air.rs485_bus_discover(registry, first_id, last_id, turnaround_us, ctypes.byref(dmap))
+    models = [lib_air.rs485_driver_get(i).contents.model.decode('utf-8') for i in range(lib_air.rs485_driver_count())]
+    devices = []
+    for d in dmap.devices[:max(count, 0)]:
+        devices.append({"bus": d.bus_id,
+                        "slave_id": d.slave_id,
+                        "signature": bool(d.signature),
+                        "addr_value": d.addr_value,
+                        "baud_code": d.baud_code,
+                        "candidates": [name for i, name in enumerate(models) if d.candidates & (1 << i)],
+                        "model": d.model.contents.model.decode('utf-8') if d.model else None})
+    return devices
+
+def bus_poller(registry, bus_id):
+    """Poller of one bus of the registry (for the poller_* functions), None for an invalid id."""
+    return lib_air.rs485_bus_poller(registry, bus_id)
+
+def bus_count(registry):
+    return lib_air.rs485_bus_count(registry)
+
+def bus_registry_destroy(registry):
+    """Stops every bus thread and closes the ports."""
+    if registry:
+        lib_air.rs485_bus_registry_destroy(registry)
+
+def _counters_dict(c):
+    hist = list(c.latency_hist)
+    return {"requests": c.requests,
+            **{name: c.results[i] for i, name in enumerate(RS485_RESULT_NAMES)},
+            "tx_bytes": c.tx_bytes,
+            "rx_bytes": c.rx_bytes,
+            "latency_avg_us": c.latency_sum_us / c.requests if c.requests else 0.0,
+            "latency_max_us": c.latency_max_us,
+            "latency_hist": hist}
+
+def stats_snapshot():
+    """
+    Counters of every bus seen by this process:
+    [{"device", "total": {...}, "slaves": {slave_id: {...}}, "untracked"}, ...]
+    latency_hist[k] counts transactions in [2^k, 2^(k+1)) us (k = 0 also holds < 1 us).
+    """
+    buses = []
+    snap = StatsBus()
+    for bus in range(lib_air.rs485_stats_bus_count()):
+        if lib_air.rs485_stats_bus_snapshot(bus, ctypes.byref(snap)) != 0:
+            continue
+        buses.append({"device": snap.device.decode('utf-8', 'replace'),
+                      "total": _counters_dict(snap.total),
+                      "slaves": {snap.slave_id[i]: _counters_dict(snap.slaves[i]) for i in range(snap.n_slaves)},
+                      "untracked": snap.untracked})
+    return buses
+
+def stats_reset():
+    lib_air.rs485_stats_reset()
+
+def stats_export_shm(name=RS485_STATS_SHM_NAME_DEFAULT):
+    """Moves the counters into shared memory for external scrapers. Call before starting the buses."""
+    return lib_air.rs485_stats_export_shm(name.encode('utf-8')) == 0
+
+def native_log_start(path, level=LOGGER_INFO, max_bytes=4 * 1024 * 1024):
+    """
+    Starts the drain thread of the C components' logger: their messages go to `path` as binary
+    records (render them with logger_decode) instead of blocking the bus threads on stderr.
+    """
+    return lib_logger.logger_init(path.encode('utf-8'), level, max_bytes, 0) == 0
+
+def native_log_stop():
+    """Writes the pending records and stops the drain thread. Returns the number of dropped records."""
+    dropped = lib_logger.logger_dropped()
+    lib_logger.logger_shutdown()
+    return dropped
+
 def close_bus(ctx):
     """Closes the Modbus context."""
     if ctx:
+        if native is not None:
+            ctx.close()
+            return
         lib_air.rs485_close(ctx)
 
 def calculate_median(values):
     """Calculates median using the O(n log n) C library implementation."""
     size = len(values)
     if size <= 0: return 0.0
+    if native is not None:
+        return native.median(values)    # No copy for an array('f'), never sorts the caller's data
     c_array = (ctypes.c_float * size)(*values)
     return lib_data_handle.calculate_median(c_array, size)
 
@@ -66,5 +667,55 @@ def calculate_average(values):
     """Calculates moving average via C library."""
     size = len(values)
     if size <= 0: return 0.0
+    if native is not None:
+        return native.average(values)
     c_array = (ctypes.c_float * size)(*values)
-    return lib_data_handle.calculate_average(c_array, size)
\ No newline at end of file
+    return lib_data_handle.calculate_average(c_array, size)
+
+class StreamFilter:
+    """Stateful C filter: push(value) returns the filtered value in O(1) / O(log window)."""
+    def __init__(self, filter_type, window=5, alpha=0.0):
+        self.__handle = lib_data_handle.filter_create(filter_type, window, alpha)
+        if not self.__handle:
+            raise ValueError(f"Invalid filter configuration (type={filter_type}, window={window}, alpha={alpha})")
+
+    def push(self, value):
+        return lib_data_handle.filter_push(self.__handle, value)
+
+    def __len__(self):
+        return lib_data_handle.filter_count(self.__handle)
+
+    def reset(self):
+        lib_data_handle.filter_reset(self.__handle)
+
+    def __del__(self):
+        if getattr(self, "_StreamFilter__handle", None):
+            lib_data_handle.filter_destroy(self.__handle)
+            self.__handle = None
+
+
+class SamplePipeline:
+    """One native call per poll cycle: scale/offset, calibration, average and median for every channel."""
+    def __init__(self, channel_cfgs):
+        self.__size = len(channel_cfgs)
+        cfgs = (PipelineChannelCfg * self.__size)(*channel_cfgs)
+        self.__handle = lib_data_handle.pipeline_create(cfgs, self.__size)
+        if not self.__handle:
+            raise ValueError("Invalid pipeline configuration")
+        self.__out = (ctypes.c_float * self.__size)()
+
+    def process(self, sample):
+        """
+        Feeds the raw registers of a poller Sample (no conversion to Python lists on the way in).
+        Returns the filtered values.
+        """
+        lib_data_handle.pipeline_process(self.__handle, sample.values, sample.valid, self.__out)
+        return list(self.__out)
+
+    def set_calibration(self, channel, offset):
+        return lib_data_handle.pipeline_set_calibration(self.__handle, channel, offset) == 0
+
+    def __del__(self):
+        if getattr(self, "_SamplePipeline__handle", None):
+            lib_data_handle.pipeline_destroy(self.__handle)
+            self.__handle = None
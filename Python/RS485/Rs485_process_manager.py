@@ -1,12 +1,27 @@
 import threading
 import time
 import logging
-import random  # For simulating sensor data in testing
-from .RS485_Data.rs485_sensor_manager import SensorManager, COSensor, PMSensor
-from .RS485_Alert.alert_manager import Alert, AlertType, check_and_trigger_alert, turn_off_alert
+from .RS485_Data.rs485_sensor_manager import SensorPoller, COSensor, PMSensor, CO_SENSOR_MODEL, PM_SENSOR_MODEL
+from .RS485_Data import rs485_wrapper as RS485Wrapper
+from Snapshot.snapshot_wrapper import SnapshotStore, KEY_TO_CHANNEL, SNAPSHOT_Q_SENSOR_ERROR, SNAPSHOT_Q_ALERT
+from History.history_wrapper import HistoryStore
+from Rollup.rollup_wrapper import RollupStore
+from .RS485_Alert import alert_wrapper
+from .RS485_Alert.alert_manager import Alert, AlertType, register_alert, raise_alert, turn_off_alert, close_alert_logs
 
-CO_SLAVE_ID_ADDRESS = 0x01  # Slave ID address for CO sensor
+CO_SLAVE_ID_ADDRESS = 0x01  # Slave ID address for CO sensor (used unless discovery finds it elsewhere)
 PM_SLAVE_ID_ADDRESS = 0x24  # Slave ID address for PM sensor
+DISCOVERY_ENABLED = True    # Scan the bus at start-up: a sensor with a changed address is still found
+CO_POLL_PERIOD_MS = 500     # CO is safety critical, poll it fast
+PM_POLL_PERIOD_MS = 5000    # PM changes slowly
+NATIVE_LOG_PATH = "/var/log/lsmy_components.lg"  # Binary, read with logger_decode
+HISTORY_SYNC_S = 600        # Durable checkpoint of the history (the kernel flushes dirty pages meanwhile)
+HISTORY_RETENTION_DAYS = 28
+POLL_RT_ENABLED = False     # Real-time polling: evenly spaced samples even with a loaded CPU
+POLL_RT_CPU = 3             # Core kept free for the poller (isolcpus=3 on the Pi 4 command line), -1 for any
+POLL_RT_PRIORITY = 50       # SCHED_FIFO priority (needs CAP_SYS_NICE), 0 keeps the default scheduler
+ALERT_LED_PIN = 17          # BCM offset on gpiochip0 (output index alert_wrapper.OUTPUT_LED)
+ALERT_BUZZER_PIN = 27       # BCM offset on gpiochip0 (output index alert_wrapper.OUTPUT_BUZZER)
 """
 This module defines the RS485ProcessManager class, which manages the RS485 sensor polling, data processing, and alerting logic. It runs as a separate process and contains internal threads for continuous sensor monitoring. The manager interacts with the SensorManager to read sensor data, applies filtering and calibration, updates a global store for inter-process communication, and checks alert conditions to trigger notifications. It also ensures clean shutdown of hardware resources and alerts when the process is terminated.
 """
@@ -19,13 +34,37 @@ class RS485ProcessManager:
         self._ready_event = ready_signal
         self.global_store = global_store
         self.rs485_data_ready_cv = rs485_data_ready_cv
+        # Lock-free shared-memory copy of the latest values for other processes
+        self.snapshot = SnapshotStore(writer=True)
+        # Compressed on-device history of every value, survives restarts and uplink outages
+        self.history = HistoryStore(writer=True)
+        self._history_synced = time.monotonic()
+        self._history_rejected = 0  # Appends refused since the last sync (clock set back, or disk errors)
+        # 1 s / 1 min / 1 h rollups: dashboard windows without scanning the history
+        self.rollups = RollupStore(writer=True)
+        self._offline = set()       # Sensors whose slave the poller has taken offline
 
-        # Initialize Hardware Managers
-        self.sensors = SensorManager(device_path="/dev/ttyUSB0", baud=9600)
+        # C components log through a background thread; nothing blocks the bus on a slow disk
+        if not RS485Wrapper.native_log_start(NATIVE_LOG_PATH):
+            log.warning(f"Native log file {NATIVE_LOG_PATH} unavailable, C components log to stderr")
+
+        # Bus counters go to shared memory so external scrapers can read them
+        if not RS485Wrapper.stats_export_shm():
+            log.warning("RS485 statistics not exported to shared memory")
+
+        # Initialize Hardware Managers (the native poller owns the bus)
+        self.sensors = SensorPoller(device_path="/dev/ttyUSB0", baud=9600)
         
-        # Define specific sensors
-        self.co_sensor = COSensor(slave_id=CO_SLAVE_ID_ADDRESS, name="CO_Sensor")
-        self.pm_sensor = PMSensor(slave_id=PM_SLAVE_ID_ADDRESS, name="PM_Sensor")
+        # Define specific sensors, at the address they were found at
+        devices = self.sensors.discover() if DISCOVERY_ENABLED else []
+        for dev in devices:
+            log.info(f"Bus {dev['bus']}: slave 0x{dev['slave_id']:02X} model {dev['model'] or '/'.join(dev['candidates']) or 'unknown'}")
+        self.co_sensor = COSensor(slave_id=self._slave_id(devices, CO_SENSOR_MODEL, CO_SLAVE_ID_ADDRESS), name="CO_Sensor")
+        self.pm_sensor = PMSensor(slave_id=self._slave_id(devices, PM_SENSOR_MODEL, PM_SLAVE_ID_ADDRESS), name="PM_Sensor")
+        self.sensors.add_sensor(self.co_sensor, CO_POLL_PERIOD_MS)
+        self.sensors.add_sensor(self.pm_sensor, PM_POLL_PERIOD_MS)
+        if POLL_RT_ENABLED and not self.sensors.set_realtime(0, POLL_RT_PRIORITY, POLL_RT_CPU):
+            log.warning("Real-time polling unavailable, using the default scheduling")
         
         # Define Alerts
         self.co_alert = Alert("High CO", threshold=50.0, persistence=3, 
@@ -37,78 +76,157 @@ class RS485ProcessManager:
         self.pm_10_alert = Alert("High PM10", threshold=50.0, persistence=3, 
                                   log_file="/var/log/alerts.log", type_alert=AlertType.high_threshold)
 
+        # Conversion and filtering run natively, one call per sample
+        self.co_sensor.create_pipeline()
+        self.pm_sensor.create_pipeline()
+        self.store_keys = {self.co_sensor: ["co_level"], self.pm_sensor: ["pm_2_5_level", "pm_10_level"]}
+
+        # Thresholds are evaluated in C as samples are fed; the outputs switch before Python sees the event
+        if not alert_wrapper.init_outputs([ALERT_LED_PIN, ALERT_BUZZER_PIN]):
+            log.error(f"Alert outputs (BCM {ALERT_LED_PIN}, {ALERT_BUZZER_PIN}) unavailable: alerts are logged and reported only")
+        # CO is a safety hazard: LED and buzzer. Particulates only light the LED.
+        led, buzzer = alert_wrapper.OUTPUT_LED, alert_wrapper.OUTPUT_BUZZER
+        self.alerts_by_rule = {}
+        self.rules_by_key = {}      # Snapshot key -> rules evaluated on it (SNAPSHOT_Q_ALERT)
+        for alert, key, outputs in ((self.co_alert, "co_level", (led, buzzer)),
+                                    (self.pm_2_5_alert, "pm_2_5_level", (led,)),
+                                    (self.pm_10_alert, "pm_10_level", (led,))):
+            rule = register_alert(alert, KEY_TO_CHANNEL[key], outputs)
+            self.alerts_by_rule[rule] = alert
+            self.rules_by_key.setdefault(key, []).append(rule)
+
+    @staticmethod
+    def _slave_id(devices, model, configured_id):
+        """Configured address if something answers there, else the only device found that can be this model."""
+        if not devices or any(dev["slave_id"] == configured_id for dev in devices):
+            return configured_id
+        # A device identified as another model is not a candidate, even if it answers this model's registers
+        found = ([dev["slave_id"] for dev in devices if dev["model"] == model] or
+                 [dev["slave_id"] for dev in devices if dev["model"] is None and model in dev["candidates"]])
+        if len(found) == 1:
+            log.warning(f"{model} not at 0x{configured_id:02X}, using the one found at 0x{found[0]:02X}")
+            return found[0]
+        return configured_id
+
+    def _alert_quality(self, key):
+        """SNAPSHOT_Q_ALERT while one of the key's rules is raised in the native evaluator."""
+        return SNAPSHOT_Q_ALERT if any(alert_wrapper.rule_active(rule) for rule in self.rules_by_key.get(key, ())) else 0
+
     def _sensor_thread(self):
-        """Thread 1: Constant Polling and Data Processing"""
+        """Thread 1: Consume samples produced by the native poller and process them"""
         log.info("RS485 Sensor Polling Thread Started")
+        self.sensors.start()
         while not self._stop_event.is_set():
             try:
-                # 1. Read Raw Values and Convert to Physical Values
-                # co_raw = self.co_sensor.read_raw_value(self.sensors._SensorManager__ctx)
-                pm_raw = self.pm_sensor.read_raw_value(self.sensors._SensorManager__ctx)
-                log.debug(f"Raw CO: {co_raw}, Raw PM2.5: {pm_raw[0]}, Raw PM10: {pm_raw[1]}")
-                co_raw = random.uniform(0, 100)  # Simulated raw value for testing
-                # pm_raw = [random.uniform(0, 100), random.uniform(0, 100)]  # Simulated raw value for testing
-                co_physical = self.co_sensor._raw_to_physical(co_raw)
-                pm_2_5_physical, pm_10_physical = self.pm_sensor._raw_to_physical(pm_raw)
-
-
-                # 2. Process (Filtering/Moving Average)
-                co_val = self.co_sensor.process_physical_value(co_physical)
-                pm_2_5_val = self.pm_sensor.process_physical_value(pm_2_5_physical)
-                pm_10_val = self.pm_sensor.process_physical_value(pm_10_physical)
-
-                # 3. Update Global Store (for Webserver/Other Processes)
-                self.global_store.set("co_level", co_val)
-                self.global_store.set("pm_2_5_level", pm_2_5_val)
-                self.global_store.set("pm_10_level", pm_10_val)
-
-                # 4. Notify Alert Thread
-                with self.rs485_data_ready_cv:
-                    self.rs485_data_ready_cv.notify_all()
+                # 1. Wait for finished samples (the C poller paces each sensor on its own period)
+                samples = self.sensors.wait_samples(timeout_ms=1000)
+                updated = False
+                for sensor, sample in samples:
+                    if not all(sample.valid[j] for j in range(sample.n_values)):
+                        health = self.sensors.health(sensor)
+                        if health is None or health["state"] != "offline":
+                            log.warning(f"{sensor._name}: incomplete read, last values kept")
+                        elif sensor not in self._offline:
+                            # Polls are skipped until a probe answers: log the outage once, not every period
+                            log.error(f"{sensor._name}: not answering, probed every {health['probe_interval_ms']} ms")
+                            self._offline.add(sensor)
+                        # Nothing downstream may see stale values as a new reading (alert persistence,
+                        # history, rollups, uplink): readers of the snapshot see the error flag instead
+                        for key in self.store_keys[sensor]:
+                            self.snapshot.set_quality(key, SNAPSHOT_Q_SENSOR_ERROR | self._alert_quality(key))
+                        continue
+                    if sensor in self._offline:
+                        log.info(f"{sensor._name}: answering again")
+                        self._offline.discard(sensor)
+                    log.debug(f"Raw {sensor._name} @ {sample.timestamp_ms}: {sample.values[:sample.n_values]}")
+
+                    # 2. Convert, calibrate and filter in one native call
+                    values = sensor.pipeline.process(sample)
+                    keys = self.store_keys[sensor]
+
+                    # 3. Evaluate alert rules first: the C evaluator drives the outputs immediately.
+                    #    Fed here rather than from the poller callback (rs485_poller_set_callback): rules
+                    #    compare converted, filtered values, and the filters' state lives in this
+                    #    thread's pipelines; feeding from the poller thread would mean moving them there.
+                    #    Cost: one queue wake-up between the end of the read and the outputs.
+                    alert_wrapper.feed_many([(KEY_TO_CHANNEL[key], value) for key, value in zip(keys, values)])
+
+                    # 4. Update Global Store (for Webserver/Other Processes)
+                    for key, value in zip(keys, values):
+                        self.global_store.set(key, value)
+                        self.snapshot.set(key, value, quality=self._alert_quality(key), timestamp_ms=sample.timestamp_ms)
+                        if not self.history.append(KEY_TO_CHANNEL[key], value, timestamp_ms=sample.timestamp_ms):
+                            if not self._history_rejected:
+                                log.warning(f"History refused {key} @ {sample.timestamp_ms}: not after the last stored sample "
+                                            f"(clock set back?) or not writable")
+                            self._history_rejected += 1
+                        self.rollups.add(KEY_TO_CHANNEL[key], value, timestamp_ms=sample.timestamp_ms)
+                    updated = True
+
+                if time.monotonic() - self._history_synced >= HISTORY_SYNC_S:
+                    if self._history_rejected:
+                        log.warning(f"History refused {self._history_rejected} samples in the last {HISTORY_SYNC_S} s")
+                        self._history_rejected = 0
+                    self.history.sync()
+                    self.history.prune(int((time.time() - HISTORY_RETENTION_DAYS * 86400) * 1000))
+                    self._history_synced = time.monotonic()
+
+                # 5. Notify other consumers of new data
+                if updated:
+                    with self.rs485_data_ready_cv:
+                        self.rs485_data_ready_cv.notify_all()
 
             except Exception as e:
                 log.error(f"Sensor Thread Error: {e}")
-            
-            time.sleep(5)
     def _alert_thread(self):
-        """Thread 2: Alert Checking and Triggering"""
+        """Thread 2: Log and report alerts raised by the native evaluator"""
         log.info("RS485 Alert Monitoring Thread Started")
         while not self._stop_event.is_set():
             try:
-            # 1. Wait for the signal (with a timeout so we can check _stop_event)
-                with self.rs485_data_ready_cv:
-                    # Wait for notification or 5s timeout to re-check stop_event
-                    signaled = self.rs485_data_ready_cv.wait(timeout=5.0)
-                if signaled:
-                    log.debug ("Alert Thread Notified of New Sensor Data")
-                    # Check CO Alert
-                    check_and_trigger_alert(self.co_alert, self.global_store.get("co_level", 0.0))
-                    # Check PM2.5 Alert
-                    check_and_trigger_alert(self.pm_2_5_alert, self.global_store.get("pm_2_5_level", 0.0))
-                    # Check PM10 Alert
-                    check_and_trigger_alert(self.pm_10_alert, self.global_store.get("pm_10_level", 0.0))
+                # Blocks in C until a rule changes state (1s timeout to re-check stop_event)
+                for rule, active, value, _ in alert_wrapper.wait_events(timeout_ms=1000):
+                    alert = self.alerts_by_rule.get(rule)
+                    if alert is not None and active:
+                        raise_alert(alert, value, drive_outputs=False)  # Outputs already switched in C
 
             except Exception as e:
                 log.error(f"Alert Thread Error: {e}")
-            
-            time.sleep(10)
-    
-    
+
     def start_rs485_process(self):
         """Entry point called by app.py multiprocessing.Process"""
         log.info("========== STARTING INTEGRATED RS485 PROCESS ==========")
         
         # Start the internal threads
         t1 = threading.Thread(target=self._sensor_thread, daemon=True)
+        t2 = threading.Thread(target=self._alert_thread, daemon=True)
 
         t1.start()
+        t2.start()
 
         self._ready_event.set() # Notify app.py that initialization is complete
         self._stop_event.wait() # Keep process alive until system shutdown
         
         # Cleanup hardware on exit
+        for bus in self.sensors.stats():
+            t = bus["total"]
+            log.info(f"{bus['device']}: {t['requests']} requests, {t['ok']} ok, {t['timeout']} timeouts, "
+                     f"{t['crc']} CRC errors, avg {t['latency_avg_us']:.0f} us, max {t['latency_max_us']} us")
+        for bus, t in enumerate(self.sensors.timing()):
+            if t is not None and t["cycles"]:
+                log.info(f"Bus {bus} schedule: {t['cycles']} polls, lateness avg {t['lateness_avg_us']:.0f} us "
+                         f"max {t['lateness_max_us']} us, jitter avg {t['jitter_avg_us']:.0f} us max {t['jitter_max_us']} us, "
+                         f"{t['overruns']} overruns ({t['missed_slots']} slots missed), cpu {t['cpu']}, priority {t['priority']}")
         self.sensors.shutdown()
-        turn_off_alert(self.co_alert)
+        self.snapshot.close()
+        self.history.close()
+        self.rollups.close()
+        for alert in self.alerts_by_rule.values():
+            turn_off_alert(alert)
+        alert_wrapper.close_alerts()    # Outputs low, lines released
+        close_alert_logs()
+        dropped = RS485Wrapper.native_log_stop()
+        if dropped:
+            log.warning(f"{dropped} native log records dropped (ring full)")
         log.info("RS485 Process Shutdown Cleanly")
     
     def stop(self):
@@ -0,0 +1,92 @@
+import ctypes
+import os
+import time
+
+# --- Configuration and Initialization ---
+ROLLUP_LIB_PATH = "/usr/lib/libdatahandle.so"
+ROLLUP_SHM_NAME = "/lsmy_rollup"
+
+# Check if library exists
+if not os.path.exists(ROLLUP_LIB_PATH):
+    raise FileNotFoundError("Required shared library (.so) is missing.")
+
+# Load the shared library
+lib_rollup = ctypes.CDLL(ROLLUP_LIB_PATH)
+
+# --- Constants (must match rollup.h) ---
+ROLLUP_MAX_CHANNELS = 16
+ROLLUP_RES_SECOND = 0
+ROLLUP_RES_MINUTE = 1
+ROLLUP_RES_HOUR = 2
+
+class RollupStats(ctypes.Structure):
+    _fields_ = [("min", ctypes.c_double), ("max", ctypes.c_double), ("avg", ctypes.c_double),
+                ("sum", ctypes.c_double), ("count", ctypes.c_uint64), ("start_ms", ctypes.c_uint64)]
+
+# --- Define C Signatures ---
+lib_rollup.rollup_open.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.POINTER(ctypes.c_int)]
+lib_rollup.rollup_open.restype = ctypes.c_void_p
+
+lib_rollup.rollup_add.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_double, ctypes.c_uint64]
+lib_rollup.rollup_add.restype = ctypes.c_int
+
+lib_rollup.rollup_query.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_uint64, ctypes.POINTER(RollupStats)]
+lib_rollup.rollup_query.restype = ctypes.c_int
+
+lib_rollup.rollup_series.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_uint64, ctypes.POINTER(RollupStats)]
+lib_rollup.rollup_series.restype = ctypes.c_int
+
+lib_rollup.rollup_capacity.argtypes = [ctypes.c_int]
+lib_rollup.rollup_capacity.restype = ctypes.c_int
+
+lib_rollup.rollup_close.argtypes = [ctypes.c_void_p]
+lib_rollup.rollup_close.restype = None
+
+def _stats_dict(s):
+    return {"start_ms": s.start_ms, "count": s.count, "min": s.min, "max": s.max, "avg": s.avg}
+
+# --- Exported Class ---
+class RollupStore:
+    def __init__(self, writer=False, name=ROLLUP_SHM_NAME):
+        """
+        1 s / 1 min / 1 h min-max-avg-count rollups per channel (use the Snapshot channel numbers).
+            @param writer: True only in the process that owns the sensors (RS485 process)
+            @param name: POSIX shared memory name, None for a private in-process store
+        """
+        err = ctypes.c_int(0)
+        self.__handle = lib_rollup.rollup_open(name.encode('utf-8') if name else None, 1 if writer else 0, ctypes.byref(err))
+        if not self.__handle:
+            raise OSError(f"Unable to open rollups {name} (error {err.value})")
+        self.__stats = RollupStats()
+        self.__series = (RollupStats * max(lib_rollup.rollup_capacity(r) for r in (ROLLUP_RES_SECOND, ROLLUP_RES_MINUTE, ROLLUP_RES_HOUR)))()
+
+    def add(self, channel, value, timestamp_ms=None):
+        """Adds one sample to every resolution of the channel."""
+        if timestamp_ms is None:
+            timestamp_ms = int(time.time() * 1000)
+        return lib_rollup.rollup_add(self.__handle, channel, value, timestamp_ms) == 0
+
+    def query(self, channel, resolution, n_buckets, now_ms=0):
+        """
+        Aggregate of the last n_buckets buckets (e.g. ROLLUP_RES_MINUTE, 15: last 15 minutes) as
+        {"start_ms", "count", "min", "max", "avg"} (count 0 = no data), None on error.
+        """
+        if lib_rollup.rollup_query(self.__handle, channel, resolution, n_buckets, now_ms, ctypes.byref(self.__stats)) != 0:
+            return None
+        return _stats_dict(self.__stats)
+
+    def series(self, channel, resolution, n_buckets, now_ms=0):
+        """The last n_buckets buckets, oldest first, as a list of query() dicts."""
+        n = lib_rollup.rollup_series(self.__handle, channel, resolution, min(n_buckets, len(self.__series)), now_ms, self.__series)
+        return [_stats_dict(s) for s in self.__series[:max(n, 0)]]
+
+    def last_minutes(self, channel, minutes):
+        return self.query(channel, ROLLUP_RES_MINUTE, minutes)
+
+    def last_hours(self, channel, hours):
+        return self.query(channel, ROLLUP_RES_HOUR, hours)
+
+    def close(self):
+        if self.__handle:
+            lib_rollup.rollup_close(self.__handle)
+            self.__handle = None
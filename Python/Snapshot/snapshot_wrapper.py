@@ -0,0 +1,153 @@
+import ctypes
+import os
+import time
+
+# --- Configuration and Initialization ---
+SNAPSHOT_LIB_PATH = "/usr/lib/libsnapshot.so"
+SNAPSHOT_SHM_NAME = "/lsmy_snapshot"
+
+# Check if library exists
+if not os.path.exists(SNAPSHOT_LIB_PATH):
+    raise FileNotFoundError("Required shared library (.so) is missing.")
+
+# Load the shared library
+lib_snapshot = ctypes.CDLL(SNAPSHOT_LIB_PATH)
+
+# --- Constants (must match snapshot.h) ---
+SNAPSHOT_CH_CO = 0
+SNAPSHOT_CH_PM25 = 1
+SNAPSHOT_CH_PM10 = 2
+SNAPSHOT_CH_COUNT = 3
+
+SNAPSHOT_Q_VALID = 0x01
+SNAPSHOT_Q_SENSOR_ERROR = 0x02
+SNAPSHOT_Q_ALERT = 0x04
+
+# --- Constants (must match telemetry.h) ---
+TELEMETRY_FMT_JSON = 0
+TELEMETRY_FMT_CBOR = 1
+TELEMETRY_E_SPACE = -2
+TELEMETRY_BUF_BYTES = 256           # One encoded sample (JSON is ~110 bytes)
+
+# CoreIoT telemetry key of each channel (same order as telemetry.c)
+TELEMETRY_KEYS = ("co", "pm25", "pm10")
+
+# Global store keys served by the snapshot
+KEY_TO_CHANNEL = {
+    "co_level": SNAPSHOT_CH_CO,
+    "pm_2_5_level": SNAPSHOT_CH_PM25,
+    "pm_10_level": SNAPSHOT_CH_PM10,
+}
+
+class SnapshotData(ctypes.Structure):
+    _fields_ = [("value", ctypes.c_double * SNAPSHOT_CH_COUNT),
+                ("timestamp_ms", ctypes.c_uint64 * SNAPSHOT_CH_COUNT),
+                ("quality", ctypes.c_uint32 * SNAPSHOT_CH_COUNT),
+                ("sequence", ctypes.c_uint64)]
+
+class TelemetrySample(ctypes.Structure):
+    _fields_ = [("ts_ms", ctypes.c_uint64),
+                ("value", ctypes.c_double * SNAPSHOT_CH_COUNT),
+                ("valid", ctypes.c_uint32)]
+
+# --- Define C Signatures ---
+lib_snapshot.snapshot_open.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.POINTER(ctypes.c_int)]
+lib_snapshot.snapshot_open.restype = ctypes.c_void_p
+
+lib_snapshot.snapshot_update.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_double, ctypes.c_uint64, ctypes.c_uint32]
+lib_snapshot.snapshot_update.restype = ctypes.c_int
+
+lib_snapshot.snapshot_set_quality.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_uint32]
+lib_snapshot.snapshot_set_quality.restype = ctypes.c_int
+
+lib_snapshot.snapshot_read.argtypes = [ctypes.c_void_p, ctypes.POINTER(SnapshotData)]
+lib_snapshot.snapshot_read.restype = ctypes.c_int
+
+lib_snapshot.snapshot_close.argtypes = [ctypes.c_void_p]
+lib_snapshot.snapshot_close.restype = None
+
+lib_snapshot.telemetry_encode.argtypes = [ctypes.POINTER(TelemetrySample), ctypes.c_int, ctypes.c_int, ctypes.c_int,
+                                          ctypes.c_char_p, ctypes.c_size_t]
+lib_snapshot.telemetry_encode.restype = ctypes.c_int
+
+lib_snapshot.telemetry_encode_snapshot.argtypes = [ctypes.c_void_p, ctypes.c_uint64, ctypes.c_int, ctypes.c_char_p, ctypes.c_size_t]
+lib_snapshot.telemetry_encode_snapshot.restype = ctypes.c_int
+
+# --- Telemetry encoding ---
+def encode_telemetry(samples, fmt=TELEMETRY_FMT_JSON):
+    """
+    Encodes {"ts": ms, "values": {"co": .., "pm25": .., "pm10": ..}} samples as one array
+    (same bytes as json.dumps(samples, separators=(',', ':')) for JSON). None values become null.
+    """
+    records = (TelemetrySample * len(samples))()
+    for record, sample in zip(records, samples):
+        record.ts_ms = sample["ts"]
+        for channel, key in enumerate(TELEMETRY_KEYS):
+            value = sample["values"].get(key)
+            if value is not None:
+                record.value[channel] = value
+                record.valid |= 1 << channel
+    size = 64 + 128 * len(samples)
+    while True:
+        buf = ctypes.create_string_buffer(size)
+        n = lib_snapshot.telemetry_encode(records, len(samples), 1, fmt, buf, size)
+        if n != TELEMETRY_E_SPACE:
+            break
+        size *= 2
+    if n < 0:
+        raise ValueError(f"Telemetry encoding failed (error {n})")
+    return buf.raw[:n]
+
+# --- Exported Class ---
+class SnapshotStore:
+    def __init__(self, writer=False, name=SNAPSHOT_SHM_NAME):
+        """
+        Shared-memory view of the latest sensor values.
+            @param writer: True only in the process that owns the sensors (RS485 process)
+            @param name: POSIX shared memory name
+        """
+        err = ctypes.c_int(0)
+        self.__handle = lib_snapshot.snapshot_open(name.encode('utf-8'), 1 if writer else 0, ctypes.byref(err))
+        if not self.__handle:
+            raise OSError(f"Unable to open snapshot {name} (error {err.value})")
+        self.__data = SnapshotData()
+        self.__telemetry_buf = ctypes.create_string_buffer(TELEMETRY_BUF_BYTES)
+
+    def set(self, key, value, quality=0, timestamp_ms=None):
+        """Publishes one value under a global store key (e.g., "co_level")."""
+        if timestamp_ms is None:
+            timestamp_ms = int(time.time() * 1000)
+        return lib_snapshot.snapshot_update(self.__handle, KEY_TO_CHANNEL[key], value, timestamp_ms, quality) == 0
+
+    def set_quality(self, key, quality):
+        """Replaces the SNAPSHOT_Q_* flags of a key, keeping its last value (e.g. SNAPSHOT_Q_SENSOR_ERROR on a failed poll)."""
+        return lib_snapshot.snapshot_set_quality(self.__handle, KEY_TO_CHANNEL[key], quality) == 0
+
+    def read(self):
+        """Returns a consistent SnapshotData copy, or None if the writer kept interfering."""
+        if lib_snapshot.snapshot_read(self.__handle, ctypes.byref(self.__data)) != 0:
+            return None
+        return self.__data
+
+    def get(self, key, default=None):
+        """Drop-in for global_store.get() on the sensor keys."""
+        channel = KEY_TO_CHANNEL.get(key)
+        data = self.read()
+        if channel is None or data is None or not (data.quality[channel] & SNAPSHOT_Q_VALID):
+            return default
+        return data.value[channel]
+
+    def telemetry(self, fmt=TELEMETRY_FMT_JSON, timestamp_ms=0):
+        """
+        Encodes the current values as one CoreIoT sample (bytes), stamped now unless timestamp_ms is given.
+        Channels never written or flagged SNAPSHOT_Q_SENSOR_ERROR are null. Returns None if the snapshot could not be read.
+        """
+        n = lib_snapshot.telemetry_encode_snapshot(self.__handle, timestamp_ms, fmt, self.__telemetry_buf, TELEMETRY_BUF_BYTES)
+        if n < 0:
+            return None
+        return self.__telemetry_buf.raw[:n]
+
+    def close(self):
+        if self.__handle:
+            lib_snapshot.snapshot_close(self.__handle)
+            self.__handle = None
@@ -0,0 +1,233 @@
+import json
+import os
+import shutil
+import socket
+import struct
+import tempfile
+import unittest
+
+from CoreIoT import uplink as uplink_module
+from CoreIoT.broker_sim import BrokerSim, CONNECT, CONNACK, PUBLISH, PUBACK, _read_packet
+from CoreIoT.uplink import TelemetryUplink
+
+"""
+TelemetryUplink against the local broker stand-in (broker_sim.py).
+
+The uplink publishes through a minimal synchronous MQTT 3.1.1 client (QoS 1, PUBACK awaited),
+so the tests need neither paho nor a network. Times are injected through the now= arguments.
+
+    cd Python && python3 -m unittest discover -s tests
+"""
+
+TOPIC = "v1/devices/me/telemetry"
+
+
+def _remaining_length(n):
+    out = bytearray()
+    while True:
+        byte = n & 0x7F
+        n >>= 7
+        out.append(byte | (0x80 if n else 0))
+        if not n:
+            return bytes(out)
+
+
+class MiniClient:
+    """Reconnects on demand, like paho's background loop does between two is_connected() calls."""
+
+    def __init__(self, port):
+        self.port = port
+        self.sock = None
+        self.packet_id = 0
+
+    def is_connected(self):
+        if self.sock is None:
+            self._connect()
+        return self.sock is not None
+
+    def publish(self, payload):
+        if self.sock is None:
+            return False
+        self.packet_id = self.packet_id % 0xFFFF + 1
+        body = struct.pack(">H", len(TOPIC)) + TOPIC.encode() + struct.pack(">H", self.packet_id) + payload.encode()
+        try:
+            self.sock.sendall(bytes([PUBLISH << 4 | 0x02]) + _remaining_length(len(body)) + body)
+            ptype, _, ack = _read_packet(self.sock)
+            if ptype == PUBACK and struct.unpack(">H", ack)[0] == self.packet_id:
+                return True
+        except (ConnectionError, OSError):
+            pass
+        self.close()
+        return False
+
+    def close(self):
+        if self.sock is not None:
+            self.sock.close()
+            self.sock = None
+
+    def _connect(self):
+        body = b"\x00\x04MQTT\x04\x02\x00\x3c" + b"\x00\x04test"
+        try:
+            sock = socket.create_connection(("127.0.0.1", self.port), timeout=2.0)
+        except OSError:
+            return
+        try:
+            sock.sendall(bytes([CONNECT << 4]) + _remaining_length(len(body)) + body)
+            ptype, _, _ = _read_packet(sock)
+            if ptype == CONNACK:
+                self.sock = sock
+                return
+        except (ConnectionError, OSError):
+            pass
+        sock.close()                    # Refused: the broker is down
+
+
+def sample(ts):
+    return {"ts": ts, "values": {"co": float(ts % 100), "pm25": None, "pm10": 1.5}}
+
+
+class UplinkBrokerTest(unittest.TestCase):
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.record = os.path.join(self.dir, "broker.jsonl")
+        self.broker = BrokerSim(port=0, record=self.record).start()
+        self.client = MiniClient(self.broker.server_address[1])
+        self.spool = os.path.join(self.dir, "spool")
+
+    def tearDown(self):
+        self.client.close()
+        self.broker.shutdown()
+        self.broker.server_close()
+        self.broker.state.record.close()
+        shutil.rmtree(self.dir)
+
+    def make_uplink(self, **kwargs):
+        return TelemetryUplink(self.client.publish, self.client.is_connected, self.spool, **kwargs)
+
+    def received(self):
+        """Timestamps of every sample the broker got, in arrival order."""
+        with open(self.record) as f:
+            return [s["ts"] for line in f for s in json.loads(json.loads(line)["payload"])]
+
+    def drain(self, up, now, step=None):
+        """Polls until the spool is empty. Returns the time reached."""
+        step = up.drain_interval if step is None else step
+        for _ in range(10000):
+            if not up.spool_bytes:
+                return now
+            up.poll(now=now)
+            now += step
+        self.fail("spool never drained")
+
+    def test_outage_and_reconnect(self):
+        up = self.make_uplink(max_samples=5, drain_rate=2.0)
+        ts = 0
+        for _ in range(10):
+            up.add(sample(ts), now=0.0)
+            ts += 1
+        self.assertEqual(up.stats["published"], 2)
+
+        self.broker.state.set_down(True)
+        for _ in range(20):
+            up.add(sample(ts), now=1.0)
+            ts += 1
+        self.assertEqual(up.stats["spooled"], 4)
+        self.assertGreater(up.spool_bytes, 0)
+
+        # While down, poll() must give the caller a real wait, not a busy loop
+        up.poll(now=2.0)
+        self.assertAlmostEqual(up.timeout(now=2.0), up.drain_interval)
+        up.poll(now=2.0)
+        self.assertGreater(up.timeout(now=2.0), 0.0)
+        self.assertEqual(up.stats["drained"], 0)
+
+        # Live batches queue behind the spool even once the link is back
+        self.broker.state.set_down(False)
+        for _ in range(5):
+            up.add(sample(ts), now=3.0)
+            ts += 1
+        self.assertEqual(up.stats["spooled"], 5)
+        self.drain(up, 3.0)
+        self.assertEqual(up.stats["drained"], 5)
+        self.assertEqual(self.received(), list(range(ts)))
+        up.close()
+
+    def test_spool_bound_drops_oldest_file(self):
+        saved = uplink_module.SPOOL_FILE_BYTES
+        uplink_module.SPOOL_FILE_BYTES = 1024
+        self.addCleanup(setattr, uplink_module, "SPOOL_FILE_BYTES", saved)
+
+        self.broker.state.set_down(True)
+        up = self.make_uplink(max_samples=4, spool_max_bytes=4096)
+        for ts in range(400):
+            up.add(sample(ts), now=0.0)
+        files = sorted(f for f in os.listdir(self.spool) if f.endswith(".spool"))
+        on_disk = sum(os.path.getsize(os.path.join(self.spool, f)) for f in files)
+        self.assertEqual(up.spool_bytes, on_disk)
+        self.assertLessEqual(up.spool_bytes, 4096)
+        self.assertGreater(up.stats["dropped_batches"], 0)
+        self.assertNotIn("00000000.spool", files)
+
+        self.broker.state.set_down(False)
+        self.drain(up, 1.0)
+        got = self.received()
+        # The oldest samples were dropped; what is left is the newest run, contiguous and in order
+        self.assertEqual(got, list(range(400 - len(got), 400)))
+        self.assertLess(len(got), 400)
+        up.close()
+
+    def test_drain_rate_and_order(self):
+        self.broker.state.set_down(True)
+        up = self.make_uplink(max_samples=2, drain_rate=4.0)
+        for ts in range(40):
+            up.add(sample(ts), now=0.0)
+        self.assertEqual(up.stats["spooled"], 20)
+        self.broker.state.set_down(False)
+
+        # Polled every 10 ms for 2 s: at most 4 batches a second go out
+        now = 10.0
+        while now < 12.0 - 1e-9:
+            up.poll(now=now)
+            self.assertLessEqual(up.timeout(now=now), up.drain_interval)
+            now += 0.01
+        self.assertEqual(up.stats["drained"], 8)
+        self.assertEqual(self.broker.state.summary()["messages"], 8)
+
+        self.drain(up, now, step=0.01)
+        self.assertEqual(up.stats["drained"], 20)
+        self.assertEqual(self.received(), list(range(40)))
+        up.close()
+
+    def test_torn_file_replayed_after_crash(self):
+        self.broker.state.set_down(True)
+        up = self.make_uplink(max_samples=3)
+        for ts in range(15):
+            up.add(sample(ts), now=0.0)
+        self.broker.state.set_down(False)
+        up.poll(now=1.0)
+        up.poll(now=2.0)
+        self.assertEqual(up.stats["drained"], 2)
+
+        # Crash mid-drain: no close(), and the last spooled write was cut short
+        path = os.path.join(self.spool, "00000000.spool")
+        up._writer[1].close()
+        up._reader[1].close()
+        with open(path, "ab") as f:
+            f.write(json.dumps([sample(99)], separators=(',', ':'))[:20].encode())
+
+        up = self.make_uplink(max_samples=3)
+        self.drain(up, 10.0)
+        up.add(sample(15), now=20.0)
+        up.add(sample(16), now=20.0)
+        up.add(sample(17), now=20.0)
+
+        # At-least-once: the two batches sent before the crash come again, the torn line never does
+        got = self.received()
+        self.assertEqual(got, list(range(6)) + list(range(18)))
+        self.assertEqual(up.spool_bytes, 0)
+        self.assertEqual(os.listdir(self.spool), [])
+        up.close()
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,11 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <unistd.h>
+#include <sys/timerfd.h>
 #include <modbus/modbus.h>
 
 #define SLAVE_ID   0x24
 #define REG_PM25   0x0004
 #define REG_PM10   0x0009
+#define PERIOD_S   1
 
 int main(void) {
     int baudrate = 9600;
@@ -29,6 +32,18 @@ int main(void) {
 
     uint16_t tab_reg[2];
 
+    // Periodic timer on an absolute grid: the reads below do not stretch the interval
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    struct itimerspec its = { .it_interval = { PERIOD_S, 0 }, .it_value = { now.tv_sec + PERIOD_S, now.tv_nsec } };
+    if (tfd == -1 || timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL) == -1) {
+        fprintf(stderr, "Unable to create the poll timer\n");
+        modbus_close(ctx);
+        modbus_free(ctx);
+        return -1;
+    }
+
     while (1) {
         if (modbus_read_registers(ctx, REG_PM25, 1, &tab_reg[0]) == -1) {
             fprintf(stderr, "Failed to read PM2.5\n");
@@ -42,9 +57,14 @@ int main(void) {
             printf("PM10: %.2f\n", (float)tab_reg[1]);
         }
 
-        sleep(1);
+        uint64_t expirations;
+        if (read(tfd, &expirations, sizeof(expirations)) == sizeof(expirations) && expirations > 1) {
+            fprintf(stderr, "Overrun: %llu periods missed\n", (unsigned long long)(expirations - 1));
+        }
     }
 
+    close(tfd);
+
     // --- Clean up Modbus ---
     modbus_close(ctx);
     modbus_free(ctx);